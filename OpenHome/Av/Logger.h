@@ -15,6 +15,7 @@ EXCEPTION(LogPostError);
 namespace OpenHome {
     class RingBufferLogger;
     class Environment;
+    class IInfoAggregator;
 namespace Net {
     class DvDevice;
 }
@@ -68,6 +69,7 @@ public:
     ~LoggerBuffered();
     ILoggerSerial& LoggerSerial();
     RingBufferLogger& LogBuffer();
+    IInfoAggregator& InfoAggregator(); // queries are available via the Debug service's GetInfo action
 private: // from IShellCommandHandler
     void HandleShellCommand(Brn aCommand, const std::vector<Brn>& aArgs, IWriter& aResponse) override;
     void DisplayHelp(IWriter& aResponse) override;
@@ -141,6 +141,7 @@ void MediaPlayer::AddAttribute(const TChar* aAttribute)
 ILoggerSerial& MediaPlayer::BufferLogOutput(TUint aBytes, IShell& aShell, Optional<ILogPoster> aLogPoster)
 {
     iLoggerBuffered = new LoggerBuffered(aBytes, iDevice, *iProduct, aShell, aLogPoster);
+    iPipeline->RegisterProfile(iLoggerBuffered->InfoAggregator());
     return iLoggerBuffered->LoggerSerial();
 }
 
@@ -3,6 +3,7 @@
 #include <OpenHome/Private/Stream.h>
 #include <OpenHome/Optional.h>
 #include <OpenHome/Av/Logger.h>
+#include <OpenHome/Media/Pipeline/LatencyTracer.h>
 
 using namespace OpenHome;
 using namespace OpenHome::Av;
@@ -12,9 +13,20 @@ ProviderDebug::ProviderDebug(DvDevice& aDevice, RingBufferLogger& aLogger, Optio
     : DvProviderAvOpenhomeOrgDebug1(aDevice)
     , iLogger(aLogger)
     , iLogPoster(aLogPoster)
+    , iLock("PDBG")
 {
     EnableActionGetLog();
     EnableActionSendLog();
+    EnableActionGetLatencyStats();
+    EnableActionGetInfo();
+}
+
+void ProviderDebug::Register(IInfoProvider& aProvider, std::vector<Brn>& aSupportedQueries)
+{
+    AutoMutex _(iLock);
+    for (auto& query : aSupportedQueries) {
+        iInfoQueries.push_back(InfoQuery(aProvider, query));
+    }
 }
 
 void ProviderDebug::GetLog(IDvInvocation& aInvocation, IDvInvocationResponseString& aLog)
@@ -34,3 +46,41 @@ void ProviderDebug::SendLog(IDvInvocation& aInvocation, const Brx& aData)
     aInvocation.StartResponse();
     aInvocation.EndResponse();
 }
+
+void ProviderDebug::GetLatencyStats(IDvInvocation& aInvocation, IDvInvocationResponseString& aStats)
+{
+    aInvocation.StartResponse();
+    Media::LatencyTracer::WriteJson(aStats);
+    aStats.WriteFlush();
+    aInvocation.EndResponse();
+}
+
+void ProviderDebug::GetInfo(IDvInvocation& aInvocation, const Brx& aQuery, IDvInvocationResponseString& aInfo)
+{
+    IInfoProvider* provider = nullptr;
+    {
+        AutoMutex _(iLock);
+        for (auto& query : iInfoQueries) {
+            if (query.iQuery == aQuery) {
+                provider = query.iProvider;
+                break;
+            }
+        }
+    }
+    if (provider == nullptr) {
+        aInvocation.Error(802, Brn("Unknown query"));
+    }
+    aInvocation.StartResponse();
+    provider->QueryInfo(aQuery, aInfo);
+    aInfo.WriteFlush();
+    aInvocation.EndResponse();
+}
+
+
+// ProviderDebug::InfoQuery
+
+ProviderDebug::InfoQuery::InfoQuery(IInfoProvider& aProvider, const Brx& aQuery)
+    : iProvider(&aProvider)
+    , iQuery(aQuery)
+{
+}
@@ -3,22 +3,41 @@
 #include <OpenHome/Types.h>
 #include <Generated/DvAvOpenhomeOrgDebug1.h>
 #include <OpenHome/Optional.h>
+#include <OpenHome/Private/InfoProvider.h>
+#include <OpenHome/Private/Thread.h>
+
+#include <vector>
 
 namespace OpenHome {
     class RingBufferLogger;
 namespace Av {
     class ILogPoster;
 
-class ProviderDebug : public Net::DvProviderAvOpenhomeOrgDebug1
+class ProviderDebug : public Net::DvProviderAvOpenhomeOrgDebug1, public IInfoAggregator
 {
 public:
     ProviderDebug(Net::DvDevice& aDevice, RingBufferLogger& aLogger, Optional<ILogPoster> aLogPoster);
+public: // from IInfoAggregator
+    void Register(IInfoProvider& aProvider, std::vector<Brn>& aSupportedQueries) override;
 private: // from DvProviderAvOpenhomeOrgDebug1
     void GetLog(Net::IDvInvocation& aInvocation, Net::IDvInvocationResponseString& aLog) override;
     void SendLog(Net::IDvInvocation& aInvocation, const Brx& aData) override;
+    void GetLatencyStats(Net::IDvInvocation& aInvocation, Net::IDvInvocationResponseString& aStats) override;
+    void GetInfo(Net::IDvInvocation& aInvocation, const Brx& aQuery, Net::IDvInvocationResponseString& aInfo) override;
+private:
+    class InfoQuery
+    {
+    public:
+        InfoQuery(IInfoProvider& aProvider, const Brx& aQuery);
+    public:
+        IInfoProvider* iProvider;
+        Brn iQuery;
+    };
 private:
     RingBufferLogger& iLogger;
     Optional<ILogPoster> iLogPoster;
+    Mutex iLock;
+    std::vector<InfoQuery> iInfoQueries;
 };
 
 } // namespace Av
@@ -26,6 +26,7 @@ SupplyScd::~SupplyScd()
 inline void SupplyScd::OutputEncodedAudio()
 {
     if (iAudioEncoded != nullptr) {
+        iAudioEncoded->TryStartLatencyTrace();
         iDownStreamElement.Push(iAudioEncoded);
         iAudioEncoded = nullptr;
     }
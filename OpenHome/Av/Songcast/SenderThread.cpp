@@ -1,5 +1,6 @@
 #include <OpenHome/Av/Songcast/SenderThread.h>
 #include <OpenHome/Media/Pipeline/Msg.h>
+#include <OpenHome/Media/Pipeline/ThreadScheduling.h>
 #include <OpenHome/Types.h>
 #include <OpenHome/Private/Thread.h>
 #include <OpenHome/Private/Printer.h>
@@ -43,6 +44,7 @@ void SenderThread::Push(Msg* aMsg)
 
 void SenderThread::Run()
 {
+    ThreadScheduling::Apply(PipelineThread::eSongcastSender);
     do {
         iThread->Wait();
         iLock.Wait();
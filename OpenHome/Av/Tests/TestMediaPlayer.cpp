@@ -6,6 +6,9 @@
 #include <OpenHome/Net/Core/DvDevice.h>
 #include <OpenHome/Media/PipelineManager.h>
 #include <OpenHome/Media/Utils/AllocatorInfoLogger.h>
+#include <OpenHome/Media/Utils/PipelineLogShell.h>
+#include <OpenHome/Media/Utils/LatencyTracerShell.h>
+#include <OpenHome/Media/Utils/PipelineProfileShell.h>
 #include <OpenHome/Private/Printer.h>
 #include <OpenHome/Private/TestFramework.h>
 #include <OpenHome/Media/Codec/CodecFactory.h>
@@ -140,6 +143,9 @@ TestMediaPlayer::TestMediaPlayer(Net::DvStack& aDvStack, const Brx& aUdn, const
     , iUserAgent(aUserAgent)
     , iTxTimestamper(nullptr)
     , iRxTimestamper(nullptr)
+    , iPipelineLogShell(nullptr)
+    , iLatencyTracerShell(nullptr)
+    , iPipelineProfileShell(nullptr)
     , iMinWebUiResourceThreads(aMinWebUiResourceThreads)
     , iMaxWebUiTabs(aMaxWebUiTabs)
     , iUiSendQueueSize(aUiSendQueueSize)
@@ -228,6 +234,9 @@ TestMediaPlayer::~TestMediaPlayer()
     delete iFnUpdaterUpnpAv;
     delete iFnManagerUpnpAv;
     ASSERT(!iDevice->Enabled());
+    delete iPipelineProfileShell;
+    delete iLatencyTracerShell;
+    delete iPipelineLogShell;
     delete iMediaPlayer;
     delete iPipelineObserver;
     delete iInfoLogger;
@@ -275,6 +284,9 @@ void TestMediaPlayer::Run()
     RegisterPlugins(iMediaPlayer->Env());
     AddConfigApp();
     InitialiseLogger();
+    iPipelineLogShell = new Media::PipelineLogShell(iMediaPlayer->Pipeline(), *(iMediaPlayer->Env().Shell()));
+    iLatencyTracerShell = new Media::LatencyTracerShell(*(iMediaPlayer->Env().Shell()));
+    iPipelineProfileShell = new Media::PipelineProfileShell(iMediaPlayer->Pipeline(), *(iMediaPlayer->Env().Shell()));
     iMediaPlayer->Start();
     InitialiseSubsystems();
 
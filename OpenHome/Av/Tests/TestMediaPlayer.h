@@ -39,6 +39,9 @@ namespace Media {
     class DriverSongcastSender;
     class IPullableClock;
     class AllocatorInfoLogger;
+    class PipelineLogShell;
+    class LatencyTracerShell;
+    class PipelineProfileShell;
 }
 namespace Configuration {
     class ConfigRamStore;
@@ -161,6 +164,9 @@ private:
     VolumeSinkLogger iVolumeLogger;
     Bws<Uri::kMaxUriBytes+1> iPresentationUrl;
     Media::LoggingPipelineObserver* iPipelineObserver;
+    Media::PipelineLogShell* iPipelineLogShell;
+    Media::LatencyTracerShell* iLatencyTracerShell;
+    Media::PipelineProfileShell* iPipelineProfileShell;
     Av::FriendlyNameAttributeUpdater* iFnUpdaterStandard;
     FriendlyNameManagerUpnpAv* iFnManagerUpnpAv;
     Av::FriendlyNameAttributeUpdater* iFnUpdaterUpnpAv;
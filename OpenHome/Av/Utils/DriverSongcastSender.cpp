@@ -7,7 +7,6 @@
 #include <OpenHome/OsWrapper.h>
 #include <OpenHome/Av/Songcast/OhmSender.h>
 #include <OpenHome/Private/Timer.h>
-#include <OpenHome/Media/Utils/ProcessorPcmUtils.h>
 #include <OpenHome/Net/Private/DviStack.h>
 #include <OpenHome/Private/Env.h>
 #include <OpenHome/Av/Songcast/ZoneHandler.h>
@@ -42,6 +41,8 @@ DriverSongcastSender::DriverSongcastSender(IPipelineElementUpstream& aPipeline,
     , iLastTimeUs(0)
     , iTimeOffsetUs(0)
     , iPlayable(nullptr)
+    , iAudioBuf(nullptr)
+    , iAudioBufBytes(0)
     , iAudioSent(false)
     , iQuit(false)
 {
@@ -88,12 +89,13 @@ DriverSongcastSender::~DriverSongcastSender()
     delete iOhmSenderDriver;
     delete iDevice;
     delete iZoneHandler;
+    delete[] iAudioBuf;
 }
 
 void DriverSongcastSender::DriverThread()
 {
     // pull the first (assumed non-audio) msg here so that any delays populating the pipeline don't affect timing calculations below.
-    Msg* msg = iPipeline.Pull();
+    Msg* msg = PullMsg();
     (void)msg->Process(*this);
 
     TUint64 now = OsTimeInUs(iEnv.OsCtx());
@@ -149,7 +151,7 @@ void DriverSongcastSender::DriverThread()
                 SendAudio(iPlayable);
             }
             else {
-                Msg* msg = iPipeline.Pull();
+                Msg* msg = PullMsg();
                 (void)msg->Process(*this);
             }
         }
@@ -158,14 +160,23 @@ void DriverSongcastSender::DriverThread()
 
     // pull until the pipeline is emptied
     while (!iQuit) {
-        Msg* msg = iPipeline.Pull();
+        Msg* msg = PullMsg();
         (void)msg->Process(*this);
         if (iPlayable != nullptr) {
             iPlayable->RemoveRef();
+            iPlayable = nullptr;
         }
     }
 }
 
+Msg* DriverSongcastSender::PullMsg()
+{
+    if (iPulled.IsEmpty()) {
+        iPipeline.PullBatch(iPulled, kMaxPullMsgs);
+    }
+    return iPulled.Dequeue();
+}
+
 void DriverSongcastSender::TimerCallback()
 {
     iThread->Signal();
@@ -189,11 +200,10 @@ void DriverSongcastSender::SendAudio(MsgPlayable* aMsg)
         }
     }
     iJiffiesToSend -= jiffies;
-    ProcessorPcmBufTest pcmProcessor;
-    aMsg->Read(pcmProcessor);
-    Brn buf = pcmProcessor.Buf();
-    const TUint numSubsamples = buf.Bytes() / (iBitDepth/8);
-    iOhmSenderDriver->SendAudio(buf.Ptr(), numSubsamples * (iBitDepth/8));
+    AnimatorBuffer buffer(iAudioBuf, iAudioBufBytes / ((iBitDepth/8) * iNumChannels),
+                          iNumChannels, iBitDepth/8, AudioDataEndian::Big);
+    aMsg->Read(buffer);
+    iOhmSenderDriver->SendAudio(iAudioBuf, buffer.SamplesWritten() * buffer.BytesPerSample());
     aMsg->RemoveRef();
 }
 
@@ -230,6 +240,13 @@ Msg* DriverSongcastSender::ProcessMsg(MsgDecodedStream* aMsg)
     }
     iBitDepth = stream.BitDepth();
     iJiffiesPerSample = Jiffies::PerSample(iSampleRate);
+    // SendAudio() never reads more than iMaxMsgSizeJiffies from a single msg
+    const TUint maxBytes = (iMaxMsgSizeJiffies / iJiffiesPerSample) * iNumChannels * (iBitDepth/8);
+    if (iAudioBufBytes < maxBytes) {
+        delete[] iAudioBuf;
+        iAudioBuf = new TByte[maxBytes];
+        iAudioBufBytes = maxBytes;
+    }
     iOhmSenderDriver->SetAudioFormat(iSampleRate, stream.BitRate(), reportedChannels,
                                      iBitDepth, stream.Lossless(), stream.CodecName(),
                                      stream.SampleStart());
@@ -239,6 +256,7 @@ Msg* DriverSongcastSender::ProcessMsg(MsgDecodedStream* aMsg)
 
 Msg* DriverSongcastSender::ProcessMsg(MsgPlayable* aMsg)
 {
+    aMsg->AddLogPoint(LatencyPoint::eAnimator);
     SendAudio(aMsg);
     return nullptr;
 }
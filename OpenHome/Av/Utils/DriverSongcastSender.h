@@ -20,6 +20,7 @@ class DriverSongcastSender : public Media::PipelineElement, private Net::IResour
     static const TUint kSongcastTtl = 1;
     static const TUint kSongcastLatencyMs = 300;
     static const TUint kSongcastPreset = 0;
+    static const TUint kMaxPullMsgs = 4;
     static const Brn kSenderIconFileName;
     static const TUint kSupportedMsgTypes;
 public:
@@ -27,6 +28,7 @@ public:
     ~DriverSongcastSender();
 private:
     void DriverThread();
+    Media::Msg* PullMsg();
     void TimerCallback();
     void SendAudio(Media::MsgPlayable* aMsg);
     void DeviceDisabled();
@@ -41,6 +43,7 @@ private: // from Net::IResourceManager
     void WriteResource(const Brx& aUriTail, TIpAddress aInterface, std::vector<char*>& aLanguageList, Net::IResourceWriter& aResourceWriter) override;
 private:
     Media::IPipelineElementUpstream& iPipeline;
+    Media::MsgQueueLite iPulled;
     TUint iMaxMsgSizeJiffies;
     Environment& iEnv;
     OhmSenderDriver* iOhmSenderDriver;
@@ -61,6 +64,8 @@ private:
                             //  <0 means sender is behind
                             //  >0 means sender is ahead
     Media::MsgPlayable* iPlayable;
+    TByte* iAudioBuf; // lent to each MsgPlayable so audio is written straight into the buffer we send
+    TUint iAudioBufBytes;
     TBool iAudioSent;
     TBool iQuit;
 };
@@ -8,9 +8,11 @@
 #include <OpenHome/Media/Codec/Id3v2.h>
 #include <OpenHome/Media/Pipeline/Rewinder.h>
 #include <OpenHome/Media/Pipeline/Logger.h>
+#include <OpenHome/Media/Pipeline/ThreadScheduling.h>
 #include <OpenHome/Media/Debug.h>
 
 #include <algorithm>
+#include <string.h>
 
 using namespace OpenHome;
 using namespace OpenHome::Media;
@@ -153,6 +155,7 @@ CodecController::CodecController(MsgFactory& aMsgFactory, IPipelineElementUpstre
     , iLock("CDCC")
     , iShutdownSem("CDC2", 0)
     , iActiveCodec(nullptr)
+    , iPrevCodec(nullptr)
     , iPendingMsg(nullptr)
     , iSeekObserver(nullptr)
     , iSeekHandle(0)
@@ -211,6 +214,7 @@ void CodecController::AddCodec(CodecBase* aCodec)
         }
     }
     iCodecs.insert(it, aCodec);
+    iRecognitionOrder.reserve(iCodecs.size());
 #if 0
     Log::Print("Sorted codecs are: ");
     it = iCodecs.begin();
@@ -226,6 +230,11 @@ void CodecController::Start()
     iDecoderThread->Start();
 }
 
+RecognitionStats& CodecController::Recognition()
+{
+    return iRecognitionStats;
+}
+
 void CodecController::StartSeek(TUint aStreamId, TUint aSecondsAbsolute, ISeekObserver& aObserver, TUint& aHandle)
 {
     AutoMutex a(iLock);
@@ -257,6 +266,7 @@ void CodecController::StartSeek(TUint aStreamId, TUint aSecondsAbsolute, ISeekOb
 
 void CodecController::CodecThread()
 {
+    ThreadScheduling::Apply(PipelineThread::eCodec);
     iStreamStarted = false;
     iSeek = false;
     iQuit = false;
@@ -300,10 +310,27 @@ void CodecController::CodecThread()
             }
 
             LOG(kMedia, "CodecThread: start recognition.  iTrackId=%u, iStreamId=%u\n", iTrackId, iStreamId);
+            const TUint64 recognitionStartUs = RecognitionStats::NowUs();
             TBool streamEnded = false;
 
-            for (size_t i=0; i<iCodecs.size() && !iQuit && !iStreamStopped; i++) {
-                CodecBase* codec = iCodecs[i];
+            Bws<RecognitionHint::kHeaderBytes> header;
+            TBool flushed = false;
+            // recognition order is irrelevant with a single codec so don't wait for the stream's first bytes
+            if (!iRawPcm && iCodecs.size() > 1) {
+                flushed = !PeekHeader(header);
+                iLock.Wait();
+                if (iStreamStarted || iStreamEnded) {
+                    streamEnded = true;
+                }
+                iStreamStarted = iStreamEnded = false;
+                Rewind();
+                iLock.Signal();
+            }
+            CodecBase* hinted = SetRecognitionOrder(header);
+            TUint attempts = 0;
+            for (size_t i=0; i<iRecognitionOrder.size() && !flushed && !iQuit && !iStreamStopped; i++) {
+                CodecBase* codec = iRecognitionOrder[i];
+                attempts++;
                 TBool recognised = false;
                 try {
                     recognised = codec->Recognise(streamInfo);
@@ -328,6 +355,7 @@ void CodecController::CodecThread()
                 iLock.Signal();
                 if (recognised) {
                     iActiveCodec = codec;
+                    iPrevCodec = codec;
                     break;
                 }
             }
@@ -336,6 +364,12 @@ void CodecController::CodecThread()
             if (iQuit) {
                 break;
             }
+            const TBool recognised = (iActiveCodec != nullptr);
+            // streams that were stopped or ended during recognition (plus Filler's null track) aren't expected to be recognised
+            if (recognised || (attempts > 0 && iStreamId != 0 && !iStreamStopped && !streamEnded)) {
+                iRecognitionStats.Add(RecognitionStats::NowUs() - recognitionStartUs, attempts, recognised,
+                                      hinted != nullptr, recognised && iActiveCodec == hinted);
+            }
             LOG(kMedia, "CodecThread: recognition complete\n");
             if (iActiveCodec == nullptr) {
                 if (iStreamId != 0  && // FIXME - hard-coded assumption about Filler's NullTrack
@@ -410,6 +444,10 @@ void CodecController::CodecThread()
             catch (CodecStreamFeatureUnsupported&) {
                 LOG2(kPipeline, kError, "WARNING: CodecStreamFeatureUnsupported\n");
             }
+            catch (AllocatorNoMemory&) {
+                // an elastic msg pool stayed full; abandon the stream rather than the codec thread
+                LOG2(kPipeline, kError, "WARNING: AllocatorNoMemory from codec %s\n", iActiveCodec->Id());
+            }
         }
         catch (CodecStreamStopped&) {}
         catch (CodecStreamFlush&) {}
@@ -434,6 +472,54 @@ void CodecController::CodecThread()
     }
 }
 
+TBool CodecController::PeekHeader(Bwx& aBuf)
+{
+    try {
+        Read(aBuf, aBuf.MaxBytes());
+    }
+    catch (CodecStreamStart&) {}
+    catch (CodecStreamEnded&) {}
+    catch (CodecStreamStopped&) {}
+    catch (CodecStreamFlush&) {
+        return false;
+    }
+    catch (CodecRecognitionOutOfData&) {}
+    return true;
+}
+
+CodecBase* CodecController::SetRecognitionOrder(const Brx& aHeader)
+{
+    /* Try codecs in order of likelihood.  A codec whose magic bytes match the start of the
+       stream is tried first.  After that, consecutive streams (e.g. tracks from the same album)
+       are very likely to share a format so the codec that decoded the previous stream is next.
+       Each of these saves the cost of rewinding through every failed Recognise() that would
+       otherwise precede it, at the point where the decoded reservoir is likely to be draining.
+       All other codecs follow in order of cost so are still tried if both guesses are wrong. */
+    CodecBase* hinted = nullptr;
+    const TChar* id = RecognitionHint::CodecId(aHeader);
+    if (id != nullptr) {
+        for (auto codec : iCodecs) {
+            if (strcmp(codec->Id(), id) == 0) {
+                hinted = codec;
+                break;
+            }
+        }
+    }
+    iRecognitionOrder.clear();
+    if (hinted != nullptr) {
+        iRecognitionOrder.push_back(hinted);
+    }
+    if (iPrevCodec != nullptr && iPrevCodec != hinted) {
+        iRecognitionOrder.push_back(iPrevCodec);
+    }
+    for (auto codec : iCodecs) {
+        if (codec != hinted && codec != iPrevCodec) {
+            iRecognitionOrder.push_back(codec);
+        }
+    }
+    return hinted;
+}
+
 void CodecController::Rewind()
 {
     iRewinder.Rewind();
@@ -487,6 +573,16 @@ void CodecController::ReleaseAudioEncoded()
     }
 }
 
+void CodecController::AbandonIfStopped()
+{
+    /* Once TryStop has returned a flush id for this stream, any audio decoded before that flush
+       is pulled will be discarded.  Drop encoded data we're holding rather than decode it. */
+    if (iStreamStopped && !iRecognising && iExpectedFlushId != MsgFlush::kIdInvalid) {
+        ReleaseAudioEncoded();
+        THROW(CodecStreamStopped);
+    }
+}
+
 void CodecController::Read(Bwx& aBuf, TUint aBytes)
 {
     if (iPendingMsg != nullptr) {
@@ -495,6 +591,7 @@ void CodecController::Read(Bwx& aBuf, TUint aBytes)
         }
         THROW(CodecStreamEnded);
     }
+    AbandonIfStopped();
     if (iStreamEnded || iStreamStopped) {
         if (DoRead(aBuf, aBytes)) {
             return;
@@ -550,6 +647,7 @@ TBool CodecController::DoRead(Bwx& aBuf, TUint aBytes)
 
 void CodecController::ReadNextMsg(Bwx& aBuf)
 {
+    AbandonIfStopped();
     while (iAudioEncoded == nullptr) {
         Msg* msg = PullMsg();
         if (msg != nullptr) {
@@ -564,6 +662,7 @@ void CodecController::ReadNextMsg(Bwx& aBuf)
 
 MsgAudioEncoded* CodecController::ReadNextMsg()
 {
+    AbandonIfStopped();
     while (iAudioEncoded == nullptr) {
         Msg* msg = PullMsg();
         if (msg != nullptr) {
@@ -664,7 +763,9 @@ void CodecController::OutputDecodedStream(TUint aBitRate, TUint aBitDepth, TUint
         Queue(msg);
     }
 
-    const TUint maxSamples = Jiffies::ToSamples(iMaxOutputJiffies, aSampleRate);
+    TUint maxSamples = Jiffies::ToSamples(iMaxOutputJiffies, aSampleRate);
+    const TUint decodedBytesPerSample = DecodedAudio::BytesPerSubsample(aBitDepth, iMsgFactory.DecodedFormat()) * aNumChannels;
+    maxSamples = std::min(maxSamples, DecodedAudio::kMaxBytes / decodedBytesPerSample);
     iMaxOutputBytes = maxSamples * (aBitDepth/8) * aNumChannels;
 }
 
@@ -708,19 +809,39 @@ TUint64 CodecController::OutputAudioPcm(MsgAudioEncoded* aMsg, TUint aChannels,
     ASSERT(aChannels == iChannels);
     ASSERT(aSampleRate == iSampleRate);
     ASSERT(aBitDepth == iBitDepth);
+    if (iMsgFactory.DecodedFormat() == DecodedAudioFormat::NativeInt32) {
+        // DecodedAudio will be larger than aMsg so may need to be split across several MsgAudioPcm
+        const TUint64 offsetBefore = aTrackOffset;
+        while (aMsg != nullptr) {
+            MsgAudioEncoded* remaining = (aMsg->Bytes() > iMaxOutputBytes? aMsg->Split(iMaxOutputBytes) : nullptr);
+            aMsg->CopyTo(const_cast<TByte*>(iPcmBuf.Ptr()));
+            iPcmBuf.SetBytes(aMsg->Bytes());
+            aMsg->RemoveRef();
+            aMsg = remaining;
+            MsgAudioPcm* audio = iMsgFactory.CreateMsgAudioPcm(iPcmBuf, aChannels, aSampleRate, aBitDepth, AudioDataEndian::Big, aTrackOffset);
+            aTrackOffset += DoOutputAudioPcm(audio);
+        }
+        return aTrackOffset - offsetBefore;
+    }
     MsgAudioPcm* audio = iMsgFactory.CreateMsgAudioPcm(aMsg, aChannels, aSampleRate, aBitDepth, aTrackOffset);
     aMsg->RemoveRef();
     return DoOutputAudioPcm(audio);
 }
 
-TUint64 CodecController::DoOutputAudioPcm(MsgAudio* aAudioMsg)
+TUint64 CodecController::DoOutputAudioPcm(MsgAudioPcm* aAudioMsg)
 {
     if (iExpectedFlushId != MsgFlush::kIdInvalid) {
         // Codec outputting audio while flush is pending
         // This audio may be cached by third party code so it's easier to ignore it here rather than tracking down all causes of it
+        iLatencyTrace.Clear();
         aAudioMsg->RemoveRef();
         return 0;
     }
+    if (iLatencyTrace.IsSet()) {
+        aAudioMsg->SetLatencyTrace(iLatencyTrace);
+        aAudioMsg->AddLogPoint(LatencyPoint::eCodec);
+        iLatencyTrace.Clear();
+    }
     if (iSeek && iSeekInProgress) {
         iSeekObserver->NotifySeekComplete(iSeekHandle, iExpectedSeekFlushId);
         iSeek = false;
@@ -854,8 +975,12 @@ Msg* CodecController::ProcessMsg(MsgAudioEncoded* aMsg)
 {
     if (!QueueTrackData()) {
         aMsg->RemoveRef();
+        return nullptr;
     }
-    else if (iAudioEncoded == nullptr) {
+    if (aMsg->IsLatencyTraced()) {
+        iLatencyTrace = aMsg->GetLatencyTrace();
+    }
+    if (iAudioEncoded == nullptr) {
         iAudioEncoded = aMsg;
     }
     else {
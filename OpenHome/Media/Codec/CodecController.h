@@ -6,6 +6,7 @@
 #include <OpenHome/Private/Standard.h>
 #include <OpenHome/Media/Pipeline/Msg.h>
 #include <OpenHome/Media/Pipeline/Rewinder.h>
+#include <OpenHome/Media/Codec/RecognitionHint.h>
 
 #include <atomic>
 #include <vector>
@@ -329,15 +330,19 @@ public:
     virtual ~CodecController();
     void AddCodec(CodecBase* aCodec);
     void Start();
+    RecognitionStats& Recognition();
 private:
     void CodecThread();
+    TBool PeekHeader(Bwx& aBuf); // returns false if a flush was encountered
+    CodecBase* SetRecognitionOrder(const Brx& aHeader); // returns codec suggested by aHeader, if any
     void Rewind();
     Msg* PullMsg();
     void Queue(Msg* aMsg);
     TBool QueueTrackData() const;
     void ReleaseAudioEncoded();
+    void AbandonIfStopped();
     TBool DoRead(Bwx& aBuf, TUint aBytes);
-    TUint64 DoOutputAudioPcm(MsgAudio* aAudioMsg);
+    TUint64 DoOutputAudioPcm(MsgAudioPcm* aAudioMsg);
 private: // ISeeker
     void StartSeek(TUint aStreamId, TUint aSecondsAbsolute, ISeekObserver& aObserver, TUint& aHandle) override;
 private: // ICodecController
@@ -391,8 +396,11 @@ private:
     Mutex iLock;
     Semaphore iShutdownSem;
     std::vector<CodecBase*> iCodecs;
+    std::vector<CodecBase*> iRecognitionOrder; // iCodecs, with any hinted codec then iPrevCodec moved to the front
+    RecognitionStats iRecognitionStats;
     ThreadFunctor* iDecoderThread;
     CodecBase* iActiveCodec;
+    CodecBase* iPrevCodec; // codec that decoded the most recently recognised stream
     Msg* iPendingMsg;
     TBool iQueueTrackData;
     TBool iStreamStarted;
@@ -411,6 +419,7 @@ private:
     MsgFlush* iPostSeekFlush;
     MsgDecodedStream* iPostSeekStreamInfo;
     MsgAudioEncoded* iAudioEncoded;
+    LatencyTrace iLatencyTrace; // from the most recent traced MsgAudioEncoded; passed to the next MsgAudioPcm output
 
     TBool iSeekable;
     TBool iLive;
@@ -428,6 +437,7 @@ private:
     TUint iTrackId;
     TUint iMaxOutputBytes;
     const TUint iMaxOutputJiffies;
+    Bws<DecodedAudio::kMaxBytes> iPcmBuf; // only used if iMsgFactory stores DecodedAudioFormat::NativeInt32
 };
 
 class CodecBufferedReader : public IReader, private INonCopyable
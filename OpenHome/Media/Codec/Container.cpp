@@ -433,6 +433,7 @@ ContainerController::ContainerController(MsgFactory& aMsgFactory, IPipelineEleme
     , iRewinder(iMsgFactory, aUpstreamElement)
     , iLoggerRewinder(nullptr)
     , iActiveContainer(nullptr)
+    , iHintedContainer(nullptr)
     , iContainerNull(nullptr)
     , iContainerDiscard(nullptr)
     , iStreamHandler(nullptr)
@@ -440,6 +441,7 @@ ContainerController::ContainerController(MsgFactory& aMsgFactory, IPipelineEleme
     , iRecognising(false)
     , iState(eRecognitionStart)
     , iRecogIdx(0)
+    , iRecognitionStartUs(0)
     , iStreamEnded(false)
     , iStreamId(IPipelineIdProvider::kStreamIdInvalid)
     , iExpectedFlushId(MsgFlush::kIdInvalid)
@@ -475,6 +477,12 @@ void ContainerController::AddContainer(ContainerBase* aContainer)
      iContainers.pop_back();
      iContainers.push_back(aContainer);
      iContainers.push_back(containerNull);
+     iRecognitionOrder.reserve(iContainers.size());
+}
+
+RecognitionStats& ContainerController::Recognition()
+{
+    return iRecognitionStats;
 }
 
 ContainerController::~ContainerController()
@@ -502,12 +510,40 @@ Msg* ContainerController::RecogniseContainer()
         iActiveContainer = nullptr;
         while (iState != eRecognitionComplete) {
             if (iState == eRecognitionStart) {
+                iRecognitionStartUs = RecognitionStats::NowUs();
+                iStreamEnded = false;
+                iRewinder.Rewind();
+                iCache->Reset();
+                iCache->Inspect(iSignature, iSignature.MaxBytes());
+                iState = eRecognitionSignature;
+            }
+            else if (iState == eRecognitionSignature) {
+                // Inspect the start of the stream once so that any container it suggests can be tried first.
+                // Streams shorter than iSignature (or that end early) are recognised without a hint.
+                if (!iStreamEnded) {
+                    try {
+                        Msg* msg = iCache->Pull();
+                        if (msg != nullptr) {
+                            return msg;
+                        }
+                    }
+                    catch (CodecPulledNullMsg&) {
+                        iSignature.SetBytes(0);
+                    }
+                    catch (AudioCacheException&) {
+                        iSignature.SetBytes(0);
+                    }
+                }
+                else {
+                    iSignature.SetBytes(0);
+                }
+                iHintedContainer = SetRecognitionOrder();
                 iRecogIdx = 0;
                 iState = eRecognitionSelectContainer;
             }
             else if (iState == eRecognitionSelectContainer) {
-                ASSERT(iRecogIdx < iContainers.size()); // ContainerNull should always recognise.
-                auto& container = iContainers[iRecogIdx];
+                ASSERT(iRecogIdx < iRecognitionOrder.size()); // ContainerNull should always recognise.
+                auto& container = iRecognitionOrder[iRecogIdx];
                 iStreamEnded = false;
                 iRewinder.Rewind();
                 iCache->Reset();
@@ -516,7 +552,7 @@ Msg* ContainerController::RecogniseContainer()
             }
             else if (iState == eRecognitionContainer) {
                 if (!iStreamEnded) {
-                    auto& container = iContainers[iRecogIdx];
+                    auto& container = iRecognitionOrder[iRecogIdx];
                     try {
                         Msg* msg = container->Recognise();
                         if (msg != nullptr) {
@@ -526,6 +562,8 @@ Msg* ContainerController::RecogniseContainer()
                         if (container->Recognised()) {
                             container->Init(iStreamBytes);
                             iActiveContainer = container;
+                            iRecognitionStats.Add(RecognitionStats::NowUs() - iRecognitionStartUs, iRecogIdx + 1, true,
+                                                  iHintedContainer != nullptr, container == iHintedContainer);
                             iRewinder.Rewind();
                             iRewinder.Stop();
                             iCache->Reset();
@@ -573,6 +611,33 @@ Msg* ContainerController::RecogniseContainer()
     }
 }
 
+ContainerBase* ContainerController::SetRecognitionOrder()
+{
+    /* A container whose magic bytes match the start of the stream is tried first.  The
+       remaining containers follow in the order they were added, with ContainerNull last. */
+    ContainerBase* hinted = nullptr;
+    const TChar* id = RecognitionHint::ContainerId(iSignature);
+    if (id != nullptr) {
+        const Brn idBuf(id);
+        for (auto container : iContainers) {
+            if (container->Id() == idBuf) {
+                hinted = container;
+                break;
+            }
+        }
+    }
+    iRecognitionOrder.clear();
+    if (hinted != nullptr) {
+        iRecognitionOrder.push_back(hinted);
+    }
+    for (auto container : iContainers) {
+        if (container != hinted) {
+            iRecognitionOrder.push_back(container);
+        }
+    }
+    return hinted;
+}
+
 Msg* ContainerController::Pull()
 {
     TBool recognising = false;
@@ -842,6 +907,8 @@ TUint ContainerController::TryStop(TUint aStreamId)
         return MsgFlush::kIdInvalid;
     }
     iExpectedFlushId = flushId;
+    // discard encoded audio in the cache rather than have the container parse data that will never be played
+    iCache->SetFlushing(iExpectedFlushId);
     return iExpectedFlushId;
 }
 
@@ -7,6 +7,7 @@
 #include <OpenHome/Media/Pipeline/Msg.h>
 #include <OpenHome/Media/Pipeline/Rewinder.h>
 #include <OpenHome/Media/Pipeline/Logger.h>
+#include <OpenHome/Media/Codec/RecognitionHint.h>
 
 #include <atomic>
 #include <vector>
@@ -183,8 +184,10 @@ public:
     ContainerController(MsgFactory& aMsgFactory, IPipelineElementUpstream& aUpstreamElement, IUrlBlockWriter& aUrlBlockWriter, TBool aLogger);
     ~ContainerController();
     void AddContainer(ContainerBase* aContainer);
+    RecognitionStats& Recognition();
 private:
     Msg* RecogniseContainer();
+    ContainerBase* SetRecognitionOrder();
 public: // from IPipelineElementUpstream
     Msg* Pull() override;
 private: // IMsgProcessor
@@ -221,6 +224,7 @@ private:
     enum ERecognitionState
     {
         eRecognitionStart,
+        eRecognitionSignature,
         eRecognitionSelectContainer,
         eRecognitionContainer,
         eRecognitionComplete,
@@ -232,7 +236,9 @@ private:
     Logger* iLoggerRewinder;
     MsgAudioEncodedCache* iCache;
     std::vector<ContainerBase*> iContainers;
+    std::vector<ContainerBase*> iRecognitionOrder;
     ContainerBase* iActiveContainer;
+    ContainerBase* iHintedContainer;
     ContainerNull* iContainerNull;
     ContainerDiscard* iContainerDiscard;
     std::atomic<IStreamHandler*> iStreamHandler;
@@ -241,6 +247,9 @@ private:
     TBool iRecognising;
     ERecognitionState iState;
     TUint iRecogIdx;
+    Bws<RecognitionHint::kHeaderBytes> iSignature;
+    TUint64 iRecognitionStartUs;
+    RecognitionStats iRecognitionStats;
     TBool iStreamEnded;
     TUint iStreamId;
     TUint64 iStreamBytes;
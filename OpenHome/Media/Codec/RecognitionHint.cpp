@@ -0,0 +1,157 @@
+#include <OpenHome/Media/Codec/RecognitionHint.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/OsWrapper.h>
+#include <OpenHome/Private/Ascii.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Net/Private/Globals.h>
+
+#include <atomic>
+#include <string.h>
+
+using namespace OpenHome;
+using namespace OpenHome::Media;
+using namespace OpenHome::Media::Codec;
+
+// RecognitionHint
+
+const TChar* RecognitionHint::CodecId(const Brx& aHeader)
+{ // static
+    if (Matches(aHeader, 0, "fLaC")) {
+        return "FLAC";
+    }
+    if (Matches(aHeader, 0, "OggS")) {
+        // first page of an Ogg stream normally has a single segment; its packet starts at byte 28
+        if (Matches(aHeader, 29, "FLAC") || Matches(aHeader, 37, "fLaC")) {
+            return "FLAC";
+        }
+        return "Vorbis";
+    }
+    if (Matches(aHeader, 0, "RIFF") && Matches(aHeader, 8, "WAVE")) {
+        return "WAV";
+    }
+    if (Matches(aHeader, 0, "FORM")) {
+        if (Matches(aHeader, 8, "AIFF")) {
+            return "AIFF";
+        }
+        if (Matches(aHeader, 8, "AIFC")) {
+            return "AIFC";
+        }
+        return nullptr;
+    }
+    // MPEG-4 container outputs a codec identifier ahead of the codec's config
+    if (Matches(aHeader, 0, "mp4a")) {
+        return "AAC";
+    }
+    if (Matches(aHeader, 0, "alac")) {
+        return "ALAC";
+    }
+    // MPEG audio frame sync.  The layer bits are 00 for ADTS; non-zero for MP1/2/3
+    if (aHeader.Bytes() >= 2 && aHeader[0] == 0xff && (aHeader[1] & 0xe0) == 0xe0) {
+        return ((aHeader[1] & 0x06) == 0? "ADTS" : "MP3");
+    }
+    return nullptr;
+}
+
+const TChar* RecognitionHint::ContainerId(const Brx& aHeader)
+{ // static
+    if (Matches(aHeader, 0, "ID3")) {
+        return "ID3";
+    }
+    if (Matches(aHeader, 4, "ftyp")) {
+        return "MP4";
+    }
+    static const TByte kMpegTsSyncByte = 0x47;
+    if (aHeader.Bytes() > 0 && aHeader[0] == kMpegTsSyncByte) {
+        return "MTS";
+    }
+    return nullptr;
+}
+
+TBool RecognitionHint::Matches(const Brx& aHeader, TUint aOffset, const TChar* aMagic)
+{ // static
+    const TUint bytes = (TUint)strlen(aMagic);
+    if (aHeader.Bytes() < aOffset + bytes) {
+        return false;
+    }
+    return memcmp(aHeader.Ptr() + aOffset, aMagic, bytes) == 0;
+}
+
+
+// RecognitionStats
+
+RecognitionStats::RecognitionStats()
+{
+    Reset();
+}
+
+void RecognitionStats::Add(TUint64 aDurationUs, TUint aAttempts, TBool aRecognised, TBool aHinted, TBool aHintCorrect)
+{
+    iCount.fetch_add(1, std::memory_order_relaxed);
+    iTotalUs.fetch_add(aDurationUs, std::memory_order_relaxed);
+    if (aDurationUs > iMaxUs.load(std::memory_order_relaxed)) {
+        iMaxUs.store(aDurationUs, std::memory_order_relaxed);
+    }
+    iAttempts.fetch_add(aAttempts, std::memory_order_relaxed);
+    if (!aRecognised) {
+        iFailures.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (aHinted) {
+        iHinted.fetch_add(1, std::memory_order_relaxed);
+        if (aHintCorrect) {
+            iHintsCorrect.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void RecognitionStats::Reset()
+{
+    iCount.store(0);
+    iTotalUs.store(0);
+    iMaxUs.store(0);
+    iAttempts.store(0);
+    iFailures.store(0);
+    iHinted.store(0);
+    iHintsCorrect.store(0);
+}
+
+void RecognitionStats::WriteJson(IWriter& aWriter) const
+{
+    const TUint64 count = iCount.load();
+    WriterAscii writer(aWriter);
+    writer.Write(Brn("{\"streams\":"));
+    writer.WriteUint64(count);
+    writer.Write(Brn(",\"meanUs\":"));
+    writer.WriteUint64(count == 0? 0 : iTotalUs.load() / count);
+    writer.Write(Brn(",\"maxUs\":"));
+    writer.WriteUint64(iMaxUs.load());
+    writer.Write(Brn(",\"attempts\":"));
+    writer.WriteUint64(iAttempts.load());
+    writer.Write(Brn(",\"failures\":"));
+    writer.WriteUint64(iFailures.load());
+    writer.Write(Brn(",\"hinted\":"));
+    writer.WriteUint64(iHinted.load());
+    writer.Write(Brn(",\"hintsCorrect\":"));
+    writer.WriteUint64(iHintsCorrect.load());
+    writer.Write('}');
+}
+
+TUint64 RecognitionStats::Count() const
+{
+    return iCount.load();
+}
+
+TUint64 RecognitionStats::Failures() const
+{
+    return iFailures.load();
+}
+
+TUint64 RecognitionStats::HintsCorrect() const
+{
+    return iHintsCorrect.load();
+}
+
+TUint64 RecognitionStats::NowUs()
+{ // static
+    return OsTimeInUs(gEnv->OsCtx());
+}
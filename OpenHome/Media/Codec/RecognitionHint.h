@@ -0,0 +1,59 @@
+#pragma once
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+
+#include <atomic>
+
+namespace OpenHome {
+    class IWriter;
+namespace Media {
+namespace Codec {
+
+/*
+ Guesses the format of a stream from the magic bytes at its start.
+
+ Used by CodecController and ContainerController to choose which codec/container to
+ try first.  A guess is only a hint - full recognition is always run on the suggested
+ codec/container and all others are still tried if it fails.
+*/
+class RecognitionHint
+{
+public:
+    static const TUint kHeaderBytes = 42; // enough to distinguish Ogg FLAC from Ogg Vorbis
+public:
+    static const TChar* CodecId(const Brx& aHeader);     // nullptr if no codec is suggested
+    static const TChar* ContainerId(const Brx& aHeader); // nullptr if no container is suggested
+private:
+    static TBool Matches(const Brx& aHeader, TUint aOffset, const TChar* aMagic);
+};
+
+/*
+ Time taken to recognise streams (including those no codec/container recognised), and the
+ accuracy of RecognitionHint.
+ Updated by a single (recognising) thread; may be read or reset from any thread.
+*/
+class RecognitionStats
+{
+public:
+    RecognitionStats();
+    void Add(TUint64 aDurationUs, TUint aAttempts, TBool aRecognised, TBool aHinted, TBool aHintCorrect);
+    void Reset();
+    void WriteJson(IWriter& aWriter) const;
+    TUint64 Count() const;
+    TUint64 Failures() const;
+    TUint64 HintsCorrect() const;
+    static TUint64 NowUs();
+private:
+    std::atomic<TUint64> iCount;
+    std::atomic<TUint64> iTotalUs;
+    std::atomic<TUint64> iMaxUs;
+    std::atomic<TUint64> iAttempts; // total number of Recognise() calls
+    std::atomic<TUint64> iFailures;
+    std::atomic<TUint64> iHinted;
+    std::atomic<TUint64> iHintsCorrect;
+};
+
+} // namespace Codec
+} // namespace Media
+} // namespace OpenHome
@@ -6,6 +6,7 @@
 #include <OpenHome/Media/Pipeline/Msg.h>
 #include <OpenHome/Media/IdManager.h>
 #include <OpenHome/Media/Protocol/Protocol.h>
+#include <OpenHome/Media/Pipeline/ThreadScheduling.h>
 #include <OpenHome/Media/Debug.h>
 
 using namespace OpenHome;
@@ -302,6 +303,7 @@ TUint Filler::StopLocked()
 
 void Filler::Run()
 {
+    ThreadScheduling::Apply(PipelineThread::eProtocol);
     try {
         Wait();
         for (;;) {
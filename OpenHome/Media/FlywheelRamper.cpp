@@ -4,6 +4,8 @@
 #include <OpenHome/Media/FlywheelRamper.h>
 #include <OpenHome/Private/Debug.h>
 
+#include <string.h>
+
 using namespace OpenHome;
 using namespace OpenHome::Media;
 using namespace std;
@@ -61,8 +63,6 @@ void FlywheelRamperManager::Ramp(const Brx& aSamples, TUint aSampleRate, TUint a
         remainingSamples -= outputSamples;
         RenderChannels(outputSamples, decFactor, aChannelCount); // output ramp audio data
     }
-
-    Reset(); // clear memory ready for next ramp request
 }
 
 void FlywheelRamperManager::InitChannels(const Brx& aSamples, TUint aSampleRate, TUint aChannelCount)
@@ -82,37 +82,33 @@ void FlywheelRamperManager::InitChannels(const Brx& aSamples, TUint aSampleRate,
 void FlywheelRamperManager::RenderChannels(TUint aSampleCount, TUint aDecFactor, TUint aChannelCount)
 {
     TByte* ptr = (TByte*)iOutBuf.Ptr();
-    TUint outputBytes = 0;
+    const TUint frameBytes = aChannelCount * FlywheelRamper::kBytesPerSample;
     TUint sampleHoldCount = 0;
 
-    TInt32 prevSample[kMaxChannelCount];
-
     for(TUint j=0; j<aSampleCount; j++)
     {
-        for(TUint k=0; k<aChannelCount; k++)
+        if (sampleHoldCount==0)
         {
-            TInt32 sample;
-            if (sampleHoldCount==0)
+            for(TUint k=0; k<aChannelCount; k++)
             {
-                sample = iRampers[k]->NextSample();
-                prevSample[k] = sample;
+                TInt32 sample = iRampers[k]->NextSample();
+
+                // write out in big endian format
+                ptr[3] = (TByte)sample;
+                sample >>= 8;
+                ptr[2] = (TByte)sample;
+                sample >>= 8;
+                ptr[1] = (TByte)sample;
+                sample >>= 8;
+                ptr[0] = (TByte)sample;
+                ptr += 4;
             }
-            else
-            {
-                sample = prevSample[k];
-            }
-
-            // write out in big endian format
-            *(ptr+3) = (TByte)sample;
-            sample >>= 8;
-            *(ptr+2) = (TByte)sample;
-            sample >>= 8;
-            *(ptr+1) = (TByte)sample;
-            sample >>= 8;
-            *(ptr) = (TByte)sample;
-
-            ptr += 4;
-            outputBytes += 4;
+        }
+        else
+        {
+            // decimated generation - repeat the previous frame
+            (void)memcpy(ptr, ptr-frameBytes, frameBytes);
+            ptr += frameBytes;
         }
 
         if (++sampleHoldCount == aDecFactor)
@@ -121,21 +117,13 @@ void FlywheelRamperManager::RenderChannels(TUint aSampleCount, TUint aDecFactor,
         }
     }
 
-    iOutBuf.SetBytes(outputBytes);
+    iOutBuf.SetBytes(aSampleCount * frameBytes);
     iOutput.BeginBlock();
     iOutput.ProcessFragment32(iOutBuf, aChannelCount);
     iOutput.EndBlock();
 
 }
 
-void FlywheelRamperManager::Reset()
-{
-    for(TUint i=0; i<kMaxChannelCount; i++)
-    {
-        iRampers[i]->Reset(); // clears memory ready for next ramp request
-    }
-}
-
 ////////////////////////////////////////////////////////////////////////////////////////////
 
 FlywheelRamper::FlywheelRamper(TUint aDegree, TUint aInputJiffies)
@@ -188,8 +176,10 @@ void FlywheelRamper::Initialise(const Brx& aSamples, TUint aSampleRate)
         bufPtr += (aSamples.Bytes() - expectedBytes);
     }
 
-    TUint sampleCount = aSamples.Bytes()/(kBytesPerSample*decFactor);
+    TUint sampleCount = expectedBytes/(kBytesPerSample*decFactor);
     TUint ptrInc = 4*decFactor;
+    ASSERT(sampleCount <= iMaxInputSampleCount);
+    ClearBurgState(sampleCount); // only the samples used by this ramp
 
     for(TUint i=0; i<sampleCount; i++)
     {
@@ -232,10 +222,10 @@ void FlywheelRamper::PrepareFeedbackCoeffs()
     }
 }
 
-void FlywheelRamper::Reset()
+void FlywheelRamper::ClearBurgState(TUint aSampleCount)
 {
-    memset(iBurgPer, 0, iMaxInputSampleCount*sizeof(TInt16)); // clear
-    memset(iBurgPef, 0, iMaxInputSampleCount*sizeof(TInt16)); // clear
+    memset(iBurgPer, 0, aSampleCount*sizeof(TInt16)); // clear
+    memset(iBurgPef, 0, aSampleCount*sizeof(TInt16)); // clear
 }
 
 TInt32 FlywheelRamper::NextSample()
@@ -42,7 +42,6 @@ private:
     void Initialise(const Brx& aSamples, TUint aSampleRate);
     TUint InputJiffies() const;
     TInt32 NextSample();
-    void Reset();
 public:
     static void BurgsMethod(TInt16* aSamples, TUint aSamplesCount, TUint aDegree, TInt16* aOutput, TInt16* aH, TInt16* aPer, TInt16* aPef);
     static TUint SampleCount(TUint aSampleRate, TUint aJiffies) { return Jiffies::ToSamples(aJiffies, aSampleRate); }
@@ -55,6 +54,7 @@ public:
 private:
     void PrepareFeedbackCoeffs();
     void CorrectBurgCoeffs();
+    void ClearBurgState(TUint aSampleCount);
 private:
     TUint iDegree;
     TUint iInputJiffies;
@@ -87,7 +87,6 @@ public:
 private:
     void InitChannels(const Brx& aSamples, TUint aSampleRate, TUint aChannelCount);
     void RenderChannels(TUint aSampleCount, TUint aDecFactor, TUint aChannelCount);
-    void Reset();
 private:
     IPcmProcessor& iOutput;
     Bwh iOutBuf;
@@ -56,6 +56,24 @@ Msg* AnalogBypassRamper::Pull()
     return msg;
 }
 
+void AnalogBypassRamper::PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs)
+{
+    Msg* msg = iUpstream.PullBatch(aMaxMsgs);
+    AutoMutex _(iLock);
+    TUint count = 0;
+    do {
+        iHalting = false;
+        aQueue.Enqueue(msg->Process(*this));
+        /* Halted()/Drained() check that nothing was pulled after a halt or drain.  Volume follows
+           the ramp of each msg when bypass is enabled so don't pull ahead of the animator then either. */
+    } while (!iHalting && !iAnalogBypassEnabled && ++count < aMaxMsgs && (msg = iUpstream.TryPull()) != nullptr);
+}
+
+UpstreamLink* AnalogBypassRamper::SpliceableUpstream()
+{
+    return &iUpstream;
+}
+
 Msg* AnalogBypassRamper::ProcessMsg(MsgDrain* aMsg)
 {
     ASSERT(iMsgDrain == nullptr);
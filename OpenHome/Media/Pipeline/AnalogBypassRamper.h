@@ -29,6 +29,8 @@ public:
     void SetVolumeRamper(IAnalogBypassVolumeRamper& aVolumeRamper);
 private: // from IPipelineElementUpstream
     Msg* Pull() override;
+    void PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs) override;
+    UpstreamLink* SpliceableUpstream() override;
 private: // IMsgProcessor
     Msg* ProcessMsg(MsgDrain* aMsg) override;
     Msg* ProcessMsg(MsgHalt* aMsg) override;
@@ -41,7 +43,7 @@ private:
     void CheckForHalted();
 private:
     MsgFactory& iMsgFactory;
-    IPipelineElementUpstream& iUpstream;
+    UpstreamLink iUpstream;
     Mutex iLock;
     IAnalogBypassVolumeRamper* iVolumeRamper;
     MsgDrain* iMsgDrain;
@@ -43,6 +43,11 @@ Msg* Attenuator::Pull()
     return msg;
 }
 
+UpstreamLink* Attenuator::SpliceableUpstream()
+{
+    return &iUpstreamElement;
+}
+
 Msg* Attenuator::ProcessMsg(MsgMode* aMsg)
 {
     iActive = aMsg->Mode() == Brn("RAOP");
@@ -31,11 +31,12 @@ public: // from IAttenuator
     void SetAttenuation(TUint aAttenuation) override;
 public: // from IPipelineElementUpstream
     Msg* Pull() override;
+    UpstreamLink* SpliceableUpstream() override;
 private: // IMsgProcessor
     Msg* ProcessMsg(MsgMode* aMsg) override;
     Msg* ProcessMsg(MsgAudioPcm* aMsg) override;
 private:
-    IPipelineElementUpstream& iUpstreamElement;
+    UpstreamLink iUpstreamElement;
     std::atomic<TUint> iAttenuation;
     TBool iActive;
 };
@@ -0,0 +1,481 @@
+#include <OpenHome/Media/Pipeline/AudioDumpWriter.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Standard.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Private/File.h>
+#include <OpenHome/Private/Printer.h>
+#include <OpenHome/Media/Debug.h>
+
+#include <algorithm>
+#include <string.h>
+
+using namespace OpenHome;
+using namespace OpenHome::Media;
+
+// AudioDumpWriter
+
+AudioDumpWriter::AudioDumpWriter(TUint aRingBytes, TUint aThreadPriority)
+    : AudioDumpWriter(aRingBytes, aThreadPriority, iFileSystemAnsii)
+{
+}
+
+AudioDumpWriter::AudioDumpWriter(TUint aRingBytes, TUint aThreadPriority, IFileSystem& aFileSystem)
+    : iRingBytes(aRingBytes)
+    , iWriteCount(0)
+    , iReadCount(0)
+    , iDroppedBytes(0)
+    , iDroppedBytesFile(0)
+    , iReserved(0)
+    , iReservedRecordBytes(0)
+    , iDropping(true)
+    , iFileSystem(aFileSystem)
+    , iFile(nullptr)
+    , iWriteBuf(kWriteBufBytes)
+    , iWav(false)
+    , iSampleRate(0)
+    , iBitDepth(0)
+    , iNumChannels(0)
+    , iDataBytes(0)
+{
+    ASSERT(aRingBytes % kRecordAlign == 0);
+    ASSERT(aRingBytes >= 4 * RecordBytes(kMaxFilenameBytes));
+    iRing = new TByte[iRingBytes];
+    iThread = new ThreadFunctor("AudioDumpWriter", MakeFunctor(*this, &AudioDumpWriter::WriterThread), aThreadPriority);
+    iThread->Start();
+}
+
+AudioDumpWriter::~AudioDumpWriter()
+{
+    delete iThread;
+    Drain();
+    CloseFile();
+    delete[] iRing;
+}
+
+void AudioDumpWriter::OpenRaw(const Brx& aFilename)
+{
+    Open(eOpenRaw, aFilename, 0, 0, 0);
+}
+
+void AudioDumpWriter::OpenWav(const Brx& aFilename, TUint aSampleRate, TUint aBitDepth, TUint aNumChannels)
+{
+    ASSERT(aBitDepth % 8 == 0 && aBitDepth > 0 && aBitDepth <= 32);
+    ASSERT(aNumChannels > 0);
+    Open(eOpenWav, aFilename, aSampleRate, aBitDepth, aNumChannels);
+}
+
+void AudioDumpWriter::Write(const Brx& aData)
+{
+    WriteData(eData, aData);
+}
+
+void AudioDumpWriter::WriteNative32(const Brx& aData)
+{
+    WriteData(eDataNative32, aData);
+}
+
+void AudioDumpWriter::WriteSilence(TUint aBytes)
+{
+    if (aBytes == 0) {
+        return;
+    }
+    if (iDropping || TryReserve(eSilence, 0, aBytes) == nullptr) {
+        Drop(aBytes);
+        return;
+    }
+    Commit();
+}
+
+TByte* AudioDumpWriter::TryReserve(TUint aBytes)
+{
+    if (iDropping || RecordBytes(aBytes) > iRingBytes / 2) {
+        Drop(aBytes);
+        return nullptr;
+    }
+    TByte* p = TryReserve(eData, aBytes, 0);
+    if (p == nullptr) {
+        Drop(aBytes);
+    }
+    return p;
+}
+
+void AudioDumpWriter::Commit()
+{
+    ASSERT(iReservedRecordBytes != 0);
+    const TUint64 written = iReserved + iReservedRecordBytes;
+    iWriteCount.store(written, std::memory_order_release);
+    iReservedRecordBytes = 0;
+    // wake the writer once a quarter of the ring is used; otherwise it polls every kWakeIntervalMs
+    if (written - iReadCount.load(std::memory_order_relaxed) >= iRingBytes / 4) {
+        iThread->Signal();
+    }
+}
+
+void AudioDumpWriter::Close()
+{
+    if (iDropping) {
+        return;
+    }
+    if (TryReserve(eClose, 0, 0) == nullptr) {
+        // the writer will close the file when it processes the next open
+        iDropping = true;
+        return;
+    }
+    Commit();
+    iThread->Signal();
+    iDropping = true;
+}
+
+TUint64 AudioDumpWriter::DroppedBytes() const
+{
+    return iDroppedBytes.load(std::memory_order_relaxed);
+}
+
+void AudioDumpWriter::Open(ERecordType aType, const Brx& aFilename, TUint aSampleRate, TUint aBitDepth, TUint aNumChannels)
+{
+    const TUint filenameBytes = std::min(aFilename.Bytes(), kMaxFilenameBytes - 1);
+    const TUint payloadBytes = 3 * sizeof(TUint32) + filenameBytes;
+    TByte* p = TryReserve(aType, payloadBytes, 0);
+    if (p == nullptr) {
+        LOG(kPipeline, "AudioDumpWriter: no space to open %.*s\n", PBUF(aFilename));
+        iDropping = true;
+        return;
+    }
+    TUint32* fmt = reinterpret_cast<TUint32*>(p);
+    fmt[0] = aSampleRate;
+    fmt[1] = aBitDepth;
+    fmt[2] = aNumChannels;
+    (void)memcpy(p + 3 * sizeof(TUint32), aFilename.Ptr(), filenameBytes);
+    Commit();
+    iThread->Signal();
+    iDropping = false;
+}
+
+void AudioDumpWriter::WriteData(ERecordType aType, const Brx& aData)
+{
+    if (iDropping) {
+        Drop(aData.Bytes());
+        return;
+    }
+    // split large writes so that no record occupies more than a quarter of the ring
+    const TUint maxBytes = (iRingBytes / 4) - sizeof(RecordHeader);
+    TUint offset = 0;
+    while (offset < aData.Bytes()) {
+        const TUint bytes = std::min(aData.Bytes() - offset, maxBytes);
+        TByte* p = TryReserve(aType, bytes, 0);
+        if (p == nullptr) {
+            Drop(aData.Bytes() - offset);
+            return;
+        }
+        (void)memcpy(p, aData.Ptr() + offset, bytes);
+        Commit();
+        offset += bytes;
+    }
+}
+
+TByte* AudioDumpWriter::TryReserve(ERecordType aType, TUint aPayloadBytes, TUint aArg)
+{
+    ASSERT(iReservedRecordBytes == 0);
+    const TUint recordBytes = RecordBytes(aPayloadBytes);
+    TUint64 write = iWriteCount.load(std::memory_order_relaxed);
+    const TUint64 read = iReadCount.load(std::memory_order_acquire);
+    const TUint offset = (TUint)(write % iRingBytes);
+    const TUint toEnd = iRingBytes - offset;
+    const TUint padBytes = (toEnd < recordBytes? toEnd : 0);
+    if (iRingBytes - (TUint)(write - read) < padBytes + recordBytes) {
+        return nullptr;
+    }
+    if (padBytes > 0) {
+        // records never wrap; fill the end of the ring and start the record at offset 0
+        RecordHeader* pad = reinterpret_cast<RecordHeader*>(iRing + offset);
+        pad->iType = ePad;
+        pad->iPayloadBytes = padBytes - sizeof(RecordHeader);
+        pad->iArg = 0;
+        write += padBytes;
+    }
+    RecordHeader* header = reinterpret_cast<RecordHeader*>(iRing + (write % iRingBytes));
+    header->iType = aType;
+    header->iPayloadBytes = aPayloadBytes;
+    header->iArg = aArg;
+    iReserved = write;
+    iReservedRecordBytes = recordBytes;
+    return reinterpret_cast<TByte*>(header + 1);
+}
+
+void AudioDumpWriter::Drop(TUint aBytes)
+{
+    iDroppedBytes.fetch_add(aBytes, std::memory_order_relaxed);
+    if (!iDropping) {
+        // attribute to the open file so the writer can log it on close
+        iDroppedBytesFile.fetch_add(aBytes, std::memory_order_relaxed);
+    }
+}
+
+TUint AudioDumpWriter::RecordBytes(TUint aPayloadBytes)
+{ // static
+    const TUint bytes = sizeof(RecordHeader) + aPayloadBytes;
+    return (bytes + kRecordAlign - 1) & ~(kRecordAlign - 1);
+}
+
+void AudioDumpWriter::WriterThread()
+{
+    try {
+        for (;;) {
+            try {
+                iThread->Wait(kWakeIntervalMs);
+            }
+            catch (Timeout&) {}
+            Drain();
+        }
+    }
+    catch (ThreadKill&) {}
+}
+
+void AudioDumpWriter::Drain()
+{
+    TUint64 read = iReadCount.load(std::memory_order_relaxed);
+    const TUint64 write = iWriteCount.load(std::memory_order_acquire);
+    while (read < write) {
+        const RecordHeader* header = reinterpret_cast<const RecordHeader*>(iRing + (read % iRingBytes));
+        if (header->iType != ePad) {
+            Process(*header, reinterpret_cast<const TByte*>(header + 1));
+        }
+        read += RecordBytes(header->iPayloadBytes);
+        iReadCount.store(read, std::memory_order_release);
+    }
+    FlushWriteBuf();
+}
+
+void AudioDumpWriter::Process(const RecordHeader& aHeader, const TByte* aPayload)
+{
+    if (iFile == nullptr && aHeader.iType >= eData) {
+        return; // open or an earlier write failed
+    }
+    switch (aHeader.iType)
+    {
+    case eOpenRaw:
+    case eOpenWav:
+        OpenFile(aHeader.iType == eOpenWav, aPayload, aHeader.iPayloadBytes);
+        break;
+    case eClose:
+        CloseFile();
+        break;
+    case eData:
+        if (iWav) {
+            AppendPcm(aPayload, aHeader.iPayloadBytes);
+        }
+        else {
+            Append(Brn(aPayload, aHeader.iPayloadBytes));
+        }
+        break;
+    case eDataNative32:
+        AppendNative32(aPayload, aHeader.iPayloadBytes);
+        break;
+    case eSilence:
+        AppendSilence(aHeader.iArg);
+        break;
+    default:
+        ASSERTS();
+    }
+}
+
+void AudioDumpWriter::OpenFile(TBool aWav, const TByte* aPayload, TUint aBytes)
+{
+    CloseFile();
+    iWriteBuf.SetBytes(0);
+    const TUint32* fmt = reinterpret_cast<const TUint32*>(aPayload);
+    const TUint fmtBytes = 3 * sizeof(TUint32);
+    iFilename.Replace(Brn(aPayload + fmtBytes, aBytes - fmtBytes));
+    try {
+        iFile = iFileSystem.Open(iFilename.PtrZ(), eFileReadWrite);
+    }
+    catch (FileOpenError&) {
+        Log::Print("AudioDumpWriter failed to open file %s\n", iFilename.PtrZ());
+        iFile = nullptr;
+        return;
+    }
+    iWav = aWav;
+    iSampleRate = fmt[0];
+    iBitDepth = fmt[1];
+    iNumChannels = fmt[2];
+    iDataBytes = 0;
+    iDroppedBytesFile.store(0, std::memory_order_relaxed);
+    if (iWav) {
+        WriteWavHeader(0); // placeholder sizes; rewritten by CloseFile()
+    }
+}
+
+void AudioDumpWriter::CloseFile()
+{
+    if (iFile == nullptr) {
+        return;
+    }
+    FlushWriteBuf();
+    if (iFile != nullptr && iWav) {
+        try {
+            iFile->Seek(0, eSeekFromStart);
+            WriteWavHeader(iDataBytes);
+            FlushWriteBuf();
+        }
+        catch (FileSeekError&) {
+            Log::Print("AudioDumpWriter failed to finalise header for %s\n", iFilename.PtrZ());
+        }
+    }
+    const TUint64 dropped = iDroppedBytesFile.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0) {
+        Log::Print("AudioDumpWriter dropped %llu bytes from %s\n", dropped, iFilename.PtrZ());
+    }
+    delete iFile;
+    iFile = nullptr;
+}
+
+void AudioDumpWriter::AppendPcm(const TByte* aData, TUint aBytes)
+{
+    // big-endian -> little-endian; 8-bit wav is unsigned
+    const TUint bytesPerSubsample = iBitDepth / 8;
+    TUint remaining = aBytes / bytesPerSubsample;
+    while (remaining > 0) {
+        TUint numSubsamples = (iWriteBuf.MaxBytes() - iWriteBuf.Bytes()) / bytesPerSubsample;
+        if (numSubsamples == 0) {
+            FlushWriteBuf();
+            continue;
+        }
+        numSubsamples = std::min(numSubsamples, remaining);
+        TByte* dest = const_cast<TByte*>(iWriteBuf.Ptr()) + iWriteBuf.Bytes();
+        if (bytesPerSubsample == 1) {
+            for (TUint i=0; i<numSubsamples; i++) {
+                *dest++ = (TByte)(*aData++ + 0x80);
+            }
+        }
+        else {
+            for (TUint i=0; i<numSubsamples; i++) {
+                for (TUint j=0; j<bytesPerSubsample; j++) {
+                    *dest++ = aData[bytesPerSubsample - 1 - j];
+                }
+                aData += bytesPerSubsample;
+            }
+        }
+        const TUint bytes = numSubsamples * bytesPerSubsample;
+        iWriteBuf.SetBytes(iWriteBuf.Bytes() + bytes);
+        iDataBytes += bytes;
+        remaining -= numSubsamples;
+    }
+}
+
+void AudioDumpWriter::AppendNative32(const TByte* aData, TUint aBytes)
+{
+    ASSERT(iWav);
+    const TUint bytesPerSubsample = iBitDepth / 8;
+    const TInt32* src = reinterpret_cast<const TInt32*>(aData);
+    const TUint numSubsamples = aBytes / sizeof(TInt32);
+    for (TUint i=0; i<numSubsamples; i++) {
+        if (iWriteBuf.Bytes() + bytesPerSubsample > iWriteBuf.MaxBytes()) {
+            FlushWriteBuf();
+        }
+        const TUint32 subsample = (TUint32)src[i];
+        if (bytesPerSubsample == 1) {
+            iWriteBuf.Append((TByte)((subsample >> 24) + 0x80));
+        }
+        else {
+            for (TUint j=0; j<bytesPerSubsample; j++) {
+                iWriteBuf.Append((TByte)(subsample >> (32 - 8 * (bytesPerSubsample - j))));
+            }
+        }
+    }
+    iDataBytes += numSubsamples * bytesPerSubsample;
+}
+
+void AudioDumpWriter::AppendSilence(TUint aBytes)
+{
+    const TByte silence = (iWav && iBitDepth == 8? 0x80 : 0);
+    iDataBytes += aBytes;
+    while (aBytes > 0) {
+        if (iWriteBuf.Bytes() == iWriteBuf.MaxBytes()) {
+            FlushWriteBuf();
+        }
+        const TUint bytes = std::min(aBytes, iWriteBuf.MaxBytes() - iWriteBuf.Bytes());
+        (void)memset(const_cast<TByte*>(iWriteBuf.Ptr()) + iWriteBuf.Bytes(), silence, bytes);
+        iWriteBuf.SetBytes(iWriteBuf.Bytes() + bytes);
+        aBytes -= bytes;
+    }
+}
+
+void AudioDumpWriter::Append(const Brx& aData)
+{
+    TUint offset = 0;
+    while (offset < aData.Bytes()) {
+        if (iWriteBuf.Bytes() == iWriteBuf.MaxBytes()) {
+            FlushWriteBuf();
+        }
+        const TUint bytes = std::min(aData.Bytes() - offset, iWriteBuf.MaxBytes() - iWriteBuf.Bytes());
+        iWriteBuf.Append(aData.Ptr() + offset, bytes);
+        offset += bytes;
+    }
+    iDataBytes += aData.Bytes();
+}
+
+void AudioDumpWriter::FlushWriteBuf()
+{
+    if (iWriteBuf.Bytes() == 0) {
+        return;
+    }
+    if (iFile != nullptr) {
+        try {
+            iFile->Write(iWriteBuf);
+        }
+        catch (FileWriteError&) {
+            Log::Print("AudioDumpWriter failed to write to %s.  Closing file\n", iFilename.PtrZ());
+            delete iFile;
+            iFile = nullptr;
+        }
+    }
+    iWriteBuf.SetBytes(0);
+}
+
+void AudioDumpWriter::WriteWavHeader(TUint64 aDataBytes)
+{
+    /* RIFF/WAVE with a JUNK chunk that is replaced by ds64 if the file grows beyond 4GB.
+       Chunk layout (and so the header size) is the same for both formats. */
+    static const TUint64 kMaxRiffBytes = 0xffffffffULL;
+    const TUint64 riffBytes = aDataBytes + kWavHeaderBytes - 8;
+    const TBool rf64 = (riffBytes > kMaxRiffBytes);
+    const TUint bytesPerSample = (iBitDepth / 8) * iNumChannels;
+
+    ASSERT(iWriteBuf.Bytes() == 0);
+    iWriteBuf.Append(rf64? "RF64" : "RIFF");
+    AppendLe(iWriteBuf, rf64? kMaxRiffBytes : riffBytes, 4);
+    iWriteBuf.Append("WAVE");
+    iWriteBuf.Append(rf64? "ds64" : "JUNK");
+    AppendLe(iWriteBuf, 28, 4);
+    if (rf64) {
+        AppendLe(iWriteBuf, riffBytes, 8);
+        AppendLe(iWriteBuf, aDataBytes, 8);
+        AppendLe(iWriteBuf, aDataBytes / bytesPerSample, 8);
+        AppendLe(iWriteBuf, 0, 4); // table length
+    }
+    else {
+        AppendLe(iWriteBuf, 0, 8);
+        AppendLe(iWriteBuf, 0, 8);
+        AppendLe(iWriteBuf, 0, 8);
+        AppendLe(iWriteBuf, 0, 4);
+    }
+    iWriteBuf.Append("fmt ");
+    AppendLe(iWriteBuf, 16, 4);
+    AppendLe(iWriteBuf, 1, 2); // WAVE_FORMAT_PCM
+    AppendLe(iWriteBuf, iNumChannels, 2);
+    AppendLe(iWriteBuf, iSampleRate, 4);
+    AppendLe(iWriteBuf, iSampleRate * bytesPerSample, 4);
+    AppendLe(iWriteBuf, bytesPerSample, 2);
+    AppendLe(iWriteBuf, iBitDepth, 2);
+    iWriteBuf.Append("data");
+    AppendLe(iWriteBuf, rf64? kMaxRiffBytes : aDataBytes, 4);
+    ASSERT(iWriteBuf.Bytes() == kWavHeaderBytes);
+}
+
+void AudioDumpWriter::AppendLe(Bwx& aBuf, TUint64 aVal, TUint aBytes)
+{ // static
+    for (TUint i=0; i<aBytes; i++) {
+        aBuf.Append((TByte)(aVal >> (8 * i)));
+    }
+}
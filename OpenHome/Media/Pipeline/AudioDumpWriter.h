@@ -0,0 +1,112 @@
+#pragma once
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Standard.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Private/File.h>
+
+#include <atomic>
+
+namespace OpenHome {
+namespace Media {
+
+/*
+ Writes audio dumps to disk from a low priority thread.
+
+ A single producer (the pipeline thread being dumped) queues file opens and data in a lock-free
+ ring.  The writer thread drains the ring and writes to disk in large sequential blocks.  If the
+ ring is full, data is dropped (and counted) rather than blocking the producer.  If an open can't
+ be queued, data is dropped until the next open.
+
+ Raw files are written as-is.  Wav files take pcm in the pipeline's formats: big-endian packed
+ or left-aligned TInt32.  It is written little-endian, with a header that is completed when the
+ file is closed.  Files with more than 4GB of audio are written as RF64.
+*/
+class AudioDumpWriter : private INonCopyable
+{
+    friend class SuiteAudioDumpWriter;
+public:
+    static const TUint kDefaultRingBytes = 4 * 1024 * 1024;
+private:
+    static const TUint kMaxFilenameBytes = 256;
+    static const TUint kWriteBufBytes = 256 * 1024;
+    static const TUint kWakeIntervalMs = 100;
+    static const TUint kWavHeaderBytes = 80;
+    static const TUint kRecordAlign = 16;
+    enum ERecordType
+    {
+        ePad
+       ,eOpenRaw
+       ,eOpenWav
+       ,eClose
+       ,eData
+       ,eDataNative32
+       ,eSilence
+    };
+    struct RecordHeader
+    {
+        TUint32 iType;
+        TUint32 iPayloadBytes;
+        TUint32 iArg;
+        TUint32 iReserved;
+    };
+public:
+    AudioDumpWriter(TUint aRingBytes, TUint aThreadPriority);
+    AudioDumpWriter(TUint aRingBytes, TUint aThreadPriority, IFileSystem& aFileSystem);
+    ~AudioDumpWriter(); // writes any queued data then closes the current file
+    // called from a single producer thread
+    void OpenRaw(const Brx& aFilename);
+    void OpenWav(const Brx& aFilename, TUint aSampleRate, TUint aBitDepth, TUint aNumChannels);
+    void Write(const Brx& aData);        // raw bytes or big-endian pcm at the bit depth passed to OpenWav
+    void WriteNative32(const Brx& aData); // left-aligned TInt32 subsamples; wav files only
+    void WriteSilence(TUint aBytes);     // aBytes of silence in the format of the current wav file
+    TByte* TryReserve(TUint aBytes);     // space for aBytes of data, or nullptr if there isn't room
+    void Commit();                       // queue data copied into the space returned by TryReserve
+    void Close();
+    TUint64 DroppedBytes() const;
+private:
+    void Open(ERecordType aType, const Brx& aFilename, TUint aSampleRate, TUint aBitDepth, TUint aNumChannels);
+    void WriteData(ERecordType aType, const Brx& aData);
+    TByte* TryReserve(ERecordType aType, TUint aPayloadBytes, TUint aArg);
+    void Drop(TUint aBytes);
+    static TUint RecordBytes(TUint aPayloadBytes);
+    void WriterThread();
+    void Drain();
+    void Process(const RecordHeader& aHeader, const TByte* aPayload);
+    void OpenFile(TBool aWav, const TByte* aPayload, TUint aBytes);
+    void CloseFile();
+    void AppendPcm(const TByte* aData, TUint aBytes);
+    void AppendNative32(const TByte* aData, TUint aBytes);
+    void AppendSilence(TUint aBytes);
+    void Append(const Brx& aData);
+    void FlushWriteBuf();
+    void WriteWavHeader(TUint64 aDataBytes);
+    static void AppendLe(Bwx& aBuf, TUint64 aVal, TUint aBytes);
+private:
+    TByte* iRing;
+    const TUint iRingBytes;
+    std::atomic<TUint64> iWriteCount; // bytes queued; only updated by the producer
+    std::atomic<TUint64> iReadCount;  // bytes processed; only updated by the writer thread
+    std::atomic<TUint64> iDroppedBytes;
+    std::atomic<TUint64> iDroppedBytesFile;
+    // producer state
+    TUint64 iReserved;                // start of the record returned by TryReserve
+    TUint iReservedRecordBytes;
+    TBool iDropping;
+    // writer thread state
+    ThreadFunctor* iThread;
+    FileSystemAnsii iFileSystemAnsii;
+    IFileSystem& iFileSystem;
+    IFile* iFile;
+    Bws<kMaxFilenameBytes> iFilename;
+    Bwh iWriteBuf;
+    TBool iWav;
+    TUint iSampleRate;
+    TUint iBitDepth;
+    TUint iNumChannels;
+    TUint64 iDataBytes;
+};
+
+} // namespace Media
+} // namespace OpenHome
@@ -1,12 +1,15 @@
 #include <OpenHome/Types.h>
 #include <OpenHome/Private/Standard.h>
 #include <OpenHome/Media/Pipeline/AudioDumper.h>
+#include <OpenHome/Media/Pipeline/AudioDumpWriter.h>
 #include <OpenHome/Media/Pipeline/Msg.h>
+#include <OpenHome/Private/Thread.h>
 #include <OpenHome/Private/Ascii.h>
 #include <OpenHome/Private/Parser.h>
 #include <OpenHome/Private/Uri.h>
 #include <OpenHome/Private/Printer.h>
 
+#include <algorithm>
 #include <ctime>
 
 using namespace OpenHome;
@@ -25,42 +28,39 @@ const TUint AudioDumper::kSupportedMsgTypes =   eMode
                                               | eWait
                                               | eQuit;
 
-const Brn AudioDumper::kDumpPrefix("AudioDump");
-
 AudioDumper::AudioDumper(IPipelineElementDownstream& aDownstream)
     : PipelineElement(kSupportedMsgTypes)
     , iDownstream(aDownstream)
-    , iFile(nullptr)
+    , iLock("ADMP")
+    , iWriter(nullptr)
     , iEnabled(false)
+    , iFileOpen(false)
 {
-    /**
-     * FIXME - bug in current filesystem handling: unable to create dirs.
-     * So, can't create an "AudioDump-<time>" dir with all streams under it.
-     *
-     * Instead, prefix all streams from a session with "AudioDump-<time>-".
-     * Initialise current time here so that same time is reused for all
-     * filenames in session.
-     */
-    SetCurrentTime();
 }
 
 AudioDumper::~AudioDumper()
 {
-    if (iFile != nullptr) {
-        delete iFile;
-        iFile = nullptr;
-    }
+    delete iWriter;
 }
 
 void AudioDumper::SetEnabled(TBool aEnabled)
 {
-    // If file was allowed to be open when this was set to disabled, would need to close file while holding a mutex to ensure no ProcessMsg() method attempted to write to an invalid file ptr.
-    ASSERT(iFile == nullptr);
-    iEnabled = aEnabled;
+    /* The writer is created on first use and never deleted, so it is safe for Push() to
+       use it without a lock once iEnabled has been set.
+       The current file (if any) is closed by the next msg Push()ed. */
+    AutoMutex _(iLock);
+    if (aEnabled && iWriter == nullptr) {
+        iWriter = new AudioDumpWriter(AudioDumpWriter::kDefaultRingBytes, kPriorityLow);
+    }
+    iEnabled.store(aEnabled, std::memory_order_release);
 }
 
 void AudioDumper::Push(Msg* aMsg)
 {
+    if (iFileOpen && !iEnabled.load(std::memory_order_acquire)) {
+        iWriter->Close();
+        iFileOpen = false;
+    }
     Msg* msg = aMsg->Process(*this);
     ASSERT(msg != nullptr);
     iDownstream.Push(msg);
@@ -68,50 +68,55 @@ void AudioDumper::Push(Msg* aMsg)
 
 Msg* AudioDumper::ProcessMsg(MsgEncodedStream* aMsg)
 {
-    if (iEnabled) {
-        if (iFile != nullptr) {
-            delete iFile;
-            iFile = nullptr;
-        }
-
-        // Don't try create file if URI is empty.
-        if (aMsg->Uri().Bytes() > 0) {
-            Bws<kMaxFilenameBytes> filename;
-            ConstructFilename(aMsg->StreamId(), aMsg->Uri(), filename);
-            try {
-                iFile = iFileSystem.Open(filename.PtrZ(), eFileReadWrite);
-            }
-            catch (FileOpenError&) {
-                Log::Print("AudioDumper failed to open file %s\n.", filename.PtrZ());
-                iFile = nullptr;
-            }
+    if (iFileOpen) {
+        iWriter->Close();
+        iFileOpen = false;
+    }
+    // Don't try create file if URI is empty.
+    if (iEnabled.load(std::memory_order_acquire) && aMsg->Uri().Bytes() > 0) {
+        // Parse URI to get filename.
+        Uri uri(aMsg->Uri());
+        Parser p(uri.Path());
+        Brn streamFile;
+        while (!p.Finished()) {
+            streamFile = p.Next('/');
         }
+        Bws<AudioDumpSession::kMaxFilenameBytes> filename;
+        iSession.ConstructFilename(aMsg->StreamId(), streamFile, filename);
+        iWriter->OpenRaw(filename);
+        iFileOpen = true;
     }
     return aMsg;
 }
 
 Msg* AudioDumper::ProcessMsg(MsgAudioEncoded* aMsg)
 {
-    if (iEnabled) {
-        if (iFile != nullptr) {
-            aMsg->CopyTo(const_cast<TByte*>(iBuf.Ptr()));
-            iBuf.SetBytes(aMsg->Bytes());
-            try {
-                iFile->Write(iBuf);
-            }
-            catch (FileWriteError&) {
-                Log::Print("AudioDumper failed to write audio block. Closing file\n.");
-                delete iFile;
-                iFile = nullptr;
-            }
-            iBuf.SetBytes(0);
+    if (iFileOpen) {
+        TByte* p = iWriter->TryReserve(aMsg->Bytes());
+        if (p != nullptr) {
+            aMsg->CopyTo(p);
+            iWriter->Commit();
         }
     }
     return aMsg;
 }
 
-void AudioDumper::SetCurrentTime()
+
+// AudioDumpSession
+
+const Brn AudioDumpSession::kDumpPrefix("AudioDump");
+
+AudioDumpSession::AudioDumpSession()
 {
+    /**
+     * FIXME - bug in current filesystem handling: unable to create dirs.
+     * So, can't create an "AudioDump-<time>" dir with all streams under it.
+     *
+     * Instead, prefix all streams from a session with "AudioDump-<time>-".
+     * Initialise current time here so that same time is reused for all
+     * filenames in session.
+     */
+
     // Get current system time.
     time_t timeCurrent = time(nullptr);
     struct tm* timeInfo = localtime(&timeCurrent);
@@ -123,21 +128,10 @@ void AudioDumper::SetCurrentTime()
     ASSERT(size == iTime.MaxBytes()-1);
 }
 
-void AudioDumper::ConstructFilename(TUint aSeq, const Brx& aUri, Bwx& aBuf)
+void AudioDumpSession::ConstructFilename(TUint aSeq, const Brx& aName, Bwx& aBuf) const
 {
-    ASSERT(aUri.Bytes() != 0);
     ASSERT(iTime.Bytes() != 0);
 
-    // Parse URI to get filename.
-    Uri uri(aUri);
-    Parser p(uri.Path());
-    Brn streamFile;
-    while (!p.Finished()) {
-        streamFile = p.Next('/');
-    }
-
-    // Construct file path.
-
     // Directory part.
     aBuf.Append(kDumpPrefix);
     aBuf.Append('-');
@@ -145,8 +139,7 @@ void AudioDumper::ConstructFilename(TUint aSeq, const Brx& aUri, Bwx& aBuf)
     aBuf.Append('-');
 
     // Filename part.
-    // Assume stream dumps will only go into the 100s. Prefix numbers <100 with "0"s.
-    ASSERT(aSeq < 1000);
+    // Prefix numbers <100 with "0"s so that the first few hundred streams sort in order.
     if (aSeq < 10) {
         aBuf.Append("00");
     }
@@ -155,5 +148,179 @@ void AudioDumper::ConstructFilename(TUint aSeq, const Brx& aUri, Bwx& aBuf)
     }
     Ascii::AppendDec(aBuf, aSeq);
     aBuf.Append('-');
-    aBuf.Append(streamFile);
+    const TUint maxNameBytes = aBuf.MaxBytes() - aBuf.Bytes();
+    aBuf.Append(aName.Split(0, std::min(aName.Bytes(), maxNameBytes)));
+}
+
+
+// DecodedAudioDumper
+
+const TUint DecodedAudioDumper::kSupportedMsgTypes =   eMode
+                                                     | eDrain
+                                                     | eStreamInterrupted
+                                                     | eHalt
+                                                     | eDecodedStream
+                                                     | eAudioPcm
+                                                     | eSilence
+                                                     | eQuit;
+
+const Brn DecodedAudioDumper::kExtension(".wav");
+
+DecodedAudioDumper::DecodedAudioDumper(IPipelineElementUpstream& aUpstream)
+    : PipelineElement(kSupportedMsgTypes)
+    , iUpstream(aUpstream)
+    , iLock("DADM")
+    , iWriter(nullptr)
+    , iEnabled(false)
+    , iFileOpen(false)
+    , iStreamId(0)
+    , iSampleRate(0)
+    , iBitDepth(0)
+    , iNumChannels(0)
+    , iNumOpens(0)
+{
+}
+
+DecodedAudioDumper::~DecodedAudioDumper()
+{
+    delete iWriter;
+}
+
+void DecodedAudioDumper::SetEnabled(TBool aEnabled)
+{
+    // see AudioDumper::SetEnabled
+    AutoMutex _(iLock);
+    if (aEnabled && iWriter == nullptr) {
+        iWriter = new AudioDumpWriter(AudioDumpWriter::kDefaultRingBytes, kPriorityLow);
+    }
+    iEnabled.store(aEnabled, std::memory_order_release);
+}
+
+Msg* DecodedAudioDumper::Pull()
+{
+    Msg* msg = iUpstream.Pull();
+    msg = msg->Process(*this);
+    return msg;
+}
+
+void DecodedAudioDumper::PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs)
+{
+    Msg* msg = iUpstream.PullBatch(aMaxMsgs);
+    TUint count = 0;
+    do {
+        aQueue.Enqueue(msg->Process(*this));
+    } while (++count < aMaxMsgs && (msg = iUpstream.TryPull()) != nullptr);
+}
+
+UpstreamLink* DecodedAudioDumper::SpliceableUpstream()
+{
+    return &iUpstream;
+}
+
+Msg* DecodedAudioDumper::ProcessMsg(MsgDecodedStream* aMsg)
+{
+    const DecodedStreamInfo& info = aMsg->StreamInfo();
+    // a seek (same stream and format) continues the current file
+    const TBool sameFile = (info.StreamId() == iStreamId && info.SampleRate() == iSampleRate &&
+                            info.BitDepth() == iBitDepth && info.NumChannels() == iNumChannels);
+    if (info.StreamId() != iStreamId) {
+        iNumOpens = 0;
+    }
+    iStreamId = info.StreamId();
+    iSampleRate = info.SampleRate();
+    iBitDepth = info.BitDepth();
+    iNumChannels = info.NumChannels();
+    iCodecName.Replace(info.CodecName());
+    if (iFileOpen && !sameFile) {
+        iWriter->Close();
+        iFileOpen = false;
+    }
+    (void)UpdateFile();
+    return aMsg;
+}
+
+Msg* DecodedAudioDumper::ProcessMsg(MsgAudioPcm* aMsg)
+{
+    if (UpdateFile()) {
+        // read from a clone so that aMsg continues down the pipeline untouched
+        MsgPlayable* playable = static_cast<MsgAudioPcm*>(aMsg->Clone())->CreatePlayable();
+        playable->Read(*this);
+        playable->RemoveRef();
+    }
+    return aMsg;
+}
+
+Msg* DecodedAudioDumper::ProcessMsg(MsgSilence* aMsg)
+{
+    if (UpdateFile()) {
+        const TUint numSamples = Jiffies::ToSamples(aMsg->Jiffies(), iSampleRate);
+        iWriter->WriteSilence(numSamples * iNumChannels * (iBitDepth / 8));
+    }
+    return aMsg;
+}
+
+TBool DecodedAudioDumper::UpdateFile()
+{
+    const TBool enabled = iEnabled.load(std::memory_order_acquire);
+    if (iFileOpen && !enabled) {
+        iWriter->Close();
+        iFileOpen = false;
+    }
+    else if (!iFileOpen && enabled && iSampleRate != 0) {
+        OpenFile();
+    }
+    return iFileOpen;
+}
+
+void DecodedAudioDumper::OpenFile()
+{
+    Bws<AudioDumpSession::kMaxFilenameBytes> filename;
+    Bws<kMaxCodecNameBytes + 16> name(iCodecName);
+    if (iNumOpens > 0) {
+        // stream changed format or dumping was re-enabled; don't overwrite the earlier file
+        name.Append('-');
+        Ascii::AppendDec(name, iNumOpens);
+    }
+    name.Append(kExtension);
+    iNumOpens++;
+    iSession.ConstructFilename(iStreamId, name, filename);
+    iWriter->OpenWav(filename, iSampleRate, iBitDepth, iNumChannels);
+    iFileOpen = true;
+}
+
+void DecodedAudioDumper::BeginBlock()
+{
+}
+
+void DecodedAudioDumper::ProcessFragment8(const Brx& aData, TUint /*aNumChannels*/)
+{
+    iWriter->Write(aData);
+}
+
+void DecodedAudioDumper::ProcessFragment16(const Brx& aData, TUint /*aNumChannels*/)
+{
+    iWriter->Write(aData);
+}
+
+void DecodedAudioDumper::ProcessFragment24(const Brx& aData, TUint /*aNumChannels*/)
+{
+    iWriter->Write(aData);
+}
+
+void DecodedAudioDumper::ProcessFragment32(const Brx& aData, TUint /*aNumChannels*/)
+{
+    iWriter->Write(aData);
+}
+
+void DecodedAudioDumper::ProcessFragmentNative32(const Brx& aData, TUint /*aNumChannels*/, TUint /*aBitDepth*/)
+{
+    iWriter->WriteNative32(aData);
+}
+
+void DecodedAudioDumper::EndBlock()
+{
+}
+
+void DecodedAudioDumper::Flush()
+{
 }
@@ -3,27 +3,50 @@
 
 #include <OpenHome/Buffer.h>
 #include <OpenHome/Types.h>
-#include <OpenHome/Private/File.h>
+#include <OpenHome/Private/Standard.h>
 #include <OpenHome/Media/Pipeline/Msg.h>
 
+#include <atomic>
+
 namespace OpenHome {
 namespace Media {
 
+class AudioDumpWriter;
+
 /**
- * This class is only intended for use on platforms where filesystem utilities
- * and time functions exist.
+ * Names dump files for a session: "AudioDump-<time>-<seq>-<name>".
  */
-class AudioDumper : public PipelineElement, public IPipelineElementDownstream, private INonCopyable
+class AudioDumpSession
 {
-private:
-    static const TUint kSupportedMsgTypes;
     /**
     * Time format: Year|Month|Day|Hour|Min|Sec
     * e.g., 9 Oct 2015 10:59:23 == 20151009105923
     */
     static const TUint kMaxTimeFormatBytes = 15;    // Extra byte for '\0'.
-    static const TUint kMaxFilenameBytes = 150;
     static const Brn kDumpPrefix;
+public:
+    static const TUint kMaxFilenameBytes = 150;
+public:
+    AudioDumpSession();
+    void ConstructFilename(TUint aSeq, const Brx& aName, Bwx& aBuf) const;
+private:
+    Bws<kMaxTimeFormatBytes> iTime;
+};
+
+/**
+ * Dumps encoded audio, one file per stream, as it enters the pipeline.
+ *
+ * File writes happen on a low priority thread (see AudioDumpWriter); audio is dropped
+ * rather than delaying the pipeline if that thread falls behind.  Can be enabled or
+ * disabled at any time; a file is started at the next stream.
+ *
+ * This class is only intended for use on platforms where filesystem utilities
+ * and time functions exist.
+ */
+class AudioDumper : public PipelineElement, public IPipelineElementDownstream, private INonCopyable
+{
+private:
+    static const TUint kSupportedMsgTypes;
 public:
     AudioDumper(IPipelineElementDownstream& aDownstream);
     ~AudioDumper();
@@ -33,16 +56,66 @@ public: // from IPipelineElementDownstream
 private: // from PipelineElement
     Msg* ProcessMsg(MsgEncodedStream* aMsg) override;
     Msg* ProcessMsg(MsgAudioEncoded* aMsg) override;
-private:
-    void SetCurrentTime();
-    void ConstructFilename(TUint aSeq, const Brx& aUri, Bwx& aBuf);
 private:
     IPipelineElementDownstream& iDownstream;
-    FileSystemAnsii iFileSystem;
-    Bws<kMaxTimeFormatBytes> iTime;
-    IFile* iFile;
-    Bws<EncodedAudio::kMaxBytes> iBuf;
-    TBool iEnabled;
+    AudioDumpSession iSession;
+    Mutex iLock;
+    AudioDumpWriter* iWriter;
+    std::atomic<bool> iEnabled;
+    TBool iFileOpen;
+};
+
+/**
+ * Dumps decoded audio, one wav file per stream, as it is pulled by the driver.
+ * Seeks continue the current file; a change of format starts a new one.
+ *
+ * Audio is written after all pipeline processing (ramps, volume, delays), so the dump
+ * matches what is passed to the driver.  Silence is included.  File writes happen on a
+ * low priority thread (see AudioDumpWriter); audio is dropped rather than delaying the
+ * pipeline if that thread falls behind.  Can be enabled or disabled at any time; enabling
+ * mid-stream starts a file at the next audio.
+ */
+class DecodedAudioDumper : public PipelineElement, public IPipelineElementUpstream, private IPcmProcessor, private INonCopyable
+{
+    static const TUint kSupportedMsgTypes;
+    static const Brn kExtension;
+public:
+    DecodedAudioDumper(IPipelineElementUpstream& aUpstream);
+    ~DecodedAudioDumper();
+    void SetEnabled(TBool aEnabled);
+public: // from IPipelineElementUpstream
+    Msg* Pull() override;
+    void PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs) override;
+    UpstreamLink* SpliceableUpstream() override;
+private: // from PipelineElement
+    Msg* ProcessMsg(MsgDecodedStream* aMsg) override;
+    Msg* ProcessMsg(MsgAudioPcm* aMsg) override;
+    Msg* ProcessMsg(MsgSilence* aMsg) override;
+private:
+    TBool UpdateFile();
+    void OpenFile();
+private: // from IPcmProcessor
+    void BeginBlock() override;
+    void ProcessFragment8(const Brx& aData, TUint aNumChannels) override;
+    void ProcessFragment16(const Brx& aData, TUint aNumChannels) override;
+    void ProcessFragment24(const Brx& aData, TUint aNumChannels) override;
+    void ProcessFragment32(const Brx& aData, TUint aNumChannels) override;
+    void ProcessFragmentNative32(const Brx& aData, TUint aNumChannels, TUint aBitDepth) override;
+    void EndBlock() override;
+    void Flush() override;
+private:
+    UpstreamLink iUpstream;
+    AudioDumpSession iSession;
+    Mutex iLock;
+    AudioDumpWriter* iWriter;
+    std::atomic<bool> iEnabled;
+    TBool iFileOpen;
+    TUint iStreamId;
+    TUint iSampleRate;
+    TUint iBitDepth;
+    TUint iNumChannels;
+    TUint iNumOpens; // files opened for iStreamId
+    BwsCodecName iCodecName;
 };
 
 } // namespace Media
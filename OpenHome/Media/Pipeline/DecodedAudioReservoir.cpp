@@ -46,6 +46,11 @@ TUint DecodedAudioReservoir::SizeInJiffies() const
     return Jiffies();
 }
 
+TUint DecodedAudioReservoir::ReservoirLevel() const
+{
+    return Jiffies();
+}
+
 Msg* DecodedAudioReservoir::Pull()
 {
     TBool wait = false;
@@ -272,6 +277,7 @@ Msg* DecodedAudioReservoir::ProcessMsgOut(MsgFlush* aMsg)
 Msg* DecodedAudioReservoir::ProcessMsgOut(MsgAudioPcm* aMsg)
 {
     if (iDiscardJiffies == 0) {
+        aMsg->AddLogPoint(LatencyPoint::eDecodedReservoir);
         return aMsg;
     }
 
@@ -3,6 +3,7 @@
 #include <OpenHome/Types.h>
 #include <OpenHome/Media/Pipeline/AudioReservoir.h>
 #include <OpenHome/Media/Pipeline/Msg.h>
+#include <OpenHome/Media/Pipeline/ElementProfile.h>
 #include <OpenHome/Media/ClockPuller.h>
 #include <OpenHome/Private/Thread.h>
 
@@ -11,7 +12,7 @@
 namespace OpenHome {
 namespace Media {
 
-class DecodedAudioReservoir : public AudioReservoir, private IStreamHandler
+class DecodedAudioReservoir : public AudioReservoir, public IReservoirLevel, private IStreamHandler
 {
     friend class SuiteGorger;
 public:
@@ -22,6 +23,8 @@ public:
 private: // from AudioReservoir
     TBool IsFull() const override;
     void HandleBlocked() override;
+private: // from IReservoirLevel
+    TUint ReservoirLevel() const override;
 public: // from IPipelineElementUpstream
     Msg* Pull() override;
 public: // from IPipelineElementDownstream
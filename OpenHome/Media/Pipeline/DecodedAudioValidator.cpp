@@ -24,7 +24,7 @@ const TUint DecodedAudioValidator::kSupportedMsgTypes =   eMode
 
 DecodedAudioValidator::DecodedAudioValidator(IPipelineElementUpstream& aUpstream, const TChar* aId)
     : PipelineElement(kSupportedMsgTypes)
-    , iUpstream(&aUpstream)
+    , iUpstream(aUpstream)
     , iDownstream(nullptr)
     , iId(aId)
     , iStreamPos(0)
@@ -35,7 +35,6 @@ DecodedAudioValidator::DecodedAudioValidator(IPipelineElementUpstream& aUpstream
 
 DecodedAudioValidator::DecodedAudioValidator(const TChar* aId, IPipelineElementDownstream& aDownstream)
     : PipelineElement(kSupportedMsgTypes)
-    , iUpstream(nullptr)
     , iDownstream(&aDownstream)
     , iId(aId)
     , iStreamPos(0)
@@ -51,14 +50,33 @@ void DecodedAudioValidator::SetEnabled()
 
 Msg* DecodedAudioValidator::Pull()
 {
-    ASSERT(iUpstream != nullptr);
-    Msg* msg = iUpstream->Pull();
+    ASSERT(iDownstream == nullptr);
+    Msg* msg = iUpstream.Pull();
     if (iEnabled) {
         msg = msg->Process(*this);
     }
     return msg;
 }
 
+void DecodedAudioValidator::PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs)
+{
+    ASSERT(iDownstream == nullptr);
+    if (!iEnabled) {
+        iUpstream.PullBatch(aQueue, aMaxMsgs);
+        return;
+    }
+    Msg* msg = iUpstream.PullBatch(aMaxMsgs);
+    TUint count = 0;
+    do {
+        aQueue.Enqueue(msg->Process(*this));
+    } while (++count < aMaxMsgs && (msg = iUpstream.TryPull()) != nullptr);
+}
+
+UpstreamLink* DecodedAudioValidator::SpliceableUpstream()
+{
+    return (iDownstream == nullptr? &iUpstream : nullptr);
+}
+
 void DecodedAudioValidator::Push(Msg* aMsg)
 {
     ASSERT(iDownstream != nullptr);
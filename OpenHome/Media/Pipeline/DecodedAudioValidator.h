@@ -17,6 +17,8 @@ public:
                           Can disable manually to limit testing to certain points in the pipeline */
 public: // from IPipelineElementUpstream
     Msg* Pull() override;
+    void PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs) override;
+    UpstreamLink* SpliceableUpstream() override;
 public: // from IPipelineElementDownstream
     void Push(Msg* aMsg) override;
 private: // from IMsgProcessor
@@ -27,7 +29,7 @@ private: // from IMsgProcessor
     Msg* ProcessMsg(MsgDecodedStream* aMsg) override;
     Msg* ProcessMsg(MsgAudioPcm* aMsg) override;
 private:
-    IPipelineElementUpstream* iUpstream;
+    UpstreamLink iUpstream; // unattached if iDownstream is non-null
     IPipelineElementDownstream* iDownstream;
     const TChar* iId;
     TUint64 iStreamPos;
@@ -0,0 +1,457 @@
+#include <OpenHome/Media/Pipeline/DelayLine.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Standard.h>
+#include <OpenHome/Media/Pipeline/Msg.h>
+
+#include <algorithm>
+#include <string.h>
+
+using namespace OpenHome;
+using namespace OpenHome::Media;
+
+// DelayLine
+
+DelayLine::DelayLine(MsgFactory& aMsgFactory, TUint aMaxJiffies, TUint aRampJiffies)
+    : iMsgFactory(aMsgFactory)
+    , iRampJiffies(aRampJiffies)
+    , iRingSubsamples(((aMaxJiffies / Jiffies::PerSample(kMaxSampleRate)) + 1) * kSizingChannels)
+    , iOutput(nullptr)
+{
+    iRing = new TInt32[iRingSubsamples];
+    iScratch = new TInt32[kScratchSubsamples];
+    iOut = new TInt32[kScratchSubsamples];
+    iPacked = new TByte[AudioData::kMaxBytes];
+    iSampleRate = 0;
+    iBitDepth = 0;
+    iNumChannels = 0;
+    iJiffiesPerSample = 0;
+    iCapacity = 0;
+    iRampSamples = 0;
+    iMaxOutSubsamples = 0;
+    iOutSubsamples = 0;
+    iOutStart = iOutEnd = iOutLimit = kPosNone;
+    iOutTrackOffset = 0;
+    Reset();
+}
+
+DelayLine::~DelayLine()
+{
+    delete[] iRing;
+    delete[] iScratch;
+    delete[] iOut;
+    delete[] iPacked;
+}
+
+void DelayLine::Reset()
+{
+    iWriteIndex = 0;
+    iWritePos = iCapacity;
+    iNumRampSegments = 0;
+    iDelay = 0;
+    iFadeFrom = 0;
+    iRampRemaining = 0;
+    iOutputEnabled = false;
+    iHistoryOutput = false;
+    if (FormatSet()) {
+        (void)memset(iRing, 0, iCapacity * iNumChannels * sizeof(iRing[0]));
+    }
+}
+
+void DelayLine::SetFormat(TUint aSampleRate, TUint aBitDepth, TUint aNumChannels)
+{
+    ASSERT(aNumChannels > 0 && aNumChannels <= DecodedAudio::kMaxNumChannels);
+    if (aSampleRate == iSampleRate && aNumChannels == iNumChannels) {
+        SetBitDepth(aBitDepth);
+        return;
+    }
+    ASSERT(iDelay == 0);
+    iSampleRate = aSampleRate;
+    iNumChannels = aNumChannels;
+    iJiffiesPerSample = Jiffies::PerSample(aSampleRate);
+    iCapacity = iRingSubsamples / aNumChannels;
+    iRampSamples = iRampJiffies / iJiffiesPerSample;
+    iBitDepth = 0;
+    SetBitDepth(aBitDepth);
+    Reset();
+}
+
+TBool DelayLine::FormatSet() const
+{
+    return iSampleRate != 0;
+}
+
+TUint DelayLine::MaxDelayJiffies() const
+{
+    if (!FormatSet()) {
+        return 0;
+    }
+    return (iCapacity - 1) * iJiffiesPerSample;
+}
+
+TUint DelayLine::DelayJiffies() const
+{
+    return iDelay * iJiffiesPerSample;
+}
+
+void DelayLine::SetTrackOffset(TUint64 aJiffies)
+{
+    iOutTrackOffset = aJiffies;
+}
+
+TUint DelayLine::SetDelay(TUint aJiffies)
+{
+    ASSERT(FormatSet());
+    const TUint delay = aJiffies / iJiffiesPerSample;
+    ASSERT(delay < iCapacity);
+    if (delay != iDelay) {
+        // a change during a crossfade restarts it from the previous target
+        iFadeFrom = iDelay;
+        iDelay = delay;
+        iRampRemaining = (iHistoryOutput? iRampSamples : 0);
+    }
+    return iDelay * iJiffiesPerSample;
+}
+
+TBool DelayLine::IsTransparent() const
+{
+    return iDelay == 0 && iRampRemaining == 0;
+}
+
+void DelayLine::Record(MsgAudioPcm* aMsg)
+{
+    ASSERT(IsTransparent());
+    MsgAudioPcm* clone = static_cast<MsgAudioPcm*>(aMsg->Clone());
+    iOutputEnabled = false;
+    iHistoryOutput = true; // aMsg is output by the caller
+    iOutTrackOffset = aMsg->TrackOffset() + aMsg->Jiffies();
+    RecordRamp(*clone);
+    Read(clone->CreatePlayable());
+}
+
+void DelayLine::Record(MsgSilence* aMsg)
+{
+    ASSERT(IsTransparent());
+    iOutputEnabled = false;
+    iHistoryOutput = true;
+    iOutTrackOffset += aMsg->Jiffies();
+    WriteSilence(aMsg->Jiffies() / iJiffiesPerSample);
+}
+
+void DelayLine::Process(MsgAudioPcm* aMsg, MsgQueueLite& aOutput)
+{
+    iOutput = &aOutput;
+    iOutputEnabled = true;
+    RecordRamp(*aMsg);
+    Read(aMsg->CreatePlayable());
+    FlushOutput();
+    iOutput = nullptr;
+}
+
+void DelayLine::Process(MsgSilence* aMsg, MsgQueueLite& aOutput)
+{
+    iOutput = &aOutput;
+    iOutputEnabled = true;
+    WriteSilence(aMsg->Jiffies() / iJiffiesPerSample);
+    aMsg->RemoveRef();
+    FlushOutput();
+    iOutput = nullptr;
+}
+
+void DelayLine::Drain(MsgQueueLite& aOutput)
+{
+    if (!FormatSet()) {
+        return;
+    }
+    iRampRemaining = 0;
+    if (iWritePos == iCapacity) {
+        // nothing written since Reset() so no audio is held; the caller re-applies the delay
+        iDelay = 0;
+        return;
+    }
+    iOutput = &aOutput;
+    OutputFromHistory(iDelay);
+    FlushOutput();
+    iOutput = nullptr;
+    iDelay = 0;
+}
+
+void DelayLine::Read(MsgPlayable* aPlayable)
+{
+    aPlayable->Read(*this);
+    aPlayable->RemoveRef();
+}
+
+void DelayLine::RecordRamp(MsgAudio& aMsg)
+{
+    // Moves any ramp from aMsg into iRampSegments so that the ring holds unramped samples.
+    // If there's no space, the ramp is left on aMsg and applied to its samples instead.
+    const Media::Ramp& ramp = aMsg.Ramp();
+    if (!ramp.IsEnabled()) {
+        return;
+    }
+    TUint expired = 0;
+    while (expired < iNumRampSegments && iRampSegments[expired].iEnd + iCapacity <= iWritePos) {
+        expired++;
+    }
+    if (expired > 0) {
+        for (TUint i=expired; i<iNumRampSegments; i++) {
+            iRampSegments[i - expired] = iRampSegments[i];
+        }
+        iNumRampSegments -= expired;
+    }
+    const TUint numSamples = aMsg.RampJiffies() / iJiffiesPerSample;
+    if (numSamples == 0 || iNumRampSegments == kMaxRampSegments) {
+        return;
+    }
+    RampSegment& segment = iRampSegments[iNumRampSegments++];
+    segment.iStart = iWritePos;
+    segment.iEnd = iWritePos + numSamples;
+    segment.iRamp = ramp;
+    aMsg.ClearRamp();
+    if (iOutLimit > segment.iStart) {
+        iOutLimit = segment.iStart; // pending output can't run on into the new ramp
+    }
+}
+
+const DelayLine::RampSegment* DelayLine::FindRamp(TUint64 aPos) const
+{
+    for (TUint i=0; i<iNumRampSegments; i++) {
+        const RampSegment& segment = iRampSegments[i];
+        if (aPos < segment.iStart) {
+            break;
+        }
+        if (aPos < segment.iEnd) {
+            return &segment;
+        }
+    }
+    return nullptr;
+}
+
+TUint64 DelayLine::RunLimit(TUint64 aPos) const
+{
+    // returns the first position after aPos that has a different ramp
+    for (TUint i=0; i<iNumRampSegments; i++) {
+        const RampSegment& segment = iRampSegments[i];
+        if (aPos < segment.iStart) {
+            return segment.iStart;
+        }
+        if (aPos < segment.iEnd) {
+            return segment.iEnd;
+        }
+    }
+    return kPosNone;
+}
+
+TInt32 DelayLine::Gain(TUint64 aPos) const
+{
+    const RampSegment* segment = FindRamp(aPos);
+    if (segment == nullptr) {
+        return 1 << RampApplicator::kGainShift;
+    }
+    const Media::Ramp& ramp = segment->iRamp;
+    if (ramp.Direction() == Ramp::EMute) {
+        return 0;
+    }
+    const TInt64 start = ramp.Start();
+    const TInt64 end = ramp.End();
+    const TInt64 value = start + ((end - start) * (TInt64)(aPos - segment->iStart)) / (TInt64)(segment->iEnd - segment->iStart);
+    return RampApplicator::Gain((TUint)value);
+}
+
+Media::Ramp DelayLine::RampBetween(const RampSegment& aSegment, TUint64 aStart, TUint64 aEnd) const
+{
+    Media::Ramp ramp = aSegment.iRamp;
+    if (ramp.Direction() == Ramp::EMute) {
+        return ramp;
+    }
+    if (aStart > aSegment.iStart) {
+        ramp = ramp.Split((TUint)(aStart - aSegment.iStart), (TUint)(aSegment.iEnd - aSegment.iStart));
+    }
+    if (aEnd < aSegment.iEnd) {
+        (void)ramp.Split((TUint)(aEnd - aStart), (TUint)(aSegment.iEnd - aStart));
+    }
+    return ramp;
+}
+
+void DelayLine::Write(const TInt32* aSrc, TUint aNumSamples)
+{
+    for (TUint i=0; i<aNumSamples; i++) {
+        WriteSample(aSrc);
+        aSrc += iNumChannels;
+    }
+}
+
+void DelayLine::WriteSilence(TUint aNumSamples)
+{
+    static const TInt32 kSilence[DecodedAudio::kMaxNumChannels] = { 0 };
+    for (TUint i=0; i<aNumSamples; i++) {
+        WriteSample(kSilence);
+    }
+}
+
+void DelayLine::WriteSample(const TInt32* aSample)
+{
+    TInt32* dest = &iRing[iWriteIndex * iNumChannels];
+    for (TUint i=0; i<iNumChannels; i++) {
+        dest[i] = aSample[i];
+    }
+    if (iOutputEnabled) {
+        const TInt32* to = &iRing[((iWriteIndex + iCapacity - iDelay) % iCapacity) * iNumChannels];
+        if (iRampRemaining == 0) {
+            AppendOutput(to, iWritePos - iDelay);
+        }
+        else {
+            // the two positions may have different ramps so these are applied before mixing
+            const TInt32* from = &iRing[((iWriteIndex + iCapacity - iFadeFrom) % iCapacity) * iNumChannels];
+            const TInt64 toGain = Gain(iWritePos - iDelay);
+            const TInt64 fromGain = Gain(iWritePos - iFadeFrom);
+            const TInt64 toWeight = iRampSamples - iRampRemaining;
+            const TInt64 fromWeight = iRampRemaining;
+            TInt32 mixed[DecodedAudio::kMaxNumChannels];
+            for (TUint i=0; i<iNumChannels; i++) {
+                const TInt64 fromSample = (from[i] * fromGain) >> RampApplicator::kGainShift;
+                const TInt64 toSample = (to[i] * toGain) >> RampApplicator::kGainShift;
+                mixed[i] = (TInt32)(((fromSample * fromWeight) + (toSample * toWeight)) / (TInt64)iRampSamples);
+            }
+            AppendOutput(mixed, kPosNone);
+            iRampRemaining--;
+        }
+    }
+    iWritePos++;
+    if (++iWriteIndex == iCapacity) {
+        iWriteIndex = 0;
+    }
+}
+
+void DelayLine::AppendOutput(const TInt32* aSample, TUint64 aPos)
+{
+    // Pending output is a run of consecutive positions sharing a single ramp (or a run of crossfaded samples)
+    if (iOutSubsamples > 0) {
+        TBool flush = (iOutSubsamples + iNumChannels > iMaxOutSubsamples);
+        if (aPos == kPosNone || iOutStart == kPosNone) {
+            flush = flush || (aPos != iOutStart);
+        }
+        else {
+            flush = flush || aPos != iOutEnd || aPos >= iOutLimit;
+        }
+        if (flush) {
+            FlushOutput();
+        }
+    }
+    if (iOutSubsamples == 0) {
+        iOutStart = aPos;
+        iOutLimit = (aPos == kPosNone? kPosNone : RunLimit(aPos));
+    }
+    TInt32* dest = &iOut[iOutSubsamples];
+    for (TUint i=0; i<iNumChannels; i++) {
+        dest[i] = aSample[i];
+    }
+    iOutSubsamples += iNumChannels;
+    iOutEnd = (aPos == kPosNone? kPosNone : aPos + 1);
+    iHistoryOutput = true;
+}
+
+void DelayLine::OutputFromHistory(TUint aNumSamples)
+{
+    TUint index = (iWriteIndex + iCapacity - aNumSamples) % iCapacity;
+    TUint64 pos = iWritePos - aNumSamples;
+    for (TUint i=0; i<aNumSamples; i++) {
+        AppendOutput(&iRing[index * iNumChannels], pos++);
+        if (++index == iCapacity) {
+            index = 0;
+        }
+    }
+}
+
+void DelayLine::FlushOutput()
+{
+    if (iOutSubsamples == 0) {
+        return;
+    }
+    ASSERT(iOutput != nullptr);
+    const TUint bytes = iOutSubsamples * (iBitDepth / 8);
+    DecodedAudio::FromNative32(iOut, iOutSubsamples, iBitDepth, iPacked);
+    MsgAudioPcm* msg = iMsgFactory.CreateMsgAudioPcm(Brn(iPacked, bytes), iNumChannels, iSampleRate,
+                                                     iBitDepth, AudioDataEndian::Big, iOutTrackOffset);
+    if (iOutStart != kPosNone) {
+        const RampSegment* segment = FindRamp(iOutStart);
+        if (segment != nullptr) {
+            msg->RestoreRamp(RampBetween(*segment, iOutStart, iOutEnd));
+        }
+    }
+    iOutTrackOffset += (iOutSubsamples / iNumChannels) * iJiffiesPerSample;
+    iOutput->Enqueue(msg);
+    iOutSubsamples = 0;
+}
+
+void DelayLine::SetBitDepth(TUint aBitDepth)
+{
+    if (aBitDepth == iBitDepth) {
+        return;
+    }
+    if (iOutput != nullptr) {
+        FlushOutput(); // output msgs can't mix bit depths
+    }
+    iBitDepth = aBitDepth;
+    const TUint bytesPerSubsample = DecodedAudio::BytesPerSubsample(aBitDepth, iMsgFactory.DecodedFormat());
+    const TUint maxSamples = AudioData::kMaxBytes / (bytesPerSubsample * iNumChannels);
+    iMaxOutSubsamples = maxSamples * iNumChannels;
+}
+
+void DelayLine::ProcessFragment(const Brx& aData, TUint aNumChannels, TUint aBitDepth)
+{
+    ASSERT(aNumChannels == iNumChannels);
+    SetBitDepth(aBitDepth);
+    const TUint bytesPerSubsample = aBitDepth / 8;
+    const TUint maxBytes = (kScratchSubsamples / aNumChannels) * aNumChannels * bytesPerSubsample;
+    TUint offset = 0;
+    while (offset < aData.Bytes()) {
+        const TUint bytes = std::min(aData.Bytes() - offset, maxBytes);
+        const TUint numSubsamples = bytes / bytesPerSubsample;
+        DecodedAudio::ToNative32(Brn(aData.Ptr() + offset, bytes), aBitDepth, AudioDataEndian::Big, iScratch);
+        Write(iScratch, numSubsamples / aNumChannels);
+        offset += bytes;
+    }
+}
+
+void DelayLine::BeginBlock()
+{
+}
+
+void DelayLine::ProcessFragment8(const Brx& aData, TUint aNumChannels)
+{
+    ProcessFragment(aData, aNumChannels, 8);
+}
+
+void DelayLine::ProcessFragment16(const Brx& aData, TUint aNumChannels)
+{
+    ProcessFragment(aData, aNumChannels, 16);
+}
+
+void DelayLine::ProcessFragment24(const Brx& aData, TUint aNumChannels)
+{
+    ProcessFragment(aData, aNumChannels, 24);
+}
+
+void DelayLine::ProcessFragment32(const Brx& aData, TUint aNumChannels)
+{
+    ProcessFragment(aData, aNumChannels, 32);
+}
+
+void DelayLine::ProcessFragmentNative32(const Brx& aData, TUint aNumChannels, TUint aBitDepth)
+{
+    ASSERT(aNumChannels == iNumChannels);
+    SetBitDepth(aBitDepth);
+    const TInt32* src = reinterpret_cast<const TInt32*>(aData.Ptr());
+    const TUint numSubsamples = aData.Bytes() / DecodedAudio::kNativeBytesPerSubsample;
+    Write(src, numSubsamples / aNumChannels);
+}
+
+void DelayLine::EndBlock()
+{
+}
+
+void DelayLine::Flush()
+{
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Private/Standard.h>
+#include <OpenHome/Media/Pipeline/Msg.h>
+
+namespace OpenHome {
+namespace Media {
+
+/*
+ Ring buffer of recent decoded audio, used by VariableDelay to apply delays without
+ generating MsgSilence.
+
+ Audio passed to Process() is output DelayJiffies() later.  Changing the delay moves the
+ read position; audio at the old and new positions is crossfaded over the ramp duration so
+ no ramp down, silence or ramp up is needed.  Increasing the delay replays recent audio
+ (or silence, if the line has just been reset); reducing it skips audio already held.
+
+ Subsamples are held as left-aligned TInt32, without any ramp.  Ramps on input msgs are
+ remembered separately and restored on the output msgs that replay the same samples; only
+ audio output during a crossfade has ramps applied to its samples.  Output track offsets
+ follow input while the line is transparent and are otherwise contiguous from the last
+ output, starting from SetTrackOffset() for each new stream.
+
+ Storage is sized for aMaxJiffies of stereo audio at 192kHz; lower sample rates or fewer
+ channels can hold proportionally longer delays.
+ Not thread safe.
+*/
+class DelayLine : private IPcmProcessor, private INonCopyable
+{
+    static const TUint kMaxSampleRate = 192000;
+    static const TUint kSizingChannels = 2;
+    static const TUint kScratchSubsamples = AudioData::kMaxBytes; // enough for a full DecodedAudio of 8-bit audio
+    static const TUint kMaxRampSegments = 32; // ramps beyond this are applied to samples as they're written
+    static const TUint64 kPosNone = ~0ULL;
+public:
+    DelayLine(MsgFactory& aMsgFactory, TUint aMaxJiffies, TUint aRampJiffies);
+    ~DelayLine();
+    void Reset(); // clear history and delay; format and track offset are retained
+    void SetFormat(TUint aSampleRate, TUint aBitDepth, TUint aNumChannels); // history is cleared if the format changes; drain first
+    TBool FormatSet() const;
+    TUint MaxDelayJiffies() const;
+    TUint DelayJiffies() const;
+    void SetTrackOffset(TUint64 aJiffies); // offset of the next audio output
+    TUint SetDelay(TUint aJiffies); // returns delay applied (rounded down to a whole number of samples)
+    TBool IsTransparent() const;    // true => output currently matches input
+    void Record(MsgAudioPcm* aMsg); // add aMsg to history without consuming it; only valid while IsTransparent()
+    void Record(MsgSilence* aMsg);
+    void Process(MsgAudioPcm* aMsg, MsgQueueLite& aOutput); // consumes aMsg; outputs the same duration of delayed audio
+    void Process(MsgSilence* aMsg, MsgQueueLite& aOutput);
+    void Drain(MsgQueueLite& aOutput); // outputs all held audio; delay is zero afterwards
+private:
+    class RampSegment
+    {
+    public:
+        TUint64 iStart; // sample positions (see iWritePos)
+        TUint64 iEnd;
+        Media::Ramp iRamp;
+    };
+private:
+    void Read(MsgPlayable* aPlayable); // consumes aPlayable
+    void RecordRamp(MsgAudio& aMsg);
+    const RampSegment* FindRamp(TUint64 aPos) const;
+    TUint64 RunLimit(TUint64 aPos) const;
+    TInt32 Gain(TUint64 aPos) const;
+    Media::Ramp RampBetween(const RampSegment& aSegment, TUint64 aStart, TUint64 aEnd) const;
+    void Write(const TInt32* aSrc, TUint aNumSamples);
+    void WriteSilence(TUint aNumSamples);
+    void WriteSample(const TInt32* aSample);
+    void AppendOutput(const TInt32* aSample, TUint64 aPos); // aPos of kPosNone => aSample has any ramp applied already
+    void OutputFromHistory(TUint aNumSamples);
+    void FlushOutput();
+    void SetBitDepth(TUint aBitDepth);
+    void ProcessFragment(const Brx& aData, TUint aNumChannels, TUint aBitDepth);
+private: // from IPcmProcessor
+    void BeginBlock() override;
+    void ProcessFragment8(const Brx& aData, TUint aNumChannels) override;
+    void ProcessFragment16(const Brx& aData, TUint aNumChannels) override;
+    void ProcessFragment24(const Brx& aData, TUint aNumChannels) override;
+    void ProcessFragment32(const Brx& aData, TUint aNumChannels) override;
+    void ProcessFragmentNative32(const Brx& aData, TUint aNumChannels, TUint aBitDepth) override;
+    void EndBlock() override;
+    void Flush() override;
+private:
+    MsgFactory& iMsgFactory;
+    const TUint iRampJiffies;
+    const TUint iRingSubsamples;
+    TInt32* iRing;
+    TInt32* iScratch;
+    TInt32* iOut;
+    TByte* iPacked;
+    TUint iSampleRate;
+    TUint iBitDepth;
+    TUint iNumChannels;
+    TUint iJiffiesPerSample;
+    TUint iCapacity;      // samples
+    TUint iWriteIndex;    // sample index of next write
+    TUint64 iWritePos;    // position of next write; starts at iCapacity so delayed positions never underflow
+    TUint iDelay;         // samples
+    TUint iFadeFrom;      // delay (samples) being crossfaded away from
+    TUint iRampSamples;
+    TUint iRampRemaining; // samples of crossfade still to be output
+    TBool iOutputEnabled; // false => Write() only adds to history
+    TBool iHistoryOutput; // false => nothing output since Reset() so delay changes needn't be crossfaded
+    TUint iOutSubsamples;
+    TUint iMaxOutSubsamples; // most subsamples that fit in a single DecodedAudio
+    TUint64 iOutStart;    // position of first pending output sample, kPosNone if crossfaded
+    TUint64 iOutEnd;
+    TUint64 iOutLimit;    // position at which the ramp for pending output changes
+    TUint64 iOutTrackOffset;
+    RampSegment iRampSegments[kMaxRampSegments]; // oldest first
+    TUint iNumRampSegments;
+    MsgQueueLite* iOutput;
+};
+
+} // namespace Media
+} // namespace OpenHome
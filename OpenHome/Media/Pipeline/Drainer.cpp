@@ -82,6 +82,11 @@ Msg* Drainer::Pull()
     return msg;
 }
 
+UpstreamLink* Drainer::SpliceableUpstream()
+{
+    return &iUpstream;
+}
+
 Msg* Drainer::ProcessMsg(MsgHalt* aMsg)
 {
     LOG(kPipeline, "Drainer enabled (MsgHalt)\n");
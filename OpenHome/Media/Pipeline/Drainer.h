@@ -20,6 +20,7 @@ public:
     ~Drainer();
 private: // from IPipelineElementUpstream
     Msg* Pull() override;
+    UpstreamLink* SpliceableUpstream() override;
 private: // from PipelineElement
     Msg* ProcessMsg(MsgHalt* aMsg) override;
     Msg* ProcessMsg(MsgDecodedStream* aMsg) override;
@@ -31,7 +32,7 @@ private: // from IStreamHandler
     void NotifyStarving(const Brx& aMode, TUint aStreamId, TBool aStarving) override;
 private:
     MsgFactory& iMsgFactory;
-    IPipelineElementUpstream& iUpstream;
+    UpstreamLink iUpstream;
     Semaphore iSem;
     Msg* iPending;
     std::atomic<IStreamHandler*> iStreamHandler;
@@ -1,99 +1,261 @@
 #include <OpenHome/Media/Pipeline/ElementObserver.h>
 #include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/OsWrapper.h>
 #include <OpenHome/Private/Thread.h>
 #include <OpenHome/Private/Standard.h>
+#include <OpenHome/Private/Ascii.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Media/Pipeline/ThreadScheduling.h>
+#include <OpenHome/Net/Private/Globals.h>
 
-#include <atomic>
 #include <vector>
 
 using namespace OpenHome;
 using namespace OpenHome::Media;
 
-PipelineElementObserverThread::PipelineElementObserverThread(TUint aPriority)
+PipelineElementObserverThread::PipelineElementObserverThread(TUint aPriority, TUint aNumWorkers)
     : iLock("PEOT")
-    , iNextId(0)
+    , iNextIndex(0)
+    , iStopped(false)
 {
-    iThread = new ThreadFunctor("PipelineEvents", MakeFunctor(*this, &PipelineElementObserverThread::PipelineEventThread), aPriority);
-    iThread->Start();
+    ASSERT(aNumWorkers > 0);
+    for (TUint i=0; i<aNumWorkers; i++) {
+        auto worker = new ThreadFunctor("PipelineEvents", MakeFunctor(*this, &PipelineElementObserverThread::WorkerThread), aPriority);
+        iWorkers.push_back(worker);
+        worker->Start();
+    }
 }
 
 PipelineElementObserverThread::~PipelineElementObserverThread()
 {
-    delete iThread;
+    Stop();
     for (auto it=iCallbacks.begin(); it!=iCallbacks.end(); ++it) {
         delete *it;
     }
 }
 
 void PipelineElementObserverThread::Stop()
+{
+    iLock.Wait();
+    iStopped = true;
+    iLock.Signal();
+    // workers may be waiting on iLock so can't be deleted while it is held
+    for (auto it=iWorkers.begin(); it!=iWorkers.end(); ++it) {
+        delete *it;
+    }
+    iWorkers.clear();
+}
+
+void PipelineElementObserverThread::ResetStats()
 {
     AutoMutex _(iLock);
-    delete iThread;
-    iThread = nullptr;
+    for (auto it=iCallbacks.begin(); it!=iCallbacks.end(); ++it) {
+        (*it)->ResetStats();
+    }
+}
+
+void PipelineElementObserverThread::WriteStats(IWriter& aWriter) const
+{
+    AutoMutex _(iLock);
+    WriterAscii writer(aWriter);
+    writer.Write('[');
+    for (TUint i=0; i<iCallbacks.size(); i++) {
+        if (i > 0) {
+            writer.Write(',');
+        }
+        iCallbacks[i]->WriteStats(aWriter, i);
+    }
+    writer.Write(']');
 }
 
-void PipelineElementObserverThread::PipelineEventThread()
+void PipelineElementObserverThread::WorkerThread()
 {
+    ThreadScheduling::Apply(PipelineThread::eEvent);
+    Thread* thread = Thread::Current();
     try {
         for (;;) {
-            iThread->Wait();
-            for (auto it=iCallbacks.begin(); it!=iCallbacks.end(); ++it) {
-                (*it)->RunIfPending();
+            TUint waitMs = 0;
+            iLock.Wait();
+            const TUint64 startUs = NowUs();
+            Callback* cb = NextRunnable(startUs, waitMs);
+            iLock.Signal();
+            if (cb == nullptr) {
+                if (waitMs == 0) {
+                    thread->Wait();
+                }
+                else {
+                    try {
+                        thread->Wait(waitMs);
+                    }
+                    catch (Timeout&) {}
+                }
+                continue;
             }
+            cb->Run();
+            // any Schedule() calls made while cb ran are picked up when we next check for work
+            AutoMutex _(iLock);
+            cb->EndRun(startUs, NowUs());
         }
     }
     catch (ThreadKill&) {}
 }
 
+PipelineElementObserverThread::Callback* PipelineElementObserverThread::NextRunnable(TUint64 aNowUs, TUint& aWaitMs)
+{
+    aWaitMs = 0;
+    const TUint count = (TUint)iCallbacks.size();
+    // start each search after the last callback run so frequently scheduled callbacks can't starve others
+    for (TUint i=0; i<count; i++) {
+        const TUint index = (iNextIndex + i) % count;
+        Callback* cb = iCallbacks[index];
+        TUint waitMs = 0;
+        if (cb->Runnable(aNowUs, waitMs)) {
+            cb->StartRun(aNowUs);
+            iNextIndex = index + 1;
+            return cb;
+        }
+        if (waitMs > 0 && (aWaitMs == 0 || waitMs < aWaitMs)) {
+            aWaitMs = waitMs;
+        }
+    }
+    return nullptr;
+}
+
+TUint64 PipelineElementObserverThread::NowUs()
+{ // static
+    return OsTimeInUs(gEnv->OsCtx());
+}
+
 TUint PipelineElementObserverThread::Register(Functor aCallback)
 {
-    iLock.Wait();
-    const TUint id = iNextId++;
-    iLock.Signal();
-    Callback* cb = new Callback(id, aCallback);
-    iCallbacks.push_back(cb);
-    return cb->Id();
+    return Register(aCallback, 0);
+}
+
+TUint PipelineElementObserverThread::Register(Functor aCallback, TUint aMinIntervalMs)
+{
+    AutoMutex _(iLock);
+    const TUint id = (TUint)iCallbacks.size();
+    iCallbacks.push_back(new Callback(aCallback, aMinIntervalMs));
+    return id;
 }
 
 void PipelineElementObserverThread::Schedule(TUint aId)
 {
-    for (auto it=iCallbacks.begin(); it!=iCallbacks.end(); ++it) {
-        if ((*it)->Id() == aId) {
-            AutoMutex _(iLock);
-            if (iThread != nullptr) {
-                (*it)->SetPending();
-                iThread->Signal();
-            }
-            return;
-        }
+    AutoMutex _(iLock);
+    // aId not registered => programming error
+    ASSERT(aId < iCallbacks.size());
+    if (iStopped) {
+        return;
+    }
+    Callback* cb = iCallbacks[aId];
+    if (!cb->Schedule(NowUs()) || cb->Running()) {
+        // already pending or will be picked up by the worker running it
+        return;
+    }
+    for (auto it=iWorkers.begin(); it!=iWorkers.end(); ++it) {
+        (*it)->Signal();
     }
-    // only get this far if aId hasn't been registered => programming error
-    ASSERTS();
 }
 
 
 // PipelineElementObserverThread::Callback
 
-PipelineElementObserverThread::Callback::Callback(TUint aId, Functor aCallback)
-    : iId(aId)
-    , iCallback(aCallback)
+PipelineElementObserverThread::Callback::Callback(Functor aCallback, TUint aMinIntervalMs)
+    : iCallback(aCallback)
+    , iMinIntervalUs((TUint64)aMinIntervalMs * 1000)
+    , iPending(false)
+    , iRunning(false)
+    , iScheduledUs(0)
+    , iLastRunUs(0)
+{
+    ResetStats();
+}
+
+TBool PipelineElementObserverThread::Callback::Schedule(TUint64 aNowUs)
+{
+    if (iPending) {
+        iCoalesced++;
+        return false;
+    }
+    iPending = true;
+    iScheduledUs = aNowUs;
+    return true;
+}
+
+TBool PipelineElementObserverThread::Callback::Runnable(TUint64 aNowUs, TUint& aWaitMs) const
+{
+    aWaitMs = 0;
+    if (!iPending || iRunning) {
+        return false;
+    }
+    if (iLastRunUs != 0 && aNowUs < iLastRunUs + iMinIntervalUs) {
+        aWaitMs = (TUint)((iLastRunUs + iMinIntervalUs - aNowUs + 999) / 1000);
+        return false;
+    }
+    return true;
+}
+
+void PipelineElementObserverThread::Callback::StartRun(TUint64 aNowUs)
 {
-    iPending.store(false);
-    ASSERT(iPending.is_lock_free());
+    iPending = false;
+    iRunning = true;
+    iLastRunUs = aNowUs;
+    const TUint64 latency = (aNowUs > iScheduledUs? aNowUs - iScheduledUs : 0);
+    iDispatches++;
+    iLatencyTotalUs += latency;
+    if (latency > iLatencyMaxUs) {
+        iLatencyMaxUs = latency;
+    }
 }
 
-void PipelineElementObserverThread::Callback::SetPending()
+void PipelineElementObserverThread::Callback::Run()
 {
-    iPending.store(true);
+    iCallback();
 }
 
-void PipelineElementObserverThread::Callback::RunIfPending()
+void PipelineElementObserverThread::Callback::EndRun(TUint64 aStartUs, TUint64 aNowUs)
 {
-    if (iPending.exchange(false)) {
-        iCallback();
+    iRunning = false;
+    const TUint64 duration = (aNowUs > aStartUs? aNowUs - aStartUs : 0);
+    iRunTotalUs += duration;
+    if (duration > iRunMaxUs) {
+        iRunMaxUs = duration;
     }
 }
 
+void PipelineElementObserverThread::Callback::ResetStats()
+{
+    iDispatches = 0;
+    iCoalesced = 0;
+    iLatencyTotalUs = 0;
+    iLatencyMaxUs = 0;
+    iRunTotalUs = 0;
+    iRunMaxUs = 0;
+}
+
+void PipelineElementObserverThread::Callback::WriteStats(IWriter& aWriter, TUint aId) const
+{
+    WriterAscii writer(aWriter);
+    writer.Write(Brn("{\"id\":"));
+    writer.WriteUint(aId);
+    writer.Write(Brn(",\"minIntervalMs\":"));
+    writer.WriteUint64(iMinIntervalUs / 1000);
+    writer.Write(Brn(",\"dispatches\":"));
+    writer.WriteUint64(iDispatches);
+    writer.Write(Brn(",\"coalesced\":"));
+    writer.WriteUint64(iCoalesced);
+    writer.Write(Brn(",\"latencyAvgUs\":"));
+    writer.WriteUint64(iDispatches == 0? 0 : iLatencyTotalUs / iDispatches);
+    writer.Write(Brn(",\"latencyMaxUs\":"));
+    writer.WriteUint64(iLatencyMaxUs);
+    writer.Write(Brn(",\"runAvgUs\":"));
+    writer.WriteUint64(iDispatches == 0? 0 : iRunTotalUs / iDispatches);
+    writer.Write(Brn(",\"runMaxUs\":"));
+    writer.WriteUint64(iRunMaxUs);
+    writer.Write('}');
+}
+
 
 // ElementObserverSync
 
@@ -106,6 +268,11 @@ TUint ElementObserverSync::Register(Functor aCallback)
     return kId;
 }
 
+TUint ElementObserverSync::Register(Functor aCallback, TUint /*aMinIntervalMs*/)
+{
+    return Register(aCallback);
+}
+
 void ElementObserverSync::Schedule(TUint aId)
 {
     ASSERT(aId == kId);
@@ -5,10 +5,10 @@
 #include <OpenHome/Private/Standard.h>
 #include <OpenHome/Functor.h>
 
-#include <atomic>
 #include <vector>
 
 namespace OpenHome {
+    class IWriter;
 namespace Media {
 
 /*
@@ -16,6 +16,8 @@ namespace Media {
     (i.e. Ensures callbacks don't block flow of pipeline msgs)
     Effect of calling Schedule while a previous callback is pending is slightly
     unpredictable - the callback is guaranteed to be called at least once.
+    Callbacks registered with a minimum interval run at most once per interval; calls
+    to Schedule during the interval are coalesced into a single callback at its end.
 */
 
 class IPipelineElementCallback
@@ -30,38 +32,66 @@ class IPipelineElementObserverThread
 public:
     virtual ~IPipelineElementObserverThread() {}
     virtual TUint Register(Functor aCallback) = 0;
+    virtual TUint Register(Functor aCallback, TUint aMinIntervalMs) = 0;
     virtual void Schedule(TUint aId) = 0;
 };
 
+/*
+    Callbacks are shared between aNumWorkers threads so that a slow callback only delays
+    others once all workers are busy.  A callback never runs concurrently with itself but
+    callbacks are not guaranteed to run in the order they were scheduled if aNumWorkers > 1.
+*/
+
 class PipelineElementObserverThread : public IPipelineElementObserverThread, private INonCopyable
 {
 public:
-    PipelineElementObserverThread(TUint aPriority);
+    PipelineElementObserverThread(TUint aPriority, TUint aNumWorkers);
     ~PipelineElementObserverThread();
     void Stop();
+    void ResetStats();
+    void WriteStats(IWriter& aWriter) const; // JSON array, one object per registered callback
 private:
-    void PipelineEventThread();
+    class Callback;
+    void WorkerThread();
+    Callback* NextRunnable(TUint64 aNowUs, TUint& aWaitMs); // called with iLock held
+    static TUint64 NowUs();
 private: // from IPipelineElementObserverThread
     TUint Register(Functor aCallback) override;
+    TUint Register(Functor aCallback, TUint aMinIntervalMs) override;
     void Schedule(TUint aId) override;
 private:
     class Callback : private INonCopyable
     {
     public:
-        Callback(TUint aId, Functor aCallback);
-        TUint Id() const { return iId; }
-        void SetPending();
-        void RunIfPending();
+        Callback(Functor aCallback, TUint aMinIntervalMs);
+        TBool Schedule(TUint64 aNowUs); // returns true if the callback wasn't already pending
+        TBool Runnable(TUint64 aNowUs, TUint& aWaitMs) const;
+        void StartRun(TUint64 aNowUs);
+        void Run();
+        void EndRun(TUint64 aStartUs, TUint64 aNowUs);
+        TBool Running() const { return iRunning; }
+        void ResetStats();
+        void WriteStats(IWriter& aWriter, TUint aId) const;
     private:
-        TUint iId;
         Functor iCallback;
-        std::atomic<bool> iPending;
+        const TUint64 iMinIntervalUs;
+        TBool iPending;
+        TBool iRunning;
+        TUint64 iScheduledUs;
+        TUint64 iLastRunUs;
+        TUint64 iDispatches;
+        TUint64 iCoalesced;
+        TUint64 iLatencyTotalUs; // Schedule() to start of callback, including any rate limiting
+        TUint64 iLatencyMaxUs;
+        TUint64 iRunTotalUs;
+        TUint64 iRunMaxUs;
     };
 private:
-    ThreadFunctor* iThread;
-    Mutex iLock;
-    std::vector<Callback*> iCallbacks;
-    TUint iNextId;
+    mutable Mutex iLock;
+    std::vector<ThreadFunctor*> iWorkers;
+    std::vector<Callback*> iCallbacks; // indexed by id
+    TUint iNextIndex;                  // first callback checked by NextRunnable
+    TBool iStopped;
 };
 
 // Test helper - supports a single callback and runs it synchronously, inside calls to Schedule()
@@ -70,6 +100,7 @@ class ElementObserverSync : public IPipelineElementObserverThread
     static const TUint kId;
 private: // from IPipelineElementObserverThread
     TUint Register(Functor aCallback) override;
+    TUint Register(Functor aCallback, TUint aMinIntervalMs) override;
     void Schedule(TUint aId) override;
 private:
     Functor iCallback;
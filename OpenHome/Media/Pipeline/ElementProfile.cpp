@@ -0,0 +1,219 @@
+#include <OpenHome/Media/Pipeline/ElementProfile.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/OsWrapper.h>
+#include <OpenHome/Private/Ascii.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Media/Pipeline/Msg.h>
+#include <OpenHome/Net/Private/Globals.h>
+
+#include <atomic>
+#include <climits>
+#ifndef _WIN32
+# include <time.h>
+#endif
+
+using namespace OpenHome;
+using namespace OpenHome::Media;
+
+// ElementProfile
+
+const TChar* ElementProfile::kMsgTypeNames[kNumMsgTypes] = {
+    "mode", "track", "drain", "delay", "encodedStream", "audioEncoded", "metaText", "streamInterrupted",
+    "halt", "flush", "wait", "decodedStream", "bitRate", "audioPcm", "silence", "playable", "quit" };
+
+ElementProfile::ElementProfile()
+    : iLevel(nullptr)
+    , iLevelUnits(nullptr)
+    , iNextLevelSampleUs(0)
+{
+    Reset();
+}
+
+void ElementProfile::SetLevelSource(IReservoirLevel& aLevel, const TChar* aUnits)
+{
+    iLevel = &aLevel;
+    iLevelUnits = aUnits;
+}
+
+ElementProfile::Timestamp ElementProfile::Start() const
+{
+    Timestamp ts;
+    ts.iWallUs = WallTimeUs();
+    ts.iCpuUs = ThreadCpuUs();
+    return ts;
+}
+
+void ElementProfile::Stop(const Timestamp& aStart)
+{
+    const TUint64 wall = WallTimeUs();
+    const TUint64 cpu = ThreadCpuUs();
+    iCalls.fetch_add(1, std::memory_order_relaxed);
+    iWallUs.fetch_add(wall - aStart.iWallUs, std::memory_order_relaxed);
+    iCpuUs.fetch_add(cpu - aStart.iCpuUs, std::memory_order_relaxed);
+    iThreadCpuUs.store(cpu, std::memory_order_relaxed);
+    if (iLevel != nullptr && wall >= iNextLevelSampleUs) {
+        SampleLevel(wall);
+    }
+}
+
+void ElementProfile::Count(Msg& aMsg)
+{
+    (void)aMsg.Process(*this);
+}
+
+void ElementProfile::Reset()
+{
+    iCalls.store(0);
+    iWallUs.store(0);
+    iCpuUs.store(0);
+    iThreadCpuUs.store(0);
+    for (TUint i=0; i<kNumMsgTypes; i++) {
+        iMsgCounts[i].store(0);
+    }
+    iLevelMin.store(UINT_MAX);
+    iLevelMax.store(0);
+    for (TUint i=0; i<kLevelHistory; i++) {
+        iLevelHistory[i].store(0);
+    }
+    iLevelSamples.store(0);
+}
+
+void ElementProfile::WriteJson(IWriter& aWriter, const TChar* aId, TBool aPush) const
+{
+    WriterAscii writer(aWriter);
+    const TUint64 wallUs = iWallUs.load();
+    const TUint64 cpuUs = iCpuUs.load();
+    writer.Write(Brn("{\"id\":\""));
+    writer.Write(Brn(aId));
+    writer.Write(Brn("\",\"direction\":\""));
+    writer.Write(aPush? Brn("push") : Brn("pull"));
+    writer.Write(Brn("\",\"calls\":"));
+    writer.WriteUint64(iCalls.load());
+    writer.Write(Brn(",\"wallUs\":"));
+    writer.WriteUint64(wallUs);
+    writer.Write(Brn(",\"cpuUs\":"));
+    writer.WriteUint64(cpuUs);
+    writer.Write(Brn(",\"blockedUs\":"));
+    writer.WriteUint64(wallUs > cpuUs? wallUs - cpuUs : 0);
+    writer.Write(Brn(",\"threadCpuUs\":"));
+    writer.WriteUint64(iThreadCpuUs.load());
+    writer.Write(Brn(",\"msgs\":{"));
+    TBool first = true;
+    for (TUint i=0; i<kNumMsgTypes; i++) {
+        const TUint64 count = iMsgCounts[i].load();
+        if (count == 0) {
+            continue;
+        }
+        if (!first) {
+            writer.Write(',');
+        }
+        first = false;
+        writer.Write('\"');
+        writer.Write(Brn(kMsgTypeNames[i]));
+        writer.Write(Brn("\":"));
+        writer.WriteUint64(count);
+    }
+    writer.Write('}');
+    if (iLevel != nullptr) {
+        const TUint samples = iLevelSamples.load();
+        writer.Write(Brn(",\"level\":{\"units\":\""));
+        writer.Write(Brn(iLevelUnits));
+        writer.Write(Brn("\",\"current\":"));
+        writer.WriteUint(iLevel->ReservoirLevel());
+        writer.Write(Brn(",\"min\":"));
+        writer.WriteUint(samples == 0? 0 : iLevelMin.load());
+        writer.Write(Brn(",\"max\":"));
+        writer.WriteUint(iLevelMax.load());
+        writer.Write(Brn(",\"sampleIntervalMs\":"));
+        writer.WriteUint(kLevelSampleIntervalUs / 1000);
+        writer.Write(Brn(",\"history\":["));
+        // oldest first
+        const TUint count = (samples < kLevelHistory? samples : kLevelHistory);
+        for (TUint i=0; i<count; i++) {
+            if (i > 0) {
+                writer.Write(',');
+            }
+            writer.WriteUint(iLevelHistory[(samples - count + i) % kLevelHistory].load());
+        }
+        writer.Write(Brn("]}"));
+    }
+    writer.Write('}');
+}
+
+TUint64 ElementProfile::Calls() const
+{
+    return iCalls.load();
+}
+
+TUint64 ElementProfile::MsgCount() const
+{
+    TUint64 count = 0;
+    for (TUint i=0; i<kNumMsgTypes; i++) {
+        count += iMsgCounts[i].load();
+    }
+    return count;
+}
+
+TBool ElementProfile::ThreadCpuSupported()
+{ // static
+#ifdef CLOCK_THREAD_CPUTIME_ID
+    return true;
+#else
+    return false;
+#endif
+}
+
+TUint64 ElementProfile::WallTimeUs()
+{ // static
+    return OsTimeInUs(gEnv->OsCtx());
+}
+
+TUint64 ElementProfile::ThreadCpuUs()
+{ // static
+#ifdef CLOCK_THREAD_CPUTIME_ID
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return ((TUint64)ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+    }
+#endif
+    return 0;
+}
+
+void ElementProfile::SampleLevel(TUint64 aWallUs)
+{
+    iNextLevelSampleUs = aWallUs + kLevelSampleIntervalUs;
+    const TUint level = iLevel->ReservoirLevel();
+    const TUint index = iLevelSamples.load(std::memory_order_relaxed);
+    iLevelHistory[index % kLevelHistory].store(level, std::memory_order_relaxed);
+    iLevelSamples.store(index + 1, std::memory_order_release);
+    if (level < iLevelMin.load(std::memory_order_relaxed)) {
+        iLevelMin.store(level, std::memory_order_relaxed);
+    }
+    if (level > iLevelMax.load(std::memory_order_relaxed)) {
+        iLevelMax.store(level, std::memory_order_relaxed);
+    }
+}
+
+void ElementProfile::Count(TUint aIndex)
+{
+    iMsgCounts[aIndex].fetch_add(1, std::memory_order_relaxed);
+}
+
+Msg* ElementProfile::ProcessMsg(MsgMode* aMsg)              { Count(0);  return aMsg; }
+Msg* ElementProfile::ProcessMsg(MsgTrack* aMsg)             { Count(1);  return aMsg; }
+Msg* ElementProfile::ProcessMsg(MsgDrain* aMsg)             { Count(2);  return aMsg; }
+Msg* ElementProfile::ProcessMsg(MsgDelay* aMsg)             { Count(3);  return aMsg; }
+Msg* ElementProfile::ProcessMsg(MsgEncodedStream* aMsg)     { Count(4);  return aMsg; }
+Msg* ElementProfile::ProcessMsg(MsgAudioEncoded* aMsg)      { Count(5);  return aMsg; }
+Msg* ElementProfile::ProcessMsg(MsgMetaText* aMsg)          { Count(6);  return aMsg; }
+Msg* ElementProfile::ProcessMsg(MsgStreamInterrupted* aMsg) { Count(7);  return aMsg; }
+Msg* ElementProfile::ProcessMsg(MsgHalt* aMsg)              { Count(8);  return aMsg; }
+Msg* ElementProfile::ProcessMsg(MsgFlush* aMsg)             { Count(9);  return aMsg; }
+Msg* ElementProfile::ProcessMsg(MsgWait* aMsg)              { Count(10); return aMsg; }
+Msg* ElementProfile::ProcessMsg(MsgDecodedStream* aMsg)     { Count(11); return aMsg; }
+Msg* ElementProfile::ProcessMsg(MsgBitRate* aMsg)           { Count(12); return aMsg; }
+Msg* ElementProfile::ProcessMsg(MsgAudioPcm* aMsg)          { Count(13); return aMsg; }
+Msg* ElementProfile::ProcessMsg(MsgSilence* aMsg)           { Count(14); return aMsg; }
+Msg* ElementProfile::ProcessMsg(MsgPlayable* aMsg)          { Count(15); return aMsg; }
+Msg* ElementProfile::ProcessMsg(MsgQuit* aMsg)              { Count(16); return aMsg; }
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Media/Pipeline/Msg.h>
+
+#include <atomic>
+
+namespace OpenHome {
+    class IWriter;
+namespace Media {
+
+/*
+ Source of a fill level sampled by ElementProfile.  Implemented by reservoirs.
+*/
+class IReservoirLevel
+{
+public:
+    virtual ~IReservoirLevel() {}
+    virtual TUint ReservoirLevel() const = 0;
+};
+
+/*
+ Counters describing the time spent in (and msgs passed through) one point in the pipeline.
+ Owned by a Logger, which updates them while profiling is enabled.
+
+ Times are inclusive - they cover all work done by upstream elements on the calling thread,
+ plus any time spent blocked waiting for a reservoir.  The cost of a single element is the
+ difference between its counters and those of the profile immediately upstream of it.
+
+ Updated by a single thread; may be read or reset from any thread.
+*/
+class ElementProfile : private IMsgProcessor, private INonCopyable
+{
+    static const TUint kNumMsgTypes = 17;
+    static const TUint kLevelHistory = 60;
+    static const TUint kLevelSampleIntervalUs = 500 * 1000;
+public:
+    class Timestamp
+    {
+        friend class ElementProfile;
+    private:
+        TUint64 iWallUs;
+        TUint64 iCpuUs;
+    };
+public:
+    ElementProfile();
+    void SetLevelSource(IReservoirLevel& aLevel, const TChar* aUnits);
+    Timestamp Start() const;
+    void Stop(const Timestamp& aStart);
+    void Count(Msg& aMsg);
+    void Reset();
+    void WriteJson(IWriter& aWriter, const TChar* aId, TBool aPush) const;
+    TUint64 Calls() const;
+    TUint64 MsgCount() const;
+    static TBool ThreadCpuSupported();
+private:
+    static TUint64 WallTimeUs();
+    static TUint64 ThreadCpuUs();
+    void SampleLevel(TUint64 aWallUs);
+    void Count(TUint aIndex);
+private: // from IMsgProcessor
+    Msg* ProcessMsg(MsgMode* aMsg) override;
+    Msg* ProcessMsg(MsgTrack* aMsg) override;
+    Msg* ProcessMsg(MsgDrain* aMsg) override;
+    Msg* ProcessMsg(MsgDelay* aMsg) override;
+    Msg* ProcessMsg(MsgEncodedStream* aMsg) override;
+    Msg* ProcessMsg(MsgAudioEncoded* aMsg) override;
+    Msg* ProcessMsg(MsgMetaText* aMsg) override;
+    Msg* ProcessMsg(MsgStreamInterrupted* aMsg) override;
+    Msg* ProcessMsg(MsgHalt* aMsg) override;
+    Msg* ProcessMsg(MsgFlush* aMsg) override;
+    Msg* ProcessMsg(MsgWait* aMsg) override;
+    Msg* ProcessMsg(MsgDecodedStream* aMsg) override;
+    Msg* ProcessMsg(MsgBitRate* aMsg) override;
+    Msg* ProcessMsg(MsgAudioPcm* aMsg) override;
+    Msg* ProcessMsg(MsgSilence* aMsg) override;
+    Msg* ProcessMsg(MsgPlayable* aMsg) override;
+    Msg* ProcessMsg(MsgQuit* aMsg) override;
+private:
+    static const TChar* kMsgTypeNames[kNumMsgTypes];
+    std::atomic<TUint64> iCalls;
+    std::atomic<TUint64> iWallUs;
+    std::atomic<TUint64> iCpuUs;
+    std::atomic<TUint64> iThreadCpuUs; // cumulative cpu time of the thread which last called Stop()
+    std::atomic<TUint64> iMsgCounts[kNumMsgTypes];
+    IReservoirLevel* iLevel;
+    const TChar* iLevelUnits;
+    TUint64 iNextLevelSampleUs;
+    std::atomic<TUint> iLevelMin;
+    std::atomic<TUint> iLevelMax;
+    std::atomic<TUint> iLevelHistory[kLevelHistory];
+    std::atomic<TUint> iLevelSamples; // total number of samples taken; iLevelHistory is indexed modulo kLevelHistory
+};
+
+} // namespace Media
+} // namespace OpenHome
@@ -34,6 +34,11 @@ TUint EncodedAudioReservoir::SizeInBytes() const
     return EncodedBytes();
 }
 
+TUint EncodedAudioReservoir::ReservoirLevel() const
+{
+    return EncodedBytes();
+}
+
 Msg* EncodedAudioReservoir::EndSeek(Msg* aMsg)
 {
     EnqueueAtHead(aMsg);
@@ -111,6 +116,7 @@ Msg* EncodedAudioReservoir::ProcessMsgOut(MsgAudioEncoded* aMsg)
     ASSERT_VA(EncodedBytes() < kEncodedBytesInvalid, "EncodedBytes() = %08x\n", EncodedBytes());
     ASSERT_VA(EncodedAudioCount() < kMsgCountInvalid, "EncodedAudioCount() = %08x\n", EncodedAudioCount());
     iStreamPos = newStreamPos;
+    aMsg->AddLogPoint(LatencyPoint::eEncodedReservoir);
     return aMsg;
 }
 
@@ -2,6 +2,7 @@
 
 #include <OpenHome/Types.h>
 #include <OpenHome/Media/Pipeline/AudioReservoir.h>
+#include <OpenHome/Media/Pipeline/ElementProfile.h>
 #include <OpenHome/Private/Thread.h>
 #include <OpenHome/Private/Standard.h>
 
@@ -12,7 +13,7 @@ namespace Media {
 
 class SuiteEncodedReservoir;
 
-class EncodedAudioReservoir : public AudioReservoir, private IStreamHandler, private INonCopyable
+class EncodedAudioReservoir : public AudioReservoir, public IReservoirLevel, private IStreamHandler, private INonCopyable
 {
     friend class SuiteEncodedReservoir;
     static const TUint kEncodedBytesInvalid; // values larger than this will have been caused by unsigned underflow (i.e. implementation error)
@@ -24,6 +25,8 @@ private:
     Msg* EndSeek(Msg* aMsg);
 private: // from AudioReservoir
     TBool IsFull() const override;
+private: // from IReservoirLevel
+    TUint ReservoirLevel() const override;
 private: // from MsgReservoir
     void ProcessMsgIn(MsgTrack* aMsg) override;
     void ProcessMsgIn(MsgEncodedStream* aMsg) override;
@@ -73,6 +73,11 @@ Msg* Flusher::Pull()
     return msg;
 }
 
+UpstreamLink* Flusher::SpliceableUpstream()
+{
+    return &iUpstream;
+}
+
 inline TBool Flusher::IsFlushing() const
 {
     return (iTargetHaltId != MsgHalt::kIdInvalid || iTargetFlushId != MsgFlush::kIdInvalid);
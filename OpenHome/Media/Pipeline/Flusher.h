@@ -17,6 +17,7 @@ public:
     void DiscardUntilFlush(TUint aId);
 public: // from IPipelineElementUpstream
     Msg* Pull() override;
+    UpstreamLink* SpliceableUpstream() override;
 private:
     inline TBool IsFlushing() const;
     Msg* ProcessFlushable(Msg* aMsg);
@@ -40,7 +41,7 @@ private: // from IMsgProcessor
     Msg* ProcessMsg(MsgQuit* aMsg) override;
 private:
     Mutex iLock;
-    IPipelineElementUpstream& iUpstream;
+    UpstreamLink iUpstream;
     const TChar* iId;
     TUint iTargetHaltId;
     TUint iTargetFlushId;
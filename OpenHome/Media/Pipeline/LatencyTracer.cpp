@@ -0,0 +1,216 @@
+#include <OpenHome/Media/Pipeline/LatencyTracer.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/OsWrapper.h>
+#include <OpenHome/Private/Ascii.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/Standard.h>
+#include <OpenHome/Net/Private/Globals.h>
+
+#include <atomic>
+#include <string.h>
+
+using namespace OpenHome;
+using namespace OpenHome::Media;
+
+// LatencyTrace
+
+LatencyTrace::LatencyTrace()
+{
+    Clear();
+}
+
+void LatencyTrace::Clear()
+{
+    (void)memset(iStamps, 0, sizeof iStamps);
+}
+
+TBool LatencyTrace::IsSet() const
+{
+    for (TUint i=0; i<kNumPoints; i++) {
+        if (iStamps[i] != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void LatencyTrace::Stamp(LatencyPoint aPoint, TUint64 aTimeUs)
+{
+    TUint64& stamp = iStamps[(TUint)aPoint];
+    if (stamp == 0) {
+        stamp = aTimeUs;
+    }
+}
+
+TUint64 LatencyTrace::Get(LatencyPoint aPoint) const
+{
+    return iStamps[(TUint)aPoint];
+}
+
+
+// LatencyTracer
+
+std::atomic<TUint> LatencyTracer::iSampleInterval(0);
+std::atomic<TUint> LatencyTracer::iSampleCounter(0);
+LatencyTracer::Hop LatencyTracer::iHops[LatencyTracer::kNumHops];
+
+void LatencyTracer::Enable(TUint aSampleInterval)
+{ // static
+    iSampleCounter.store(0);
+    iSampleInterval.store(aSampleInterval);
+}
+
+void LatencyTracer::Disable()
+{ // static
+    iSampleInterval.store(0);
+}
+
+TUint LatencyTracer::SampleInterval()
+{ // static
+    return iSampleInterval.load();
+}
+
+TBool LatencyTracer::DoTrySample()
+{ // static
+    const TUint interval = iSampleInterval.load(std::memory_order_relaxed);
+    if (interval == 0) {
+        return false;
+    }
+    return (iSampleCounter.fetch_add(1, std::memory_order_relaxed) % interval) == 0;
+}
+
+void LatencyTracer::Record(const LatencyTrace& aTrace)
+{ // static
+    // Points may be skipped (e.g. a pipeline with no StarvationRamper); charge each hop from the last point reached
+    TUint64 prev = aTrace.Get(LatencyPoint::eProtocol);
+    if (prev == 0) {
+        return;
+    }
+    const TUint64 start = prev;
+    for (TUint i=1; i<LatencyTrace::kNumPoints; i++) {
+        const TUint64 stamp = aTrace.Get((LatencyPoint)i);
+        if (stamp == 0) {
+            continue;
+        }
+        AddToHop(i-1, (stamp >= prev? stamp - prev : 0));
+        prev = stamp;
+    }
+    const TUint64 end = aTrace.Get(LatencyPoint::eAnimator);
+    if (end != 0) {
+        AddToHop(kNumHops-1, (end >= start? end - start : 0));
+    }
+}
+
+void LatencyTracer::Reset()
+{ // static
+    for (TUint i=0; i<kNumHops; i++) {
+        Hop& hop = iHops[i];
+        hop.iCount.store(0);
+        hop.iTotalUs.store(0);
+        hop.iMaxUs.store(0);
+        for (TUint j=0; j<kNumBuckets; j++) {
+            hop.iBuckets[j].store(0);
+        }
+    }
+}
+
+void LatencyTracer::WriteJson(IWriter& aWriter)
+{ // static
+    WriterAscii writer(aWriter);
+    writer.Write(Brn("{\"sampleInterval\":"));
+    writer.WriteUint(iSampleInterval.load());
+    writer.Write(Brn(",\"bucketUpperBoundsUs\":["));
+    for (TUint i=0; i<kNumBuckets-1; i++) {
+        if (i > 0) {
+            writer.Write(',');
+        }
+        writer.WriteUint64(1ULL << i);
+    }
+    writer.Write(Brn(",null],\"hops\":["));
+    for (TUint i=0; i<kNumHops-1; i++) {
+        WriteHopJson(aWriter, i, Name((LatencyPoint)i), Name((LatencyPoint)(i+1)));
+        writer.Write(',');
+    }
+    WriteHopJson(aWriter, kNumHops-1, Name(LatencyPoint::eProtocol), Name(LatencyPoint::eAnimator));
+    writer.Write(Brn("]}"));
+}
+
+void LatencyTracer::WriteHopJson(IWriter& aWriter, TUint aHop, const TChar* aFrom, const TChar* aTo)
+{ // static
+    const Hop& hop = iHops[aHop];
+    const TUint64 count = hop.iCount.load();
+    WriterAscii writer(aWriter);
+    writer.Write(Brn("{\"from\":\""));
+    writer.Write(Brn(aFrom));
+    writer.Write(Brn("\",\"to\":\""));
+    writer.Write(Brn(aTo));
+    writer.Write(Brn("\",\"count\":"));
+    writer.WriteUint64(count);
+    writer.Write(Brn(",\"meanUs\":"));
+    writer.WriteUint64(count == 0? 0 : hop.iTotalUs.load() / count);
+    writer.Write(Brn(",\"maxUs\":"));
+    writer.WriteUint64(hop.iMaxUs.load());
+    writer.Write(Brn(",\"buckets\":["));
+    for (TUint i=0; i<kNumBuckets; i++) {
+        if (i > 0) {
+            writer.Write(',');
+        }
+        writer.WriteUint64(hop.iBuckets[i].load());
+    }
+    writer.Write(Brn("]}"));
+}
+
+const TChar* LatencyTracer::Name(LatencyPoint aPoint)
+{ // static
+    switch (aPoint)
+    {
+    case LatencyPoint::eProtocol:
+        return "protocol";
+    case LatencyPoint::eEncodedReservoir:
+        return "encodedReservoir";
+    case LatencyPoint::eCodec:
+        return "codec";
+    case LatencyPoint::eDecodedReservoir:
+        return "decodedReservoir";
+    case LatencyPoint::eStarvationRamper:
+        return "starvationRamper";
+    case LatencyPoint::ePreDriver:
+        return "preDriver";
+    case LatencyPoint::eAnimator:
+        return "animator";
+    }
+    return "unknown";
+}
+
+TUint64 LatencyTracer::NowUs()
+{ // static
+    return OsTimeInUs(gEnv->OsCtx());
+}
+
+TUint64 LatencyTracer::HopCount(TUint aHop)
+{ // static
+    ASSERT(aHop < kNumHops);
+    return iHops[aHop].iCount.load();
+}
+
+TUint LatencyTracer::BucketIndex(TUint64 aLatencyUs)
+{ // static
+    TUint index = 0;
+    while (aLatencyUs != 0 && index < kNumBuckets-1) {
+        aLatencyUs >>= 1;
+        index++;
+    }
+    return index;
+}
+
+void LatencyTracer::AddToHop(TUint aHop, TUint64 aLatencyUs)
+{ // static
+    Hop& hop = iHops[aHop];
+    hop.iBuckets[BucketIndex(aLatencyUs)].fetch_add(1, std::memory_order_relaxed);
+    hop.iTotalUs.fetch_add(aLatencyUs, std::memory_order_relaxed);
+    TUint64 max = hop.iMaxUs.load(std::memory_order_relaxed);
+    while (aLatencyUs > max && !hop.iMaxUs.compare_exchange_weak(max, aLatencyUs, std::memory_order_relaxed)) {
+    }
+    hop.iCount.fetch_add(1, std::memory_order_relaxed);
+}
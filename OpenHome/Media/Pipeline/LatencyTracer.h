@@ -0,0 +1,97 @@
+#pragma once
+
+#include <OpenHome/Types.h>
+
+#include <atomic>
+
+namespace OpenHome {
+    class IWriter;
+namespace Media {
+
+/**
+ * Points at which a traced audio msg is timestamped, in the order a msg reaches them.
+ */
+enum class LatencyPoint
+{
+    eProtocol,          // encoded audio pushed by a protocol (Supply)
+    eEncodedReservoir,  // pulled from the encoded reservoir
+    eCodec,             // first decoded audio output after a traced encoded msg
+    eDecodedReservoir,  // pulled from the decoded reservoir
+    eStarvationRamper,  // pulled from StarvationRamper
+    ePreDriver,         // converted to MsgPlayable by PreDriver
+    eAnimator           // consumed by the animator
+};
+
+/**
+ * Timestamps (in us) collected by one traced msg.  0 => point not (yet) reached.
+ */
+class LatencyTrace
+{
+public:
+    static const TUint kNumPoints = (TUint)LatencyPoint::eAnimator + 1;
+public:
+    LatencyTrace();
+    void Clear();
+    TBool IsSet() const;
+    void Stamp(LatencyPoint aPoint, TUint64 aTimeUs); // ignored if aPoint has already been stamped
+    TUint64 Get(LatencyPoint aPoint) const;
+private:
+    TUint64 iStamps[kNumPoints];
+};
+
+/**
+ * Process-wide, runtime sampled latency tracing.
+ *
+ * Disabled by default.  When enabled, one encoded msg in every N pushed by a protocol is
+ * traced.  The trace passes to the first decoded msg the codec outputs after it and is
+ * completed when that msg reaches the animator.  The time spent between each pair of
+ * adjacent points is then added to a per-hop histogram.
+ *
+ * All functions are thread safe.  Histograms are updated using atomics only so may be read
+ * while tracing continues; a snapshot may be very slightly inconsistent as a result.
+ */
+class LatencyTracer
+{
+public:
+    static const TUint kNumHops = LatencyTrace::kNumPoints; // one per adjacent pair of points, plus end-to-end
+    static const TUint kNumBuckets = 24; // bucket n holds latencies in [2^(n-1), 2^n) us; the last bucket also holds anything larger
+public:
+    static void Enable(TUint aSampleInterval); // aSampleInterval==0 disables tracing
+    static void Disable();
+    static TUint SampleInterval(); // 0 => disabled
+    static inline TBool TrySample();
+    static void Record(const LatencyTrace& aTrace);
+    static void Reset();
+    static void WriteJson(IWriter& aWriter);
+    static const TChar* Name(LatencyPoint aPoint);
+    static TUint64 NowUs();
+    static TUint64 HopCount(TUint aHop); // for tests
+private:
+    static TBool DoTrySample();
+    static TUint BucketIndex(TUint64 aLatencyUs);
+    static void AddToHop(TUint aHop, TUint64 aLatencyUs);
+    static void WriteHopJson(IWriter& aWriter, TUint aHop, const TChar* aFrom, const TChar* aTo);
+private:
+    class Hop
+    {
+    public:
+        std::atomic<TUint64> iCount;
+        std::atomic<TUint64> iTotalUs;
+        std::atomic<TUint64> iMaxUs;
+        std::atomic<TUint64> iBuckets[kNumBuckets];
+    };
+    static std::atomic<TUint> iSampleInterval;
+    static std::atomic<TUint> iSampleCounter;
+    static Hop iHops[kNumHops];
+};
+
+inline TBool LatencyTracer::TrySample()
+{
+    if (iSampleInterval.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+    return DoTrySample();
+}
+
+} // namespace Media
+} // namespace OpenHome
@@ -17,6 +17,7 @@ Logger::Logger(IPipelineElementUpstream& aUpstreamElement, const TChar* aId)
     , iDownstreamElement(nullptr)
     , iId(aId)
     , iEnabled(false)
+    , iProfiling(false)
     , iFilter(EMsgNone)
     , iShutdownSem("PDSD", 0)
 {
@@ -27,6 +28,7 @@ Logger::Logger(const TChar* aId, IPipelineElementDownstream& aDownstreamElement)
     , iDownstreamElement(&aDownstreamElement)
     , iId(aId)
     , iEnabled(false)
+    , iProfiling(false)
     , iFilter(EMsgNone)
     , iShutdownSem("PDSD", 0)
 {
@@ -49,21 +51,95 @@ void Logger::SetFilter(TUint aMsgTypes)
     iFilter = aMsgTypes;
 }
 
+TBool Logger::Enabled() const
+{
+    return iEnabled;
+}
+
+const TChar* Logger::Id() const
+{
+    return iId;
+}
+
+IPipelineElementUpstream* Logger::Upstream() const
+{
+    return iUpstreamElement;
+}
+
+void Logger::SetProfiling(TBool aEnabled)
+{
+    iProfiling = aEnabled;
+}
+
+TBool Logger::Profiling() const
+{
+    return iProfiling;
+}
+
+ElementProfile& Logger::Profile()
+{
+    return iProfile;
+}
+
 Msg* Logger::Pull()
 {
-    Msg* msg = iUpstreamElement->Pull();
+    Msg* msg;
+    if (!iProfiling) {
+        msg = iUpstreamElement->Pull();
+    }
+    else {
+        const auto start = iProfile.Start();
+        msg = iUpstreamElement->Pull();
+        iProfile.Stop(start);
+        iProfile.Count(*msg);
+    }
     if (iEnabled) {
         (void)msg->Process(*this);
     }
     return msg;
 }
 
+void Logger::PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs)
+{
+    if (!iProfiling && !iEnabled) {
+        iUpstreamElement->PullBatch(aQueue, aMaxMsgs);
+        return;
+    }
+    MsgQueueLite batch;
+    if (!iProfiling) {
+        iUpstreamElement->PullBatch(batch, aMaxMsgs);
+    }
+    else {
+        const auto start = iProfile.Start();
+        iUpstreamElement->PullBatch(batch, aMaxMsgs);
+        iProfile.Stop(start);
+    }
+    while (!batch.IsEmpty()) {
+        Msg* msg = batch.Dequeue();
+        if (iProfiling) {
+            iProfile.Count(*msg);
+        }
+        if (iEnabled) {
+            (void)msg->Process(*this);
+        }
+        aQueue.Enqueue(msg);
+    }
+}
+
 void Logger::Push(Msg* aMsg)
 {
     if (iEnabled) {
         (void)aMsg->Process(*this);
     }
-    iDownstreamElement->Push(aMsg);
+    if (!iProfiling) {
+        iDownstreamElement->Push(aMsg);
+    }
+    else {
+        iProfile.Count(*aMsg); // aMsg may have been consumed by the time Push() returns
+        const auto start = iProfile.Start();
+        iDownstreamElement->Push(aMsg);
+        iProfile.Stop(start);
+    }
 }
 
 inline TBool Logger::IsEnabled(EMsgType aType) const
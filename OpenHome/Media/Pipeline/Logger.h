@@ -3,6 +3,7 @@
 #include <OpenHome/Types.h>
 #include <OpenHome/Private/Standard.h>
 #include <OpenHome/Media/Pipeline/Msg.h>
+#include <OpenHome/Media/Pipeline/ElementProfile.h>
 
 namespace OpenHome {
 namespace Media {
@@ -45,8 +46,15 @@ public:
     virtual ~Logger();
     void SetEnabled(TBool aEnabled);
     void SetFilter(TUint aMsgTypes);
+    TBool Enabled() const;
+    const TChar* Id() const;
+    IPipelineElementUpstream* Upstream() const; // nullptr for loggers that push
+    void SetProfiling(TBool aEnabled);
+    TBool Profiling() const;
+    ElementProfile& Profile();
 public: // from IPipelineElementUpstream
     Msg* Pull() override;
+    void PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs) override;
 public: // from IPipelineElementDownstream
     void Push(Msg* aMsg) override;
 private: // IMsgProcessor
@@ -75,9 +83,11 @@ private:
     IPipelineElementDownstream* iDownstreamElement;
     const TChar* iId;
     TBool iEnabled;
+    TBool iProfiling;
     TInt iFilter;
     Semaphore iShutdownSem;
     Bws<kMaxLogBytes> iBuf;
+    ElementProfile iProfile;
 };
 
 } // namespace Media
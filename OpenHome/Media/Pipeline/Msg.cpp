@@ -2,6 +2,7 @@
 #include <OpenHome/Media/Pipeline/RampArray.h>
 #include <OpenHome/Types.h>
 #include <OpenHome/Buffer.h>
+#include <OpenHome/OsWrapper.h>
 #include <OpenHome/Optional.h>
 #include <OpenHome/Private/Ascii.h>
 #include <OpenHome/Private/InfoProvider.h>
@@ -9,6 +10,8 @@
 #include <OpenHome/Private/Thread.h>
 #include <OpenHome/Private/Arch.h>
 #include <OpenHome/Media/ClockPuller.h>
+#include <OpenHome/Media/Utils/ByteSwapper.h>
+#include <OpenHome/Media/Utils/GainApplicator.h>
 #include <OpenHome/Private/Printer.h>
 #include <OpenHome/Private/Debug.h>
 #include <OpenHome/Media/Debug.h>
@@ -18,6 +21,14 @@
 #include <climits>
 #include <algorithm>
 #include <cstdint>
+#ifdef __linux__
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+# include <arm_neon.h>
+# define RAMP_NEON
+#endif
 
 using namespace OpenHome;
 using namespace OpenHome::Media;
@@ -31,28 +42,44 @@ const Brn AllocatorBase::kQueryMemory = Brn("memory");
 
 AllocatorBase::~AllocatorBase()
 {
-    LOG(kPipeline, "> ~AllocatorBase for %s. (Peak %u/%u)\n", iName, iCellsUsedMax, iFree.Slots());
-    const TUint slots = iFree.Slots();
+    LOG(kPipeline, "> ~AllocatorBase for %s. (Peak %u/%u)\n", iName, iCellsUsedMax.load(), iCellsTotal);
+    const TUint slots = iCellsAdded;
     for (TUint i=0; i<slots; i++) {
         //Log::Print("  %u", i);
         try {
             Allocated* ptr = Read();
             //Log::Print("(%p)", ptr);
-            delete ptr;
+            if (iSlab == nullptr) {
+                delete ptr;
+            }
+            else {
+                ptr->~Allocated();
+            }
         }
         catch (AssertionFailed&) {
             Log::Print("...leak at %u of %u\n", i+1, slots);
             throw;
         }
     }
+    delete[] iCells;
+    delete[] iNextFree;
+    DestroySlab();
     LOG(kPipeline, "< ~AllocatorBase for %s\n", iName);
 }
 
 void AllocatorBase::Free(Allocated* aPtr)
 {
+    if (iImpl == Impl::eLockFree) {
+        iCellsUsed--;
+        WriteLockFree(aPtr);
+        return;
+    }
     iLock.Wait();
     iCellsUsed--;
     iFree.Write(aPtr);
+    if (iWaiters > 0) {
+        iSemFree.Signal();
+    }
     iLock.Signal();
 }
 
@@ -61,6 +88,11 @@ TUint AllocatorBase::CellsTotal() const
     return iCellsTotal;
 }
 
+TUint AllocatorBase::CellsCreated() const
+{
+    return iCellsAdded;
+}
+
 TUint AllocatorBase::CellBytes() const
 {
     return iCellBytes;
@@ -68,60 +100,229 @@ TUint AllocatorBase::CellBytes() const
 
 TUint AllocatorBase::CellsUsed() const
 {
-    iLock.Wait();
-    TUint cellsUsed = iCellsUsed;
-    iLock.Signal();
-    return cellsUsed;
+    return iCellsUsed;
 }
 
 TUint AllocatorBase::CellsUsedMax() const
 {
-    iLock.Wait();
-    TUint cellsUsedMax = iCellsUsedMax;
-    iLock.Signal();
-    return cellsUsedMax;
+    return iCellsUsedMax;
 }
 
 void AllocatorBase::GetStats(TUint& aCellsTotal, TUint& aCellBytes, TUint& aCellsUsed, TUint& aCellsUsedMax) const
 {
     aCellsTotal = iCellsTotal;
     aCellBytes = iCellBytes;
-    iLock.Wait();
     aCellsUsed = iCellsUsed;
     aCellsUsedMax = iCellsUsedMax;
-    iLock.Signal();
 }
 
-AllocatorBase::AllocatorBase(const TChar* aName, TUint aNumCells, TUint aCellBytes, IInfoAggregator& aInfoAggregator)
+AllocatorBase::AllocatorBase(const TChar* aName, TUint aNumCells, TUint aCellBytes, IInfoAggregator& aInfoAggregator,
+                             Impl aImpl, Storage aStorage, const AllocatorGrowth& aGrowth)
     : iFree(aNumCells)
     , iLock("PAL1")
     , iName(aName)
     , iCellsTotal(aNumCells)
     , iCellBytes(aCellBytes)
+    , iImpl(aImpl)
+    , iStorage(aStorage)
+    , iSlab(nullptr)
+    , iSlabAlloc(nullptr)
+    , iSlabBytes(0)
+    , iSlabStride(0)
+    , iSlabMapped(false)
+    , iSlabLocked(false)
+    , iCellsAdded(0)
+    , iChunkCells(0)
+    , iShrinkAfterMs(aGrowth.ShrinkAfterMs())
+    , iFullTimeoutMs(aGrowth.FullTimeoutMs())
+    , iWindowStartMs(0)
+    , iWindowPeak(0)
+    , iGrowCount(0)
+    , iShrinkCount(0)
+    , iWaiters(0)
+    , iSemFree("PAL2", 0)
+    , iCells(nullptr)
+    , iNextFree(nullptr)
+    , iHead(kIndexNone)
     , iCellsUsed(0)
     , iCellsUsedMax(0)
 {
+    ASSERT(iCellsUsed.is_lock_free());
+    ASSERT(iCellsUsedMax.is_lock_free());
+    if (aGrowth.Elastic()) {
+        const TUint chunkCells = (aNumCells + aGrowth.Chunks() - 1) / aGrowth.Chunks();
+        if (chunkCells < aNumCells) {
+            // cells are created and deleted as the pool grows and shrinks so can't live in a slab or lock-free stack
+            ASSERT_VA(iImpl == Impl::eLocking && iStorage == Storage::eHeap,
+                      "Allocator %s: elastic pools must be eLocking and eHeap\n", iName);
+            iChunkCells = chunkCells;
+            iWindowStartMs = NowMs();
+        }
+    }
+    if (iImpl == Impl::eLockFree) {
+        if (!iHead.is_lock_free()) {
+            Log::Print("Allocator %s: 64-bit atomics are not lock-free on this platform.  Using locking allocator\n", iName);
+            iImpl = Impl::eLocking;
+        }
+        else {
+            iCells = new Allocated*[aNumCells];
+            iNextFree = new std::atomic<TUint32>[aNumCells];
+        }
+    }
+    if (iStorage != Storage::eHeap) {
+        CreateSlab();
+    }
     std::vector<Brn> infoQueries;
     infoQueries.push_back(kQueryMemory);
     aInfoAggregator.Register(*this, infoQueries);
 }
 
+TUint AllocatorBase::InitialCells() const
+{
+    return (iChunkCells == 0? iCellsTotal : iChunkCells);
+}
+
+void* AllocatorBase::SlabCell(TUint aIndex) const
+{
+    if (iSlab == nullptr) {
+        return nullptr;
+    }
+    ASSERT(aIndex < iCellsTotal);
+    return iSlab + (aIndex * iSlabStride);
+}
+
+void AllocatorBase::CreateSlab()
+{
+    iSlabStride = ((iCellBytes + kCacheLineBytes - 1) / kCacheLineBytes) * kCacheLineBytes;
+    const TUint cellBytes = iSlabStride * iCellsTotal;
+    if (iStorage == Storage::eSlabLocked) {
+#ifdef __linux__
+        /* Only ask for huge pages when the slab fills at least one.  Smaller pools would
+           otherwise waste most of a 2MB page each. */
+        static const TUint kHugePageBytes = 2 * 1024 * 1024;
+        const TUint pageBytes = (TUint)sysconf(_SC_PAGESIZE);
+        const TBool huge = (cellBytes >= kHugePageBytes);
+        const TUint roundTo = (huge? kHugePageBytes : pageBytes);
+        iSlabBytes = ((cellBytes + roundTo - 1) / roundTo) * roundTo;
+        void* p = MAP_FAILED;
+# ifdef MAP_HUGETLB
+        if (huge) {
+            p = mmap(nullptr, iSlabBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        }
+# endif
+        if (p == MAP_FAILED) {
+            // no reserved huge pages; fall back to normal pages, hinting that they can be merged into transparent huge pages
+            p = mmap(nullptr, iSlabBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p != MAP_FAILED) {
+# ifdef MADV_HUGEPAGE
+                if (huge) {
+                    (void)madvise(p, iSlabBytes, MADV_HUGEPAGE);
+                }
+# endif
+            }
+        }
+        if (p != MAP_FAILED) {
+            iSlabAlloc = p;
+            iSlab = static_cast<TByte*>(p);
+            iSlabMapped = true;
+            if (mlock(p, iSlabBytes) == 0) {
+                iSlabLocked = true;
+            }
+            else {
+                Log::Print("Allocator %s: unable to lock %u bytes into memory\n", iName, iSlabBytes);
+            }
+            return;
+        }
+        Log::Print("Allocator %s: unable to map %u bytes.  Using unlocked slab\n", iName, iSlabBytes);
+#else
+        Log::Print("Allocator %s: locked slabs not supported on this platform.  Using unlocked slab\n", iName);
+#endif
+        iStorage = Storage::eSlab;
+    }
+    iSlabBytes = cellBytes + kCacheLineBytes - 1;
+    TByte* p = new TByte[iSlabBytes];
+    iSlabAlloc = p;
+    const uintptr_t aligned = ((uintptr_t)p + kCacheLineBytes - 1) & ~((uintptr_t)kCacheLineBytes - 1);
+    iSlab = reinterpret_cast<TByte*>(aligned);
+}
+
+void AllocatorBase::DestroySlab()
+{
+    if (iSlabAlloc == nullptr) {
+        return;
+    }
+    if (iSlabMapped) {
+#ifdef __linux__
+        if (iSlabLocked) {
+            (void)munlock(iSlabAlloc, iSlabBytes);
+        }
+        (void)munmap(iSlabAlloc, iSlabBytes);
+#endif
+    }
+    else {
+        delete[] static_cast<TByte*>(iSlabAlloc);
+    }
+    iSlabAlloc = nullptr;
+    iSlab = nullptr;
+}
+
+void AllocatorBase::Add(Allocated* aCell)
+{ // called during construction or, for elastic pools, with iLock held
+    ASSERT(iCellsAdded < iCellsTotal);
+    aCell->iAllocatorIndex = iCellsAdded++;
+    if (iImpl == Impl::eLockFree) {
+        iCells[aCell->iAllocatorIndex] = aCell;
+        WriteLockFree(aCell);
+    }
+    else {
+        iFree.Write(aCell);
+    }
+}
+
 Allocated* AllocatorBase::DoAllocate()
 {
-    iLock.Wait();
-    Allocated* cell = Read();
-    ASSERT_VA(cell->iRefCount == 0, "%s has count %u\n", iName, cell->iRefCount.load());
-    cell->iRefCount = 1;
-    iCellsUsed++;
-    if (iCellsUsed > iCellsUsedMax) {
-        iCellsUsedMax = iCellsUsed;
+    if (iImpl == Impl::eLockFree) {
+        return Claim(ReadLockFree());
+    }
+    AutoMutex _(iLock);
+    return AllocateLocked();
+}
+
+Allocated* AllocatorBase::TryDoAllocate()
+{
+    if (iImpl == Impl::eLockFree) {
+        Allocated* cell = TryReadLockFree();
+        return (cell == nullptr? nullptr : Claim(cell));
+    }
+    AutoMutex _(iLock);
+    if (iFree.SlotsUsed() == 0 && iCellsAdded == iCellsTotal) {
+        return nullptr;
+    }
+    return AllocateLocked();
+}
+
+Allocated* AllocatorBase::AllocateLocked()
+{ // called with iLock held
+    Allocated* cell = Claim(iChunkCells == 0? Read() : ReadElastic());
+    if (iChunkCells != 0) {
+        CheckShrink();
     }
-    iLock.Signal();
     return cell;
 }
 
+Allocated* AllocatorBase::Claim(Allocated* aCell)
+{
+    ASSERT_VA(aCell->iRefCount == 0, "%s has count %u\n", iName, aCell->iRefCount.load());
+    aCell->iRefCount = 1;
+    CellAllocated();
+    return aCell;
+}
+
 Allocated* AllocatorBase::Read()
 {
+    if (iImpl == Impl::eLockFree) {
+        return ReadLockFree();
+    }
     Allocated* p = nullptr;
     try {
         p = iFree.Read();
@@ -133,10 +334,132 @@ Allocated* AllocatorBase::Read()
     return p;
 }
 
+Allocated* AllocatorBase::ReadElastic()
+{ // called with iLock held.  Releases and reacquires it while waiting for a full pool to have a cell freed
+    for (;;) {
+        if (iFree.SlotsUsed() > 0) {
+            return iFree.Read();
+        }
+        if (iCellsAdded < iCellsTotal) {
+            Grow();
+            continue;
+        }
+        iWaiters++;
+        iLock.Signal();
+        try {
+            if (iFullTimeoutMs == 0) {
+                iSemFree.Wait();
+            }
+            else {
+                iSemFree.Wait(iFullTimeoutMs);
+            }
+        }
+        catch (Timeout&) {
+            iLock.Wait(); // caller releases iLock
+            iWaiters--;
+            Log::Print("Warning: Allocator %s exhausted (%u cells)\n", iName, iCellsTotal);
+            THROW(AllocatorNoMemory);
+        }
+        iLock.Wait();
+        iWaiters--;
+    }
+}
+
+void AllocatorBase::Grow()
+{ // called with iLock held
+    const TUint cells = std::min(iChunkCells, iCellsTotal - iCellsAdded);
+    for (TUint i=0; i<cells; i++) {
+        Add(NewCell());
+    }
+    iGrowCount++;
+    LOG(kPipeline, "Allocator %s grown to %u cells\n", iName, iCellsAdded);
+}
+
+void AllocatorBase::CheckShrink()
+{ // called with iLock held
+    if (iCellsUsed > iWindowPeak) {
+        iWindowPeak = iCellsUsed;
+    }
+    if (iShrinkAfterMs == 0) {
+        return;
+    }
+    const TUint now = NowMs();
+    if (now - iWindowStartMs < iShrinkAfterMs) {
+        return;
+    }
+    /* Usage hasn't exceeded iWindowPeak for iShrinkAfterMs.
+       Release one chunk if that still leaves at least a chunk's worth of headroom. */
+    if (iCellsAdded >= 2 * iChunkCells && iCellsAdded - iWindowPeak > iChunkCells) {
+        for (TUint i=0; i<iChunkCells; i++) {
+            Allocated* cell = iFree.Read();
+            delete cell;
+        }
+        iCellsAdded -= iChunkCells;
+        iShrinkCount++;
+        LOG(kPipeline, "Allocator %s shrunk to %u cells\n", iName, iCellsAdded);
+    }
+    iWindowStartMs = now;
+    iWindowPeak = iCellsUsed;
+}
+
+TUint AllocatorBase::NowMs()
+{ // static
+    return Os::TimeInMs(gEnv->OsCtx());
+}
+
+Allocated* AllocatorBase::ReadLockFree()
+{
+    Allocated* cell = TryReadLockFree();
+    if (cell == nullptr) {
+        Log::Print("Warning: Allocator error for %s\n", iName);
+        ASSERTS();
+    }
+    return cell;
+}
+
+Allocated* AllocatorBase::TryReadLockFree()
+{
+    /* Treiber stack of cell indices.  The tag in the upper 32 bits of iHead is bumped
+       on every update so a stale head (ABA) fails its compare-exchange. */
+    TUint64 head = iHead.load(std::memory_order_acquire);
+    for (;;) {
+        const TUint32 index = static_cast<TUint32>(head);
+        if (index == kIndexNone) {
+            return nullptr;
+        }
+        const TUint32 next = iNextFree[index].load(std::memory_order_relaxed);
+        const TUint64 newHead = ((head & kTagMask) + kTagIncrement) | next;
+        if (iHead.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire)) {
+            return iCells[index];
+        }
+    }
+}
+
+void AllocatorBase::WriteLockFree(Allocated* aCell)
+{
+    const TUint32 index = aCell->iAllocatorIndex;
+    TUint64 head = iHead.load(std::memory_order_relaxed);
+    for (;;) {
+        iNextFree[index].store(static_cast<TUint32>(head), std::memory_order_relaxed);
+        const TUint64 newHead = ((head & kTagMask) + kTagIncrement) | index;
+        if (iHead.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed)) {
+            return;
+        }
+    }
+}
+
+void AllocatorBase::CellAllocated()
+{
+    const TUint cellsUsed = ++iCellsUsed;
+    TUint cellsUsedMax = iCellsUsedMax.load(std::memory_order_relaxed);
+    while (cellsUsed > cellsUsedMax &&
+           !iCellsUsedMax.compare_exchange_weak(cellsUsedMax, cellsUsed, std::memory_order_relaxed)) {
+    }
+}
+
 void AllocatorBase::QueryInfo(const Brx& aQuery, IWriter& aWriter)
 {
-    // Note that value of iCellsUsed may be slightly out of date as Allocator doesn't hold any lock while updating its fifo and iCellsUsed
-    AutoMutex a(iLock);
+    // Note that value of iCellsUsed may be slightly out of date as Allocator doesn't hold any lock while updating its free list and iCellsUsed
     if (aQuery == kQueryMemory) {
         WriterAscii writer(aWriter);
         writer.Write(Brn("Allocator: "));
@@ -149,7 +472,23 @@ void AllocatorBase::QueryInfo(const Brx& aQuery, IWriter& aWriter)
         writer.WriteUint(iCellsUsed);
         writer.Write(Brn(" cells, peak:"));
         writer.WriteUint(iCellsUsedMax);
-        aWriter.Write(Brn(" cells\n"));
+        writer.Write(Brn(" cells"));
+        if (iChunkCells != 0) {
+            writer.Write(Brn(", created:"));
+            writer.WriteUint(iCellsAdded);
+            writer.Write(Brn(" cells (grown "));
+            writer.WriteUint(iGrowCount);
+            writer.Write(Brn(", shrunk "));
+            writer.WriteUint(iShrinkCount);
+            writer.Write(Brn(" times)"));
+        }
+        if (iImpl == Impl::eLockFree) {
+            writer.Write(Brn(" (lock-free)"));
+        }
+        if (iSlab != nullptr) {
+            writer.Write(iSlabLocked? Brn(" (slab, locked)") : Brn(" (slab)"));
+        }
+        aWriter.Write(Brn("\n"));
     }
 }
 
@@ -178,6 +517,7 @@ void Allocated::Clear()
 Allocated::Allocated(AllocatorBase& aAllocator)
     : iAllocator(aAllocator)
     , iRefCount(0)
+    , iAllocatorIndex(0)
 {
     ASSERT(iRefCount.is_lock_free());
 }
@@ -189,14 +529,11 @@ Allocated::~Allocated()
 
 // AudioData
 
-AudioData::AudioData(AllocatorBase& aAllocator)
+AudioData::AudioData(AllocatorBase& aAllocator, TByte* aStorage, TUint aMaxBytes)
     : Allocated(aAllocator)
+    , iData(aStorage, 0, aMaxBytes)
+    , iLatencyTraced(false)
 {
-#ifdef TIMESTAMP_LOGGING_ENABLE
-    iOsCtx = gEnv->OsCtx();
-    iNextTimestampIndex = 0;
-    (void)memset(iTimestamps, 0, sizeof iTimestamps);
-#endif
 }
 
 const TByte* AudioData::Ptr(TUint aBytes) const
@@ -210,79 +547,57 @@ TUint AudioData::Bytes() const
     return iData.Bytes();
 }
 
-#ifdef TIMESTAMP_LOGGING_ENABLE
-void AudioData::SetTimestamp(const TChar* aId)
+TUint AudioData::MaxBytes() const
 {
-    if (iNextTimestampIndex < kMaxTimestamps-1) {
-        const TUint64 ts = OsTimeInUs(iOsCtx);
-        iTimestamps[iNextTimestampIndex++].Set(aId, ts);
-    }
+    return iData.MaxBytes();
 }
 
-TBool AudioData::TryLogTimestamps()
+void AudioData::StartLatencyTrace()
 {
-    if (iNextTimestampIndex == 0) {
-        return false;
-    }
-    Log::Print("Timestamps:\n");
-    for (TUint i=0; i<iNextTimestampIndex; i++) {
-        (void)iTimestamps[i].TryLog();
-    }
-    return true;
+    iLatencyTrace.Clear();
+    iLatencyTrace.Stamp(LatencyPoint::eProtocol, LatencyTracer::NowUs());
+    iLatencyTraced = true;
 }
-#endif // TIMESTAMP_LOGGING_ENABLE
 
-void AudioData::Clear()
+void AudioData::SetLatencyTrace(const LatencyTrace& aTrace)
 {
-#ifdef DEFINE_DEBUG
-    // fill in all members with recognisable 'bad' values to make ref counting bugs more obvious
-    memset(const_cast<TByte*>(iData.Ptr()), 0xde, iData.Bytes());
-#endif // DEFINE_DEBUG
-    iData.SetBytes(0);
-#ifdef TIMESTAMP_LOGGING_ENABLE
-    for (TUint i=0; i<iNextTimestampIndex; i++) {
-        iTimestamps[i].Reset();
-    }
-    iNextTimestampIndex = 0;
-#endif
+    iLatencyTrace = aTrace;
+    iLatencyTraced = true;
 }
 
-#ifdef TIMESTAMP_LOGGING_ENABLE
-AudioData::Timestamp::Timestamp()
+const LatencyTrace& AudioData::GetLatencyTrace() const
 {
-    Reset();
+    return iLatencyTrace;
 }
 
-void AudioData::Timestamp::Reset()
+void AudioData::AddLatencyStamp(LatencyPoint aPoint)
 {
-    iId = nullptr;
-    iTimestamp = 0;
+    /* All msgs split from (or cloned from) the traced one share this AudioData.
+       The first to reach each point stamps it; the first to reach the animator completes the trace. */
+    if (!iLatencyTraced) {
+        return;
+    }
+    iLatencyTrace.Stamp(aPoint, LatencyTracer::NowUs());
+    if (aPoint == LatencyPoint::eAnimator) {
+        iLatencyTraced = false;
+        LatencyTracer::Record(iLatencyTrace);
+    }
 }
 
-void AudioData::Timestamp::Set(const TChar* aId, TUint64 aTimestamp)
+void AudioData::Clear()
 {
-    iId = aId;
-    iTimestamp = aTimestamp;
+#ifdef DEFINE_DEBUG
+    // fill in all members with recognisable 'bad' values to make ref counting bugs more obvious
+    memset(const_cast<TByte*>(iData.Ptr()), 0xde, iData.Bytes());
+#endif // DEFINE_DEBUG
+    iData.SetBytes(0);
+    iLatencyTraced = false;
 }
 
-TBool AudioData::Timestamp::TryLog()
-{
-    if (iId == nullptr) {
-        return false;
-    }
-    Log::Print("\t%s: \t%llu\n", iId, iTimestamp);
-    return true;
-}
-#endif
 
 
 // EncodedAudio
 
-EncodedAudio::EncodedAudio(AllocatorBase& aAllocator)
-    : AudioData(aAllocator)
-{
-}
-
 TUint EncodedAudio::Append(const Brx& aData)
 {
     const TUint avail = iData.MaxBytes() - iData.Bytes();
@@ -303,19 +618,16 @@ void EncodedAudio::Construct(const Brx& aData)
 
 // DecodedAudio
 
-DecodedAudio::DecodedAudio(AllocatorBase& aAllocator)
-    : AudioData(aAllocator)
-{
-}
-
 void DecodedAudio::Aggregate(DecodedAudio& aDecodedAudio)
 {
+    ASSERT(iData.Bytes() + aDecodedAudio.iData.Bytes() <= iData.MaxBytes());
     iData.Append(aDecodedAudio.iData);
 }
 
 void DecodedAudio::Construct(const Brx& aData, TUint aBitDepth, AudioDataEndian aEndian)
 {
     ASSERT((aBitDepth & 7) == 0);
+    ASSERT(aData.Bytes() <= iData.MaxBytes());
     ASSERT(aData.Bytes() % (aBitDepth/8) == 0);
     TByte* ptr = const_cast<TByte*>(iData.Ptr());
     if (aEndian == AudioDataEndian::Big || aBitDepth == 8) {
@@ -336,34 +648,189 @@ void DecodedAudio::Construct(const Brx& aData, TUint aBitDepth, AudioDataEndian
     iData.SetBytes(aData.Bytes());
 }
 
-void DecodedAudio::CopyToBigEndian16(const Brx& aData, TByte* aDest)
+void DecodedAudio::ConstructNative32(const Brx& aData, TUint aBitDepth, AudioDataEndian aEndian)
+{
+    ASSERT((aBitDepth & 7) == 0);
+    ASSERT(aData.Bytes() % (aBitDepth/8) == 0);
+    const TUint bytes = (aData.Bytes() / (aBitDepth/8)) * kNativeBytesPerSubsample;
+    ASSERT(bytes <= iData.MaxBytes());
+    ToNative32(aData, aBitDepth, aEndian, reinterpret_cast<TInt32*>(const_cast<TByte*>(iData.Ptr())));
+    iData.SetBytes(bytes);
+}
+
+TUint DecodedAudio::BytesPerSubsample(TUint aBitDepth, DecodedAudioFormat aFormat)
 { // static
-    const TByte* src = aData.Ptr();
-    for (TUint i=0; i<aData.Bytes(); i+=2) {
-        *aDest++ = src[i+1];
-        *aDest++ = src[i];
+    if (aFormat == DecodedAudioFormat::NativeInt32) {
+        return kNativeBytesPerSubsample;
     }
+    return aBitDepth / 8;
 }
 
-void DecodedAudio::CopyToBigEndian24(const Brx& aData, TByte* aDest)
+void DecodedAudio::ToNative32(const Brx& aData, TUint aBitDepth, AudioDataEndian aEndian, TInt32* aDest)
 { // static
     const TByte* src = aData.Ptr();
-    for (TUint i=0; i<aData.Bytes(); i+=3) {
-        *aDest++ = src[i+2];
-        *aDest++ = src[i+1];
-        *aDest++ = src[i];
+    const TUint bytes = aData.Bytes();
+    const TBool big = (aEndian == AudioDataEndian::Big);
+    TUint32* dest = reinterpret_cast<TUint32*>(aDest);
+    switch (aBitDepth)
+    {
+    case 8:
+        for (TUint i=0; i<bytes; i++) {
+            *dest++ = (TUint32)src[i] << 24;
+        }
+        break;
+    case 16:
+        if (big) {
+            for (TUint i=0; i<bytes; i+=2) {
+                *dest++ = ((TUint32)src[i] << 24) | ((TUint32)src[i+1] << 16);
+            }
+        }
+        else {
+            for (TUint i=0; i<bytes; i+=2) {
+                *dest++ = ((TUint32)src[i+1] << 24) | ((TUint32)src[i] << 16);
+            }
+        }
+        break;
+    case 24:
+        if (big) {
+            for (TUint i=0; i<bytes; i+=3) {
+                *dest++ = ((TUint32)src[i] << 24) | ((TUint32)src[i+1] << 16) | ((TUint32)src[i+2] << 8);
+            }
+        }
+        else {
+            for (TUint i=0; i<bytes; i+=3) {
+                *dest++ = ((TUint32)src[i+2] << 24) | ((TUint32)src[i+1] << 16) | ((TUint32)src[i] << 8);
+            }
+        }
+        break;
+    case 32:
+#ifdef DEFINE_BIG_ENDIAN
+        if (big) {
+#else
+        if (!big) {
+#endif
+            (void)memcpy(dest, src, bytes);
+        }
+        else {
+            // reversing bytes converts between big and little endian in either direction
+            ByteSwapper::CopyToBigEndian32(src, reinterpret_cast<TByte*>(dest), bytes);
+        }
+        break;
+    default: // unsupported bit depth
+        ASSERTS();
     }
 }
 
+void DecodedAudio::FromNative32(const TInt32* aSrc, TUint aNumSubsamples, TUint aBitDepth, TByte* aDest)
+{ // static
+    const TUint32* src = reinterpret_cast<const TUint32*>(aSrc);
+    switch (aBitDepth)
+    {
+    case 8:
+        for (TUint i=0; i<aNumSubsamples; i++) {
+            *aDest++ = (TByte)(src[i] >> 24);
+        }
+        break;
+    case 16:
+        for (TUint i=0; i<aNumSubsamples; i++) {
+            *aDest++ = (TByte)(src[i] >> 24);
+            *aDest++ = (TByte)(src[i] >> 16);
+        }
+        break;
+    case 24:
+        for (TUint i=0; i<aNumSubsamples; i++) {
+            *aDest++ = (TByte)(src[i] >> 24);
+            *aDest++ = (TByte)(src[i] >> 16);
+            *aDest++ = (TByte)(src[i] >> 8);
+        }
+        break;
+    case 32:
+#ifdef DEFINE_BIG_ENDIAN
+        (void)memcpy(aDest, src, aNumSubsamples * kNativeBytesPerSubsample);
+#else
+        ByteSwapper::CopyToBigEndian32(reinterpret_cast<const TByte*>(src), aDest, aNumSubsamples * kNativeBytesPerSubsample);
+#endif
+        break;
+    default: // unsupported bit depth
+        ASSERTS();
+    }
+}
+
+void DecodedAudio::CopyToBigEndian16(const Brx& aData, TByte* aDest)
+{ // static
+    ByteSwapper::CopyToBigEndian16(aData.Ptr(), aDest, aData.Bytes());
+}
+
+void DecodedAudio::CopyToBigEndian24(const Brx& aData, TByte* aDest)
+{ // static
+    ByteSwapper::CopyToBigEndian24(aData.Ptr(), aDest, aData.Bytes());
+}
+
 void DecodedAudio::CopyToBigEndian32(const Brx& aData, TByte* aDest)
 { // static
-    const TByte* src = aData.Ptr();
-    for (TUint i=0; i<aData.Bytes(); i+=4) {
-        *aDest++ = src[i+3];
-        *aDest++ = src[i+2];
-        *aDest++ = src[i+1];
-        *aDest++ = src[i];
+    ByteSwapper::CopyToBigEndian32(aData.Ptr(), aDest, aData.Bytes());
+}
+
+
+// AudioDataAllocator
+
+AudioDataAllocator::AudioDataAllocator(IInfoAggregator& aInfoAggregator, TUint aNumCells, TBool aSizeClasses,
+                                       AllocatorBase::Impl aImpl, AllocatorBase::Storage aStorage, const AllocatorGrowth& aGrowth)
+    : iAllocator1k(nullptr)
+    , iAllocator2k(nullptr)
+    , iAllocator4k(nullptr)
+    , iAllocatorMax("AudioData", aNumCells, aInfoAggregator, aImpl, aStorage, aSizeClasses? SizeClassGrowth(aImpl, aStorage, aGrowth) : aGrowth)
+{
+    if (aSizeClasses) {
+        // smaller classes split the cell count; AllocateDecoded falls through to iAllocatorMax if they fill
+        const AllocatorGrowth growth = SizeClassGrowth(aImpl, aStorage, aGrowth);
+        const TUint cells = std::max(aNumCells / kNumSizeClasses, 1u);
+        iAllocator1k = new Allocator<AudioDataSized<kSizeClass1k>>("AudioData1k", cells, aInfoAggregator, aImpl, aStorage, growth);
+        iAllocator2k = new Allocator<AudioDataSized<kSizeClass2k>>("AudioData2k", cells, aInfoAggregator, aImpl, aStorage, growth);
+        iAllocator4k = new Allocator<AudioDataSized<kSizeClass4k>>("AudioData4k", cells, aInfoAggregator, aImpl, aStorage, growth);
+    }
+}
+
+AudioDataAllocator::~AudioDataAllocator()
+{
+    delete iAllocator1k;
+    delete iAllocator2k;
+    delete iAllocator4k;
+}
+
+EncodedAudio* AudioDataAllocator::AllocateEncoded()
+{
+    AudioData* audioData = iAllocatorMax.Allocate();
+    return static_cast<EncodedAudio*>(audioData);
+}
+
+DecodedAudio* AudioDataAllocator::AllocateDecoded(TUint aBytes)
+{
+    ASSERT(aBytes <= AudioData::kMaxBytes);
+    AudioData* audioData = nullptr;
+    if (iAllocator1k != nullptr && aBytes <= kSizeClass1k) {
+        audioData = iAllocator1k->TryAllocate();
+    }
+    if (audioData == nullptr && iAllocator2k != nullptr && aBytes <= kSizeClass2k) {
+        audioData = iAllocator2k->TryAllocate();
+    }
+    if (audioData == nullptr && iAllocator4k != nullptr && aBytes <= kSizeClass4k) {
+        audioData = iAllocator4k->TryAllocate();
+    }
+    if (audioData == nullptr) {
+        audioData = iAllocatorMax.Allocate();
+    }
+    return static_cast<DecodedAudio*>(audioData);
+}
+
+AllocatorGrowth AudioDataAllocator::SizeClassGrowth(AllocatorBase::Impl aImpl, AllocatorBase::Storage aStorage, const AllocatorGrowth& aGrowth)
+{ // static
+    /* fixed size pools for every class would use more memory than a single kMaxBytes pool
+       but lock-free and slab pools can't grow so are left as the caller asked */
+    if (aGrowth.Elastic() || aImpl != AllocatorBase::Impl::eLocking || aStorage != AllocatorBase::Storage::eHeap) {
+        return aGrowth;
     }
+    return AllocatorGrowth(kSizeClassChunks, kSizeClassShrinkAfterMs, kSizeClassFullTimeoutMs);
 }
 
 
@@ -662,6 +1129,25 @@ void Ramp::SelectLowerRampPoints(TUint aRequestedStart, TUint aRequestedEnd)
     }
 }
 
+void Ramp::Join(const Ramp& aFollowing)
+{
+    /* Set() only splits a ramp where two ramps intersect; the lower of the two rises to the
+       intersection then the other falls away from it.  A line from the start of this ramp to
+       the end of aFollowing is never above either. */
+    ASSERT(iEnd == aFollowing.iStart);
+    iEnd = aFollowing.iEnd;
+    if (iStart == iEnd) {
+        iDirection = ENone;
+    }
+    else if (iStart > iEnd) {
+        iDirection = EDown;
+    }
+    else {
+        iDirection = EUp;
+    }
+    Validate("Join");
+}
+
 void Ramp::Validate(const TChar* aId)
 {
     if (!DoValidate()) {
@@ -738,6 +1224,124 @@ Ramp Ramp::Split(TUint aNewSize, TUint aCurrentSize)
 
 // RampApplicator
 
+// Kernels apply a per-sample gain (fixed point, RampApplicator::kGainShift fractional bits)
+// to every subsample.  Packed kernels read and write big endian subsamples of kBytes;
+// a kChannels of 0 means the channel count is only known at run time.
+
+typedef void (*RampKernel)(const TByte* aSrc, TByte* aDest, const TInt32* aGains, TUint aNumSamples, TUint aNumChannels);
+
+template <TUint kBytes> static inline TInt32 ReadSubsample(const TByte* aPtr);
+template <> inline TInt32 ReadSubsample<1>(const TByte* aPtr)
+{
+    return (TInt8)aPtr[0];
+}
+template <> inline TInt32 ReadSubsample<2>(const TByte* aPtr)
+{
+    return (TInt16)((aPtr[0] << 8) | aPtr[1]);
+}
+template <> inline TInt32 ReadSubsample<3>(const TByte* aPtr)
+{
+    return ((TInt32)(((TUint)aPtr[0] << 24) | ((TUint)aPtr[1] << 16) | ((TUint)aPtr[2] << 8))) >> 8;
+}
+template <> inline TInt32 ReadSubsample<4>(const TByte* aPtr)
+{
+    return (TInt32)(((TUint)aPtr[0] << 24) | ((TUint)aPtr[1] << 16) | ((TUint)aPtr[2] << 8) | (TUint)aPtr[3]);
+}
+
+template <TUint kBytes> static inline void WriteSubsample(TByte* aPtr, TInt32 aSubsample)
+{
+    for (TUint i=0; i<kBytes; i++) {
+        aPtr[i] = (TByte)(aSubsample >> (8 * (kBytes - 1 - i)));
+    }
+}
+
+template <TUint kBytes, TUint kChannels>
+static void RampPacked(const TByte* aSrc, TByte* aDest, const TInt32* aGains, TUint aNumSamples, TUint aNumChannels)
+{
+    const TUint numChannels = (kChannels == 0? aNumChannels : kChannels);
+    for (TUint i=0; i<aNumSamples; i++) {
+        const TInt64 gain = aGains[i];
+        for (TUint j=0; j<numChannels; j++) {
+            const TInt64 subsample = ReadSubsample<kBytes>(aSrc);
+            WriteSubsample<kBytes>(aDest, (TInt32)((subsample * gain) >> RampApplicator::kGainShift));
+            aSrc += kBytes;
+            aDest += kBytes;
+        }
+    }
+}
+
+template <TUint kChannels>
+static void RampNative32(const TByte* aSrc, TByte* aDest, const TInt32* aGains, TUint aNumSamples, TUint aNumChannels)
+{
+    const TUint numChannels = (kChannels == 0? aNumChannels : kChannels);
+    const TInt32* src = reinterpret_cast<const TInt32*>(aSrc);
+    TInt32* dest = reinterpret_cast<TInt32*>(aDest);
+    for (TUint i=0; i<aNumSamples; i++) {
+        const TInt64 gain = aGains[i];
+        for (TUint j=0; j<numChannels; j++) {
+            dest[j] = (TInt32)((src[j] * gain) >> RampApplicator::kGainShift);
+        }
+        src += numChannels;
+        dest += numChannels;
+    }
+}
+
+#ifdef RAMP_NEON
+template <>
+void RampNative32<1>(const TByte* aSrc, TByte* aDest, const TInt32* aGains, TUint aNumSamples, TUint /*aNumChannels*/)
+{
+    const TInt32* src = reinterpret_cast<const TInt32*>(aSrc);
+    TInt32* dest = reinterpret_cast<TInt32*>(aDest);
+    TUint i = 0;
+    for (; i+4<=aNumSamples; i+=4) {
+        const int32x4_t s = vld1q_s32(src + i);
+        const int32x4_t g = vld1q_s32(aGains + i);
+        const int64x2_t lo = vmull_s32(vget_low_s32(s), vget_low_s32(g));
+        const int64x2_t hi = vmull_s32(vget_high_s32(s), vget_high_s32(g));
+        vst1q_s32(dest + i, vcombine_s32(vshrn_n_s64(lo, RampApplicator::kGainShift), vshrn_n_s64(hi, RampApplicator::kGainShift)));
+    }
+    for (; i<aNumSamples; i++) {
+        dest[i] = (TInt32)(((TInt64)src[i] * aGains[i]) >> RampApplicator::kGainShift);
+    }
+}
+
+template <>
+void RampNative32<2>(const TByte* aSrc, TByte* aDest, const TInt32* aGains, TUint aNumSamples, TUint /*aNumChannels*/)
+{
+    const TInt32* src = reinterpret_cast<const TInt32*>(aSrc);
+    TInt32* dest = reinterpret_cast<TInt32*>(aDest);
+    TUint i = 0;
+    for (; i+2<=aNumSamples; i+=2) {
+        const int32x4_t s = vld1q_s32(src);
+        const int32x2_t g = vld1_s32(aGains + i);
+        const int64x2_t lo = vmull_s32(vget_low_s32(s), vdup_lane_s32(g, 0));
+        const int64x2_t hi = vmull_s32(vget_high_s32(s), vdup_lane_s32(g, 1));
+        vst1q_s32(dest, vcombine_s32(vshrn_n_s64(lo, RampApplicator::kGainShift), vshrn_n_s64(hi, RampApplicator::kGainShift)));
+        src += 4;
+        dest += 4;
+    }
+    if (i < aNumSamples) {
+        const TInt64 gain = aGains[i];
+        dest[0] = (TInt32)((src[0] * gain) >> RampApplicator::kGainShift);
+        dest[1] = (TInt32)((src[1] * gain) >> RampApplicator::kGainShift);
+    }
+}
+#endif // RAMP_NEON
+
+template <TUint kBytes>
+static RampKernel PackedKernel(TUint aNumChannels)
+{
+    switch (aNumChannels)
+    {
+    case 1:
+        return RampPacked<kBytes, 1>;
+    case 2:
+        return RampPacked<kBytes, 2>;
+    default:
+        return RampPacked<kBytes, 0>;
+    }
+}
+
 const TUint RampApplicator::kFullRampSpan = Ramp::kMax - Ramp::kMin;
 
 RampApplicator::RampApplicator(const Media::Ramp& aRamp)
@@ -749,77 +1353,113 @@ RampApplicator::RampApplicator(const Media::Ramp& aRamp)
 TUint RampApplicator::Start(const Brx& aData, TUint aBitDepth, TUint aNumChannels)
 {
     iPtr = aData.Ptr();
-    iBitDepth = aBitDepth;
+    iBytesPerSubsample = aBitDepth/8;
     iNumChannels = aNumChannels;
-    ASSERT_DEBUG(aData.Bytes() % ((iBitDepth/8) * iNumChannels) == 0);
-    iNumSamples = (TInt)(aData.Bytes() / ((iBitDepth/8) * iNumChannels));
-    iTotalRamp = (iRamp.Start() - iRamp.End());
-    iLoopCount = 0;
-    return iNumSamples;
+    ASSERT_DEBUG(aData.Bytes() % (iBytesPerSubsample * iNumChannels) == 0);
+    const TUint numSamples = aData.Bytes() / (iBytesPerSubsample * iNumChannels);
+    iRemaining = numSamples;
+
+    switch (aBitDepth)
+    {
+    case 8:
+        iKernelPacked = PackedKernel<1>(aNumChannels);
+        break;
+    case 16:
+        iKernelPacked = PackedKernel<2>(aNumChannels);
+        break;
+    case 24:
+        iKernelPacked = PackedKernel<3>(aNumChannels);
+        break;
+    case 32:
+        iKernelPacked = PackedKernel<4>(aNumChannels);
+        break;
+    default:
+        ASSERTS();
+    }
+    switch (aNumChannels)
+    {
+    case 1:
+        iKernelNative32 = RampNative32<1>;
+        break;
+    case 2:
+        iKernelNative32 = RampNative32<2>;
+        break;
+    default:
+        iKernelNative32 = RampNative32<0>;
+        break;
+    }
+
+    /* The ramp for sample n is Start() - (n * (Start() - End())) / (numSamples - 1).
+       Step the quotient and remainder of this division rather than dividing for every sample. */
+    const TUint start = iRamp.Start();
+    const TUint end = iRamp.End();
+    iRampDown = (start >= end);
+    const TUint span = (iRampDown? start - end : end - start);
+    iDivisor = (numSamples > 1? numSamples - 1 : 1);
+    iStepQuotient = (numSamples > 1? span / iDivisor : 0);
+    iStepRemainder = (numSamples > 1? span % iDivisor : 0);
+    iQuotient = 0;
+    iRemainder = 0;
+    return numSamples;
+}
+
+TUint RampApplicator::Apply(TByte* aDest, TUint aMaxSamples)
+{
+    return ApplyBlocks(iKernelPacked, aDest, aMaxSamples);
+}
+
+TUint RampApplicator::ApplyNative32(TInt32* aDest, TUint aMaxSamples)
+{
+    ASSERT_DEBUG(iBytesPerSubsample == DecodedAudio::kNativeBytesPerSubsample);
+    return ApplyBlocks(iKernelNative32, reinterpret_cast<TByte*>(aDest), aMaxSamples);
+}
+
+TInt32 RampApplicator::Gain(TUint aRamp)
+{ // static
+    static const TUint kIndexShift = 5; // assumes fullRampSpan==2^14 and kRampArray has 512 (2^9) items
+    static const TUint kFractionMask = (1 << kIndexShift) - 1;
+    static_assert(kGainShift == 15 + kIndexShift, "gain interpolation assumes kRampArray holds 15-bit fractions");
+    const TUint pos = kFullRampSpan - std::min(aRamp, kFullRampSpan);
+    const TUint index = pos >> kIndexShift;
+    if (index >= kRampArrayCount - 1) {
+        return (TInt32)(kRampArray[kRampArrayCount - 1] << kIndexShift);
+    }
+    const TInt32 a = (TInt32)kRampArray[index];
+    const TInt32 b = (TInt32)kRampArray[index + 1];
+    return (a << kIndexShift) - ((a - b) * (TInt32)(pos & kFractionMask));
 }
 
-void RampApplicator::GetNextSample(TByte* aDest)
+TUint RampApplicator::ApplyBlocks(Kernel aKernel, TByte* aDest, TUint aMaxSamples)
 {
     ASSERT_DEBUG(iPtr != nullptr);
-    const TUint16 ramp = (iNumSamples==1? (TUint16)iRamp.Start() : (TUint16)(iRamp.Start() - ((iLoopCount * iTotalRamp)/(iNumSamples-1))));
-    //Log::Print(" %04x ", ramp);
-    const TUint rampIndex = std::min(kRampArrayCount-1, (kFullRampSpan - ramp + (1<<4)) >> 5); // assumes fullRampSpan==2^14 and kRampArray has 512 (2^9) items. (1<<4 allows rounding up)
-    for (TUint i=0; i<iNumChannels; i++) {
-        TInt16 subsample16 = 0;
-        switch (iBitDepth)
-        {
-        case 8:
-            subsample16 = *iPtr++ << 8;
-            break;
-        case 16:
-            subsample16 = *iPtr++ << 8;
-            subsample16 += *iPtr++;
-            break;
-        case 24:
-            subsample16 = *iPtr++ << 8;
-            subsample16 += *iPtr++;
-            iPtr++;
-            break;
-        case 32:
-            subsample16 = *iPtr++ << 8;
-            subsample16 += *iPtr++;
-            iPtr++;
-            iPtr++;
-            break;
-        default:
-            ASSERTS();
-        }
-        //Log::Print(" %03u ", rampIndex);
-        const TUint16 rampMult = static_cast<TUint16>(kRampArray[rampIndex]);
-        TInt rampedSubsample = (rampIndex==512? 0 : (subsample16 * rampMult) >> 15);
-        //Log::Print("Original=%04x (%d), ramped=%04x (%d), rampIndex=%u\n", subsample, subsample, rampedSubsample, rampedSubsample, rampIndex);
+    const TUint bytesPerSample = iBytesPerSubsample * iNumChannels;
+    const TUint total = std::min(aMaxSamples, iRemaining);
+    TUint remaining = total;
+    while (remaining > 0) {
+        const TUint numSamples = std::min(remaining, kMaxGainBlock);
+        NextGains(numSamples);
+        aKernel(iPtr, aDest, iGains, numSamples, iNumChannels);
+        iPtr += numSamples * bytesPerSample;
+        aDest += numSamples * bytesPerSample;
+        remaining -= numSamples;
+    }
+    iRemaining -= total;
+    return total;
+}
 
-        switch (iBitDepth)
-        {
-        case 8:
-            *aDest++ = (TByte)(rampedSubsample >> 8);
-            break;
-        case 16:
-            *aDest++ = (TByte)(rampedSubsample >> 8);
-            *aDest++ = (TByte)rampedSubsample;
-            break;
-        case 24:
-            *aDest++ = (TByte)(rampedSubsample >> 8);
-            *aDest++ = (TByte)rampedSubsample;
-            *aDest++ = (TByte)0;
-            break;
-        case 32:
-            *aDest++ = (TByte)(rampedSubsample >> 8);
-            *aDest++ = (TByte)rampedSubsample;
-            *aDest++ = (TByte)0;
-            *aDest++ = (TByte)0;
-            break;
-        default:
-            ASSERTS();
+void RampApplicator::NextGains(TUint aNumSamples)
+{
+    const TUint start = iRamp.Start();
+    for (TUint i=0; i<aNumSamples; i++) {
+        const TUint ramp = (iRampDown? start - iQuotient : start + iQuotient);
+        iGains[i] = Gain(ramp);
+        iQuotient += iStepQuotient;
+        iRemainder += iStepRemainder;
+        if (iRemainder >= iDivisor) {
+            iRemainder -= iDivisor;
+            iQuotient++;
         }
     }
-
-    iLoopCount++;
 }
 
 TUint RampApplicator::MedianMultiplier(const Media::Ramp& aRamp)
@@ -1448,6 +2088,11 @@ MsgAudioEncoded* MsgAudioEncoded::Clone()
     return clone;
 }
 
+const LatencyTrace& MsgAudioEncoded::GetLatencyTrace() const
+{
+    return iAudioData->GetLatencyTrace();
+}
+
 void MsgAudioEncoded::Initialise(EncodedAudio* aEncodedAudio)
 {
     iAudioData = aEncodedAudio;
@@ -1702,6 +2347,27 @@ Msg* MsgBitRate::Process(IMsgProcessor& aProcessor)
 
 // MsgAudio
 
+static void SplitRampSegment(Ramp& aRamp, TUint& aRampSize, TUint aSplitPos, TUint aSize,
+                             Ramp& aRemaining, TUint& aRemainingRampSize)
+{
+    /* aRamp covers the first aRampSize (0 => all) of a msg of aSize.
+       Split it at aSplitPos, setting aRemaining to the ramp for the audio after aSplitPos. */
+    aRemaining.Reset();
+    aRemainingRampSize = 0;
+    if (!aRamp.IsEnabled()) {
+        return;
+    }
+    const TUint rampSize = (aRampSize == 0? aSize : aRampSize);
+    if (aSplitPos < rampSize) {
+        aRemaining = aRamp.Split(aSplitPos, rampSize);
+        aRemainingRampSize = (aRampSize == 0? 0 : rampSize - aSplitPos);
+        aRampSize = 0;
+    }
+    else if (aSplitPos == rampSize) {
+        aRampSize = 0;
+    }
+}
+
 void MsgAudio::SetObserver(IPipelineBufferObserver& aPipelineBufferObserver)
 {
     ASSERT(iPipelineBufferObserver == nullptr);
@@ -1720,12 +2386,7 @@ MsgAudio* MsgAudio::Split(TUint aJiffies)
     remaining->iBitDepth = iBitDepth;
     remaining->iNumChannels = iNumChannels;
     remaining->iPipelineBufferObserver = iPipelineBufferObserver;
-    if (iRamp.IsEnabled()) {
-        remaining->iRamp = iRamp.Split(aJiffies, iSize);
-    }
-    else {
-        remaining->iRamp.Reset();
-    }
+    SplitRampSegment(iRamp, iRampJiffies, aJiffies, iSize, remaining->iRamp, remaining->iRampJiffies);
     iSize = aJiffies;
     SplitCompleted(*remaining);
     return remaining;
@@ -1737,6 +2398,7 @@ MsgAudio* MsgAudio::Clone()
     clone->iSize = iSize;
     clone->iOffset = iOffset;
     clone->iRamp = iRamp;
+    clone->iRampJiffies = iRampJiffies;
     clone->iSampleRate = iSampleRate;
     clone->iBitDepth = iBitDepth;
     clone->iNumChannels = iNumChannels;
@@ -1763,16 +2425,42 @@ TUint MsgAudio::SetRamp(TUint aStart, TUint& aRemainingDuration, Ramp::EDirectio
         }
         return iRamp.End();
     }
+    if (iRampJiffies != 0) {
+        /* Ramps aren't merged with one that ends part way through this msg.  Treat the existing
+           ramp (always a ramp up) as covering the whole msg instead.  This is never louder than
+           the original so is safe to combine with the new ramp. */
+        iRampJiffies = 0;
+    }
+    TUint rampJiffies = iSize;
+    MsgAudio* remaining = nullptr;
+    if (iSize > remainingDuration) {
+        ASSERT(remainingDuration > 0);
+        if (aDirection == Ramp::EUp && !iRamp.IsEnabled()) {
+            // ramp ends part way through this msg; later audio is played unramped
+            rampJiffies = remainingDuration;
+        }
+        else {
+            /* Audio after a ramp down may need to be muted or discarded.  Audio after a ramp
+               merged with an existing one needs the rest of the existing ramp.  Either way, it
+               has to be a separate msg. */
+            remaining = Split(remainingDuration);
+            rampJiffies = iSize;
+        }
+    }
 
     /*TBool logAppliedRamp = false;
     if (iRamp.IsEnabled()) {
         Log::Print("++ MsgAudio::SetRamp(%08x, %u, %u): Existing ramp is [%08x...%08x]\n", aStart, aRemainingDuration, aDirection, iRamp.Start(), iRamp.End());
         logAppliedRamp = true;
     }*/
-    if (iRamp.Set(aStart, iSize, remainingDuration, aDirection, split, splitPos)) {
+    if (iRamp.Set(aStart, rampJiffies, remainingDuration, aDirection, split, splitPos)) {
         if (splitPos == 0) {
             iRamp = split;
         }
+        else if (splitPos != iSize && remaining != nullptr) {
+            // aSplit is already needed for the audio after this ramp
+            iRamp.Join(split);
+        }
         else if (splitPos != iSize) {
             Media::Ramp ramp = iRamp; // Split() will muck about with ramps.  Allow this to happen then reset the correct values
             aSplit = Split(splitPos);
@@ -1791,7 +2479,10 @@ TUint MsgAudio::SetRamp(TUint aStart, TUint& aRemainingDuration, Ramp::EDirectio
         Log::Print("\n");
     }*/
 
-    aRemainingDuration -= iSize;
+    if (rampJiffies < iSize) {
+        iRampJiffies = rampJiffies;
+    }
+    aRemainingDuration -= rampJiffies;
     if (aSplit != nullptr && aSplit->Ramp().Direction() != aDirection && aDirection == Ramp::EUp) {
         aRemainingDuration += aSplit->iSize; // roughly compensate for split running in opposite direction to requested ramp
     }
@@ -1805,17 +2496,28 @@ TUint MsgAudio::SetRamp(TUint aStart, TUint& aRemainingDuration, Ramp::EDirectio
         aRemainingDuration = 0;
     }
 
+    if (remaining != nullptr) {
+        aSplit = remaining;
+    }
     return iRamp.End();
 }
 
 void MsgAudio::ClearRamp()
 {
     iRamp.Reset();
+    iRampJiffies = 0;
 }
 
 void MsgAudio::SetMuted()
 {
     iRamp.SetMuted();
+    iRampJiffies = 0;
+}
+
+void MsgAudio::RestoreRamp(const Media::Ramp& aRamp)
+{
+    iRamp = aRamp;
+    iRampJiffies = 0;
 }
 
 const Media::Ramp& MsgAudio::Ramp() const
@@ -1823,6 +2525,11 @@ const Media::Ramp& MsgAudio::Ramp() const
     return iRamp;
 }
 
+TUint MsgAudio::RampJiffies() const
+{
+    return (iRampJiffies == 0? iSize : iRampJiffies);
+}
+
 TUint MsgAudio::MedianRampMultiplier()
 {
     if (!iRamp.IsEnabled()) {
@@ -1831,8 +2538,12 @@ TUint MsgAudio::MedianRampMultiplier()
     else if (iRamp.Direction() == Ramp::EMute) {
         return 0;
     }
-    const TUint mult = RampApplicator::MedianMultiplier(iRamp);
-    iRamp.Reset();
+    TUint mult = RampApplicator::MedianMultiplier(iRamp);
+    if (iRampJiffies != 0) {
+        // audio after the ramp is at full level
+        mult = (TUint)(((TUint64)mult * iRampJiffies + (TUint64)0x8000 * (iSize - iRampJiffies)) / iSize);
+    }
+    ClearRamp();
     return mult;
 }
 
@@ -1844,6 +2555,7 @@ MsgAudio::MsgAudio(AllocatorBase& aAllocator)
 void MsgAudio::Initialise(TUint aSampleRate, TUint aBitDepth, TUint aChannels)
 {
     iRamp.Reset();
+    iRampJiffies = 0;
     iSampleRate = aSampleRate;
     iBitDepth = aBitDepth;
     iNumChannels = aChannels;
@@ -1884,17 +2596,28 @@ MsgPlayable* MsgAudioPcm::CreatePlayable()
 {
     TUint offsetJiffies = iOffset;
     const TUint jiffiesPerSample = Jiffies::PerSample(iSampleRate);
+    // MsgPlayable sizes/offsets always count bytes of packed audio, regardless of iFormat
     const TUint offsetBytes = Jiffies::ToBytes(offsetJiffies, jiffiesPerSample, iNumChannels, iBitDepth/8);
     TUint sizeJiffies = iSize + (iOffset - offsetJiffies);
     const TUint sizeBytes = Jiffies::ToBytes(sizeJiffies, jiffiesPerSample, iNumChannels, iBitDepth/8);
     // both size & offset will be rounded down if they don't fall on a sample boundary
     // we don't risk losing any data doing this as the start and end of each DecodedAudio's data fall on sample boundaries
 
+    TUint rampBytes = 0;
+    if (iRampJiffies != 0) {
+        TUint rampJiffies = iRampJiffies + (iOffset - offsetJiffies);
+        rampBytes = Jiffies::ToBytes(rampJiffies, jiffiesPerSample, iNumChannels, iBitDepth/8);
+        rampBytes = std::max(rampBytes, iNumChannels * (iBitDepth/8)); // always ramp at least one sample
+        if (rampBytes >= sizeBytes) {
+            rampBytes = 0;
+        }
+    }
+
     Optional<IPipelineBufferObserver> bufferObserver(iPipelineBufferObserver);
     MsgPlayable* playable;
     if (iRamp.Direction() != Ramp::EMute) {
         MsgPlayablePcm* pcm = iAllocatorPlayablePcm->Allocate();
-        pcm->Initialise(iAudioData, sizeBytes, iSampleRate, iBitDepth, iNumChannels, offsetBytes, iAttenuation, iRamp, bufferObserver);
+        pcm->Initialise(iAudioData, iFormat, sizeBytes, iSampleRate, iBitDepth, iNumChannels, offsetBytes, iAttenuation, iRamp, rampBytes, bufferObserver);
         playable = pcm;
     }
     else {
@@ -1913,9 +2636,18 @@ void MsgAudioPcm::Aggregate(MsgAudioPcm* aMsg)
     ASSERT(aMsg->iSampleRate == iSampleRate);
     ASSERT(aMsg->iBitDepth == iBitDepth);
     ASSERT(aMsg->iNumChannels == iNumChannels);
+    ASSERT(aMsg->iFormat == iFormat);
     ASSERT(aMsg->iTrackOffset == iTrackOffset+Jiffies());   // aMsg must logically follow this one
     ASSERT(!iRamp.IsEnabled() && !aMsg->iRamp.IsEnabled()); // no ramps allowed
 
+    const TUint bytes = iAudioData->Bytes() + aMsg->iAudioData->Bytes();
+    if (bytes > iAudioData->MaxBytes()) {
+        // our DecodedAudio is from a smaller size class; move to one that can hold the aggregated audio
+        DecodedAudio* audioData = iAllocatorAudioData->AllocateDecoded(bytes);
+        audioData->Aggregate(*iAudioData);
+        iAudioData->RemoveRef();
+        iAudioData = audioData;
+    }
     iAudioData->Aggregate(*(aMsg->iAudioData));
     iSize += aMsg->Jiffies();
     aMsg->RemoveRef();
@@ -1925,6 +2657,8 @@ MsgAudio* MsgAudioPcm::Clone()
 {
     MsgAudioPcm* clone = static_cast<MsgAudioPcm*>(MsgAudio::Clone());
     clone->iAudioData = iAudioData;
+    clone->iFormat = iFormat;
+    clone->iAllocatorAudioData = iAllocatorAudioData;
     clone->iAllocatorPlayablePcm = iAllocatorPlayablePcm;
     clone->iAllocatorPlayableSilence = iAllocatorPlayableSilence;
     clone->iTrackOffset = iTrackOffset;
@@ -1933,18 +2667,21 @@ MsgAudio* MsgAudioPcm::Clone()
     return clone;
 }
 
-void MsgAudioPcm::Initialise(DecodedAudio* aDecodedAudio, TUint aSampleRate, TUint aBitDepth, TUint aChannels, TUint64 aTrackOffset,
+void MsgAudioPcm::Initialise(DecodedAudio* aDecodedAudio, DecodedAudioFormat aFormat, TUint aSampleRate, TUint aBitDepth, TUint aChannels, TUint64 aTrackOffset,
+                             AudioDataAllocator& aAllocatorAudioData,
                              Allocator<MsgPlayablePcm>& aAllocatorPlayablePcm,
                              Allocator<MsgPlayableSilence>& aAllocatorPlayableSilence)
 {
     MsgAudio::Initialise(aSampleRate, aBitDepth, aChannels);
+    iAllocatorAudioData = &aAllocatorAudioData;
     iAllocatorPlayablePcm = &aAllocatorPlayablePcm;
     iAllocatorPlayableSilence = &aAllocatorPlayableSilence;
     iAudioData = aDecodedAudio;
+    iFormat = aFormat;
     iTrackOffset = aTrackOffset;
     iAttenuation = MsgAudioPcm::kUnityAttenuation;
     const TUint bytes = iAudioData->Bytes();
-    const TUint byteDepth = iBitDepth / 8;
+    const TUint byteDepth = DecodedAudio::BytesPerSubsample(iBitDepth, iFormat);
     ASSERT(bytes % byteDepth == 0);
     const TUint numSubsamples = bytes / byteDepth;
     ASSERT(numSubsamples % iNumChannels == 0);
@@ -1958,7 +2695,9 @@ void MsgAudioPcm::SplitCompleted(MsgAudio& aRemaining)
     iAudioData->AddRef();
     MsgAudioPcm& remaining = static_cast<MsgAudioPcm&>(aRemaining);
     remaining.iAudioData = iAudioData;
+    remaining.iFormat = iFormat;
     remaining.iTrackOffset = iTrackOffset + iSize;
+    remaining.iAllocatorAudioData = iAllocatorAudioData;
     remaining.iAllocatorPlayablePcm = iAllocatorPlayablePcm;
     remaining.iAllocatorPlayableSilence = iAllocatorPlayableSilence;
     remaining.iAttenuation = iAttenuation;
@@ -1985,6 +2724,16 @@ void MsgAudioPcm::SetAttenuation(TUint aAttenuation)
     iAttenuation = aAttenuation;
 }
 
+DecodedAudioFormat MsgAudioPcm::Format() const
+{
+    return iFormat;
+}
+
+void MsgAudioPcm::SetLatencyTrace(const LatencyTrace& aTrace)
+{
+    iAudioData->SetLatencyTrace(aTrace);
+}
+
 // MsgSilence
 
 MsgSilence::MsgSilence(AllocatorBase& aAllocator)
@@ -2071,12 +2820,7 @@ MsgPlayable* MsgPlayable::Split(TUint aBytes)
     remaining->iSampleRate = iSampleRate;
     remaining->iBitDepth = iBitDepth;
     remaining->iNumChannels = iNumChannels;
-    if (iRamp.IsEnabled()) {
-        remaining->iRamp = iRamp.Split(aBytes, iSize);
-    }
-    else {
-        remaining->iRamp.Reset();
-    }
+    SplitRampSegment(iRamp, iRampBytes, aBytes, iSize, remaining->iRamp, remaining->iRampBytes);
     remaining->iPipelineBufferObserver = iPipelineBufferObserver;
     iSize = aBytes;
     iNextPlayable = nullptr;
@@ -2139,9 +2883,14 @@ void MsgPlayable::Read(IPcmProcessor& aProcessor)
     aProcessor.EndBlock();
 }
 
-TBool MsgPlayable::TryLogTimestamps()
+void MsgPlayable::Read(AnimatorBuffer& aBuffer)
+{
+    ASSERT(aBuffer.NumChannels() == iNumChannels);
+    Read(static_cast<IPcmProcessor&>(aBuffer));
+}
+
+void MsgPlayable::AddLogPoint(LatencyPoint /*aPoint*/)
 {
-    return false;
 }
 
 MsgPlayable::MsgPlayable(AllocatorBase& aAllocator)
@@ -2150,7 +2899,7 @@ MsgPlayable::MsgPlayable(AllocatorBase& aAllocator)
 }
 
 void MsgPlayable::Initialise(TUint aSizeBytes, TUint aSampleRate, TUint aBitDepth,
-                             TUint aNumChannels, TUint aOffsetBytes, const Media::Ramp& aRamp,
+                             TUint aNumChannels, TUint aOffsetBytes, const Media::Ramp& aRamp, TUint aRampBytes,
                              Optional<IPipelineBufferObserver> aPipelineBufferObserver)
 {
     iNextPlayable = nullptr;
@@ -2160,9 +2909,18 @@ void MsgPlayable::Initialise(TUint aSizeBytes, TUint aSampleRate, TUint aBitDept
     iNumChannels = aNumChannels;
     iOffset = aOffsetBytes;
     iRamp = aRamp;
+    iRampBytes = aRampBytes;
     iPipelineBufferObserver = aPipelineBufferObserver.Ptr();
 }
 
+TUint MsgPlayable::RampBytes() const
+{
+    if (!iRamp.IsEnabled()) {
+        return 0;
+    }
+    return (iRampBytes == 0? iSize : iRampBytes);
+}
+
 Msg* MsgPlayable::Process(IMsgProcessor& aProcessor)
 {
     return aProcessor.ProcessMsg(this);
@@ -2181,6 +2939,7 @@ void MsgPlayable::Clear()
     }
     iSize = iSampleRate = iBitDepth = iNumChannels = iOffset = 0;
     iRamp.Reset();
+    iRampBytes = 0;
 }
 
 void MsgPlayable::SplitCompleted(MsgPlayable& /*aMsg*/)
@@ -2196,120 +2955,143 @@ MsgPlayablePcm::MsgPlayablePcm(AllocatorBase& aAllocator)
 {
 }
 
-void MsgPlayablePcm::Initialise(DecodedAudio* aDecodedAudio, TUint aSizeBytes, TUint aSampleRate, TUint aBitDepth,
-                                TUint aNumChannels, TUint aOffsetBytes, TUint aAttenuation, const Media::Ramp& aRamp,
+void MsgPlayablePcm::Initialise(DecodedAudio* aDecodedAudio, DecodedAudioFormat aFormat, TUint aSizeBytes, TUint aSampleRate, TUint aBitDepth,
+                                TUint aNumChannels, TUint aOffsetBytes, TUint aAttenuation, const Media::Ramp& aRamp, TUint aRampBytes,
                                 Optional<IPipelineBufferObserver> aPipelineBufferObserver)
 {
     MsgPlayable::Initialise(aSizeBytes, aSampleRate, aBitDepth, aNumChannels,
-                            aOffsetBytes, aRamp, aPipelineBufferObserver);
+                            aOffsetBytes, aRamp, aRampBytes, aPipelineBufferObserver);
     iAudioData = aDecodedAudio;
     iAudioData->AddRef();
+    iFormat = aFormat;
     iAttenuation = aAttenuation;
 }
 
-Brn MsgPlayablePcm::ApplyAttenuation(Brn aData)
+void MsgPlayablePcm::ReadBlock(IPcmProcessor& aProcessor)
 {
-    // Note: A static buffer is used here for performance reasons.
-    // This method must only be called from a single thread to ensure data validity.
-    static Bws<AudioData::kMaxBytes> attenuatedData;
-
-    if(iAttenuation != MsgAudioPcm::kUnityAttenuation) {
-        switch (iBitDepth) {
-        case 16:
-            {
-                TInt16* source = (TInt16*)aData.Ptr();
-                TInt16* dest = (TInt16*)attenuatedData.Ptr();
-                TUint samples = aData.Bytes()/2;
-                attenuatedData.SetBytes(aData.Bytes());
-                for(TUint i = 0; i < samples; i++) {
-                    dest[i] = (TInt16)((TInt32)source[i] * iAttenuation / MsgAudioPcm::kUnityAttenuation);
-                }
-            }
-            break;
+    if (iFormat == DecodedAudioFormat::NativeInt32) {
+        ReadBlockNative32(aProcessor);
+        return;
+    }
+    const Brn audioBuf(iAudioData->Ptr(iOffset), iSize);
+    const TBool attenuate = (iAttenuation != MsgAudioPcm::kUnityAttenuation);
+    const TUint rampBytes = RampBytes();
+    if (rampBytes == 0 && !attenuate) {
+        ProcessFragment(aProcessor, audioBuf, iBitDepth, iNumChannels);
+        return;
+    }
 
-        default:
-            ASSERTS();  //only supports 16 bit data (for AirPlay)
+    // ramp and/or attenuate into a block on this thread's stack so concurrent readers don't share scratch space
+    alignas(4) TByte block[kBlockBytes];
+    const TUint gain = GainApplicator::FromAttenuation(iAttenuation, MsgAudioPcm::kUnityAttenuation);
+    const TUint bytesPerSample = (iBitDepth/8) * iNumChannels;
+    const TUint blockBytes = (kBlockBytes / bytesPerSample) * bytesPerSample;
+    RampApplicator ra(iRamp);
+    if (rampBytes > 0) {
+        (void)ra.Start(Brn(audioBuf.Ptr(), rampBytes), iBitDepth, iNumChannels);
+    }
+    for (TUint offset=0; offset<audioBuf.Bytes(); ) {
+        if (offset >= rampBytes && !attenuate) {
+            // ramp ended part way through this msg; the remaining audio is passed through unchanged
+            ProcessFragment(aProcessor, Brn(audioBuf.Ptr() + offset, audioBuf.Bytes() - offset), iBitDepth, iNumChannels);
             break;
         }
-        return Brn(attenuatedData);  // return modified data buffer
-    }
-    else {
-        return aData;           // return original data buffer
+        TUint bytes = std::min(blockBytes, audioBuf.Bytes() - offset);
+        if (offset < rampBytes) {
+            bytes = std::min(bytes, rampBytes - offset);
+            (void)ra.Apply(block, bytes / bytesPerSample);
+            if (attenuate) {
+                GainApplicator::Apply(block, block, bytes, iBitDepth, gain);
+            }
+        }
+        else {
+            GainApplicator::Apply(audioBuf.Ptr() + offset, block, bytes, iBitDepth, gain);
+        }
+        ProcessFragment(aProcessor, Brn(block, bytes), iBitDepth, iNumChannels);
+        offset += bytes;
     }
 }
 
-void MsgPlayablePcm::ReadBlock(IPcmProcessor& aProcessor)
+void MsgPlayablePcm::ReadBlockNative32(IPcmProcessor& aProcessor)
 {
-    Brn audioBuf = ApplyAttenuation(Brn(iAudioData->Ptr(iOffset), iSize));
-
+    // iOffset and iSize count bytes of packed audio; iAudioData holds kNativeBytesPerSubsample per subsample
+    const TUint packedBytesPerSubsample = iBitDepth/8;
+    const TUint offset = (iOffset / packedBytesPerSubsample) * DecodedAudio::kNativeBytesPerSubsample;
+    const TUint bytes = (iSize / packedBytesPerSubsample) * DecodedAudio::kNativeBytesPerSubsample;
+    const Brn audioBuf(iAudioData->Ptr(offset), bytes);
     const TUint numChannels = iNumChannels;
-    const TUint bitDepth = iBitDepth;
-    if (iRamp.IsEnabled()) {
-        Bws<256> rampedBuf;
-        RampApplicator ra(iRamp);
-        const TUint numSamples = ra.Start(audioBuf, bitDepth, numChannels);
-        const TUint bytesPerSample = (bitDepth/8) * numChannels;
-        const TUint samplesPerFragment = rampedBuf.MaxBytes() / bytesPerSample;
-        TByte* ptr = (TByte*)rampedBuf.Ptr();
-        TUint fragmentSamples = 0;
-        for (TUint i=0; i<numSamples; i++) {
-            ra.GetNextSample(ptr);
-
-            fragmentSamples++;
-            ptr += bytesPerSample;
-            if (fragmentSamples == samplesPerFragment || i == numSamples-1) {
-                rampedBuf.SetBytes(fragmentSamples * bytesPerSample);
-                switch (bitDepth)
-                {
-                case 8:
-                    aProcessor.ProcessFragment8(rampedBuf, numChannels);
-                    break;
-                case 16:
-                    aProcessor.ProcessFragment16(rampedBuf, numChannels);
-                    break;
-                case 24:
-                    aProcessor.ProcessFragment24(rampedBuf, numChannels);
-                    break;
-                case 32:
-                    aProcessor.ProcessFragment32(rampedBuf, numChannels);
-                    break;
-                default:
-                    ASSERTS();
-                }
-                ptr = (TByte*)rampedBuf.Ptr();
-                fragmentSamples = 0;
-            }
-        }
+    const TBool attenuate = (iAttenuation != MsgAudioPcm::kUnityAttenuation);
+    const TUint rampSamples = RampBytes() / (numChannels * packedBytesPerSubsample);
+    if (rampSamples == 0 && !attenuate) {
+        aProcessor.ProcessFragmentNative32(audioBuf, numChannels, iBitDepth);
+        return;
     }
-    else {
-        switch (bitDepth)
-        {
-        case 8:
-            aProcessor.ProcessFragment8(audioBuf, numChannels);
-            break;
-        case 16:
-            aProcessor.ProcessFragment16(audioBuf, numChannels);
-            break;
-        case 24:
-            aProcessor.ProcessFragment24(audioBuf, numChannels);
-            break;
-        case 32:
-            aProcessor.ProcessFragment32(audioBuf, numChannels);
+
+    TInt32 block[kBlockBytes / DecodedAudio::kNativeBytesPerSubsample];
+    const TUint gain = GainApplicator::FromAttenuation(iAttenuation, MsgAudioPcm::kUnityAttenuation);
+    const TUint samplesPerBlock = kBlockBytes / (numChannels * DecodedAudio::kNativeBytesPerSubsample);
+    const TInt32* src = reinterpret_cast<const TInt32*>(audioBuf.Ptr());
+    RampApplicator ra(iRamp);
+    const TUint totalSamples = audioBuf.Bytes() / (numChannels * DecodedAudio::kNativeBytesPerSubsample);
+    TUint remaining = totalSamples;
+    if (rampSamples > 0) {
+        (void)ra.Start(Brn(audioBuf.Ptr(), rampSamples * numChannels * DecodedAudio::kNativeBytesPerSubsample), 32, numChannels);
+    }
+    while (remaining > 0) {
+        const TUint done = totalSamples - remaining;
+        if (done >= rampSamples && !attenuate) {
+            // ramp ended part way through this msg; the remaining audio is passed through unchanged
+            Brn fragment(reinterpret_cast<const TByte*>(src), remaining * numChannels * DecodedAudio::kNativeBytesPerSubsample);
+            aProcessor.ProcessFragmentNative32(fragment, numChannels, iBitDepth);
             break;
-        default:
-            ASSERTS();
         }
+        TUint numSamples = std::min(samplesPerBlock, remaining);
+        if (done < rampSamples) {
+            numSamples = std::min(numSamples, rampSamples - done);
+        }
+        const TUint numSubsamples = numSamples * numChannels;
+        if (done < rampSamples) {
+            (void)ra.ApplyNative32(block, numSamples);
+            if (attenuate) {
+                GainApplicator::ApplyNative32(block, block, numSubsamples, gain);
+            }
+        }
+        else {
+            GainApplicator::ApplyNative32(src, block, numSubsamples, gain);
+        }
+        Brn fragment(reinterpret_cast<const TByte*>(block), numSubsamples * DecodedAudio::kNativeBytesPerSubsample);
+        aProcessor.ProcessFragmentNative32(fragment, numChannels, iBitDepth);
+        src += numSubsamples;
+        remaining -= numSamples;
     }
+}
 
+void MsgPlayablePcm::ProcessFragment(IPcmProcessor& aProcessor, const Brx& aData, TUint aBitDepth, TUint aNumChannels)
+{ // static
+    switch (aBitDepth)
+    {
+    case 8:
+        aProcessor.ProcessFragment8(aData, aNumChannels);
+        break;
+    case 16:
+        aProcessor.ProcessFragment16(aData, aNumChannels);
+        break;
+    case 24:
+        aProcessor.ProcessFragment24(aData, aNumChannels);
+        break;
+    case 32:
+        aProcessor.ProcessFragment32(aData, aNumChannels);
+        break;
+    default:
+        ASSERTS();
+    }
 }
 
-TBool MsgPlayablePcm::TryLogTimestamps()
+void MsgPlayablePcm::AddLogPoint(LatencyPoint aPoint)
 {
-#ifdef TIMESTAMP_LOGGING_ENABLE
-    return iAudioData->TryLogTimestamps();
-#else
-    return true;
-#endif
+    if (iAudioData->IsLatencyTraced()) {
+        iAudioData->AddLatencyStamp(aPoint);
+    }
 }
 
 MsgPlayable* MsgPlayablePcm::Allocate()
@@ -2320,7 +3102,10 @@ MsgPlayable* MsgPlayablePcm::Allocate()
 void MsgPlayablePcm::SplitCompleted(MsgPlayable& aRemaining)
 {
     iAudioData->AddRef();
-    static_cast<MsgPlayablePcm&>(aRemaining).iAudioData = iAudioData;
+    MsgPlayablePcm& remaining = static_cast<MsgPlayablePcm&>(aRemaining);
+    remaining.iAudioData = iAudioData;
+    remaining.iFormat = iFormat;
+    remaining.iAttenuation = iAttenuation;
 }
 
 void MsgPlayablePcm::Clear()
@@ -2342,7 +3127,7 @@ void MsgPlayableSilence::Initialise(TUint aSizeBytes, TUint aSampleRate, TUint a
                                     Optional<IPipelineBufferObserver> aPipelineBufferObserver)
 {
     MsgPlayable::Initialise(aSizeBytes, aSampleRate, aBitDepth,
-                            aNumChannels, 0, aRamp, aPipelineBufferObserver);
+                            aNumChannels, 0, aRamp, 0, aPipelineBufferObserver);
     iBitDepth = aBitDepth;
     iNumChannels = aNumChannels;
 }
@@ -2388,6 +3173,258 @@ void MsgPlayableSilence::SplitCompleted(MsgPlayable& aRemaining)
 }
 
 
+// IPcmProcessor
+
+void IPcmProcessor::ProcessFragmentNative32(const Brx& aData, TUint aNumChannels, TUint aBitDepth)
+{
+    static const TUint kMaxFragmentSubsamples = 240;
+    TByte packed[kMaxFragmentSubsamples * DecodedAudio::kNativeBytesPerSubsample];
+    const TInt32* src = reinterpret_cast<const TInt32*>(aData.Ptr());
+    const TUint maxSubsamples = (kMaxFragmentSubsamples / aNumChannels) * aNumChannels;
+    TUint remaining = aData.Bytes() / DecodedAudio::kNativeBytesPerSubsample;
+    while (remaining > 0) {
+        const TUint subsamples = std::min(remaining, maxSubsamples);
+        DecodedAudio::FromNative32(src, subsamples, aBitDepth, packed);
+        const Brn fragment(packed, subsamples * (aBitDepth/8));
+        switch (aBitDepth)
+        {
+        case 8:
+            ProcessFragment8(fragment, aNumChannels);
+            break;
+        case 16:
+            ProcessFragment16(fragment, aNumChannels);
+            break;
+        case 24:
+            ProcessFragment24(fragment, aNumChannels);
+            break;
+        case 32:
+            ProcessFragment32(fragment, aNumChannels);
+            break;
+        default:
+            ASSERTS();
+        }
+        src += subsamples;
+        remaining -= subsamples;
+    }
+}
+
+
+// AnimatorBuffer
+
+// Kernels write subsamples to containers of kDestBytes, most significant bits first.
+// Packed sources are big endian, as held by DecodedAudio.
+
+template <TUint kDestBytes, TBool kBigEndian> static inline void StoreSubsample(TUint32 aSubsample, TByte* aDest)
+{
+    for (TUint i=0; i<kDestBytes; i++) {
+        const TUint shift = (kBigEndian? 24 - (8 * i) : 32 - (8 * kDestBytes) + (8 * i));
+        aDest[i] = (TByte)(aSubsample >> shift);
+    }
+}
+
+template <TUint kDestBytes, TBool kBigEndian>
+static void PackFromPacked(const TByte* aSrc, TUint aSrcBytesPerSubsample, TByte* aDest, TUint aNumSubsamples)
+{
+    if (kBigEndian && aSrcBytesPerSubsample == kDestBytes) {
+        (void)memcpy(aDest, aSrc, aNumSubsamples * kDestBytes);
+        return;
+    }
+    for (TUint i=0; i<aNumSubsamples; i++) {
+        TUint32 subsample = 0;
+        for (TUint j=0; j<aSrcBytesPerSubsample; j++) {
+            subsample |= (TUint32)aSrc[j] << (24 - (8 * j));
+        }
+        StoreSubsample<kDestBytes, kBigEndian>(subsample, aDest);
+        aSrc += aSrcBytesPerSubsample;
+        aDest += kDestBytes;
+    }
+}
+
+template <TUint kDestBytes, TBool kBigEndian>
+static void PackFromNative32(const TInt32* aSrc, TByte* aDest, TUint aNumSubsamples)
+{
+    for (TUint i=0; i<aNumSubsamples; i++) {
+        StoreSubsample<kDestBytes, kBigEndian>((TUint32)aSrc[i], aDest);
+        aDest += kDestBytes;
+    }
+}
+
+AnimatorBuffer::AnimatorBuffer(TByte* aPtr, TUint aMaxSamples, TUint aNumChannels, TUint aBytesPerSubsample, AudioDataEndian aEndian)
+    : iPtr(aPtr)
+    , iMaxSamples(aMaxSamples)
+    , iNumChannels(aNumChannels)
+    , iBytesPerSubsample(aBytesPerSubsample)
+    , iSamplesWritten(0)
+{
+    ASSERT(aEndian != AudioDataEndian::Invalid);
+    const TBool bigEndian = (aEndian == AudioDataEndian::Big);
+    switch (aBytesPerSubsample)
+    {
+    case 1:
+        iKernelPacked = (bigEndian? PackFromPacked<1, true> : PackFromPacked<1, false>);
+        iKernelNative32 = (bigEndian? PackFromNative32<1, true> : PackFromNative32<1, false>);
+        break;
+    case 2:
+        iKernelPacked = (bigEndian? PackFromPacked<2, true> : PackFromPacked<2, false>);
+        iKernelNative32 = (bigEndian? PackFromNative32<2, true> : PackFromNative32<2, false>);
+        break;
+    case 3:
+        iKernelPacked = (bigEndian? PackFromPacked<3, true> : PackFromPacked<3, false>);
+        iKernelNative32 = (bigEndian? PackFromNative32<3, true> : PackFromNative32<3, false>);
+        break;
+    case 4:
+        iKernelPacked = (bigEndian? PackFromPacked<4, true> : PackFromPacked<4, false>);
+        iKernelNative32 = (bigEndian? PackFromNative32<4, true> : PackFromNative32<4, false>);
+        break;
+    default:
+        ASSERTS();
+    }
+}
+
+TUint AnimatorBuffer::NumChannels() const
+{
+    return iNumChannels;
+}
+
+TUint AnimatorBuffer::BytesPerSample() const
+{
+    return iBytesPerSubsample * iNumChannels;
+}
+
+TUint AnimatorBuffer::SamplesWritten() const
+{
+    return iSamplesWritten;
+}
+
+TUint AnimatorBuffer::SamplesFree() const
+{
+    return iMaxSamples - iSamplesWritten;
+}
+
+TByte* AnimatorBuffer::Reserve(const Brx& aData, TUint aSrcBytesPerSubsample, TUint aNumChannels, TUint& aNumSubsamples)
+{
+    ASSERT(aNumChannels == iNumChannels);
+    aNumSubsamples = aData.Bytes() / aSrcBytesPerSubsample;
+    const TUint numSamples = aNumSubsamples / iNumChannels;
+    ASSERT(numSamples <= SamplesFree());
+    TByte* dest = iPtr + (iSamplesWritten * BytesPerSample());
+    iSamplesWritten += numSamples;
+    return dest;
+}
+
+void AnimatorBuffer::BeginBlock()
+{
+}
+
+void AnimatorBuffer::ProcessFragment8(const Brx& aData, TUint aNumChannels)
+{
+    TUint numSubsamples;
+    TByte* dest = Reserve(aData, 1, aNumChannels, numSubsamples);
+    iKernelPacked(aData.Ptr(), 1, dest, numSubsamples);
+}
+
+void AnimatorBuffer::ProcessFragment16(const Brx& aData, TUint aNumChannels)
+{
+    TUint numSubsamples;
+    TByte* dest = Reserve(aData, 2, aNumChannels, numSubsamples);
+    iKernelPacked(aData.Ptr(), 2, dest, numSubsamples);
+}
+
+void AnimatorBuffer::ProcessFragment24(const Brx& aData, TUint aNumChannels)
+{
+    TUint numSubsamples;
+    TByte* dest = Reserve(aData, 3, aNumChannels, numSubsamples);
+    iKernelPacked(aData.Ptr(), 3, dest, numSubsamples);
+}
+
+void AnimatorBuffer::ProcessFragment32(const Brx& aData, TUint aNumChannels)
+{
+    TUint numSubsamples;
+    TByte* dest = Reserve(aData, 4, aNumChannels, numSubsamples);
+    iKernelPacked(aData.Ptr(), 4, dest, numSubsamples);
+}
+
+void AnimatorBuffer::ProcessFragmentNative32(const Brx& aData, TUint aNumChannels, TUint /*aBitDepth*/)
+{
+    TUint numSubsamples;
+    TByte* dest = Reserve(aData, DecodedAudio::kNativeBytesPerSubsample, aNumChannels, numSubsamples);
+    iKernelNative32(reinterpret_cast<const TInt32*>(aData.Ptr()), dest, numSubsamples);
+}
+
+void AnimatorBuffer::EndBlock()
+{
+}
+
+void AnimatorBuffer::Flush()
+{
+}
+
+
+// IPipelineElementUpstream
+
+void IPipelineElementUpstream::PullBatch(MsgQueueLite& aQueue, TUint /*aMaxMsgs*/)
+{
+    aQueue.Enqueue(Pull());
+}
+
+UpstreamLink* IPipelineElementUpstream::SpliceableUpstream()
+{
+    return nullptr;
+}
+
+
+// UpstreamLink
+
+UpstreamLink::UpstreamLink(IPipelineElementUpstream& aUpstream)
+    : iUpstream(&aUpstream)
+{
+}
+
+UpstreamLink::UpstreamLink()
+    : iUpstream(nullptr)
+{
+}
+
+Msg* UpstreamLink::PullBatch(TUint aMaxMsgs)
+{
+    ASSERT(aMaxMsgs > 0);
+    if (iBatch.IsEmpty()) {
+        iUpstream.load(std::memory_order_acquire)->PullBatch(iBatch, aMaxMsgs);
+    }
+    return iBatch.Dequeue();
+}
+
+Msg* UpstreamLink::TryPull()
+{
+    if (iBatch.IsEmpty()) {
+        return nullptr;
+    }
+    return iBatch.Dequeue();
+}
+
+void UpstreamLink::PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs)
+{
+    ASSERT(aMaxMsgs > 0);
+    if (iBatch.IsEmpty()) {
+        iUpstream.load(std::memory_order_acquire)->PullBatch(aQueue, aMaxMsgs);
+        return;
+    }
+    for (TUint i=0; i<aMaxMsgs && !iBatch.IsEmpty(); i++) {
+        aQueue.Enqueue(iBatch.Dequeue());
+    }
+}
+
+IPipelineElementUpstream& UpstreamLink::Upstream() const
+{
+    return *iUpstream.load(std::memory_order_acquire);
+}
+
+void UpstreamLink::Splice(IPipelineElementUpstream& aUpstream)
+{
+    iUpstream.store(&aUpstream, std::memory_order_release);
+}
+
+
 // MsgQuit
 
 MsgQuit::MsgQuit(AllocatorBase& aAllocator)
@@ -2547,11 +3584,121 @@ TUint MsgQueue::NumMsgs() const
 }
 
 
+// MsgRing
+
+MsgRing::MsgRing(TUint aCapacity)
+    : iHead(0)
+    , iTail(0)
+    , iMask(aCapacity - 1)
+    , iLockOverflow("MSGR")
+    , iOverflowCount(0)
+    , iNumMsgs(0)
+    , iConsumerWaiting(false)
+    , iSem("MSGR", 0)
+{
+    ASSERT(aCapacity > 0 && (aCapacity & iMask) == 0);
+    ASSERT(iHead.is_lock_free());
+    ASSERT(iConsumerWaiting.is_lock_free());
+    iSlots = new Msg*[aCapacity];
+}
+
+MsgRing::~MsgRing()
+{
+    for (TUint head=iHead.load(); head!=iTail.load(); head++) {
+        iSlots[head & iMask]->RemoveRef();
+    }
+    delete[] iSlots;
+}
+
+void MsgRing::Enqueue(Msg* aMsg)
+{
+    ASSERT(aMsg != nullptr);
+    iNumMsgs++; // before msg is visible to the consumer so that its decrement can't wrap
+    const TUint tail = iTail.load(std::memory_order_relaxed);
+    if (iOverflowCount.load(std::memory_order_acquire) == 0 &&
+        tail - iHead.load(std::memory_order_acquire) <= iMask) {
+        iSlots[tail & iMask] = aMsg;
+        iTail.store(tail + 1, std::memory_order_release);
+    }
+    else {
+        // ring is full, or earlier msgs have already spilled and must be output first
+        AutoMutex _(iLockOverflow);
+        iOverflow.Enqueue(aMsg);
+        iOverflowCount.fetch_add(1, std::memory_order_release);
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (iConsumerWaiting.exchange(false)) {
+        iSem.Signal();
+    }
+}
+
+Msg* MsgRing::Dequeue()
+{
+    for (;;) {
+        Msg* msg = TryDequeue();
+        if (msg != nullptr) {
+            return msg;
+        }
+        iConsumerWaiting.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        msg = TryDequeue();
+        if (msg != nullptr) {
+            (void)iConsumerWaiting.exchange(false); // may leave a stale signal on iSem; harmless as we always re-check after waiting
+            return msg;
+        }
+        iSem.Wait();
+    }
+}
+
+void MsgRing::EnqueueAtHead(Msg* aMsg)
+{
+    iRequeued.EnqueueAtHead(aMsg);
+    iNumMsgs++;
+}
+
+TBool MsgRing::IsEmpty() const
+{
+    return iNumMsgs.load() == 0;
+}
+
+TUint MsgRing::NumMsgs() const
+{
+    return iNumMsgs.load();
+}
+
+Msg* MsgRing::TryDequeue()
+{
+    Msg* msg = nullptr;
+    if (!iRequeued.IsEmpty()) {
+        msg = iRequeued.Dequeue();
+    }
+    else {
+        /* Read iOverflowCount before iTail.  Any ring slots filled before msgs spilled are
+           then guaranteed to be visible and are output ahead of the overflow list. */
+        const TUint overflowCount = iOverflowCount.load(std::memory_order_acquire);
+        const TUint head = iHead.load(std::memory_order_relaxed);
+        if (head != iTail.load(std::memory_order_acquire)) {
+            msg = iSlots[head & iMask];
+            iHead.store(head + 1, std::memory_order_release);
+        }
+        else if (overflowCount > 0) {
+            AutoMutex _(iLockOverflow);
+            msg = iOverflow.Dequeue();
+            iOverflowCount.fetch_sub(1, std::memory_order_release);
+        }
+        else {
+            return nullptr;
+        }
+    }
+    iNumMsgs--;
+    return msg;
+}
+
+
 // MsgReservoir
 
 MsgReservoir::MsgReservoir()
-    : iLockEncoded("MSGR")
-    , iEncodedBytes(0)
+    : iEncodedBytes(0)
     , iJiffies(0)
     , iTrackCount(0)
     , iEncodedStreamCount(0)
@@ -2564,6 +3711,8 @@ MsgReservoir::MsgReservoir()
     ASSERT(iEncodedStreamCount.is_lock_free());
     ASSERT(iDecodedStreamCount.is_lock_free());
     ASSERT(iDecodedAudioCount.is_lock_free());
+    ASSERT(iEncodedBytes.is_lock_free());
+    ASSERT(iEncodedAudioCount.is_lock_free());
 }
 
 MsgReservoir::~MsgReservoir()
@@ -2603,7 +3752,6 @@ TUint MsgReservoir::Jiffies() const
 
 TUint MsgReservoir::EncodedBytes() const
 {
-    AutoMutex _(iLockEncoded);
     return iEncodedBytes;
 }
 
@@ -2629,7 +3777,6 @@ TUint MsgReservoir::DecodedStreamCount() const
 
 TUint MsgReservoir::EncodedAudioCount() const
 {
-    AutoMutex _(iLockEncoded);
     return iEncodedAudioCount;
 }
 
@@ -2699,7 +3846,6 @@ Msg* MsgReservoir::ProcessorEnqueue::ProcessMsg(MsgEncodedStream* aMsg)
 
 Msg* MsgReservoir::ProcessorEnqueue::ProcessMsg(MsgAudioEncoded* aMsg)
 {
-    AutoMutex _(iQueue.iLockEncoded);
     iQueue.iEncodedAudioCount++;
     iQueue.iEncodedBytes += aMsg->Bytes();
     return aMsg;
@@ -2894,11 +4040,8 @@ Msg* MsgReservoir::ProcessorQueueOut::ProcessMsg(MsgEncodedStream* aMsg)
 
 Msg* MsgReservoir::ProcessorQueueOut::ProcessMsg(MsgAudioEncoded* aMsg)
 {
-    {
-        AutoMutex _(iQueue.iLockEncoded);
-        iQueue.iEncodedAudioCount--;
-        iQueue.iEncodedBytes -= aMsg->Bytes();
-    }
+    iQueue.iEncodedAudioCount--;
+    iQueue.iEncodedBytes -= aMsg->Bytes();
     return iQueue.ProcessMsgOut(aMsg);
 }
 
@@ -3126,26 +4269,28 @@ Track* TrackFactory::CreateNullTrack()
 // MsgFactory
 
 MsgFactory::MsgFactory(IInfoAggregator& aInfoAggregator, const MsgFactoryInitParams& aInitParams)
-    : iAllocatorMsgMode("MsgMode", aInitParams.iMsgModeCount, aInfoAggregator)
-    , iAllocatorMsgTrack("MsgTrack", aInitParams.iMsgTrackCount, aInfoAggregator)
-    , iAllocatorMsgDrain("MsgDrain", aInitParams.iMsgDrainCount, aInfoAggregator)
+    : iAllocatorMsgMode("MsgMode", aInitParams.iMsgModeCount, aInfoAggregator, aInitParams.iAllocatorImpl, aInitParams.iAllocatorStorage, aInitParams.iAllocatorGrowth)
+    , iAllocatorMsgTrack("MsgTrack", aInitParams.iMsgTrackCount, aInfoAggregator, aInitParams.iAllocatorImpl, aInitParams.iAllocatorStorage, aInitParams.iAllocatorGrowth)
+    , iAllocatorMsgDrain("MsgDrain", aInitParams.iMsgDrainCount, aInfoAggregator, aInitParams.iAllocatorImpl, aInitParams.iAllocatorStorage, aInitParams.iAllocatorGrowth)
     , iDrainId(0)
-    , iAllocatorMsgDelay("MsgDelay", aInitParams.iMsgDelayCount, aInfoAggregator)
-    , iAllocatorMsgEncodedStream("MsgEncodedStream", aInitParams.iMsgEncodedStreamCount, aInfoAggregator)
-    , iAllocatorAudioData("AudioData", aInitParams.iEncodedAudioCount + aInitParams.iDecodedAudioCount, aInfoAggregator)
-    , iAllocatorMsgAudioEncoded("MsgAudioEncoded", aInitParams.iMsgAudioEncodedCount, aInfoAggregator)
-    , iAllocatorMsgMetaText("MsgMetaText", aInitParams.iMsgMetaTextCount, aInfoAggregator)
-    , iAllocatorMsgStreamInterrupted("MsgStreamInterrupted", aInitParams.iMsgStreamInterruptedCount, aInfoAggregator)
-    , iAllocatorMsgHalt("MsgHalt", aInitParams.iMsgHaltCount, aInfoAggregator)
-    , iAllocatorMsgFlush("MsgFlush", aInitParams.iMsgFlushCount, aInfoAggregator)
-    , iAllocatorMsgWait("MsgWait", aInitParams.iMsgWaitCount, aInfoAggregator)
-    , iAllocatorMsgDecodedStream("MsgDecodedStream", aInitParams.iMsgDecodedStreamCount, aInfoAggregator)
-    , iAllocatorMsgBitRate("MsgBitRate", aInitParams.iMsgBitRateCount, aInfoAggregator)
-    , iAllocatorMsgAudioPcm("MsgAudioPcm", aInitParams.iMsgAudioPcmCount, aInfoAggregator)
-    , iAllocatorMsgSilence("MsgSilence", aInitParams.iMsgSilenceCount, aInfoAggregator)
-    , iAllocatorMsgPlayablePcm("MsgPlayablePcm", aInitParams.iMsgPlayablePcmCount, aInfoAggregator)
-    , iAllocatorMsgPlayableSilence("MsgPlayableSilence", aInitParams.iMsgPlayableSilenceCount, aInfoAggregator)
-    , iAllocatorMsgQuit("MsgQuit", aInitParams.iMsgQuitCount, aInfoAggregator)
+    , iAllocatorMsgDelay("MsgDelay", aInitParams.iMsgDelayCount, aInfoAggregator, aInitParams.iAllocatorImpl, aInitParams.iAllocatorStorage, aInitParams.iAllocatorGrowth)
+    , iAllocatorMsgEncodedStream("MsgEncodedStream", aInitParams.iMsgEncodedStreamCount, aInfoAggregator, aInitParams.iAllocatorImpl, aInitParams.iAllocatorStorage, aInitParams.iAllocatorGrowth)
+    , iAllocatorAudioData(aInfoAggregator, aInitParams.iEncodedAudioCount + aInitParams.iDecodedAudioCount, aInitParams.iAudioDataSizeClasses,
+                          aInitParams.iAllocatorImpl, aInitParams.iAllocatorStorage, aInitParams.iAllocatorGrowth)
+    , iAllocatorMsgAudioEncoded("MsgAudioEncoded", aInitParams.iMsgAudioEncodedCount, aInfoAggregator, aInitParams.iAllocatorImpl, aInitParams.iAllocatorStorage, aInitParams.iAllocatorGrowth)
+    , iAllocatorMsgMetaText("MsgMetaText", aInitParams.iMsgMetaTextCount, aInfoAggregator, aInitParams.iAllocatorImpl, aInitParams.iAllocatorStorage, aInitParams.iAllocatorGrowth)
+    , iAllocatorMsgStreamInterrupted("MsgStreamInterrupted", aInitParams.iMsgStreamInterruptedCount, aInfoAggregator, aInitParams.iAllocatorImpl, aInitParams.iAllocatorStorage, aInitParams.iAllocatorGrowth)
+    , iAllocatorMsgHalt("MsgHalt", aInitParams.iMsgHaltCount, aInfoAggregator, aInitParams.iAllocatorImpl, aInitParams.iAllocatorStorage, aInitParams.iAllocatorGrowth)
+    , iAllocatorMsgFlush("MsgFlush", aInitParams.iMsgFlushCount, aInfoAggregator, aInitParams.iAllocatorImpl, aInitParams.iAllocatorStorage, aInitParams.iAllocatorGrowth)
+    , iAllocatorMsgWait("MsgWait", aInitParams.iMsgWaitCount, aInfoAggregator, aInitParams.iAllocatorImpl, aInitParams.iAllocatorStorage, aInitParams.iAllocatorGrowth)
+    , iAllocatorMsgDecodedStream("MsgDecodedStream", aInitParams.iMsgDecodedStreamCount, aInfoAggregator, aInitParams.iAllocatorImpl, aInitParams.iAllocatorStorage, aInitParams.iAllocatorGrowth)
+    , iAllocatorMsgBitRate("MsgBitRate", aInitParams.iMsgBitRateCount, aInfoAggregator, aInitParams.iAllocatorImpl, aInitParams.iAllocatorStorage, aInitParams.iAllocatorGrowth)
+    , iAllocatorMsgAudioPcm("MsgAudioPcm", aInitParams.iMsgAudioPcmCount, aInfoAggregator, aInitParams.iAllocatorImpl, aInitParams.iAllocatorStorage, aInitParams.iAllocatorGrowth)
+    , iAllocatorMsgSilence("MsgSilence", aInitParams.iMsgSilenceCount, aInfoAggregator, aInitParams.iAllocatorImpl, aInitParams.iAllocatorStorage, aInitParams.iAllocatorGrowth)
+    , iAllocatorMsgPlayablePcm("MsgPlayablePcm", aInitParams.iMsgPlayablePcmCount, aInfoAggregator, aInitParams.iAllocatorImpl, aInitParams.iAllocatorStorage, aInitParams.iAllocatorGrowth)
+    , iAllocatorMsgPlayableSilence("MsgPlayableSilence", aInitParams.iMsgPlayableSilenceCount, aInfoAggregator, aInitParams.iAllocatorImpl, aInitParams.iAllocatorStorage, aInitParams.iAllocatorGrowth)
+    , iAllocatorMsgQuit("MsgQuit", aInitParams.iMsgQuitCount, aInfoAggregator, aInitParams.iAllocatorImpl, aInitParams.iAllocatorStorage, aInitParams.iAllocatorGrowth)
+    , iDecodedAudioFormat(aInitParams.iDecodedAudioFormat)
 {
 }
 
@@ -3292,6 +4437,12 @@ MsgAudioPcm* MsgFactory::CreateMsgAudioPcm(const Brx& aData, TUint aChannels, TU
 
 MsgAudioPcm* MsgFactory::CreateMsgAudioPcm(MsgAudioEncoded* aAudio, TUint aChannels, TUint aSampleRate, TUint aBitDepth, TUint64 aTrackOffset)
 {
+    if (iDecodedAudioFormat == DecodedAudioFormat::NativeInt32) {
+        // can't share aAudio's data; convert it into a new DecodedAudio
+        ASSERT(aAudio->iNextAudio == nullptr);
+        Brn data(aAudio->iAudioData->Ptr(aAudio->iOffset), aAudio->iSize);
+        return CreateMsgAudioPcm(data, aChannels, aSampleRate, aBitDepth, AudioDataEndian::Big, aTrackOffset);
+    }
     AudioData* audioData = aAudio->iAudioData;
     audioData->AddRef();
     return CreateMsgAudioPcm(static_cast<DecodedAudio*>(audioData),
@@ -3310,16 +4461,28 @@ MsgQuit* MsgFactory::CreateMsgQuit()
     return iAllocatorMsgQuit.Allocate();
 }
 
+DecodedAudioFormat MsgFactory::DecodedFormat() const
+{
+    return iDecodedAudioFormat;
+}
+
 EncodedAudio* MsgFactory::CreateEncodedAudio(const Brx& aData)
 {
-    EncodedAudio* encodedAudio = static_cast<EncodedAudio*>(iAllocatorAudioData.Allocate());
+    EncodedAudio* encodedAudio = iAllocatorAudioData.AllocateEncoded();
     encodedAudio->Construct(aData);
     return encodedAudio;
 }
 
 DecodedAudio* MsgFactory::CreateDecodedAudio(const Brx& aData, TUint aBitDepth, AudioDataEndian aEndian)
 {
-    DecodedAudio* decodedAudio = static_cast<DecodedAudio*>(iAllocatorAudioData.Allocate());
+    if (iDecodedAudioFormat == DecodedAudioFormat::NativeInt32) {
+        ASSERT((aBitDepth & 7) == 0);
+        const TUint bytes = (aData.Bytes() / (aBitDepth/8)) * DecodedAudio::kNativeBytesPerSubsample;
+        DecodedAudio* decodedAudio = iAllocatorAudioData.AllocateDecoded(bytes);
+        decodedAudio->ConstructNative32(aData, aBitDepth, aEndian);
+        return decodedAudio;
+    }
+    DecodedAudio* decodedAudio = iAllocatorAudioData.AllocateDecoded(aData.Bytes());
     decodedAudio->Construct(aData, aBitDepth, aEndian);
     return decodedAudio;
 }
@@ -3328,7 +4491,7 @@ MsgAudioPcm* MsgFactory::CreateMsgAudioPcm(DecodedAudio* aAudioData, TUint aChan
 {
     MsgAudioPcm* msg = iAllocatorMsgAudioPcm.Allocate();
     try {
-        msg->Initialise(aAudioData, aSampleRate, aBitDepth, aChannels, aTrackOffset,
+        msg->Initialise(aAudioData, iDecodedAudioFormat, aSampleRate, aBitDepth, aChannels, aTrackOffset, iAllocatorAudioData,
                         iAllocatorMsgPlayablePcm, iAllocatorMsgPlayableSilence);
     }
     catch (AssertionFailed&) { // test code helper
@@ -10,26 +10,64 @@
 #include <OpenHome/Private/Thread.h>
 #include <OpenHome/Private/InfoProvider.h>
 #include <OpenHome/Optional.h>
+#include <OpenHome/Media/Pipeline/LatencyTracer.h>
 
 #include <limits.h>
 #include <atomic>
+#include <new>
 
 EXCEPTION(SampleRateInvalid);
 EXCEPTION(SampleRateUnsupported);
-
-#undef TIMESTAMP_LOGGING_ENABLE
+EXCEPTION(AllocatorNoMemory);
 
 namespace OpenHome {
 namespace Media {
 
 class Allocated;
 
+/*
+ Controls whether an Allocator creates all of its cells up front (the default) or
+ starts with a single chunk, growing on demand up to its capacity and returning
+ idle chunks once usage has stayed low for aShrinkAfterMs.  (Shrinking is only
+ checked when a cell is allocated so an idle pool keeps its chunks.)
+ A full elastic pool blocks Allocate() for up to aFullTimeoutMs waiting for a cell
+ to be freed, then throws AllocatorNoMemory.  0 waits indefinitely.
+ Elastic pools must be Impl::eLocking and Storage::eHeap.
+*/
+class AllocatorGrowth
+{
+public:
+    inline AllocatorGrowth(); // fixed size
+    inline AllocatorGrowth(TUint aChunks, TUint aShrinkAfterMs, TUint aFullTimeoutMs);
+    inline TBool Elastic() const;
+    inline TUint Chunks() const;
+    inline TUint ShrinkAfterMs() const;
+    inline TUint FullTimeoutMs() const;
+private:
+    TUint iChunks;
+    TUint iShrinkAfterMs;
+    TUint iFullTimeoutMs;
+};
+
 class AllocatorBase : private IInfoProvider
 {
+public:
+    enum class Impl
+    {
+        eLocking,  // mutex protected fifo
+        eLockFree  // lock-free (tagged index) stack.  Falls back to eLocking if 64-bit atomics aren't lock-free
+    };
+    enum class Storage
+    {
+        eHeap,      // each cell is a separate heap allocation
+        eSlab,      // all cells are constructed in a single cache-line aligned block
+        eSlabLocked // as eSlab but page aligned, backed by huge pages where possible and locked into RAM
+    };
 public:
     ~AllocatorBase();
     void Free(Allocated* aPtr);
     TUint CellsTotal() const;
+    TUint CellsCreated() const;
     TUint CellBytes() const;
     TUint CellsUsed() const;
     TUint CellsUsedMax() const;
@@ -37,36 +75,92 @@ public:
     inline const TChar* Name() const;
     static const Brn kQueryMemory;
 protected:
-    AllocatorBase(const TChar* aName, TUint aNumCells, TUint aCellBytes, IInfoAggregator& aInfoAggregator);
+    AllocatorBase(const TChar* aName, TUint aNumCells, TUint aCellBytes, IInfoAggregator& aInfoAggregator,
+                  Impl aImpl, Storage aStorage, const AllocatorGrowth& aGrowth);
+    TUint InitialCells() const;
+    void* SlabCell(TUint aIndex) const; // nullptr if cells should be heap allocated
+    void Add(Allocated* aCell); // only valid during construction or while growing
     Allocated* DoAllocate();
+    Allocated* TryDoAllocate(); // nullptr if the pool is at capacity (never blocks)
+protected:
+    static const TUint kCacheLineBytes = 64;
 private:
+    void CreateSlab();
+    void DestroySlab();
+    virtual Allocated* NewCell() = 0;
     Allocated* Read();
+    Allocated* ReadElastic();
+    Allocated* AllocateLocked();
+    Allocated* Claim(Allocated* aCell);
+    void Grow();
+    void CheckShrink();
+    static TUint NowMs();
+    Allocated* ReadLockFree();
+    Allocated* TryReadLockFree(); // nullptr if no cell is free
+    void WriteLockFree(Allocated* aCell);
+    void CellAllocated();
 private: // from IInfoProvider
     void QueryInfo(const Brx& aQuery, IWriter& aWriter);
-protected:
-    FifoLiteDynamic<Allocated*> iFree;
 private:
+    static const TUint32 kIndexNone = 0xffffffff;
+    static const TUint64 kTagIncrement = 1ULL << 32;
+    static const TUint64 kTagMask = 0xffffffff00000000ULL;
+private:
+    FifoLiteDynamic<Allocated*> iFree;
     mutable Mutex iLock;
     const TChar* iName;
     const TUint iCellsTotal;
     const TUint iCellBytes;
-    TUint iCellsUsed;
-    TUint iCellsUsedMax;
+    Impl iImpl;
+    Storage iStorage;
+    TByte* iSlab;        // eSlab/eSlabLocked only.  Aligned start of first cell
+    void* iSlabAlloc;    // eSlab/eSlabLocked only.  Block to be released on destruction
+    TUint iSlabBytes;
+    TUint iSlabStride;   // bytes between the start of adjacent cells
+    TBool iSlabMapped;   // iSlabAlloc came from mmap rather than malloc
+    TBool iSlabLocked;
+    TUint iCellsAdded;
+    TUint iChunkCells;      // elastic pools only; 0 for fixed size
+    TUint iShrinkAfterMs;
+    TUint iFullTimeoutMs;
+    TUint iWindowStartMs;   // time usage was last checked for shrinking
+    TUint iWindowPeak;      // peak cells used since usage was last checked for shrinking
+    TUint iGrowCount;
+    TUint iShrinkCount;
+    TUint iWaiters;         // Allocate() calls blocked on a full elastic pool
+    Semaphore iSemFree;
+    Allocated** iCells;              // eLockFree only.  Indexed by Allocated::iAllocatorIndex
+    std::atomic<TUint32>* iNextFree; // eLockFree only.  Index of the free cell following each cell
+    std::atomic<TUint64> iHead;      // eLockFree only.  (tag << 32) | index of first free cell
+    std::atomic<TUint> iCellsUsed;
+    std::atomic<TUint> iCellsUsedMax;
 };
 
 template <class T> class Allocator : public AllocatorBase
 {
 public:
-    Allocator(const TChar* aName, TUint aNumCells, IInfoAggregator& aInfoAggregator);
+    Allocator(const TChar* aName, TUint aNumCells, IInfoAggregator& aInfoAggregator, Impl aImpl = Impl::eLocking,
+              Storage aStorage = Storage::eHeap, const AllocatorGrowth& aGrowth = AllocatorGrowth());
     virtual ~Allocator();
     T* Allocate();
-};
-
-template <class T> Allocator<T>::Allocator(const TChar* aName, TUint aNumCells, IInfoAggregator& aInfoAggregator)
-    : AllocatorBase(aName, aNumCells, sizeof(T), aInfoAggregator)
-{
-    for (TUint i=0; i<aNumCells; i++) {
-        iFree.Write(new T(*this));
+    T* TryAllocate(); // nullptr if the pool is at capacity
+private: // from AllocatorBase
+    Allocated* NewCell() override;
+};
+
+template <class T> Allocator<T>::Allocator(const TChar* aName, TUint aNumCells, IInfoAggregator& aInfoAggregator, Impl aImpl, Storage aStorage, const AllocatorGrowth& aGrowth)
+    : AllocatorBase(aName, aNumCells, sizeof(T), aInfoAggregator, aImpl, aStorage, aGrowth)
+{
+    static_assert(alignof(T) <= kCacheLineBytes, "Allocator slab can't satisfy cell alignment");
+    const TUint initialCells = InitialCells();
+    for (TUint i=0; i<initialCells; i++) {
+        void* cell = SlabCell(i);
+        if (cell == nullptr) {
+            Add(new T(*this));
+        }
+        else {
+            Add(new (cell) T(*this));
+        }
     }
 }
 
@@ -79,6 +173,16 @@ template <class T> T* Allocator<T>::Allocate()
     return static_cast<T*>(DoAllocate());
 }
 
+template <class T> T* Allocator<T>::TryAllocate()
+{
+    return static_cast<T*>(TryDoAllocate());
+}
+
+template <class T> Allocated* Allocator<T>::NewCell()
+{
+    return new T(*this);
+}
+
 class Logger;
 
 class Allocated
@@ -99,6 +203,7 @@ protected:
     AllocatorBase& iAllocator;
 private:
     std::atomic<TUint> iRefCount;
+    TUint iAllocatorIndex;
 };
 
 enum class AudioDataEndian
@@ -108,40 +213,41 @@ enum class AudioDataEndian
     Big
 };
 
+/**
+ * Layout of pcm held in DecodedAudio.
+ *
+ * Packed is big endian data at the stream's bit depth.
+ * NativeInt32 is one host endian TInt32 per subsample, left-aligned so that the stream's
+ * bit depth is held in the most significant bits.
+ */
+enum class DecodedAudioFormat
+{
+    Packed,
+    NativeInt32
+};
+
 class AudioData : public Allocated
 {
 public: 
     static const TUint kMaxBytes = 7680; // max of 2ms/10ch/96/32 and 5ms/2ch/192/24 (latter for Songcast, supporting earliest receiver)
 public:
-    AudioData(AllocatorBase& aAllocator);
     const TByte* Ptr(TUint aOffsetBytes) const;
     TUint Bytes() const;
-#ifdef TIMESTAMP_LOGGING_ENABLE
-    void SetTimestamp(const TChar* aId);
-    TBool TryLogTimestamps();
-#endif
+    TUint MaxBytes() const;
+    inline TBool IsLatencyTraced() const;
+    void StartLatencyTrace(); // records LatencyPoint::eProtocol
+    void SetLatencyTrace(const LatencyTrace& aTrace);
+    const LatencyTrace& GetLatencyTrace() const;
+    void AddLatencyStamp(LatencyPoint aPoint); // completes the trace on LatencyPoint::eAnimator
+protected:
+    AudioData(AllocatorBase& aAllocator, TByte* aStorage, TUint aMaxBytes);
 private: // from Allocated
     void Clear() override;
 protected:
-    Bws<kMaxBytes> iData;
-#ifdef TIMESTAMP_LOGGING_ENABLE
+    Bwn iData;
 private:
-    class Timestamp
-    {
-    public:
-        Timestamp();
-        void Reset();
-        void Set(const TChar* aId, TUint64 aTimestamp);
-        TBool TryLog();
-    private:
-        const TChar* iId;
-        TUint64 iTimestamp;
-    };
-    static const TUint kMaxTimestamps = 20;
-    Timestamp iTimestamps[kMaxTimestamps];
-    TUint iNextTimestampIndex;
-    OsContext* iOsCtx;
-#endif // TIMESTAMP_LOGGING_ENABLE
+    TBool iLatencyTraced;
+    LatencyTrace iLatencyTrace;
 };
 
 class EncodedAudio : public AudioData
@@ -150,7 +256,6 @@ class EncodedAudio : public AudioData
 public:
     TUint Append(const Brx& aData); // returns number of bytes appended
 private:
-    EncodedAudio(AllocatorBase& aAllocator);
     void Construct(const Brx& aData);
 };
 
@@ -159,16 +264,83 @@ class DecodedAudio : public AudioData
     friend class MsgFactory;
 public:
     static const TUint kMaxNumChannels = 8;
+    static const TUint kNativeBytesPerSubsample = 4;
 public:
     void Aggregate(DecodedAudio& aDecodedAudio);
+    static TUint BytesPerSubsample(TUint aBitDepth, DecodedAudioFormat aFormat);
+    static void ToNative32(const Brx& aData, TUint aBitDepth, AudioDataEndian aEndian, TInt32* aDest);
+    static void FromNative32(const TInt32* aSrc, TUint aNumSubsamples, TUint aBitDepth, TByte* aDest); // writes packed big endian
 private:
-    DecodedAudio(AllocatorBase& aAllocator);
     void Construct(const Brx& aData, TUint aBitDepth, AudioDataEndian aEndian);
+    void ConstructNative32(const Brx& aData, TUint aBitDepth, AudioDataEndian aEndian);
     static void CopyToBigEndian16(const Brx& aData, TByte* aDest);
     static void CopyToBigEndian24(const Brx& aData, TByte* aDest);
     static void CopyToBigEndian32(const Brx& aData, TByte* aDest);
 };
 
+/**
+ * AudioData with inline storage for up to kBytes of audio.
+ *
+ * Cells are only accessed as AudioData, EncodedAudio or DecodedAudio.
+ */
+template <TUint kBytes> class AudioDataSized : public AudioData
+{
+public:
+    AudioDataSized(AllocatorBase& aAllocator);
+private:
+    alignas(8) TByte iStorage[kBytes]; // DecodedAudioFormat::NativeInt32 reads this as TInt32
+};
+
+template <TUint kBytes> AudioDataSized<kBytes>::AudioDataSized(AllocatorBase& aAllocator)
+    : AudioData(aAllocator, iStorage, kBytes)
+{
+}
+
+/**
+ * Owns the pool(s) that EncodedAudio and DecodedAudio are allocated from.
+ *
+ * By default, a single pool of AudioData::kMaxBytes cells is used.  If size classes
+ * are enabled, DecodedAudio is instead allocated from the smallest of 1k, 2k, 4k or
+ * kMaxBytes pools that can hold it.  EncodedAudio is always appended to so is always
+ * allocated from the kMaxBytes pool.
+ *
+ * Every pool uses the caller's Impl and Storage.  Locking, heap allocated pools are
+ * made elastic (see AllocatorGrowth) if the caller didn't ask for growth so memory is
+ * only committed for the classes in use.  Lock-free and slab pools can't grow so the
+ * size classes are then fixed size and always commit their ceiling.
+ *
+ * The kMaxBytes pool keeps the full cell count so anything that fitted a single pool
+ * still fits.  The 1k, 2k and 4k pools share the cell count between them; a full class
+ * falls through to the next larger one.  The ceiling is therefore
+ * aNumCells * (kMaxBytes + (1k + 2k + 4k) / kNumSizeClasses) bytes, around 1.25x a
+ * single pool.
+ */
+class AudioDataAllocator : private INonCopyable
+{
+public:
+    static const TUint kNumSizeClasses = 4;
+    static const TUint kSizeClass1k = 1024;
+    static const TUint kSizeClass2k = 2048;
+    static const TUint kSizeClass4k = 4096;
+public:
+    AudioDataAllocator(IInfoAggregator& aInfoAggregator, TUint aNumCells, TBool aSizeClasses,
+                       AllocatorBase::Impl aImpl, AllocatorBase::Storage aStorage, const AllocatorGrowth& aGrowth);
+    ~AudioDataAllocator();
+    EncodedAudio* AllocateEncoded();
+    DecodedAudio* AllocateDecoded(TUint aBytes);
+private:
+    static AllocatorGrowth SizeClassGrowth(AllocatorBase::Impl aImpl, AllocatorBase::Storage aStorage, const AllocatorGrowth& aGrowth);
+private:
+    static const TUint kSizeClassChunks = 16;
+    static const TUint kSizeClassShrinkAfterMs = 10000;
+    static const TUint kSizeClassFullTimeoutMs = 1000;
+private:
+    Allocator<AudioDataSized<kSizeClass1k>>* iAllocator1k; // nullptr unless size classes are enabled
+    Allocator<AudioDataSized<kSizeClass2k>>* iAllocator2k; // nullptr unless size classes are enabled
+    Allocator<AudioDataSized<kSizeClass4k>>* iAllocator4k; // nullptr unless size classes are enabled
+    Allocator<AudioDataSized<AudioData::kMaxBytes>> iAllocatorMax;
+};
+
 /**
  * Provides the pipeline's unit of timing.
  *
@@ -249,6 +421,7 @@ public:
     TBool Set(TUint aStart, TUint aFragmentSize, TUint aRemainingDuration, EDirection aDirection, Ramp& aSplit, TUint& aSplitPos); // returns true iff aSplit is set
     void SetMuted();
     Ramp Split(TUint aNewSize, TUint aCurrentSize);
+    void Join(const Ramp& aFollowing); // replace this ramp and the one that immediately follows it with a single ramp that is never louder than either
     inline TUint Start() const;
     inline TUint End() const;
     inline EDirection Direction() const;
@@ -265,22 +438,47 @@ private:
     TUint iAttenuation;
 };
 
+/**
+ * Applies a ramp to a block of audio.
+ *
+ * Gain is interpolated between kRampArray entries for every sample and applied to the
+ * full width of each subsample.  Start() selects a kernel specialised for the bit depth
+ * and channel count; Apply()/ApplyNative32() can then be called repeatedly to ramp
+ * successive blocks of the audio passed to Start().
+ */
 class RampApplicator : private INonCopyable
 {
+public:
+    static const TUint kGainShift = 20; // gains are fixed point with this many fractional bits
+private:
     static const TUint kFullRampSpan;
+    static const TUint kMaxGainBlock = 128;
+    typedef void (*Kernel)(const TByte* aSrc, TByte* aDest, const TInt32* aGains, TUint aNumSamples, TUint aNumChannels);
 public:
     RampApplicator(const Media::Ramp& aRamp);
     TUint Start(const Brx& aData, TUint aBitDepth, TUint aNumChannels); // returns number of samples
-    void GetNextSample(TByte* aDest);
+    TUint Apply(TByte* aDest, TUint aMaxSamples); // writes packed big endian samples; returns number of samples written
+    TUint ApplyNative32(TInt32* aDest, TUint aMaxSamples); // Start() must have been passed native audio and a bit depth of 32
     static TUint MedianMultiplier(const Media::Ramp& aRamp);
+    static TInt32 Gain(TUint aRamp); // aRamp in [Ramp::kMin..Ramp::kMax]
+private:
+    TUint ApplyBlocks(Kernel aKernel, TByte* aDest, TUint aMaxSamples);
+    void NextGains(TUint aNumSamples);
 private:
     const Media::Ramp& iRamp;
     const TByte* iPtr;
-    TUint iBitDepth;
+    TUint iBytesPerSubsample;
     TUint iNumChannels;
-    TInt iNumSamples;
-    TInt iTotalRamp;
-    TInt iLoopCount;
+    TUint iRemaining;
+    Kernel iKernelPacked;
+    Kernel iKernelNative32;
+    TBool iRampDown;
+    TUint iDivisor;
+    TUint iStepQuotient;
+    TUint iStepRemainder;
+    TUint iQuotient;
+    TUint iRemainder;
+    TInt32 iGains[kMaxGainBlock];
 };
 
 class MsgFactory;
@@ -587,7 +785,10 @@ public:
     TUint Bytes() const;
     void CopyTo(TByte* aPtr);
     MsgAudioEncoded* Clone();
-    inline void AddLogPoint(const TChar* aId);
+    inline void TryStartLatencyTrace(); // traces one msg in every LatencyTracer::SampleInterval()
+    inline TBool IsLatencyTraced() const;
+    const LatencyTrace& GetLatencyTrace() const;
+    inline void AddLogPoint(LatencyPoint aPoint);
 private:
     void Initialise(EncodedAudio* aEncodedAudio);
 private: // from Msg
@@ -731,10 +932,23 @@ public:
     MsgAudio* Split(TUint aJiffies); // returns block after aAt
     virtual MsgAudio* Clone(); // create new MsgAudio, copy size/offset
     TUint Jiffies() const;
-    TUint SetRamp(TUint aStart, TUint& aRemainingDuration, Ramp::EDirection aDirection, MsgAudio*& aSplit); // returns iRamp.End()
+    /**
+     * Apply a ramp to this msg, merging it with any existing ramp.
+     *
+     * A ramp up applied to an unramped msg may end part way through it; later audio is
+     * left unramped (see RampJiffies()).  Audio beyond the end of any other ramp may need
+     * to be muted, discarded or ramped differently so is split off and returned via aSplit.
+     * aSplit is also set if the new ramp intersects an existing one.  Callers should
+     * enqueue aSplit ahead of any later msgs.
+     *
+     * @return  iRamp.End()
+     */
+    TUint SetRamp(TUint aStart, TUint& aRemainingDuration, Ramp::EDirection aDirection, MsgAudio*& aSplit);
     void ClearRamp();
     void SetMuted(); // should only be used with msgs immediately following a ramp down
+    void RestoreRamp(const Media::Ramp& aRamp); // replaces any ramp with aRamp (as previously read from Ramp()), applied to the whole msg
     const Media::Ramp& Ramp() const;
+    TUint RampJiffies() const; // jiffies at the start of this msg that Ramp() applies to; any later audio is unramped
     TUint MedianRampMultiplier(); // 1<<31 => full level.  Note - clears any existing ramp
 protected:
     MsgAudio(AllocatorBase& aAllocator);
@@ -748,6 +962,7 @@ protected:
     TUint iSize; // Jiffies
     TUint iOffset; // Jiffies
     Media::Ramp iRamp;
+    TUint iRampJiffies; // 0 => iRamp covers the whole msg
     TUint iSampleRate;
     TUint iBitDepth;
     TUint iNumChannels;
@@ -785,11 +1000,14 @@ public:
     MsgPlayable* CreatePlayable(); // removes ref, transfer ownership of DecodedAudio
     void Aggregate(MsgAudioPcm* aMsg); // append aMsg to the end of this msg, removes ref on aMsg
     void SetAttenuation(TUint aAttenuation);
-    inline void AddLogPoint(const TChar* aId);
+    DecodedAudioFormat Format() const;
+    void SetLatencyTrace(const LatencyTrace& aTrace);
+    inline void AddLogPoint(LatencyPoint aPoint);
 public: // from MsgAudio
     MsgAudio* Clone() override; // create new MsgAudio, take ref to DecodedAudio, copy size/offset
 private:
-    void Initialise(DecodedAudio* aDecodedAudio, TUint aSampleRate, TUint aBitDepth, TUint aChannels, TUint64 aTrackOffset,
+    void Initialise(DecodedAudio* aDecodedAudio, DecodedAudioFormat aFormat, TUint aSampleRate, TUint aBitDepth, TUint aChannels, TUint64 aTrackOffset,
+                    AudioDataAllocator& aAllocatorAudioData,
                     Allocator<MsgPlayablePcm>& aAllocatorPlayablePcm,
                     Allocator<MsgPlayableSilence>& aAllocatorPlayableSilence);
 private: // from MsgAudio
@@ -800,6 +1018,8 @@ private: // from Msg
     Msg* Process(IMsgProcessor& aProcessor) override;
 private:
     DecodedAudio* iAudioData;
+    DecodedAudioFormat iFormat;
+    AudioDataAllocator* iAllocatorAudioData;
     Allocator<MsgPlayablePcm>* iAllocatorPlayablePcm;
     Allocator<MsgPlayableSilence>* iAllocatorPlayableSilence;
     TUint64 iTrackOffset;
@@ -828,6 +1048,7 @@ private:
 };
 
 class IPcmProcessor;
+class AnimatorBuffer;
 
 /**
  * Holds decoded audio and can write it to a stream.
@@ -845,7 +1066,8 @@ public:
     /**
      * Extract pcm data from this msg.
      *
-     * Any ramp is applied at the same time.
+     * Any ramp is applied at the same time.  A ramp may end part way through the msg;
+     * audio after it is read unramped.
      *
      * @param[in] aProcessor       PCM data is returned via this interface.  Writing the data
      *                             in a blocks is preferred.  Data may be written sample at a
@@ -853,12 +1075,23 @@ public:
      *                             padding around each sample) or if a ramp is being applied.
      */
     void Read(IPcmProcessor& aProcessor);
-    virtual TBool TryLogTimestamps();
+    /**
+     * Write pcm data directly into a buffer lent by the animator.
+     *
+     * Any ramp and attenuation are applied and the data converted to the buffer's format
+     * as it is written.
+     *
+     * @param[in] aBuffer          Must have room for all of this msg's samples and have the
+     *                             same number of channels.  Split() the msg first if necessary.
+     */
+    void Read(AnimatorBuffer& aBuffer);
+    virtual void AddLogPoint(LatencyPoint aPoint);
 protected:
     MsgPlayable(AllocatorBase& aAllocator);
     void Initialise(TUint aSizeBytes, TUint aSampleRate, TUint aBitDepth,
-                    TUint aNumChannels, TUint aOffsetBytes, const Media::Ramp& aRamp,
+                    TUint aNumChannels, TUint aOffsetBytes, const Media::Ramp& aRamp, TUint aRampBytes,
                     Optional<IPipelineBufferObserver> aPipelineBufferObserver);
+    TUint RampBytes() const; // bytes at the start of this msg covered by iRamp; 0 if there is no ramp
 protected: // from Msg
     Msg* Process(IMsgProcessor& aProcessor) override;
     void Clear() override;
@@ -875,28 +1108,32 @@ protected:
     TUint iNumChannels;
     TUint iOffset; // Bytes
     Media::Ramp iRamp;
+    TUint iRampBytes; // 0 => iRamp covers the whole msg
     IPipelineBufferObserver* iPipelineBufferObserver;
 };
 
 class MsgPlayablePcm : public MsgPlayable
 {
     friend class MsgAudioPcm;
+    static const TUint kBlockBytes = 4 * 1024; // ramped or attenuated audio is passed to IPcmProcessor in fragments of up to this size
 public:
     MsgPlayablePcm(AllocatorBase& aAllocator);
 private:
-    void Initialise(DecodedAudio* aDecodedAudio, TUint aSizeBytes, TUint aSampleRate, TUint aBitDepth,
-                    TUint aNumChannels, TUint aOffsetBytes, TUint aAttenuation, const Media::Ramp& aRamp,
+    void Initialise(DecodedAudio* aDecodedAudio, DecodedAudioFormat aFormat, TUint aSizeBytes, TUint aSampleRate, TUint aBitDepth,
+                    TUint aNumChannels, TUint aOffsetBytes, TUint aAttenuation, const Media::Ramp& aRamp, TUint aRampBytes,
                     Optional<IPipelineBufferObserver> aPipelineBufferObserver);
 private: // from MsgPlayable
     MsgPlayable* Allocate() override;
     void SplitCompleted(MsgPlayable& aRemaining) override;
     void ReadBlock(IPcmProcessor& aProcessor) override;
-    TBool TryLogTimestamps() override;
+    void AddLogPoint(LatencyPoint aPoint) override;
 private: // from Msg
     void Clear() override;
 private:
-    Brn ApplyAttenuation(Brn aData);
+    void ReadBlockNative32(IPcmProcessor& aProcessor);
+    static void ProcessFragment(IPcmProcessor& aProcessor, const Brx& aData, TUint aBitDepth, TUint aNumChannels);
     DecodedAudio* iAudioData;
+    DecodedAudioFormat iFormat;
     TUint iAttenuation;
 };
 
@@ -983,6 +1220,19 @@ public:
     virtual void ProcessFragment16(const Brx& aData, TUint aNumChannels) = 0;
     virtual void ProcessFragment24(const Brx& aData, TUint aNumChannels) = 0;
     virtual void ProcessFragment32(const Brx& aData, TUint aNumChannels) = 0;
+    /**
+     * Copy a block of audio data held as DecodedAudioFormat::NativeInt32.
+     *
+     * Only called by pipelines configured to use DecodedAudioFormat::NativeInt32.
+     * The default implementation packs the data to big endian and passes it to
+     * ProcessFragment8/16/24/32 so only processors that can use unpacked samples
+     * need to override this.
+     *
+     * @param aData         Host endian, left-aligned TInt32 subsamples.  Will always be a complete number of samples.
+     * @param aNumChannels  Number of channels.
+     * @param aBitDepth     Bit depth of the stream.  Only the top aBitDepth bits of each subsample are significant.
+     */
+    virtual void ProcessFragmentNative32(const Brx& aData, TUint aNumChannels, TUint aBitDepth);
     /**
      * Called once per call to MsgPlayable::Read.
      *
@@ -995,6 +1245,47 @@ public:
     virtual void Flush() = 0;
 };
 
+/**
+ * Region of an animator's output buffer (e.g. an mmap'd ALSA period or a file sink's buffer),
+ * lent to MsgPlayable::Read so audio can be written in the animator's native format without
+ * an intermediate copy.
+ *
+ * Subsamples are written to containers of 1, 2, 3 or 4 bytes, most significant bits first, so
+ * audio is left-aligned in containers larger than its bit depth (as ALSA's S32 formats expect)
+ * and truncated in smaller ones.  Not thread safe.
+ */
+class AnimatorBuffer : private IPcmProcessor, private INonCopyable
+{
+    friend class MsgPlayable;
+    typedef void (*PackedKernel)(const TByte* aSrc, TUint aSrcBytesPerSubsample, TByte* aDest, TUint aNumSubsamples);
+    typedef void (*Native32Kernel)(const TInt32* aSrc, TByte* aDest, TUint aNumSubsamples);
+public:
+    AnimatorBuffer(TByte* aPtr, TUint aMaxSamples, TUint aNumChannels, TUint aBytesPerSubsample, AudioDataEndian aEndian);
+    TUint NumChannels() const;
+    TUint BytesPerSample() const;
+    TUint SamplesWritten() const;
+    TUint SamplesFree() const;
+private:
+    TByte* Reserve(const Brx& aData, TUint aSrcBytesPerSubsample, TUint aNumChannels, TUint& aNumSubsamples);
+private: // from IPcmProcessor
+    void BeginBlock() override;
+    void ProcessFragment8(const Brx& aData, TUint aNumChannels) override;
+    void ProcessFragment16(const Brx& aData, TUint aNumChannels) override;
+    void ProcessFragment24(const Brx& aData, TUint aNumChannels) override;
+    void ProcessFragment32(const Brx& aData, TUint aNumChannels) override;
+    void ProcessFragmentNative32(const Brx& aData, TUint aNumChannels, TUint aBitDepth) override;
+    void EndBlock() override;
+    void Flush() override;
+private:
+    TByte* iPtr;
+    const TUint iMaxSamples;
+    const TUint iNumChannels;
+    const TUint iBytesPerSubsample;
+    TUint iSamplesWritten;
+    PackedKernel iKernelPacked;
+    Native32Kernel iKernelNative32;
+};
+
 class MsgQueueBase
 {
 public:
@@ -1041,6 +1332,55 @@ private:
     Semaphore iSem;
 };
 
+/**
+ * Unbounded queue with one producing and one consuming thread.
+ *
+ * Msgs are passed through a fixed size ring without taking any locks.  The consumer only
+ * blocks (on a semaphore) when the queue is empty.  The producer never blocks; if the ring is
+ * full, msgs spill to a locked overflow list until the consumer has caught up.
+ *
+ * Enqueue() may only be called by one thread at a time.  Dequeue() and EnqueueAtHead() may
+ * only be called by the consuming thread.  IsEmpty() and NumMsgs() may be called from any
+ * thread.
+ */
+class MsgRing : private INonCopyable
+{
+    static const TUint kCacheLineBytes = 64;
+public:
+    static const TUint kDefaultCapacity = 1024;
+public:
+    MsgRing(TUint aCapacity = kDefaultCapacity); // aCapacity must be a power of 2
+    ~MsgRing();
+    void Enqueue(Msg* aMsg);
+    Msg* Dequeue();
+    void EnqueueAtHead(Msg* aMsg);
+    TBool IsEmpty() const;
+    TUint NumMsgs() const;
+private:
+    Msg* TryDequeue();
+private:
+    // written by consumer
+    std::atomic<TUint> iHead;
+    TByte iPadHead[kCacheLineBytes - sizeof(std::atomic<TUint>)];
+    // written by producer
+    std::atomic<TUint> iTail;
+    TByte iPadTail[kCacheLineBytes - sizeof(std::atomic<TUint>)];
+    Msg** iSlots;
+    const TUint iMask;
+    MsgQueueLite iRequeued; // consumer only
+    Mutex iLockOverflow;
+    MsgQueueLite iOverflow;
+    std::atomic<TUint> iOverflowCount;
+    std::atomic<TUint> iNumMsgs;
+    std::atomic<TBool> iConsumerWaiting;
+    Semaphore iSem;
+};
+
+/*
+Base for elements which buffer msgs between a producing and a consuming thread.
+DoEnqueue() may only be called by one thread at a time; all dequeuing (and EnqueueAtHead(),
+which is only used when processing msgs out) must happen on a single consuming thread.
+*/
 class MsgReservoir
 {
 protected:
@@ -1165,14 +1505,13 @@ private:
         MsgReservoir& iQueue;
     };
 private:
-    MsgQueue iQueue;
-    mutable Mutex iLockEncoded; // see #5098
-    TUint iEncodedBytes;
+    MsgRing iQueue;
+    std::atomic<TUint> iEncodedBytes;
     std::atomic<TUint> iJiffies;
     std::atomic<TUint> iTrackCount;
     std::atomic<TUint> iEncodedStreamCount;
     std::atomic<TUint> iDecodedStreamCount;
-    TUint iEncodedAudioCount;
+    std::atomic<TUint> iEncodedAudioCount;
     std::atomic<TUint> iDecodedAudioCount;
 };
 
@@ -1511,11 +1850,54 @@ public:
     virtual void RemoveStream(TUint aStreamId) = 0;
 };
 
+class UpstreamLink;
+
 class IPipelineElementUpstream
 {
 public:
     virtual ~IPipelineElementUpstream() {}
     virtual Msg* Pull() = 0;
+    /**
+     * Append between 1 and aMaxMsgs msgs to aQueue.
+     *
+     * Blocks (as Pull() would) until at least one msg is available but never waits for more.
+     * The default implementation appends a single msg from Pull().
+     */
+    virtual void PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs);
+    /**
+     * Link to the element this pulls from, or nullptr if this has no upstream element or
+     * doesn't allow it to be redirected.
+     *
+     * Used by Pipeline to splice disabled Loggers out of the chain.
+     */
+    virtual UpstreamLink* SpliceableUpstream();
+};
+
+/**
+ * Reference to an upstream element which can be redirected while another thread is pulling.
+ *
+ * A Pull() that is in progress when the link is redirected completes via the old element.
+ * Elements that are spliced out must therefore outlive the link.
+ *
+ * Elements which implement PullBatch() natively fetch a batch via PullBatch(TUint), process
+ * the first msg it returns then take the rest via TryPull().  Any msgs they don't take are
+ * returned by later calls to Pull(), so per-msg behaviour is unchanged.  Msgs fetched before
+ * the link is redirected are still returned, as for a Pull() that was in progress.
+ */
+class UpstreamLink : private INonCopyable
+{
+public:
+    UpstreamLink(IPipelineElementUpstream& aUpstream);
+    UpstreamLink(); // unattached, for elements which can either push or pull but are pushing
+    inline Msg* Pull();
+    Msg* PullBatch(TUint aMaxMsgs); // blocks for the first of up to aMaxMsgs msgs; returns it
+    Msg* TryPull(); // returns nullptr unless msgs from an earlier PullBatch() remain
+    void PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs); // for elements which don't process msgs
+    IPipelineElementUpstream& Upstream() const;
+    void Splice(IPipelineElementUpstream& aUpstream);
+private:
+    std::atomic<IPipelineElementUpstream*> iUpstream;
+    MsgQueueLite iBatch;
 };
 
 class IPipelineElementDownstream
@@ -1528,6 +1910,9 @@ public:
 
 /**
  * Should be implemented by the object that animates (calls Pull() on) Pipeline.
+ *
+ * Animators which can should read each MsgPlayable into an AnimatorBuffer lent from their
+ * output buffer rather than via an IPcmProcessor, avoiding an intermediate copy.
  */
 class IPipelineAnimator
 {
@@ -1604,6 +1989,11 @@ public:
     inline void SetMsgSilenceCount(TUint aCount);
     inline void SetMsgPlayableCount(TUint aPcmCount, TUint aSilenceCount);
     inline void SetMsgQuitCount(TUint aCount);
+    inline void SetAllocatorImpl(AllocatorBase::Impl aImpl);
+    inline void SetAllocatorStorage(AllocatorBase::Storage aStorage);
+    inline void SetAllocatorGrowth(const AllocatorGrowth& aGrowth);
+    inline void SetAudioDataSizeClasses(TBool aEnable);
+    inline void SetDecodedAudioFormat(DecodedAudioFormat aFormat);
 private:
     TUint iMsgModeCount;
     TUint iMsgTrackCount;
@@ -1625,6 +2015,11 @@ private:
     TUint iMsgPlayablePcmCount;
     TUint iMsgPlayableSilenceCount;
     TUint iMsgQuitCount;
+    AllocatorBase::Impl iAllocatorImpl;
+    AllocatorBase::Storage iAllocatorStorage;
+    AllocatorGrowth iAllocatorGrowth;
+    TBool iAudioDataSizeClasses;
+    DecodedAudioFormat iDecodedAudioFormat;
 };
 
 class MsgFactory
@@ -1654,6 +2049,7 @@ public:
     MsgAudioPcm* CreateMsgAudioPcm(MsgAudioEncoded* aAudio, TUint aChannels, TUint aSampleRate, TUint aBitDepth, TUint64 aTrackOffset); // aAudio must contain big endian pcm data
     MsgSilence* CreateMsgSilence(TUint& aSizeJiffies, TUint aSampleRate, TUint aBitDepth, TUint aChannels);
     MsgQuit* CreateMsgQuit();
+    DecodedAudioFormat DecodedFormat() const;
 private:
     EncodedAudio* CreateEncodedAudio(const Brx& aData);
     DecodedAudio* CreateDecodedAudio(const Brx& aData, TUint aBitDepth, AudioDataEndian aEndian);
@@ -1665,7 +2061,7 @@ private:
     TUint iDrainId;
     Allocator<MsgDelay> iAllocatorMsgDelay;
     Allocator<MsgEncodedStream> iAllocatorMsgEncodedStream;
-    Allocator<AudioData> iAllocatorAudioData;
+    AudioDataAllocator iAllocatorAudioData;
     Allocator<MsgAudioEncoded> iAllocatorMsgAudioEncoded;
     Allocator<MsgMetaText> iAllocatorMsgMetaText;
     Allocator<MsgStreamInterrupted> iAllocatorMsgStreamInterrupted;
@@ -1679,6 +2075,7 @@ private:
     Allocator<MsgPlayablePcm> iAllocatorMsgPlayablePcm;
     Allocator<MsgPlayableSilence> iAllocatorMsgPlayableSilence;
     Allocator<MsgQuit> iAllocatorMsgQuit;
+    const DecodedAudioFormat iDecodedAudioFormat;
 };
 
 #include <OpenHome/Media/Pipeline/Msg.inl>
@@ -1,3 +1,40 @@
+// AllocatorGrowth
+
+inline AllocatorGrowth::AllocatorGrowth()
+    : iChunks(0)
+    , iShrinkAfterMs(0)
+    , iFullTimeoutMs(0)
+{
+}
+
+inline AllocatorGrowth::AllocatorGrowth(TUint aChunks, TUint aShrinkAfterMs, TUint aFullTimeoutMs)
+    : iChunks(aChunks)
+    , iShrinkAfterMs(aShrinkAfterMs)
+    , iFullTimeoutMs(aFullTimeoutMs)
+{
+}
+
+inline TBool AllocatorGrowth::Elastic() const
+{
+    return iChunks > 1;
+}
+
+inline TUint AllocatorGrowth::Chunks() const
+{
+    return iChunks;
+}
+
+inline TUint AllocatorGrowth::ShrinkAfterMs() const
+{
+    return iShrinkAfterMs;
+}
+
+inline TUint AllocatorGrowth::FullTimeoutMs() const
+{
+    return iFullTimeoutMs;
+}
+
+
 // AllocatorBase
 
 inline const TChar* AllocatorBase::Name() const
@@ -145,25 +182,38 @@ inline FunctorGeneric<TUint> ModeTransportControls::Seek() const
 }
 
 
+// AudioData
+
+inline TBool AudioData::IsLatencyTraced() const
+{
+    return iLatencyTraced;
+}
+
+
 // MsgAudioEncoded, MsgAudioPcm
 
-#ifdef TIMESTAMP_LOGGING_ENABLE
-inline void MsgAudioEncoded::AddLogPoint(const TChar* aId)
+inline void MsgAudioEncoded::TryStartLatencyTrace()
 {
-    iAudioData->SetTimestamp(aId);
+    if (LatencyTracer::TrySample()) {
+        iAudioData->StartLatencyTrace();
+    }
 }
-inline void MsgAudioPcm::AddLogPoint(const TChar* aId)
+inline TBool MsgAudioEncoded::IsLatencyTraced() const
 {
-    iAudioData->SetTimestamp(aId);
+    return iAudioData->IsLatencyTraced();
 }
-#else
-inline void MsgAudioEncoded::AddLogPoint(const TChar* /*aId*/)
+inline void MsgAudioEncoded::AddLogPoint(LatencyPoint aPoint)
 {
+    if (iAudioData->IsLatencyTraced()) {
+        iAudioData->AddLatencyStamp(aPoint);
+    }
 }
-inline void MsgAudioPcm::AddLogPoint(const TChar* /*aId*/)
+inline void MsgAudioPcm::AddLogPoint(LatencyPoint aPoint)
 {
+    if (iAudioData->IsLatencyTraced()) {
+        iAudioData->AddLatencyStamp(aPoint);
+    }
 }
-#endif
 
 
 // DecodedStreamInfo
@@ -258,6 +308,17 @@ inline TUint MsgQueueLite::NumMsgs() const
 }
 
 
+// UpstreamLink
+
+inline Msg* UpstreamLink::Pull()
+{
+    if (!iBatch.IsEmpty()) {
+        return iBatch.Dequeue();
+    }
+    return iUpstream.load(std::memory_order_acquire)->Pull();
+}
+
+
 // MsgFactoryInitParams
 
 inline MsgFactoryInitParams::MsgFactoryInitParams()
@@ -281,6 +342,11 @@ inline MsgFactoryInitParams::MsgFactoryInitParams()
     , iMsgPlayablePcmCount(1)
     , iMsgPlayableSilenceCount(1)
     , iMsgQuitCount(1)
+    , iAllocatorImpl(AllocatorBase::Impl::eLocking)
+    , iAllocatorStorage(AllocatorBase::Storage::eHeap)
+    , iAllocatorGrowth()
+    , iAudioDataSizeClasses(false)
+    , iDecodedAudioFormat(DecodedAudioFormat::Packed)
 {
 }
 inline void MsgFactoryInitParams::SetMsgModeCount(TUint aCount)
@@ -354,3 +420,23 @@ inline void MsgFactoryInitParams::SetMsgQuitCount(TUint aCount)
 {
     iMsgQuitCount = aCount;
 }
+inline void MsgFactoryInitParams::SetAllocatorImpl(AllocatorBase::Impl aImpl)
+{
+    iAllocatorImpl = aImpl;
+}
+inline void MsgFactoryInitParams::SetAllocatorStorage(AllocatorBase::Storage aStorage)
+{
+    iAllocatorStorage = aStorage;
+}
+inline void MsgFactoryInitParams::SetAllocatorGrowth(const AllocatorGrowth& aGrowth)
+{
+    iAllocatorGrowth = aGrowth;
+}
+inline void MsgFactoryInitParams::SetAudioDataSizeClasses(TBool aEnable)
+{
+    iAudioDataSizeClasses = aEnable;
+}
+inline void MsgFactoryInitParams::SetDecodedAudioFormat(DecodedAudioFormat aFormat)
+{
+    iDecodedAudioFormat = aFormat;
+}
@@ -144,6 +144,27 @@ Msg* Muter::Pull()
     return msg;
 }
 
+void Muter::PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs)
+{
+    // msgs split from a ramp are queued in iQueue and must be output before any more from upstream
+    Msg* msg = (iQueue.IsEmpty()? iUpstream.PullBatch(aMaxMsgs) : iQueue.Dequeue());
+    AutoMutex _(iLock);
+    TUint count = 0;
+    do {
+        msg = msg->Process(*this);
+        ASSERT(msg != nullptr);
+        aQueue.Enqueue(msg);
+        /* PipelineHalted() relies on no audio being pulled after a halt and eMuting counts down
+           the animator's buffer as msgs are pulled.  Don't pull ahead of the animator for either. */
+    } while (!iHalting && iState != eMuting && ++count < aMaxMsgs &&
+             (msg = (iQueue.IsEmpty()? iUpstream.TryPull() : iQueue.Dequeue())) != nullptr);
+}
+
+UpstreamLink* Muter::SpliceableUpstream()
+{
+    return &iUpstream;
+}
+
 Msg* Muter::ProcessMsg(MsgHalt* aMsg)
 {
     auto msg = iMsgFactory.CreateMsgHalt(aMsg->Id(), MakeFunctor(*this, &Muter::PipelineHalted));
@@ -168,15 +189,8 @@ Msg* Muter::ProcessMsg(MsgAudioPcm* aMsg)
     case eRampingDown:
     case eRampingUp:
     {
-        MsgAudio* split;
-        if (msg->Jiffies() > iRemainingRampSize && iRemainingRampSize > 0) {
-            split = msg->Split(iRemainingRampSize);
-            if (split != nullptr) {
-                iQueue.EnqueueAtHead(split);
-            }
-        }
-        split = nullptr;
         const Ramp::EDirection direction = (iState == eRampingDown? Ramp::EDown : Ramp::EUp);
+        MsgAudio* split = nullptr;
         if (iRemainingRampSize > 0) {
             iCurrentRampValue = msg->SetRamp(iCurrentRampValue, iRemainingRampSize, direction, split);
         }
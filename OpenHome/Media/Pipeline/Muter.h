@@ -31,6 +31,8 @@ public: // from IMute
     void Unmute() override;
 private: // from IPipelineElementUpstream
     Msg* Pull() override;
+    void PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs) override;
+    UpstreamLink* SpliceableUpstream() override;
 private: // IMsgProcessor
     Msg* ProcessMsg(MsgHalt* aMsg) override;
     Msg* ProcessMsg(MsgAudioPcm* aMsg) override;
@@ -48,7 +50,7 @@ private:
     };
 private:
     MsgFactory& iMsgFactory;
-    IPipelineElementUpstream& iUpstream;
+    UpstreamLink iUpstream;
     IPipelineAnimator* iAnimator;
     Mutex iLock;
     Semaphore iSemMuted;
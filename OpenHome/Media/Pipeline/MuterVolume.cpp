@@ -33,6 +33,7 @@ MuterVolume::MuterVolume(MsgFactory& aMsgFactory, IPipelineElementUpstream& aUps
     , iSemMuted("MPMT", 0)
     , iState(State::eRunning)
     , iHalted(true)
+    , iHaltPulled(false)
 {
 }
 
@@ -129,10 +130,30 @@ Msg* MuterVolume::Pull()
     return msg;
 }
 
+void MuterVolume::PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs)
+{
+    Msg* msg = iUpstream.PullBatch(aMaxMsgs);
+    AutoMutex _(iLock);
+    TUint count = 0;
+    do {
+        iHaltPulled = false;
+        aQueue.Enqueue(msg->Process(*this));
+        /* Volume ramps are stepped as audio is pulled and PipelineHalted() relies on no audio
+           being pulled after a halt.  Don't pull ahead of the animator for either. */
+    } while (!iHaltPulled && (iState == State::eRunning || iState == State::eMuted) &&
+             ++count < aMaxMsgs && (msg = iUpstream.TryPull()) != nullptr);
+}
+
+UpstreamLink* MuterVolume::SpliceableUpstream()
+{
+    return &iUpstream;
+}
+
 Msg* MuterVolume::ProcessMsg(MsgHalt* aMsg)
 {
     auto msg = iMsgFactory.CreateMsgHalt(aMsg->Id(), MakeFunctor(*this, &MuterVolume::PipelineHalted));
     aMsg->RemoveRef();
+    iHaltPulled = true;
     return msg;
 }
 
@@ -45,6 +45,8 @@ public: // from IMute
     void Unmute() override;
 private: // from IPipelineElementUpstream
     Msg* Pull() override;
+    void PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs) override;
+    UpstreamLink* SpliceableUpstream() override;
 private: // IMsgProcessor
     Msg* ProcessMsg(MsgHalt* aMsg) override;
     Msg* ProcessMsg(MsgAudioPcm* aMsg) override;
@@ -63,13 +65,14 @@ private:
     };
 private:
     MsgFactory& iMsgFactory;
-    IPipelineElementUpstream& iUpstream;
+    UpstreamLink iUpstream;
     IVolumeRamper* iVolumeRamper;
     Mutex iLock;
     Semaphore iSemMuted;
     State iState;
     TUint iJiffiesUntilMute;
     TBool iHalted;
+    TBool iHaltPulled; // PullBatch() ends a batch after a halt
 };
 
 class VolumeRamperStub : public IVolumeRamper
@@ -32,6 +32,8 @@
 #include <OpenHome/Media/Pipeline/AnalogBypassRamper.h>
 #include <OpenHome/Media/Pipeline/PreDriver.h>
 #include <OpenHome/Private/Printer.h>
+#include <OpenHome/Private/Ascii.h>
+#include <OpenHome/Private/Stream.h>
 #include <OpenHome/Media/Pipeline/Msg.h>
 #include <OpenHome/Media/Debug.h>
 
@@ -56,9 +58,18 @@ PipelineInitParams::PipelineInitParams()
     , iRampLongJiffies(kLongRampDurationDefault)
     , iRampShortJiffies(kShortRampDurationDefault)
     , iRampEmergencyJiffies(kEmergencyRampDurationDefault)
+    , iEventThreads(kEventThreadsDefault)
     , iMaxLatencyJiffies(kMaxLatencyDefault)
     , iSupportElements(EPipelineSupportElementsAll)
     , iMuter(kMuterDefault)
+    , iAllocatorImpl(kAllocatorImplDefault)
+    , iAllocatorStorage(kAllocatorStorageDefault)
+    , iAllocatorGrowth()
+    , iAudioDataSizeClasses(kAudioDataSizeClassesDefault)
+    , iDecodedAudioFormat(kDecodedAudioFormatDefault)
+    , iElideDisabledLoggers(kElideDisabledLoggersDefault)
+    , iVariableDelayLineJiffies(kVariableDelayLineDefault)
+    , iThreadScheduling()
 {
     SetThreadPriorityMax(kThreadPriorityMax);
 }
@@ -121,6 +132,12 @@ void PipelineInitParams::SetThreadPriorities(TUint aStarvationRamper, TUint aCod
     iThreadPriorityEvent            = aEvent;
 }
 
+void PipelineInitParams::SetEventThreads(TUint aCount)
+{
+    ASSERT(aCount > 0);
+    iEventThreads = aCount;
+}
+
 void PipelineInitParams::SetMaxLatency(TUint aJiffies)
 {
     iMaxLatencyJiffies = aJiffies;
@@ -136,6 +153,56 @@ void PipelineInitParams::SetMuter(MuterImpl aMuter)
     iMuter = aMuter;
 }
 
+void PipelineInitParams::SetAllocatorImpl(AllocatorBase::Impl aImpl)
+{
+    iAllocatorImpl = aImpl;
+}
+
+void PipelineInitParams::SetAllocatorStorage(AllocatorBase::Storage aStorage)
+{
+    iAllocatorStorage = aStorage;
+}
+
+void PipelineInitParams::SetAllocatorGrowth(const AllocatorGrowth& aGrowth)
+{
+    iAllocatorGrowth = aGrowth;
+}
+
+void PipelineInitParams::SetAudioDataSizeClasses(TBool aEnable)
+{
+    iAudioDataSizeClasses = aEnable;
+}
+
+void PipelineInitParams::SetDecodedAudioFormat(DecodedAudioFormat aFormat)
+{
+    iDecodedAudioFormat = aFormat;
+}
+
+void PipelineInitParams::SetElideDisabledLoggers(TBool aElide)
+{
+    iElideDisabledLoggers = aElide;
+}
+
+void PipelineInitParams::SetVariableDelayLine(TUint aJiffies)
+{
+    iVariableDelayLineJiffies = aJiffies;
+}
+
+void PipelineInitParams::SetThreadAffinity(PipelineThread aThread, TUint64 aCpuMask)
+{
+    iThreadScheduling.SetAffinity(aThread, aCpuMask);
+}
+
+void PipelineInitParams::SetThreadPolicy(PipelineThread aThread, ThreadSchedPolicy aPolicy, TUint aPriority)
+{
+    iThreadScheduling.SetPolicy(aThread, aPolicy, aPriority);
+}
+
+void PipelineInitParams::SetLockMemory(TBool aLock)
+{
+    iThreadScheduling.SetLockMemory(aLock);
+}
+
 TUint PipelineInitParams::EncodedReservoirBytes() const
 {
     return iEncodedReservoirBytes;
@@ -191,6 +258,11 @@ TUint PipelineInitParams::ThreadPriorityEvent() const
     return iThreadPriorityEvent;
 }
 
+TUint PipelineInitParams::EventThreads() const
+{
+    return iEventThreads;
+}
+
 TUint PipelineInitParams::MaxLatencyJiffies() const
 {
     return iMaxLatencyJiffies;
@@ -206,9 +278,55 @@ PipelineInitParams::MuterImpl PipelineInitParams::Muter() const
     return iMuter;
 }
 
+AllocatorBase::Impl PipelineInitParams::AllocatorImpl() const
+{
+    return iAllocatorImpl;
+}
+
+AllocatorBase::Storage PipelineInitParams::AllocatorStorage() const
+{
+    return iAllocatorStorage;
+}
+
+const AllocatorGrowth& PipelineInitParams::AllocatorGrowthParams() const
+{
+    return iAllocatorGrowth;
+}
+
+TBool PipelineInitParams::AudioDataSizeClasses() const
+{
+    return iAudioDataSizeClasses;
+}
+
+DecodedAudioFormat PipelineInitParams::DecodedFormat() const
+{
+    return iDecodedAudioFormat;
+}
+
+TBool PipelineInitParams::ElideDisabledLoggers() const
+{
+    return iElideDisabledLoggers;
+}
+
+TUint PipelineInitParams::VariableDelayLineJiffies() const
+{
+    return iVariableDelayLineJiffies;
+}
+
+const ThreadSchedulingParams& PipelineInitParams::SchedulingParams() const
+{
+    return iThreadScheduling;
+}
+
 
 // Pipeline
 
+Pipeline::SplicedLogger::SplicedLogger(Logger& aLogger, UpstreamLink& aLink)
+    : iLogger(&aLogger)
+    , iLink(&aLink)
+{
+}
+
 #define ATTACH_ELEMENT(elem, ctor, prev_elem, supported, type)  \
     do {                                                        \
         if ((supported & (type)) ||                             \
@@ -222,6 +340,8 @@ PipelineInitParams::MuterImpl PipelineInitParams::Muter() const
     } while (0)
 
 static Pipeline* gPipeline = nullptr;
+const Brn Pipeline::kQueryProfile("pipeline_profile");
+
 Pipeline::Pipeline(PipelineInitParams* aInitParams, IInfoAggregator& aInfoAggregator, TrackFactory& aTrackFactory, IPipelineObserver& aObserver,
                    IStreamPlayObserver& aStreamPlayObserver, ISeekRestreamer& aSeekRestreamer, IUrlBlockWriter& aUrlBlockWriter)
     : iInitParams(aInitParams)
@@ -232,8 +352,10 @@ Pipeline::Pipeline(PipelineInitParams* aInitParams, IInfoAggregator& aInfoAggreg
     , iBuffering(false)
     , iWaiting(false)
     , iQuitting(false)
+    , iProfiling(false)
     , iNextFlushId(MsgFlush::kIdInvalid + 1)
 {
+    ThreadScheduling::Configure(aInitParams->SchedulingParams()); // before any pipeline threads are created
     const TUint perStreamMsgCount = aInitParams->MaxStreamsPerReservoir() * kReservoirCount;
     TUint encodedAudioCount = ((aInitParams->EncodedReservoirBytes() + EncodedAudio::kMaxBytes - 1) / EncodedAudio::kMaxBytes); // this may only be required on platforms that don't guarantee priority based thread scheduling
     encodedAudioCount = std::max(encodedAudioCount, // songcast and some hardware inputs won't use the full capacity of each encodedAudio
@@ -242,7 +364,8 @@ Pipeline::Pipeline(PipelineInitParams* aInitParams, IInfoAggregator& aInfoAggreg
     encodedAudioCount += kRewinderMaxMsgs; // this may only be required on platforms that don't guarantee priority based thread scheduling
     const TUint msgEncodedAudioCount = encodedAudioCount + 100; // +100 allows for Split()ing by Container and CodecController
     const TUint decodedReservoirSize = aInitParams->DecodedReservoirJiffies() + aInitParams->StarvationRamperMinJiffies();
-    const TUint decodedAudioCount = ((decodedReservoirSize + kSenderMinLatency) / DecodedAudioAggregator::kMaxJiffies) + 200; // +200 allows for songcast sender, some smaller msgs and some buffering in non-reservoir elements
+    TUint decodedAudioCount = ((decodedReservoirSize + kSenderMinLatency) / DecodedAudioAggregator::kMaxJiffies) + 200; // +200 allows for songcast sender, some smaller msgs and some buffering in non-reservoir elements
+    decodedAudioCount += (2 * aInitParams->VariableDelayLineJiffies()) / DecodedAudioAggregator::kMaxJiffies; // each VariableDelay may output the contents of its delay line in one burst
     const TUint msgAudioPcmCount = decodedAudioCount + 100; // +100 allows for Split()ing in various elements
     const TUint msgHaltCount = perStreamMsgCount * 2; // worst case is tiny Vorbis track with embedded metatext in a single-track playlist with repeat
     MsgFactoryInitParams msgInit;
@@ -262,9 +385,14 @@ Pipeline::Pipeline(PipelineInitParams* aInitParams, IInfoAggregator& aInfoAggreg
     msgInit.SetMsgSilenceCount(kMsgCountSilence);
     msgInit.SetMsgPlayableCount(kMsgCountPlayablePcm, kMsgCountPlayableSilence);
     msgInit.SetMsgQuitCount(kMsgCountQuit);
+    msgInit.SetAllocatorImpl(aInitParams->AllocatorImpl());
+    msgInit.SetAllocatorStorage(aInitParams->AllocatorStorage());
+    msgInit.SetAllocatorGrowth(aInitParams->AllocatorGrowthParams());
+    msgInit.SetAudioDataSizeClasses(aInitParams->AudioDataSizeClasses());
+    msgInit.SetDecodedAudioFormat(aInitParams->DecodedFormat());
     iMsgFactory = new MsgFactory(aInfoAggregator, msgInit);
 
-    iEventThread = new PipelineElementObserverThread(aInitParams->ThreadPriorityEvent());
+    iEventThread = new PipelineElementObserverThread(aInitParams->ThreadPriorityEvent(), aInitParams->EventThreads());
     IPipelineElementDownstream* downstream = nullptr;
     IPipelineElementUpstream* upstream = nullptr;
     const auto elementsSupported = aInitParams->SupportElements();
@@ -343,7 +471,8 @@ Pipeline::Pipeline(PipelineInitParams* aInitParams, IInfoAggregator& aInfoAggreg
                    upstream, elementsSupported, EPipelineSupportElementsDecodedAudioValidator);
     ATTACH_ELEMENT(iVariableDelay1,
                    new VariableDelayLeft(*iMsgFactory, *upstream,
-                                         aInitParams->RampEmergencyJiffies(), kSenderMinLatency),
+                                         aInitParams->RampEmergencyJiffies(), kSenderMinLatency,
+                                         aInitParams->VariableDelayLineJiffies()),
                    upstream, elementsSupported, EPipelineSupportElementsMandatory);
     ATTACH_ELEMENT(iLoggerVariableDelay1, new Logger(*iVariableDelay1, "VariableDelay1"),
                    upstream, elementsSupported, EPipelineSupportElementsLogger);
@@ -351,7 +480,7 @@ Pipeline::Pipeline(PipelineInitParams* aInitParams, IInfoAggregator& aInfoAggreg
                    upstream, elementsSupported, EPipelineSupportElementsRampValidator);
     ATTACH_ELEMENT(iDecodedAudioValidatorDelay1, new DecodedAudioValidator(*upstream, "VariableDelay1"),
                    upstream, elementsSupported, EPipelineSupportElementsDecodedAudioValidator);
-    ATTACH_ELEMENT(iSkipper, new Skipper(*iMsgFactory, *upstream, aInitParams->RampShortJiffies()),
+    ATTACH_ELEMENT(iSkipper, new Skipper(*iMsgFactory, *upstream, *iDecodedAudioReservoir, aInitParams->RampShortJiffies()),
                    upstream, elementsSupported, EPipelineSupportElementsMandatory);
     ATTACH_ELEMENT(iLoggerSkipper, new Logger(*iSkipper, "Skipper"),
                    upstream, elementsSupported, EPipelineSupportElementsLogger);
@@ -405,7 +534,8 @@ Pipeline::Pipeline(PipelineInitParams* aInitParams, IInfoAggregator& aInfoAggreg
     ATTACH_ELEMENT(iVariableDelay2,
                    new VariableDelayRight(*iMsgFactory, *upstream,
                                           aInitParams->RampEmergencyJiffies(),
-                                          aInitParams->StarvationRamperMinJiffies()),
+                                          aInitParams->StarvationRamperMinJiffies(),
+                                          aInitParams->VariableDelayLineJiffies()),
                    upstream, elementsSupported, EPipelineSupportElementsMandatory);
     iVariableDelay1->SetObserver(*iVariableDelay2);
     ATTACH_ELEMENT(iLoggerVariableDelay2, new Logger(*iVariableDelay2, "VariableDelay2"),
@@ -456,6 +586,8 @@ Pipeline::Pipeline(PipelineInitParams* aInitParams, IInfoAggregator& aInfoAggreg
                    upstream, elementsSupported, EPipelineSupportElementsMandatory);
     ATTACH_ELEMENT(iLoggerAnalogBypassRamper, new Logger(*iAnalogBypassRamper, "AnalogBypassRamper"),
                    upstream, elementsSupported, EPipelineSupportElementsLogger);
+    ATTACH_ELEMENT(iDecodedAudioDumper, new DecodedAudioDumper(*upstream),
+                   upstream, elementsSupported, EPipelineSupportElementsAudioDumper);
     ATTACH_ELEMENT(iPreDriver, new PreDriver(*upstream),
                    upstream, elementsSupported, EPipelineSupportElementsMandatory);
     iLoggerPreDriver = new Logger(*iPreDriver, "PreDriver");
@@ -464,15 +596,23 @@ Pipeline::Pipeline(PipelineInitParams* aInitParams, IInfoAggregator& aInfoAggreg
 # pragma warning( pop )
 #endif // _WIN32
 
-    iPipelineEnd = iLoggerPreDriver;
-    if (iPipelineEnd == nullptr) {
-        iPipelineEnd = iPreDriver;
-    }
+    iPipelineEnd = new UpstreamLink(*iLoggerPreDriver);
     iMuteCounted = new MuteCounted(*muter);
 
+    if (iLoggerEncodedAudioReservoir != nullptr) {
+        iLoggerEncodedAudioReservoir->Profile().SetLevelSource(*iEncodedAudioReservoir, "bytes");
+    }
+    if (iLoggerDecodedAudioReservoir != nullptr) {
+        iLoggerDecodedAudioReservoir->Profile().SetLevelSource(*iDecodedAudioReservoir, "jiffies");
+    }
+    if (iLoggerStarvationRamper != nullptr) {
+        iLoggerStarvationRamper->Profile().SetLevelSource(*iStarvationRamper, "jiffies");
+    }
+
     gPipeline = this;
+    ThreadScheduling::LockMemory();
 
-    //iAudioDumper->SetEnabled(true);
+    //SetAudioDumpEnabled(true);
 
     //iLoggerEncodedAudioReservoir->SetEnabled(true);
     //iLoggerContainer->SetEnabled(true);
@@ -499,9 +639,8 @@ Pipeline::Pipeline(PipelineInitParams* aInitParams, IInfoAggregator& aInfoAggreg
     //iLoggerAnalogBypassRamper->SetEnabled(true);
 
     // A logger that is enabled will block waiting for MsgQuit in its dtor
-    // ~Pipeline (below) relies on this to synchronise its destruction
-    // i.e. NEVER DISABLE THIS LOGGER
-    iLoggerPreDriver->SetEnabled(true);
+    // ~Pipeline (below) relies on this to synchronise its destruction so Quit()
+    // enables this logger if it is still in the pull chain at that point
 
     //iLoggerEncodedAudioReservoir->SetFilter(Logger::EMsgAll);
     //iLoggerContainer->SetFilter(Logger::EMsgAll);
@@ -538,8 +677,10 @@ Pipeline::~Pipeline()
 
     // loggers (if non-null) and iPreDriver will block until they receive the Quit msg
     delete iMuteCounted;
+    delete iPipelineEnd;
     delete iLoggerPreDriver;
     delete iPreDriver;
+    delete iDecodedAudioDumper;
     delete iLoggerAnalogBypassRamper;
     delete iAnalogBypassRamper;
     delete iDecodedAudioValidatorMuter;
@@ -629,15 +770,28 @@ void Pipeline::Start(IAnalogBypassVolumeRamper& aAnalogBypassVolumeRamper, IVolu
         iMuterVolume->Start(aVolumeRamper);
     }
     iCodecController->Start();
+    if (iInitParams->ElideDisabledLoggers()) {
+        ElideDisabledLoggers();
+    }
 }
 
 void Pipeline::Quit()
 {
     LOG(kPipeline, "> Pipeline::Quit()\n");
-    if (iQuitting) {
-        return;
+    {
+        AutoMutex _(iLock);
+        if (iQuitting) {
+            return;
+        }
+        iQuitting = true;
+        /* Loggers can't be spliced in or out once iQuitting is set.  If iLoggerPreDriver
+           is still pulled from, enable it so that ~Pipeline waits for MsgQuit to pass it. */
+        auto spliced = std::find_if(iSplicedLoggers.begin(), iSplicedLoggers.end(),
+                                    [this](const SplicedLogger& aSpliced) { return aSpliced.iLogger == iLoggerPreDriver; });
+        if (spliced == iSplicedLoggers.end() || &spliced->iLink->Upstream() == iLoggerPreDriver) {
+            iLoggerPreDriver->SetEnabled(true);
+        }
     }
-    iQuitting = true;
     DoPlay(true);
 }
 
@@ -812,6 +966,184 @@ void Pipeline::LogBuffers() const
                encodedBytes, decodedMs, starvationMs);
 }
 
+void Pipeline::GetLoggerIds(std::vector<const TChar*>& aIds) const
+{
+    std::vector<Logger*> loggers;
+    GetLoggers(loggers);
+    for (auto logger : loggers) {
+        aIds.push_back(logger->Id());
+    }
+}
+
+TBool Pipeline::SetLoggerEnabled(const Brx& aId, TBool aEnabled)
+{
+    AutoMutex _(iLock);
+    if (iQuitting) {
+        // an enabled logger waits for MsgQuit in its dtor; don't risk enabling one MsgQuit has already passed
+        return false;
+    }
+    std::vector<Logger*> loggers;
+    GetLoggers(loggers);
+    auto it = std::find_if(loggers.begin(), loggers.end(),
+                           [&aId](Logger* aLogger) { return Brn(aLogger->Id()) == aId; });
+    if (it == loggers.end()) {
+        return false;
+    }
+    Logger* logger = *it;
+    auto spliced = std::find_if(iSplicedLoggers.begin(), iSplicedLoggers.end(),
+                                [logger](const SplicedLogger& aSpliced) { return aSpliced.iLogger == logger; });
+    if (aEnabled) {
+        logger->SetFilter(Logger::EMsgAll);
+        logger->SetEnabled(true);
+        if (spliced != iSplicedLoggers.end()) {
+            spliced->iLink->Splice(*logger);
+        }
+    }
+    else {
+        if (spliced != iSplicedLoggers.end() && !logger->Profiling()) {
+            spliced->iLink->Splice(*logger->Upstream());
+        }
+        logger->SetFilter(Logger::EMsgNone);
+        logger->SetEnabled(false);
+    }
+    return true;
+}
+
+void Pipeline::RegisterProfile(IInfoAggregator& aInfoAggregator)
+{
+    std::vector<Brn> queries;
+    queries.push_back(kQueryProfile);
+    aInfoAggregator.Register(*this, queries);
+}
+
+TBool Pipeline::SetProfilingEnabled(TBool aEnabled)
+{
+    AutoMutex _(iLock);
+    if (iQuitting) {
+        return false;
+    }
+    std::vector<Logger*> loggers;
+    GetLoggers(loggers);
+    if (loggers.empty()) {
+        return false;
+    }
+    for (auto logger : loggers) {
+        logger->SetProfiling(aEnabled);
+    }
+    /* Profiled loggers must be in the pull chain.  Splice elided loggers back in, then
+       restore the elision of any that aren't also enabled for logging once profiling stops. */
+    for (auto& spliced : iSplicedLoggers) {
+        Logger& logger = *spliced.iLogger;
+        if (aEnabled || logger.Enabled()) {
+            spliced.iLink->Splice(logger);
+        }
+        else {
+            spliced.iLink->Splice(*logger.Upstream());
+        }
+    }
+    iProfiling = aEnabled;
+    return true;
+}
+
+TBool Pipeline::ProfilingEnabled() const
+{
+    return iProfiling;
+}
+
+void Pipeline::ResetProfile()
+{
+    std::vector<Logger*> loggers;
+    GetLoggers(loggers);
+    for (auto logger : loggers) {
+        logger->Profile().Reset();
+    }
+    iContainer->Recognition().Reset();
+    iCodecController->Recognition().Reset();
+    iEventThread->ResetStats();
+}
+
+void Pipeline::WriteProfile(IWriter& aWriter) const
+{
+    std::vector<Logger*> loggers;
+    GetLoggers(loggers);
+    WriterAscii writer(aWriter);
+    writer.Write(Brn("{\"profiling\":"));
+    writer.Write(iProfiling? Brn("true") : Brn("false"));
+    writer.Write(Brn(",\"threadCpuSupported\":"));
+    writer.Write(ElementProfile::ThreadCpuSupported()? Brn("true") : Brn("false"));
+    writer.Write(Brn(",\"elements\":["));
+    for (TUint i=0; i<loggers.size(); i++) {
+        if (i > 0) {
+            writer.Write(',');
+        }
+        Logger* logger = loggers[i];
+        logger->Profile().WriteJson(aWriter, logger->Id(), logger->Upstream() == nullptr);
+    }
+    writer.Write(Brn("],\"recognition\":{\"container\":"));
+    iContainer->Recognition().WriteJson(aWriter);
+    writer.Write(Brn(",\"codec\":"));
+    iCodecController->Recognition().WriteJson(aWriter);
+    writer.Write(Brn("},\"events\":"));
+    iEventThread->WriteStats(aWriter);
+    writer.Write('}');
+}
+
+TBool Pipeline::SetAudioDumpEnabled(TBool aEnabled)
+{
+    if (iAudioDumper == nullptr) {
+        return false;
+    }
+    iAudioDumper->SetEnabled(aEnabled);
+    iDecodedAudioDumper->SetEnabled(aEnabled);
+    return true;
+}
+
+void Pipeline::QueryInfo(const Brx& aQuery, IWriter& aWriter)
+{
+    if (aQuery == kQueryProfile) {
+        WriteProfile(aWriter);
+    }
+}
+
+void Pipeline::GetLoggers(std::vector<Logger*>& aLoggers) const
+{
+    Logger* loggers[] = { iLoggerEncodedAudioReservoir, iLoggerContainer, iLoggerCodecController, iLoggerSampleRateValidator,
+                          iLoggerDecodedAudioAggregator, iLoggerDecodedAudioReservoir, iLoggerRamper, iLoggerSeeker,
+                          iLoggerVariableDelay1, iLoggerTrackInspector, iLoggerSkipper, iLoggerWaiter, iLoggerStopper,
+                          iLoggerSpotifyReporter, iLoggerReporter, iLoggerRouter, iLoggerAttenuator, iLoggerDrainer,
+                          iLoggerVariableDelay2, iLoggerPruner, iLoggerStarvationRamper, iLoggerMuter,
+                          iLoggerAnalogBypassRamper, iLoggerPreDriver };
+    for (auto logger : loggers) {
+        if (logger != nullptr) {
+            aLoggers.push_back(logger);
+        }
+    }
+}
+
+void Pipeline::ElideDisabledLoggers()
+{
+    /* Walk upstream from iPipelineEnd, redirecting each link that pulls from a disabled
+       Logger to that logger's upstream element.  The walk ends at the first element that
+       doesn't expose its upstream link (DecodedAudioReservoir).
+       Loggers on the push side of the decoded reservoir are left in place. */
+    AutoMutex _(iLock);
+    std::vector<Logger*> loggers;
+    GetLoggers(loggers);
+    UpstreamLink* link = iPipelineEnd;
+    while (link != nullptr) {
+        IPipelineElementUpstream* elem = &link->Upstream();
+        auto it = std::find(loggers.begin(), loggers.end(), elem);
+        if (it != loggers.end() && !(*it)->Enabled() && !(*it)->Profiling() && (*it)->Upstream() != nullptr) {
+            Logger* logger = *it;
+            elem = logger->Upstream();
+            link->Splice(*elem);
+            iSplicedLoggers.push_back(SplicedLogger(*logger, *link));
+            LOG(kPipeline, "Pipeline: elided logger %s\n", logger->Id());
+        }
+        link = elem->SpliceableUpstream();
+    }
+}
+
 void Pipeline::Push(Msg* aMsg)
 {
     iPipelineStart->Push(aMsg);
@@ -822,6 +1154,11 @@ Msg* Pipeline::Pull()
     return iPipelineEnd->Pull();
 }
 
+void Pipeline::PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs)
+{
+    iPipelineEnd->PullBatch(aQueue, (aMaxMsgs < kMaxPullBatchMsgs? aMaxMsgs : kMaxPullBatchMsgs));
+}
+
 void Pipeline::SetAnimator(IPipelineAnimator& aAnimator)
 {
     iSampleRateValidator->SetAnimator(aAnimator);
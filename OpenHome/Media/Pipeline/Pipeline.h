@@ -11,6 +11,9 @@
 #include <OpenHome/Media/Pipeline/StarvationRamper.h>
 #include <OpenHome/Media/MuteManager.h>
 #include <OpenHome/Media/Pipeline/Attenuator.h>
+#include <OpenHome/Media/Pipeline/ThreadScheduling.h>
+
+#include <vector>
 
 EXCEPTION(PipelineStreamNotPausable)
 
@@ -49,9 +52,20 @@ public:
     void SetEmergencyRamp(TUint aJiffies);
     void SetThreadPriorityMax(TUint aPriority); // highest priority used by pipeline
     void SetThreadPriorities(TUint aStarvationRamper, TUint aCodec, TUint aEvent);
+    void SetEventThreads(TUint aCount); // threads shared by element observer callbacks.  >1 stops a slow observer delaying others
     void SetMaxLatency(TUint aJiffies);
     void SetSupportElements(TUint aElements); // EPipelineSupportElements members OR'd together
     void SetMuter(MuterImpl aMuter);
+    void SetAllocatorImpl(AllocatorBase::Impl aImpl);
+    void SetAllocatorStorage(AllocatorBase::Storage aStorage);
+    void SetAllocatorGrowth(const AllocatorGrowth& aGrowth); // pool sizes below become ceilings for elastic pools.  Elastic pools require Impl::eLocking and Storage::eHeap
+    void SetAudioDataSizeClasses(TBool aEnable); // allocate decoded audio from 1k/2k/4k/max pools.  Elastic unless a lock-free or slab allocator is set
+    void SetDecodedAudioFormat(DecodedAudioFormat aFormat); // NativeInt32 avoids repacking for IPcmProcessors that override ProcessFragmentNative32
+    void SetElideDisabledLoggers(TBool aElide); // splice disabled Loggers out of the pull chain at Start(); see Pipeline::SetLoggerEnabled
+    void SetVariableDelayLine(TUint aJiffies); // capacity (at 192kHz stereo) of the delay line in each VariableDelay.  0 => delay changes insert silence or discard audio
+    void SetThreadAffinity(PipelineThread aThread, TUint64 aCpuMask); // bit n set => may run on cpu n.  0 (default) => unchanged
+    void SetThreadPolicy(PipelineThread aThread, ThreadSchedPolicy aPolicy, TUint aPriority); // OS policy and priority, applied over the abstract priorities above
+    void SetLockMemory(TBool aLock); // mlockall() once msg pools are allocated
     // getters
     TUint EncodedReservoirBytes() const;
     TUint DecodedReservoirJiffies() const;
@@ -64,9 +78,18 @@ public:
     TUint ThreadPriorityStarvationRamper() const;
     TUint ThreadPriorityCodec() const;
     TUint ThreadPriorityEvent() const;
+    TUint EventThreads() const;
     TUint MaxLatencyJiffies() const;
     TUint SupportElements() const;
     MuterImpl Muter() const;
+    AllocatorBase::Impl AllocatorImpl() const;
+    AllocatorBase::Storage AllocatorStorage() const;
+    const AllocatorGrowth& AllocatorGrowthParams() const;
+    TBool AudioDataSizeClasses() const;
+    DecodedAudioFormat DecodedFormat() const;
+    TBool ElideDisabledLoggers() const;
+    TUint VariableDelayLineJiffies() const;
+    const ThreadSchedulingParams& SchedulingParams() const;
 private:
     PipelineInitParams();
 private:
@@ -81,9 +104,18 @@ private:
     TUint iThreadPriorityStarvationRamper;
     TUint iThreadPriorityCodec;
     TUint iThreadPriorityEvent;
+    TUint iEventThreads;
     TUint iMaxLatencyJiffies;
     TUint iSupportElements;
     MuterImpl iMuter;
+    AllocatorBase::Impl iAllocatorImpl;
+    AllocatorBase::Storage iAllocatorStorage;
+    AllocatorGrowth iAllocatorGrowth;
+    TBool iAudioDataSizeClasses;
+    DecodedAudioFormat iDecodedAudioFormat;
+    TBool iElideDisabledLoggers;
+    TUint iVariableDelayLineJiffies;
+    ThreadSchedulingParams iThreadScheduling;
 private:
     static const TUint kEncodedReservoirSizeBytes       = 1536 * 1024;
     static const TUint kDecodedReservoirSize            = Jiffies::kPerMs * 2000;
@@ -96,6 +128,13 @@ private:
     static const TUint kThreadPriorityMax               = kPriorityHighest - 1;
     static const TUint kMaxLatencyDefault               = Jiffies::kPerMs * 2000;
     static const MuterImpl kMuterDefault                = MuterImpl::eRampSamples;
+    static const AllocatorBase::Impl kAllocatorImplDefault = AllocatorBase::Impl::eLocking;
+    static const AllocatorBase::Storage kAllocatorStorageDefault = AllocatorBase::Storage::eHeap;
+    static const TBool kAudioDataSizeClassesDefault     = false;
+    static const DecodedAudioFormat kDecodedAudioFormatDefault = DecodedAudioFormat::Packed;
+    static const TBool kElideDisabledLoggersDefault     = true;
+    static const TUint kVariableDelayLineDefault        = 0;
+    static const TUint kEventThreadsDefault             = 1;
 };
 
 namespace Codec {
@@ -106,6 +145,7 @@ namespace Codec {
 }
 class PipelineElementObserverThread;
 class AudioDumper;
+class DecodedAudioDumper;
 class EncodedAudioReservoir;
 class Logger;
 class DecodedAudioValidator;
@@ -150,6 +190,7 @@ class Pipeline : public IPipelineElementDownstream
                , private IStopperObserver
                , private IPipelinePropertyObserver
                , private IStarvationRamperObserver
+               , private IInfoProvider
 {
     friend class SuitePipeline; // test code
 
@@ -162,10 +203,13 @@ class Pipeline : public IPipelineElementDownstream
     static const TUint kMsgCountSilence         = 410; // 2secs @ 5ms per msg + 10 spare
     static const TUint kMsgCountPlayablePcm     = 10;
     static const TUint kMsgCountPlayableSilence = 10;
+    static const TUint kMaxPullBatchMsgs        = 4; // every msg in a batch may be a MsgPlayable; leaves spare for animators to split them
     static const TUint kMsgCountFlush           = 16;
     static const TUint kMsgCountMode            = 20;
     static const TUint kMsgCountQuit            = 1;
     static const TUint kMsgCountDrain           = 5;
+public:
+    static const Brn kQueryProfile;
 public:
     Pipeline(PipelineInitParams* aInitParams, IInfoAggregator& aInfoAggregator, TrackFactory& aTrackFactory, IPipelineObserver& aObserver,
              IStreamPlayObserver& aStreamPlayObserver, ISeekRestreamer& aSeekRestreamer, IUrlBlockWriter& aUrlBlockWriter);
@@ -192,10 +236,19 @@ public:
     void GetThreadPriorityRange(TUint& aMin, TUint& aMax) const;
     void GetThreadPriorities(TUint& aFlywheelRamper, TUint& aStarvationRamper, TUint& aCodec, TUint& aEvent);
     void LogBuffers() const;
+    void GetLoggerIds(std::vector<const TChar*>& aIds) const;
+    TBool SetLoggerEnabled(const Brx& aId, TBool aEnabled); // returns false if there is no Logger called aId
+    void RegisterProfile(IInfoAggregator& aInfoAggregator);
+    TBool SetProfilingEnabled(TBool aEnabled); // returns false if the pipeline was built without loggers
+    TBool ProfilingEnabled() const;
+    void ResetProfile();
+    void WriteProfile(IWriter& aWriter) const;
+    TBool SetAudioDumpEnabled(TBool aEnabled); // returns false if the pipeline was built without EPipelineSupportElementsAudioDumper
 public: // from IPipelineElementDownstream
     void Push(Msg* aMsg) override;
 public: // from IPipeline
     Msg* Pull() override;
+    void PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs) override;
     void SetAnimator(IPipelineAnimator& aAnimator) override;
 private: // from IFlushIdProvider
     TUint NextFlushId() override;
@@ -213,6 +266,8 @@ public: // from IAttenuator
 private:
     void DoPlay(TBool aQuit);
     void NotifyStatus();
+    void GetLoggers(std::vector<Logger*>& aLoggers) const;
+    void ElideDisabledLoggers();
 private: // from IStopperObserver
     void PipelinePaused() override;
     void PipelineStopped() override;
@@ -226,6 +281,8 @@ private: // from IPipelinePropertyObserver
     void NotifyStreamInfo(const DecodedStreamInfo& aStreamInfo) override;
 private: // from IStarvationRamperObserver
     void NotifyStarvationRamperBuffering(TBool aBuffering) override;
+private: // from IInfoProvider
+    void QueryInfo(const Brx& aQuery, IWriter& aWriter) override;
 private:
     enum EStatus
     {
@@ -234,6 +291,14 @@ private:
        ,EStopped
        ,EWaiting
     };
+    class SplicedLogger
+    {
+    public:
+        SplicedLogger(Logger& aLogger, UpstreamLink& aLink);
+    public:
+        Logger* iLogger;
+        UpstreamLink* iLink; // pulls from iLogger while it is enabled, from iLogger's upstream otherwise
+    };
 private:
     PipelineInitParams* iInitParams;
     IPipelineObserver& iObserver;
@@ -308,16 +373,19 @@ private:
     DecodedAudioValidator* iDecodedAudioValidatorMuter;
     AnalogBypassRamper* iAnalogBypassRamper;
     Logger* iLoggerAnalogBypassRamper;
+    DecodedAudioDumper* iDecodedAudioDumper;
     PreDriver* iPreDriver;
     Logger* iLoggerPreDriver;
     IPipelineElementDownstream* iPipelineStart;
-    IPipelineElementUpstream* iPipelineEnd;
+    UpstreamLink* iPipelineEnd;
+    std::vector<SplicedLogger> iSplicedLoggers;
     IMute* iMuteCounted;
     EStatus iState;
     EPipelineState iLastReportedState;
     TBool iBuffering;
     TBool iWaiting;
     TBool iQuitting;
+    TBool iProfiling;
     TUint iNextFlushId;
 };
 
@@ -22,7 +22,7 @@ const TUint PreDriver::kSupportedMsgTypes =   eMode
 
 PreDriver::PreDriver(IPipelineElementUpstream& aUpstreamElement)
     : PipelineElement(kSupportedMsgTypes)
-    , iUpstreamElement(aUpstreamElement)
+    , iUpstream(aUpstreamElement)
     , iSampleRate(0)
     , iBitDepth(0)
     , iNumChannels(0)
@@ -43,23 +43,49 @@ Msg* PreDriver::Pull()
 {
     Msg* msg;
     do {
-        msg = iUpstreamElement.Pull();
-        ASSERT(msg != nullptr);
-        const TBool silenceSincePcm = iSilenceSincePcm;
-        msg = msg->Process(*this);
-        if (silenceSincePcm && !iSilenceSincePcm) {
-            const TUint ms = Jiffies::ToMs(iSilenceSinceLastPcm);
-            iSilenceSinceLastPcm = 0;
-            LOG(kPipeline, "PreDriver: silence since last audio - %ums\n", ms);
-        }
-        if (iQuit) {
-            iShutdownSem.Signal();
+        msg = ProcessUpstream(iUpstream.Pull());
+    } while (msg == nullptr);
+    return msg;
+}
+
+void PreDriver::PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs)
+{
+    TUint count = 0;
+    Msg* msg = iUpstream.PullBatch(aMaxMsgs);
+    while (msg != nullptr) {
+        msg = ProcessUpstream(msg);
+        if (msg != nullptr) {
+            aQueue.Enqueue(msg);
+            if (++count == aMaxMsgs) {
+                break;
+            }
         }
+        // block until at least one msg has been output
+        msg = (count == 0? iUpstream.PullBatch(aMaxMsgs) : iUpstream.TryPull());
+    }
+}
 
-    } while (msg == nullptr);
+Msg* PreDriver::ProcessUpstream(Msg* aMsg)
+{
+    ASSERT(aMsg != nullptr);
+    const TBool silenceSincePcm = iSilenceSincePcm;
+    Msg* msg = aMsg->Process(*this);
+    if (silenceSincePcm && !iSilenceSincePcm) {
+        const TUint ms = Jiffies::ToMs(iSilenceSinceLastPcm);
+        iSilenceSinceLastPcm = 0;
+        LOG(kPipeline, "PreDriver: silence since last audio - %ums\n", ms);
+    }
+    if (iQuit) {
+        iShutdownSem.Signal();
+    }
     return msg;
 }
 
+UpstreamLink* PreDriver::SpliceableUpstream()
+{
+    return &iUpstream;
+}
+
 Msg* PreDriver::ProcessMsg(MsgMode* aMsg)
 {
     if (iModeHasPullableClock) {
@@ -105,6 +131,7 @@ Msg* PreDriver::ProcessMsg(MsgDecodedStream* aMsg)
 Msg* PreDriver::ProcessMsg(MsgAudioPcm* aMsg)
 {
     iSilenceSincePcm = false;
+    aMsg->AddLogPoint(LatencyPoint::ePreDriver);
     return aMsg->CreatePlayable();
 }
 
@@ -12,6 +12,10 @@ Element which sits at the very right of the generic pipeline.
 Passes on Format, Halt and Quit msgs.
 Only passes on Format when either sample rate and/or bit depth changes.
 Converts AudioPcm, Silence msgs to Playable.
+Playables defer format conversion, ramping and attenuation until they are read.  Animators that
+can lend a region of their output buffer should read into an AnimatorBuffer to do all of this in
+a single pass, straight into the driver's native format (see DriverSongcastSender or
+BenchmarkPipeline's AnimatorNull).
 Consumes StreamInterrupted
 */
     
@@ -23,6 +27,10 @@ public:
     virtual ~PreDriver();
 public: // from IPipelineElementUpstream
     Msg* Pull() override;
+    void PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs) override;
+    UpstreamLink* SpliceableUpstream() override;
+private:
+    Msg* ProcessUpstream(Msg* aMsg); // returns nullptr if aMsg was consumed
 private: // IMsgProcessor
     Msg* ProcessMsg(MsgMode* aMsg) override;
     Msg* ProcessMsg(MsgDrain* aMsg) override;
@@ -32,7 +40,7 @@ private: // IMsgProcessor
     Msg* ProcessMsg(MsgSilence* aMsg) override;
     Msg* ProcessMsg(MsgQuit* aMsg) override;
 private:
-    IPipelineElementUpstream& iUpstreamElement;
+    UpstreamLink iUpstream;
     TUint iSampleRate;
     TUint iBitDepth;
     TUint iNumChannels;
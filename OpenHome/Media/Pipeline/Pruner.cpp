@@ -25,7 +25,7 @@ const TUint Pruner::kSupportedMsgTypes =   eMode
 
 Pruner::Pruner(IPipelineElementUpstream& aUpstreamElement)
     : PipelineElement(kSupportedMsgTypes)
-    , iUpstreamElement(aUpstreamElement)
+    , iUpstream(aUpstreamElement)
     , iPendingMode(nullptr)
     , iWaitingForAudio(false)
     , iConsumeHalts(false)
@@ -44,7 +44,7 @@ Msg* Pruner::Pull()
     Msg* msg = nullptr;
     do {
         if (iWaitingForAudio || iQueue.IsEmpty()) {
-            msg = iUpstreamElement.Pull();
+            msg = iUpstream.Pull();
             msg = msg->Process(*this);
         }
         else if (iPendingMode != nullptr) {
@@ -58,6 +58,11 @@ Msg* Pruner::Pull()
     return msg;
 }
 
+UpstreamLink* Pruner::SpliceableUpstream()
+{
+    return &iUpstream;
+}
+
 Msg* Pruner::TryQueue(Msg* aMsg)
 {
     if (iWaitingForAudio) {
@@ -25,6 +25,7 @@ public:
     virtual ~Pruner();
 public: // from IPipelineElementUpstream
     Msg* Pull() override;
+    UpstreamLink* SpliceableUpstream() override;
 private:
     Msg* TryQueue(Msg* aMsg);
     Msg* TryQueueCancelWaiting(Msg* aMsg);
@@ -40,7 +41,7 @@ private: // IMsgProcessor
     Msg* ProcessMsg(MsgSilence* aMsg) override;
     Msg* ProcessMsg(MsgQuit* aMsg) override;
 private:
-    IPipelineElementUpstream& iUpstreamElement;
+    UpstreamLink iUpstream;
     MsgQueueLite iQueue;
     MsgMode* iPendingMode;
     TBool iWaitingForAudio;
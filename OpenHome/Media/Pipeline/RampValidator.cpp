@@ -30,7 +30,7 @@ const TUint RampValidator::kSupportedMsgTypes =   eMode
 RampValidator::RampValidator(IPipelineElementUpstream& aUpstream, const TChar* aId)
     : PipelineElement(kSupportedMsgTypes)
     , iId(aId)
-    , iUpstream(&aUpstream)
+    , iUpstream(aUpstream)
     , iDownstream(nullptr)
     , iRampedDown(false)
     , iWaitingForAudio(true)
@@ -41,7 +41,6 @@ RampValidator::RampValidator(IPipelineElementUpstream& aUpstream, const TChar* a
 RampValidator::RampValidator(const TChar* aId, IPipelineElementDownstream& aDownstream)
     : PipelineElement(kSupportedMsgTypes)
     , iId(aId)
-    , iUpstream(nullptr)
     , iDownstream(&aDownstream)
     , iRampedDown(false)
     , iWaitingForAudio(true)
@@ -54,13 +53,30 @@ RampValidator::~RampValidator()
 
 Msg* RampValidator::Pull()
 {
-    ASSERT(iUpstream != nullptr);
-    Msg* msg = iUpstream->Pull();
+    ASSERT(iDownstream == nullptr);
+    Msg* msg = iUpstream.Pull();
     msg = msg->Process(*this);
     ASSERT(msg != nullptr);
     return msg;
 }
 
+void RampValidator::PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs)
+{
+    ASSERT(iDownstream == nullptr);
+    Msg* msg = iUpstream.PullBatch(aMaxMsgs);
+    TUint count = 0;
+    do {
+        msg = msg->Process(*this);
+        ASSERT(msg != nullptr);
+        aQueue.Enqueue(msg);
+    } while (++count < aMaxMsgs && (msg = iUpstream.TryPull()) != nullptr);
+}
+
+UpstreamLink* RampValidator::SpliceableUpstream()
+{
+    return (iDownstream == nullptr? &iUpstream : nullptr);
+}
+
 void RampValidator::Push(Msg* aMsg)
 {
     ASSERT(iDownstream != nullptr);
@@ -21,6 +21,8 @@ public:
     virtual ~RampValidator();
 public: // from IPipelineElementUpstream
     Msg* Pull() override;
+    void PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs) override;
+    UpstreamLink* SpliceableUpstream() override;
 public: // from IPipelineElementDownstream
     void Push(Msg* aMsg) override;
 private:
@@ -37,7 +39,7 @@ private: // IMsgProcessor
     Msg* ProcessMsg(MsgSilence* aMsg) override;
 private:
     const TChar* iId;
-    IPipelineElementUpstream* iUpstream;
+    UpstreamLink iUpstream; // unattached if iDownstream is non-null
     IPipelineElementDownstream* iDownstream;
     TBool iRamping;
     TBool iRampedDown;
@@ -24,7 +24,7 @@ const TUint Ramper::kSupportedMsgTypes =   eMode
 
 Ramper::Ramper(IPipelineElementUpstream& aUpstreamElement, TUint aRampDuration)
     : PipelineElement(kSupportedMsgTypes)
-    , iUpstreamElement(aUpstreamElement)
+    , iUpstream(aUpstreamElement)
     , iStreamId(IPipelineIdProvider::kStreamIdInvalid)
     , iRamping(false)
     , iRampDuration(aRampDuration)
@@ -44,13 +44,18 @@ Msg* Ramper::Pull()
         msg = iQueue.Dequeue();
     }
     else {
-        msg = iUpstreamElement.Pull();
+        msg = iUpstream.Pull();
     }
     msg = msg->Process(*this);
     ASSERT(msg != nullptr);
     return msg;
 }
 
+UpstreamLink* Ramper::SpliceableUpstream()
+{
+    return &iUpstream;
+}
+
 Msg* Ramper::ProcessMsg(MsgHalt* aMsg)
 {
     iRamping = false;
@@ -79,13 +84,6 @@ Msg* Ramper::ProcessMsg(MsgAudioPcm* aMsg)
 {
     if (iRamping) {
         MsgAudio* split;
-        if (aMsg->Jiffies() > iRemainingRampSize) {
-            split = aMsg->Split(iRemainingRampSize);
-            if (split != nullptr) {
-                iQueue.Enqueue(split);
-            }
-        }
-        split = nullptr;
         iCurrentRampValue = aMsg->SetRamp(iCurrentRampValue, iRemainingRampSize, Ramp::EUp, split);
         if (split != nullptr) {
             iQueue.EnqueueAtHead(split);
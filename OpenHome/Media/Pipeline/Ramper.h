@@ -22,13 +22,14 @@ public:
     virtual ~Ramper();
 public: // from IPipelineElementUpstream
     Msg* Pull() override;
+    UpstreamLink* SpliceableUpstream() override;
 private: // IMsgProcessor
     Msg* ProcessMsg(MsgHalt* aMsg) override;
     Msg* ProcessMsg(MsgDecodedStream* aMsg) override;
     Msg* ProcessMsg(MsgAudioPcm* aMsg) override;
     Msg* ProcessMsg(MsgSilence* aMsg) override;
 private:
-    IPipelineElementUpstream& iUpstreamElement;
+    UpstreamLink iUpstream;
     TUint iStreamId;
     TBool iRamping;
     const TUint iRampDuration;
@@ -68,6 +68,11 @@ Msg* Reporter::Pull()
     return msg;
 }
 
+UpstreamLink* Reporter::SpliceableUpstream()
+{
+    return &iUpstreamElement;
+}
+
 Msg* Reporter::ProcessMsg(MsgMode* aMsg)
 {
     AutoMutex _(iLock);
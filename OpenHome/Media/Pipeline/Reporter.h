@@ -37,6 +37,7 @@ public:
     virtual ~Reporter();
 public: // from IPipelineElementUpstream
     Msg* Pull() override;
+    UpstreamLink* SpliceableUpstream() override;
 private: // IMsgProcessor
     Msg* ProcessMsg(MsgMode* aMsg) override;
     Msg* ProcessMsg(MsgTrack* aMsg) override;
@@ -48,7 +49,7 @@ private:
     void EventCallback();
 private:
     Mutex iLock;
-    IPipelineElementUpstream& iUpstreamElement;
+    UpstreamLink iUpstreamElement;
     IPipelinePropertyObserver& iObserver;
     IPipelineElementObserverThread& iObserverThread;
     TUint iEventId;
@@ -17,7 +17,7 @@ Router::Router(IPipelineElementUpstream& aUpstream)
 IPipelineElementUpstream& Router::InsertElements(IPipelineElementUpstream& aTail)
 {
     iBranch = &aTail;
-    return iUpstream;
+    return iUpstream.Upstream();
 }
 
 Msg* Router::Pull()
@@ -27,3 +27,8 @@ Msg* Router::Pull()
     }
     return iUpstream.Pull();
 }
+
+UpstreamLink* Router::SpliceableUpstream()
+{
+    return &iUpstream;
+}
@@ -14,8 +14,9 @@ public:
     IPipelineElementUpstream& InsertElements(IPipelineElementUpstream& aTail);
 private: // from IPipelineElementUpstream
     Msg* Pull() override;
+    UpstreamLink* SpliceableUpstream() override;
 private:
-    IPipelineElementUpstream& iUpstream;
+    UpstreamLink iUpstream;
     IPipelineElementUpstream* iBranch;
 };
 
@@ -91,6 +91,11 @@ Msg* Seeker::Pull()
     return msg;
 }
 
+UpstreamLink* Seeker::SpliceableUpstream()
+{
+    return iFlusher.SpliceableUpstream();
+}
+
 Msg* Seeker::ProcessMsg(MsgMode* aMsg)
 {
     iMode.Replace(aMsg->Mode());
@@ -235,19 +240,8 @@ Msg* Seeker::ProcessMsg(MsgAudioPcm* aMsg)
         iStreamPosJiffies = iFlushEndJiffies;
     }
     else if (iState == ERampingDown || iState == ERampingUp) {
-        MsgAudio* split;
-        if (aMsg->Jiffies() > iRemainingRampSize) {
-            split = aMsg->Split(iRemainingRampSize);
-            if (split != nullptr) {
-                if (iState == ERampingDown) {
-                    split->SetMuted();
-                }
-                iQueue.EnqueueAtHead(split);
-                iStreamPosJiffies -= split->Jiffies();
-            }
-        }
-        split = nullptr;
         const Ramp::EDirection direction = (iState == ERampingDown? Ramp::EDown : Ramp::EUp);
+        MsgAudio* split;
         iCurrentRampValue = aMsg->SetRamp(iCurrentRampValue, iRemainingRampSize, direction, split);
         if (split != nullptr) {
             if (iState == ERampingDown) {
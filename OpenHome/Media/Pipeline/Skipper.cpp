@@ -9,16 +9,20 @@
 using namespace OpenHome;
 using namespace OpenHome::Media;
 
-Skipper::Skipper(MsgFactory& aMsgFactory, IPipelineElementUpstream& aUpstreamElement, TUint aRampDuration)
+Skipper::Skipper(MsgFactory& aMsgFactory, IPipelineElementUpstream& aUpstreamElement, IReservoirLevel& aDecodedAudio, TUint aRampDuration)
     : iFlusher(aUpstreamElement, "Skipper")
     , iMsgFactory(aMsgFactory)
+    , iDecodedAudio(aDecodedAudio)
     , iLock("SKP1")
     , iBlocker("SKP2")
     , iState(eStarting)
     , iRampDuration(aRampDuration)
+    , iSampleRate(0)
     , iRemainingRampSize(0)
     , iCurrentRampValue(Ramp::kMax)
     , iTargetFlushId(MsgFlush::kIdInvalid)
+    , iRampStopped(false)
+    , iRampFlushId(MsgFlush::kIdInvalid)
     , iTargetHaltId(MsgHalt::kIdInvalid)
     , iStreamId(IPipelineIdProvider::kStreamIdInvalid)
     , iStreamHandler(nullptr)
@@ -82,6 +86,11 @@ Msg* Skipper::Pull()
     return msg;
 }
 
+UpstreamLink* Skipper::SpliceableUpstream()
+{
+    return iFlusher.SpliceableUpstream();
+}
+
 Msg* Skipper::ProcessMsg(MsgMode* aMsg)
 {
     iStreamId = IPipelineIdProvider::kStreamIdInvalid;
@@ -161,6 +170,26 @@ Msg* Skipper::ProcessMsg(MsgHalt* aMsg)
 
 Msg* Skipper::ProcessMsg(MsgFlush* aMsg)
 {
+    if (iState == eRamping && iRampStopped && iRampFlushId == aMsg->Id()) {
+        /* Less audio for this stream was buffered upstream than reported (e.g. the reservoir
+           also held the start of the next stream).  There's nothing left to flush so end the
+           ramp here. */
+        LOG(kPipeline, "Skipper - pulled flush %u before ramp completed\n", iRampFlushId);
+        iRampStopped = false;
+        iRampFlushId = MsgFlush::kIdInvalid;
+        iRemainingRampSize = 0;
+        iCurrentRampValue = Ramp::kMin;
+        iQueue.Enqueue(iMsgFactory.CreateMsgHalt());
+        if (iTargetHaltId != MsgHalt::kIdNone && iTargetHaltId != MsgHalt::kIdInvalid) {
+            iState = eFlushing;
+            iFlusher.DiscardUntilHalt(iTargetHaltId);
+        }
+        else {
+            iState = eStarting;
+        }
+        aMsg->RemoveRef();
+        return nullptr;
+    }
     if (iTargetFlushId != MsgFlush::kIdInvalid && iTargetFlushId == aMsg->Id()) {
         ASSERT(iState == eFlushing);
         iState = eStarting;
@@ -186,6 +215,7 @@ Msg* Skipper::ProcessMsg(MsgWait* aMsg)
 Msg* Skipper::ProcessMsg(MsgDecodedStream* aMsg)
 {
     iState = (iTargetFlushId == MsgFlush::kIdInvalid? eStarting : eFlushing);
+    iSampleRate = aMsg->StreamInfo().SampleRate();
     auto msg = iMsgFactory.CreateMsgDecodedStream(aMsg, this);
     aMsg->RemoveRef();
     return msg;
@@ -207,13 +237,6 @@ Msg* Skipper::ProcessMsg(MsgAudioPcm* aMsg)
     }
     else if (iState == eRamping) {
         MsgAudio* split;
-        if (aMsg->Jiffies() > iRemainingRampSize) {
-            split = aMsg->Split(iRemainingRampSize);
-            if (split != nullptr) {
-                split->RemoveRef(); // we're going to flush the rest of the stream so no need to add split to iQueue
-            }
-        }
-        split = nullptr;
         iCurrentRampValue = aMsg->SetRamp(iCurrentRampValue, iRemainingRampSize, Ramp::EDown, split);
         if (split != nullptr) {
             split->RemoveRef(); // we're going to flush the rest of the stream so no need to add split to iQueue
@@ -221,6 +244,9 @@ Msg* Skipper::ProcessMsg(MsgAudioPcm* aMsg)
         if (iRemainingRampSize == 0) {
             StartFlushing();
         }
+        else {
+            TryStopIfRampBuffered();
+        }
         return aMsg;
     }
 
@@ -305,10 +331,34 @@ TBool Skipper::TryRemoveCurrentStream(TBool aRampDown)
         iState = eRamping;
         iRemainingRampSize = iRampDuration;
         iCurrentRampValue = Ramp::kMax;
+        iRampStopped = false;
+        iRampFlushId = MsgFlush::kIdInvalid;
+        /* Stopping upstream straight away saves most codec work.  If less than a full ramp is
+           buffered, ramp over what is buffered so that stopping can't cut the ramp short. */
+        TUint buffered = iDecodedAudio.ReservoirLevel();
+        Jiffies::RoundDown(buffered, iSampleRate);
+        if (buffered > 0 && buffered < iRemainingRampSize) {
+            iRemainingRampSize = buffered;
+        }
+        TryStopIfRampBuffered();
     }
     return (state != iState);
 }
 
+void Skipper::TryStopIfRampBuffered()
+{
+    /* A skip can't be cancelled so there's no need to wait for the ramp to complete before
+       stopping the stream.  Anything the codec decodes after the ramp is certain to be discarded.
+       Only stop once enough decoded audio is buffered to complete the ramp though - stopping
+       earlier risks the stream's flush arriving part way through the ramp.  This only defers
+       stopping if nothing was buffered when the ramp started (see TryRemoveCurrentStream). */
+    if (iRampStopped || iStreamHandler == nullptr || iDecodedAudio.ReservoirLevel() < iRemainingRampSize) {
+        return;
+    }
+    iRampStopped = true;
+    iRampFlushId = iStreamHandler->TryStop(iStreamId);
+}
+
 void Skipper::StartFlushing(TBool aGenerateHalt)
 {
     if (aGenerateHalt) {
@@ -316,7 +366,14 @@ void Skipper::StartFlushing(TBool aGenerateHalt)
                                                         that any subsequent break in audio is expected */
     }
     iState = eFlushing;
-    iTargetFlushId = (iStreamHandler==nullptr? MsgFlush::kIdInvalid : iStreamHandler->TryStop(iStreamId));
+    if (iRampStopped) {
+        iTargetFlushId = iRampFlushId;
+        iRampStopped = false;
+        iRampFlushId = MsgFlush::kIdInvalid;
+    }
+    else {
+        iTargetFlushId = (iStreamHandler==nullptr? MsgFlush::kIdInvalid : iStreamHandler->TryStop(iStreamId));
+    }
     if (iTargetHaltId != MsgHalt::kIdNone && iTargetHaltId != MsgHalt::kIdInvalid) {
         iFlusher.DiscardUntilHalt(iTargetHaltId);
     }
@@ -336,6 +393,8 @@ Msg* Skipper::ProcessFlushable(Msg* aMsg)
 
 void Skipper::NewStream()
 {
+    iRampStopped = false; // previous stream ended before its ramp completed
+    iRampFlushId = MsgFlush::kIdInvalid;
     iRemainingRampSize = 0;
     iCurrentRampValue = Ramp::kMax;
     iState = (iTargetFlushId == MsgFlush::kIdInvalid? eStarting : eFlushing);
@@ -4,6 +4,7 @@
 #include <OpenHome/Private/Thread.h>
 #include <OpenHome/Media/Pipeline/Msg.h>
 #include <OpenHome/Media/Pipeline/Flusher.h>
+#include <OpenHome/Media/Pipeline/ElementProfile.h>
 
 namespace OpenHome {
 namespace Media {
@@ -11,7 +12,10 @@ namespace Media {
 /*
 Element which skips to the end of a track
 If the track is playing when *RemoveStream() is called, it is first ramped down
-...followed by calling IStreamHandler::TryStop to attempt to stop delivery of the current stream
+...IStreamHandler::TryStop is called to attempt to stop delivery (and decoding) of the current
+   stream as soon as the ramp starts.  The ramp is shortened to the decoded audio buffered
+   upstream if that is less than the ramp duration.  If nothing is buffered, TryStop is deferred
+   until enough audio is buffered to complete the ramp (or until the ramp completes)
 ...followed by pulling/discarding all remaining content for that stream
 If the pipeline is paused when *RemoveStream() is called, we move straight to pulling/discarding
 If TryStop returned a valid flush id, the MsgFlush with this id is consumed
@@ -21,7 +25,7 @@ class Skipper : public IPipelineElementUpstream, private IMsgProcessor, private
 {
     friend class SuiteSkipper;
 public:
-    Skipper(MsgFactory& aMsgFactory, IPipelineElementUpstream& aUpstreamElement, TUint aRampDuration);
+    Skipper(MsgFactory& aMsgFactory, IPipelineElementUpstream& aUpstreamElement, IReservoirLevel& aDecodedAudio, TUint aRampDuration);
     virtual ~Skipper();
     void Block();
     void Unblock();
@@ -30,6 +34,7 @@ public:
     void RemoveAll(TUint aHaltId, TBool aRampDown);
 public: // from IPipelineElementUpstream
     Msg* Pull() override;
+    UpstreamLink* SpliceableUpstream() override;
 private: // from IMsgProcessor
     Msg* ProcessMsg(MsgMode* aMsg) override;
     Msg* ProcessMsg(MsgTrack* aMsg) override;
@@ -57,6 +62,7 @@ private: // from IStreamHandler
 private:
     inline TBool RemoveAllPending() const;
     TBool TryRemoveCurrentStream(TBool aRampDown);
+    void TryStopIfRampBuffered();
     void StartFlushing(TBool aGenerateHalt = true);
     Msg* ProcessFlushable(Msg* aMsg);
     void NewStream();
@@ -71,14 +77,18 @@ private:
 private:
     Flusher iFlusher;
     MsgFactory& iMsgFactory;
+    IReservoirLevel& iDecodedAudio; // jiffies
     Mutex iLock;
     Mutex iBlocker;
     EState iState;
     const TUint iRampDuration;
+    TUint iSampleRate;
     TUint iRemainingRampSize;
     TUint iCurrentRampValue;
     MsgQueue iQueue; // empty unless we have to split a msg during a ramp
     TUint iTargetFlushId;
+    TBool iRampStopped; // TryStop has been called during the current ramp
+    TUint iRampFlushId; // returned by TryStop during a ramp; becomes iTargetFlushId once the ramp completes
     TUint iTargetHaltId;
     TUint iStreamId;
     IStreamHandler* iStreamHandler;
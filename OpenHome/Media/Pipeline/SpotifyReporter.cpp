@@ -318,6 +318,11 @@ Msg* SpotifyReporter::Pull()
     return msg;
 }
 
+UpstreamLink* SpotifyReporter::SpliceableUpstream()
+{
+    return &iUpstreamElement;
+}
+
 TUint64 SpotifyReporter::SubSamples() const
 {
     AutoMutex _(iLock);
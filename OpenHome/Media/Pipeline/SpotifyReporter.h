@@ -93,6 +93,7 @@ public:
     ~SpotifyReporter();
 public: // from IPipelineElementUpstream
     Msg* Pull() override;
+    UpstreamLink* SpliceableUpstream() override;
 public: // from ISpotifyReporter
     TUint64 SubSamples() const override;
 public: // from ISpotifyTrackObserver
@@ -110,7 +111,7 @@ private:
     TUint64 TrackLengthJiffiesLocked() const;
     MsgDecodedStream* CreateMsgDecodedStreamLocked() const;
 private:
-    IPipelineElementUpstream& iUpstreamElement;
+    UpstreamLink iUpstreamElement;
     MsgFactory& iMsgFactory;
     TrackFactory& iTrackFactory;
     StartOffset iStartOffset;
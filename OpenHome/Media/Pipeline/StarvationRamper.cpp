@@ -5,6 +5,7 @@
 #include <OpenHome/Private/Printer.h>
 #include <OpenHome/Media/FlywheelRamper.h>
 #include <OpenHome/Media/Pipeline/ElementObserver.h>
+#include <OpenHome/Media/Pipeline/ThreadScheduling.h>
 #include <OpenHome/Media/Debug.h>
 //#include <OpenHome/Private/Timer.h>
 //#include <OpenHome/Net/Private/Globals.h>
@@ -192,6 +193,24 @@ void FlywheelInput::ProcessFragment32(const Brx& aData, TUint aNumChannels)
     }
 }
 
+void FlywheelInput::ProcessFragmentNative32(const Brx& aData, TUint aNumChannels, TUint /*aBitDepth*/)
+{
+    // already left-aligned 32-bit so only needs converting to big endian
+    const TInt32* src = reinterpret_cast<const TInt32*>(aData.Ptr());
+    const TUint numSubsamples = aData.Bytes() / DecodedAudio::kNativeBytesPerSubsample;
+    const TUint numSamples = numSubsamples / aNumChannels;
+    for (TUint i=0; i<numSamples; i++) {
+        for (TUint j=0; j<aNumChannels; j++) {
+            const TUint32 subsample = (TUint32)*src++;
+            TByte*& dest = iChannelPtr[j];
+            *dest++ = (TByte)(subsample >> 24);
+            *dest++ = (TByte)(subsample >> 16);
+            *dest++ = (TByte)(subsample >> 8);
+            *dest++ = (TByte)subsample;
+        }
+    }
+}
+
 void FlywheelInput::EndBlock()
 {
 }
@@ -266,6 +285,7 @@ TBool RampGenerator::TryGetAudio(Msg*& aMsg)
 
 void RampGenerator::FlywheelRamperThread()
 {
+    ThreadScheduling::Apply(PipelineThread::eFlywheelRamper);
     try {
         for (;;) {
             iThread->Wait();
@@ -390,7 +410,7 @@ StarvationRamper::StarvationRamper(MsgFactory& aMsgFactory, IPipelineElementUpst
     , iLastEventBuffering(false)
 {
     ASSERT(iEventBuffering.is_lock_free());
-    iEventId = iObserverThread.Register(MakeFunctor(*this, &StarvationRamper::EventCallback));
+    iEventId = iObserverThread.Register(MakeFunctor(*this, &StarvationRamper::EventCallback), kEventIntervalMs);
     iEventBuffering.store(false); // ensure SetBuffering call below detects a state change
     SetBuffering(true);
 
@@ -412,6 +432,11 @@ TUint StarvationRamper::SizeInJiffies() const
     return Jiffies();
 }
 
+TUint StarvationRamper::ReservoirLevel() const
+{
+    return Jiffies();
+}
+
 TUint StarvationRamper::ThreadPriorityFlywheelRamper() const
 {
     return iThreadPriorityFlywheelRamper;
@@ -427,8 +452,17 @@ inline TBool StarvationRamper::IsFull() const
     return (Jiffies() >= iMaxJiffies || DecodedStreamCount() == iMaxStreamCount);
 }
 
+void StarvationRamper::SignalIfNotFull()
+{
+    AutoMutex _(iLock);
+    if (!IsFull()) {
+        iSem.Signal();
+    }
+}
+
 void StarvationRamper::PullerThread()
 {
+    ThreadScheduling::Apply(PipelineThread::eStarvationRamper);
     do {
         Msg* msg = iUpstream.Pull();
         iLock.Wait();
@@ -567,15 +601,32 @@ Msg* StarvationRamper::Pull()
         }
 
         msg = DoDequeue(true);
-        iLock.Wait();
-        if (!IsFull()) {
-            iSem.Signal();
-        }
-        iLock.Signal();
+        SignalIfNotFull();
     } while (msg == nullptr);
     return msg;
 }
 
+void StarvationRamper::PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs)
+{
+    aQueue.Enqueue(Pull());
+    /* Only take further msgs that are already buffered.  Waiting for more would delay the
+       driver; starting or completing a flywheel ramp is left to the next Pull(). */
+    TUint count = 1;
+    while (count < aMaxMsgs && iState != State::RampingDown && !IsEmpty()) {
+        Msg* msg = DoDequeue(true);
+        SignalIfNotFull();
+        if (msg != nullptr) {
+            aQueue.Enqueue(msg);
+            count++;
+        }
+    }
+}
+
+UpstreamLink* StarvationRamper::SpliceableUpstream()
+{
+    return &iUpstream;
+}
+
 void StarvationRamper::ProcessMsgIn(MsgDelay* aMsg)
 {
     iMaxJiffies = aMsg->DelayJiffies();
@@ -652,10 +703,6 @@ Msg* StarvationRamper::ProcessMsgOut(MsgAudioPcm* aMsg)
     }
 
     if (iState == State::RampingUp && iRemainingRampSize > 0) {
-        if (aMsg->Jiffies() > iRemainingRampSize) {
-            MsgAudio* remaining = aMsg->Split(iRemainingRampSize);
-            EnqueueAtHead(remaining);
-        }
         MsgAudio* split;
         iCurrentRampValue = aMsg->SetRamp(iCurrentRampValue, iRemainingRampSize, Ramp::EUp, split);
         if (split != nullptr) {
@@ -668,6 +715,7 @@ Msg* StarvationRamper::ProcessMsgOut(MsgAudioPcm* aMsg)
 
     ProcessAudioOut(aMsg);
     SetBuffering(false);
+    aMsg->AddLogPoint(LatencyPoint::eStarvationRamper);
 
     return aMsg;
 }
@@ -2,6 +2,7 @@
 
 #include <OpenHome/Types.h>
 #include <OpenHome/Media/Pipeline/Msg.h>
+#include <OpenHome/Media/Pipeline/ElementProfile.h>
 #include <OpenHome/Private/Thread.h>
 
 #include <cstdint>
@@ -36,6 +37,7 @@ private: // from IPcmProcessor
     void ProcessFragment16(const Brx& aData, TUint aNumChannels) override;
     void ProcessFragment24(const Brx& aData, TUint aNumChannels) override;
     void ProcessFragment32(const Brx& aData, TUint aNumChannels) override;
+    void ProcessFragmentNative32(const Brx& aData, TUint aNumChannels, TUint aBitDepth) override;
     void EndBlock() override;
     void Flush() override;
 private:
@@ -85,12 +87,13 @@ private:
 class IStarvationMonitorObserver;
 class IPipelineElementObserverThread;
 
-class StarvationRamper : public MsgReservoir, public IPipelineElementUpstream
+class StarvationRamper : public MsgReservoir, public IPipelineElementUpstream, public IReservoirLevel
 {
     friend class SuiteStarvationRamper;
     static const TUint kTrainingJiffies;
     static const TUint kRampDownJiffies;
     static const TUint kMaxAudioOutJiffies;
+    static const TUint kEventIntervalMs = 20; // coalesce rapid buffering toggles
 public:
     StarvationRamper(MsgFactory& aMsgFactory, IPipelineElementUpstream& aUpstream,
                      IStarvationRamperObserver& aObserver,
@@ -102,6 +105,7 @@ public:
     TUint ThreadPriorityStarvationRamper() const;
 private:
     inline TBool IsFull() const;
+    void SignalIfNotFull();
     void PullerThread();
     void StartFlywheelRamp();
     void NewStream();
@@ -110,6 +114,10 @@ private:
     void EventCallback();
 private: // from IPipelineElementUpstream
     Msg* Pull() override;
+    void PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs) override;
+    UpstreamLink* SpliceableUpstream() override;
+private: // from IReservoirLevel
+    TUint ReservoirLevel() const override;
 private: // from MsgReservoir
     void ProcessMsgIn(MsgDelay* aMsg) override;
     void ProcessMsgIn(MsgQuit* aMsg) override;
@@ -131,7 +139,7 @@ private:
     };
 private:
     MsgFactory& iMsgFactory;
-    IPipelineElementUpstream& iUpstream;
+    UpstreamLink iUpstream;
     IStarvationRamperObserver& iObserver;
     IPipelineElementObserverThread& iObserverThread;
     TUint iMaxJiffies;
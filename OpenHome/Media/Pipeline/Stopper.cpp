@@ -14,7 +14,7 @@ using namespace OpenHome::Media;
 Stopper::Stopper(MsgFactory& aMsgFactory, IPipelineElementUpstream& aUpstreamElement, IStopperObserver& aObserver,
                  IPipelineElementObserverThread& aObserverThread, TUint aRampDuration)
     : iMsgFactory(aMsgFactory)
-    , iUpstreamElement(aUpstreamElement)
+    , iUpstream(aUpstreamElement)
     , iObserver(aObserver)
     , iObserverThread(aObserverThread)
     , iLock("STP1")
@@ -201,7 +201,7 @@ Msg* Stopper::Pull()
                 LOG(kPipeline, "Stopper::Pull(), waiting, iState=%s\n", State());
                 iSem.Wait();
             }
-            msg = (iQueue.IsEmpty()? iUpstreamElement.Pull() : iQueue.Dequeue());
+            msg = (iQueue.IsEmpty()? iUpstream.Pull() : iQueue.Dequeue());
             iLock.Wait();
             msg = msg->Process(*this);
             iLock.Signal();
@@ -213,6 +213,11 @@ Msg* Stopper::Pull()
     return msg;
 }
 
+UpstreamLink* Stopper::SpliceableUpstream()
+{
+    return &iUpstream;
+}
+
 Msg* Stopper::ProcessMsg(MsgMode* aMsg)
 {
     return aMsg;
@@ -333,18 +338,8 @@ Msg* Stopper::ProcessMsg(MsgBitRate* aMsg)
 Msg* Stopper::ProcessMsg(MsgAudioPcm* aMsg)
 {
     if (iState == ERampingDown || iState == ERampingUp) {
-        MsgAudio* split;
-        if (aMsg->Jiffies() > iRemainingRampSize && iRemainingRampSize > 0) {
-            split = aMsg->Split(iRemainingRampSize);
-            if (split != nullptr) {
-                if (iState == ERampingDown) {
-                    split->SetMuted();
-                }
-                iQueue.EnqueueAtHead(split);
-            }
-        }
-        split = nullptr;
         const Ramp::EDirection direction = (iState == ERampingDown? Ramp::EDown : Ramp::EUp);
+        MsgAudio* split = nullptr;
         if (iRemainingRampSize > 0) {
             iCurrentRampValue = aMsg->SetRamp(iCurrentRampValue, iRemainingRampSize, direction, split);
         }
@@ -52,6 +52,7 @@ public:
     void Quit();
 public: // from IPipelineElementUpstream
     Msg* Pull() override;
+    UpstreamLink* SpliceableUpstream() override;
 private: // from IMsgProcessor
     Msg* ProcessMsg(MsgMode* aMsg) override;
     Msg* ProcessMsg(MsgTrack* aMsg) override;
@@ -107,7 +108,7 @@ private:
     static const TChar* State(EState aState);
 private:
     MsgFactory& iMsgFactory;
-    IPipelineElementUpstream& iUpstreamElement;
+    UpstreamLink iUpstream;
     IStopperObserver& iObserver;
     IPipelineElementObserverThread& iObserverThread;
     Mutex iLock;
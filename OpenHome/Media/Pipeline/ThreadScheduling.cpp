@@ -0,0 +1,186 @@
+#include <OpenHome/Media/Pipeline/ThreadScheduling.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Private/Printer.h>
+
+#ifdef __linux__
+# include <pthread.h>
+# include <sched.h>
+# include <sys/mman.h>
+# include <errno.h>
+#endif
+
+using namespace OpenHome;
+using namespace OpenHome::Media;
+
+// ThreadSchedulingParams
+
+ThreadSchedulingParams::Entry::Entry()
+    : iCpuMask(0)
+    , iPolicy(ThreadSchedPolicy::eDefault)
+    , iPriority(0)
+{
+}
+
+ThreadSchedulingParams::ThreadSchedulingParams()
+    : iLockMemory(false)
+{
+}
+
+void ThreadSchedulingParams::SetAffinity(PipelineThread aThread, TUint64 aCpuMask)
+{
+    iThreads[(TUint)aThread].iCpuMask = aCpuMask;
+}
+
+void ThreadSchedulingParams::SetPolicy(PipelineThread aThread, ThreadSchedPolicy aPolicy, TUint aPriority)
+{
+    Entry& entry = iThreads[(TUint)aThread];
+    entry.iPolicy = aPolicy;
+    entry.iPriority = aPriority;
+}
+
+void ThreadSchedulingParams::SetLockMemory(TBool aLock)
+{
+    iLockMemory = aLock;
+}
+
+TUint64 ThreadSchedulingParams::Affinity(PipelineThread aThread) const
+{
+    return iThreads[(TUint)aThread].iCpuMask;
+}
+
+ThreadSchedPolicy ThreadSchedulingParams::Policy(PipelineThread aThread) const
+{
+    return iThreads[(TUint)aThread].iPolicy;
+}
+
+TUint ThreadSchedulingParams::Priority(PipelineThread aThread) const
+{
+    return iThreads[(TUint)aThread].iPriority;
+}
+
+TBool ThreadSchedulingParams::LockMemory() const
+{
+    return iLockMemory;
+}
+
+TBool ThreadSchedulingParams::IsDefault(PipelineThread aThread) const
+{
+    const Entry& entry = iThreads[(TUint)aThread];
+    return entry.iCpuMask == 0 && entry.iPolicy == ThreadSchedPolicy::eDefault;
+}
+
+
+// ThreadScheduling
+
+ThreadSchedulingParams ThreadScheduling::iParams;
+
+void ThreadScheduling::Configure(const ThreadSchedulingParams& aParams)
+{ // static
+    iParams = aParams;
+    for (TUint i=0; i<ThreadSchedulingParams::kNumThreads; i++) {
+        const PipelineThread thread = (PipelineThread)i;
+        if (!iParams.IsDefault(thread)) {
+            Log::Print("ThreadScheduling: %s - cpus=0x%llx, policy=%s, priority=%u\n",
+                       Name(thread), iParams.Affinity(thread),
+                       PolicyName(iParams.Policy(thread)), iParams.Priority(thread));
+        }
+    }
+}
+
+void ThreadScheduling::LockMemory()
+{ // static
+    if (!iParams.LockMemory()) {
+        return;
+    }
+#ifdef __linux__
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+        Log::Print("ThreadScheduling: memory locked\n");
+    }
+    else {
+        Log::Print("ThreadScheduling: mlockall failed (errno=%d)\n", errno);
+    }
+#else
+    Log::Print("ThreadScheduling: memory locking not supported on this platform\n");
+#endif
+}
+
+void ThreadScheduling::Apply(PipelineThread aThread)
+{ // static
+    if (iParams.IsDefault(aThread)) {
+        return;
+    }
+    const TUint64 cpuMask = iParams.Affinity(aThread);
+    if (cpuMask != 0 && !SetAffinity(cpuMask)) {
+        Log::Print("ThreadScheduling: %s - failed to set affinity 0x%llx\n", Name(aThread), cpuMask);
+    }
+    const ThreadSchedPolicy policy = iParams.Policy(aThread);
+    if (policy != ThreadSchedPolicy::eDefault && !SetPolicy(policy, iParams.Priority(aThread))) {
+        Log::Print("ThreadScheduling: %s - failed to set policy %s, priority %u\n",
+                   Name(aThread), PolicyName(policy), iParams.Priority(aThread));
+    }
+}
+
+const TChar* ThreadScheduling::Name(PipelineThread aThread)
+{ // static
+    switch (aThread)
+    {
+    case PipelineThread::eStarvationRamper:
+        return "StarvationRamper";
+    case PipelineThread::eFlywheelRamper:
+        return "FlywheelRamper";
+    case PipelineThread::eCodec:
+        return "Codec";
+    case PipelineThread::eEvent:
+        return "Event";
+    case PipelineThread::eProtocol:
+        return "Protocol";
+    case PipelineThread::eSongcastSender:
+        return "SongcastSender";
+    }
+    return "Unknown";
+}
+
+TBool ThreadScheduling::SetAffinity(TUint64 aCpuMask)
+{ // static
+#ifdef __linux__
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (TUint i=0; i<64 && i<CPU_SETSIZE; i++) {
+        if (aCpuMask & (1ULL << i)) {
+            CPU_SET(i, &cpus);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+    (void)aCpuMask;
+    return false;
+#endif
+}
+
+TBool ThreadScheduling::SetPolicy(ThreadSchedPolicy aPolicy, TUint aPriority)
+{ // static
+#ifdef __linux__
+    struct sched_param param;
+    param.sched_priority = (int)aPriority;
+    const int policy = (aPolicy == ThreadSchedPolicy::eFifo? SCHED_FIFO : SCHED_RR);
+    return pthread_setschedparam(pthread_self(), policy, &param) == 0;
+#else
+    (void)aPolicy;
+    (void)aPriority;
+    return false;
+#endif
+}
+
+const TChar* ThreadScheduling::PolicyName(ThreadSchedPolicy aPolicy)
+{ // static
+    switch (aPolicy)
+    {
+    case ThreadSchedPolicy::eDefault:
+        return "default";
+    case ThreadSchedPolicy::eFifo:
+        return "fifo";
+    case ThreadSchedPolicy::eRoundRobin:
+        return "rr";
+    }
+    return "unknown";
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <OpenHome/Types.h>
+
+namespace OpenHome {
+namespace Media {
+
+enum class PipelineThread
+{
+    eStarvationRamper,
+    eFlywheelRamper,
+    eCodec,
+    eEvent,
+    eProtocol,
+    eSongcastSender
+};
+
+enum class ThreadSchedPolicy
+{
+    eDefault,   // leave scheduling to ohNet's mapping of abstract priorities
+    eFifo,      // SCHED_FIFO
+    eRoundRobin // SCHED_RR
+};
+
+/*
+ OS-level scheduling for pipeline threads.  Defaults leave all threads unchanged.
+
+ Affinity masks have bit n set to allow a thread to run on cpu n; 0 leaves affinity unchanged.
+ Real-time policies take a priority in the range allowed by the OS (1..99 on Linux).
+ Affinity and policies are currently only supported on Linux.
+*/
+class ThreadSchedulingParams
+{
+public:
+    static const TUint kNumThreads = 6;
+public:
+    ThreadSchedulingParams();
+    void SetAffinity(PipelineThread aThread, TUint64 aCpuMask);
+    void SetPolicy(PipelineThread aThread, ThreadSchedPolicy aPolicy, TUint aPriority);
+    void SetLockMemory(TBool aLock); // mlockall() the process once pipeline memory pools are allocated
+    TUint64 Affinity(PipelineThread aThread) const;
+    ThreadSchedPolicy Policy(PipelineThread aThread) const;
+    TUint Priority(PipelineThread aThread) const;
+    TBool LockMemory() const;
+    TBool IsDefault(PipelineThread aThread) const;
+private:
+    class Entry
+    {
+    public:
+        Entry();
+    public:
+        TUint64 iCpuMask;
+        ThreadSchedPolicy iPolicy;
+        TUint iPriority;
+    };
+private:
+    Entry iThreads[kNumThreads];
+    TBool iLockMemory;
+};
+
+/*
+ Applies ThreadSchedulingParams.  Configure() must be called before any pipeline threads
+ are created; each thread then calls Apply() on itself as it starts.
+ Settings and any failure to apply them are logged.
+*/
+class ThreadScheduling
+{
+public:
+    static void Configure(const ThreadSchedulingParams& aParams);
+    static void LockMemory(); // no-op unless requested via ThreadSchedulingParams::SetLockMemory
+    static void Apply(PipelineThread aThread);
+    static const TChar* Name(PipelineThread aThread);
+private:
+    static TBool SetAffinity(TUint64 aCpuMask);
+    static TBool SetPolicy(ThreadSchedPolicy aPolicy, TUint aPriority);
+    static const TChar* PolicyName(ThreadSchedPolicy aPolicy);
+private:
+    static ThreadSchedulingParams iParams;
+};
+
+} // namespace Media
+} // namespace OpenHome
@@ -51,6 +51,11 @@ Msg* TrackInspector::Pull()
     return msg;
 }
 
+UpstreamLink* TrackInspector::SpliceableUpstream()
+{
+    return &iUpstreamElement;
+}
+
 void TrackInspector::NotifyTrackPlaying()
 {
     ASSERT(iTrack!=nullptr);
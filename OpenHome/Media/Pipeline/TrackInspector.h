@@ -35,6 +35,7 @@ public:
     void AddObserver(ITrackObserver& aObserver);
 public: // from IPipelineElementUpstream
     Msg* Pull() override;
+    UpstreamLink* SpliceableUpstream() override;
 private:
     void NotifyTrackPlaying();
     void NotifyTrackFailed();
@@ -43,7 +44,7 @@ private: // IMsgProcessor
     Msg* ProcessMsg(MsgEncodedStream* aMsg) override;
     Msg* ProcessMsg(MsgDecodedStream* aMsg) override;
 private:
-    IPipelineElementUpstream& iUpstreamElement;
+    UpstreamLink iUpstreamElement;
     std::vector<ITrackObserver*> iObservers;
     Track* iTrack;
 };
@@ -136,7 +136,8 @@ static const TChar* kStatus[] = { "Starting"
                                  ,"RampedDown"
                                  ,"RampingUp" };
 
-VariableDelayBase::VariableDelayBase(MsgFactory& aMsgFactory, IPipelineElementUpstream& aUpstreamElement, TUint aRampDuration, const TChar* aId)
+VariableDelayBase::VariableDelayBase(MsgFactory& aMsgFactory, IPipelineElementUpstream& aUpstreamElement, TUint aRampDuration,
+                                     TUint aDelayLineJiffies, const TChar* aId)
     : PipelineElement(kSupportedMsgTypes)
     , iMsgFactory(aMsgFactory)
     , iLock("VDEL")
@@ -150,7 +151,11 @@ VariableDelayBase::VariableDelayBase(MsgFactory& aMsgFactory, IPipelineElementUp
     , iWaitForAudioBeforeGeneratingSilence(false)
     , iPendingStream(nullptr)
     , iTargetFlushId(MsgFlush::kIdInvalid)
+    , iDelayLine(nullptr)
 {
+    if (aDelayLineJiffies > 0) {
+        iDelayLine = new DelayLine(aMsgFactory, aDelayLineJiffies, aRampDuration);
+    }
     ResetStatusAndRamp();
 }
 
@@ -159,6 +164,7 @@ VariableDelayBase::~VariableDelayBase()
     if (iDecodedStream != nullptr) {
         iDecodedStream->RemoveRef();
     }
+    delete iDelayLine;
 }
 
 Msg* VariableDelayBase::Pull()
@@ -170,6 +176,11 @@ Msg* VariableDelayBase::Pull()
     return msg;
 }
 
+UpstreamLink* VariableDelayBase::SpliceableUpstream()
+{
+    return &iUpstreamElement;
+}
+
 Msg* VariableDelayBase::DoPull()
 {
     Msg* msg = nullptr;
@@ -189,6 +200,9 @@ Msg* VariableDelayBase::DoPull()
     }
 
     // msg(s) pulled above may have altered iDelayAdjustment (e.g. MsgMode sets it to zero)
+    if ((iStatus == EStarting || iStatus == ERampedDown) && iDelayAdjustment != 0 && TryApplyToDelayLine()) {
+        CompleteDelayChange();
+    }
     if ((iStatus == EStarting || iStatus == ERampedDown) && iDelayAdjustment > 0) {
         TUint size = ((TUint)iDelayAdjustment > kMaxMsgSilenceDuration? kMaxMsgSilenceDuration : (TUint)iDelayAdjustment);
         auto stream = iDecodedStream->StreamInfo();
@@ -204,19 +218,7 @@ Msg* VariableDelayBase::DoPull()
             iDelayAdjustment -= size;
         }
         if (iDelayAdjustment == 0) {
-            LocalDelayApplied();
-            if (iStatus == ERampedDown) {
-                iStatus = ERampingUp;
-                iRampDirection = Ramp::EUp;
-                iCurrentRampValue = Ramp::kMin;
-                iRemainingRampSize = iRampDuration;
-            }
-            else {
-                iStatus = ERunning;
-                iRampDirection = Ramp::ENone;
-                iCurrentRampValue = Ramp::kMax;
-                iRemainingRampSize = 0;
-            }
+            CompleteDelayChange();
         }
     }
     else if (msg == nullptr) {
@@ -229,7 +231,10 @@ Msg* VariableDelayBase::DoPull()
 Msg* VariableDelayBase::NextMsg()
 {
     Msg* msg;
-    if (iPendingStream != nullptr) {
+    if (!iDelayLineQueue.IsEmpty()) {
+        return iDelayLineQueue.Dequeue(); // already processed
+    }
+    else if (iPendingStream != nullptr) {
         msg = iPendingStream;
         iPendingStream = nullptr;
         return msg; // avoid calling ProcessMsg and resetting iStatus
@@ -246,10 +251,6 @@ Msg* VariableDelayBase::NextMsg()
 
 void VariableDelayBase::RampMsg(MsgAudio* aMsg)
 {
-    if (aMsg->Jiffies() > iRemainingRampSize) {
-        MsgAudio* remaining = aMsg->Split(iRemainingRampSize);
-        iQueue.EnqueueAtHead(remaining);
-    }
     MsgAudio* split;
     iCurrentRampValue = aMsg->SetRamp(iCurrentRampValue, iRemainingRampSize, iRampDirection, split);
     if (split != nullptr) {
@@ -318,6 +319,23 @@ void VariableDelayBase::SetupRamp()
     }
 }
 
+void VariableDelayBase::CompleteDelayChange()
+{
+    LocalDelayApplied();
+    if (iStatus == ERampedDown) {
+        iStatus = ERampingUp;
+        iRampDirection = Ramp::EUp;
+        iCurrentRampValue = Ramp::kMin;
+        iRemainingRampSize = iRampDuration;
+    }
+    else {
+        iStatus = ERunning;
+        iRampDirection = Ramp::ENone;
+        iCurrentRampValue = Ramp::kMax;
+        iRemainingRampSize = 0;
+    }
+}
+
 MsgDecodedStream* VariableDelayBase::UpdateDecodedStream(TUint64 aTrackOffset)
 {
     auto s = iDecodedStream->StreamInfo();
@@ -332,6 +350,79 @@ MsgDecodedStream* VariableDelayBase::UpdateDecodedStream(TUint64 aTrackOffset)
     return stream;
 }
 
+TBool VariableDelayBase::TryApplyToDelayLine()
+{
+    // Moves iDelayLine's read position by as much of iDelayAdjustment as it can hold.
+    // Returns true if no adjustment remains.
+    if (iDelayLine == nullptr || !iDelayLine->FormatSet()) {
+        return false;
+    }
+    const TInt current = (TInt)iDelayLine->DelayJiffies();
+    const TInt wanted = current + iDelayAdjustment;
+    TInt target = std::max(wanted, (TInt)0);
+    target = std::min(target, (TInt)iDelayLine->MaxDelayJiffies());
+    const TInt applied = (TInt)iDelayLine->SetDelay((TUint)target);
+    // SetDelay() rounds down to a whole sample.  Ignore this unless the line couldn't hold the full adjustment.
+    iDelayAdjustment = (target == wanted? 0 : wanted - applied);
+    LOG(kMedia, "VariableDelay(%s), delay line=%u, adjustment=%d\n",
+                iId, applied/Jiffies::kPerMs, iDelayAdjustment/(TInt)Jiffies::kPerMs);
+    return iDelayAdjustment == 0;
+}
+
+Msg* VariableDelayBase::ApplyDelayLine(MsgAudioPcm* aMsg)
+{
+    if (iDelayLine == nullptr || !iDelayLine->FormatSet()) {
+        return aMsg;
+    }
+    if (iDelayLine->IsTransparent()) {
+        iDelayLine->Record(aMsg);
+        return aMsg;
+    }
+    iDelayLine->Process(aMsg, iDelayLineQueue);
+    return (iDelayLineQueue.IsEmpty()? nullptr : iDelayLineQueue.Dequeue());
+}
+
+Msg* VariableDelayBase::ApplyDelayLine(MsgSilence* aMsg)
+{
+    if (iDelayLine == nullptr || !iDelayLine->FormatSet()) {
+        return aMsg;
+    }
+    if (iDelayLine->IsTransparent()) {
+        iDelayLine->Record(aMsg);
+        return aMsg;
+    }
+    iDelayLine->Process(aMsg, iDelayLineQueue);
+    return (iDelayLineQueue.IsEmpty()? nullptr : iDelayLineQueue.Dequeue());
+}
+
+Msg* VariableDelayBase::DrainDelayLine(Msg* aMsg)
+{
+    // audio held in iDelayLine is output before aMsg.  The line is then empty, with no delay.
+    if (iDelayLine == nullptr) {
+        return aMsg;
+    }
+    Msg* msg = aMsg;
+    if (iDelayLine->DelayJiffies() > 0) {
+        iDelayLine->Drain(iDelayLineQueue);
+        iDelayLineQueue.Enqueue(aMsg);
+        msg = iDelayLineQueue.Dequeue();
+    }
+    iDelayLine->Reset();
+    return msg;
+}
+
+void VariableDelayBase::ReapplyDelay(TUint aJiffies)
+{
+    // restore delay lost by DrainDelayLine().  iDelayLine is empty so this starts with silence.
+    if (aJiffies == 0) {
+        return;
+    }
+    iDelayAdjustment += (TInt)aJiffies;
+    if (!TryApplyToDelayLine()) {
+        SetupRamp();
+    }
+}
+
 void VariableDelayBase::HandleDelayChange(TUint aNewDelay)
 {
     if (aNewDelay == iDelayJiffies) {
@@ -340,6 +431,14 @@ void VariableDelayBase::HandleDelayChange(TUint aNewDelay)
 
     iDelayAdjustment += (TInt)(aNewDelay - iDelayJiffies);
     iDelayJiffies = aNewDelay;
+    if ((iStatus == EStarting || iStatus == ERunning) && TryApplyToDelayLine()) {
+        // no ramp, silence or discard required
+        if (iClockPuller != nullptr) {
+            iClockPuller->Stop();
+        }
+        LocalDelayApplied();
+        return;
+    }
     SetupRamp();
     if (iDelayAdjustment != 0 && iClockPuller != nullptr) {
         iClockPuller->Stop();
@@ -364,7 +463,7 @@ Msg* VariableDelayBase::ProcessMsg(MsgMode* aMsg)
     iDelayAdjustment = 0;
     iWaitForAudioBeforeGeneratingSilence = true;
     ResetStatusAndRamp();
-    return aMsg;
+    return DrainDelayLine(aMsg);
 }
 
 Msg* VariableDelayBase::ProcessMsg(MsgDrain* aMsg)
@@ -385,7 +484,24 @@ Msg* VariableDelayBase::ProcessMsg(MsgDrain* aMsg)
         iStatus = ERampedDown;
 
     }
-    return aMsg;
+    // held audio is output now; iDelayAdjustment (set above) then re-applies the full delay
+    return DrainDelayLine(aMsg);
+}
+
+Msg* VariableDelayBase::ProcessMsg(MsgStreamInterrupted* aMsg)
+{
+    const TUint held = (iDelayLine == nullptr? 0 : iDelayLine->DelayJiffies());
+    Msg* msg = DrainDelayLine(aMsg);
+    ReapplyDelay(held);
+    return msg;
+}
+
+Msg* VariableDelayBase::ProcessMsg(MsgHalt* aMsg)
+{
+    const TUint held = (iDelayLine == nullptr? 0 : iDelayLine->DelayJiffies());
+    Msg* msg = DrainDelayLine(aMsg);
+    ReapplyDelay(held);
+    return msg;
 }
 
 Msg* VariableDelayBase::ProcessMsg(MsgFlush* aMsg)
@@ -398,6 +514,12 @@ Msg* VariableDelayBase::ProcessMsg(MsgFlush* aMsg)
         iRampDirection = Ramp::EUp;
         iCurrentRampValue = Ramp::kMin;
         iRemainingRampSize = iRampDuration;
+        if (iDelayLine != nullptr) {
+            // history (and any crossfade) predates the discarded audio so mustn't be replayed after it
+            const TUint held = iDelayLine->DelayJiffies();
+            iDelayLine->Reset();
+            ReapplyDelay(held);
+        }
         return nullptr;
     }
     return aMsg;
@@ -414,7 +536,17 @@ Msg* VariableDelayBase::ProcessMsg(MsgDecodedStream* aMsg)
         // if we're ramped down, assume that a new stream indicates that audio has been discarded upstream
         ResetStatusAndRamp();
     }
-    return aMsg;
+    Msg* msg = aMsg;
+    if (iDelayLine != nullptr) {
+        // held audio belongs to the previous stream (or the position before a seek) so is output first
+        const auto stream = aMsg->StreamInfo();
+        const TUint held = iDelayLine->DelayJiffies();
+        msg = DrainDelayLine(aMsg);
+        iDelayLine->SetFormat(stream.SampleRate(), stream.BitDepth(), stream.NumChannels());
+        iDelayLine->SetTrackOffset(stream.SampleStart() * Jiffies::PerSample(stream.SampleRate()));
+        ReapplyDelay(held);
+    }
+    return msg;
 }
 
 Msg* VariableDelayBase::ProcessMsg(MsgAudioPcm* aMsg)
@@ -513,7 +645,10 @@ Msg* VariableDelayBase::ProcessMsg(MsgAudioPcm* aMsg)
         ASSERTS();
     }
 
-    return msg;
+    if (msg == nullptr) {
+        return nullptr;
+    }
+    return ApplyDelayLine(msg);
 }
 
 Msg* VariableDelayBase::ProcessMsg(MsgSilence* aMsg)
@@ -536,15 +671,15 @@ Msg* VariableDelayBase::ProcessMsg(MsgSilence* aMsg)
         }
     }
 
-    return aMsg;
+    return ApplyDelayLine(aMsg);
 }
 
 
 // VariableDelayLeft
 
 VariableDelayLeft::VariableDelayLeft(MsgFactory& aMsgFactory, IPipelineElementUpstream& aUpstreamElement,
-                                     TUint aRampDuration, TUint aDownstreamDelay)
-    : VariableDelayBase(aMsgFactory, aUpstreamElement, aRampDuration, "left")
+                                     TUint aRampDuration, TUint aDownstreamDelay, TUint aDelayLineJiffies)
+    : VariableDelayBase(aMsgFactory, aUpstreamElement, aRampDuration, aDelayLineJiffies, "left")
     , iDownstreamDelay(aDownstreamDelay)
     , iObserver(nullptr)
 {
@@ -583,8 +718,8 @@ void VariableDelayLeft::LocalDelayApplied()
 
 VariableDelayRight::VariableDelayRight(MsgFactory& aMsgFactory,
                                        IPipelineElementUpstream& aUpstreamElement,
-                                       TUint aRampDuration, TUint aMinDelay)
-    : VariableDelayBase(aMsgFactory, aUpstreamElement, aRampDuration, "right")
+                                       TUint aRampDuration, TUint aMinDelay, TUint aDelayLineJiffies)
+    : VariableDelayBase(aMsgFactory, aUpstreamElement, aRampDuration, aDelayLineJiffies, "right")
     , iMinDelay(aMinDelay)
     , iAnimator(nullptr)
     , iDelayJiffiesTotal(0)
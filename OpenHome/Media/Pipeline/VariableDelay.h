@@ -5,6 +5,7 @@
 #include <OpenHome/Private/Thread.h>
 #include <OpenHome/Media/Pipeline/Msg.h>
 #include <OpenHome/Media/ClockPuller.h>
+#include <OpenHome/Media/Pipeline/DelayLine.h>
 
 #include <atomic>
 
@@ -17,6 +18,11 @@ If the delay is increased, silence is introduced.
 If the delay is decreased, audio (pulled from upstream) is discarded.
 Before any change in delay is actioned, audio spends RampDuration ramping down.
 After a delay is actioned, audio spends RampDuration ramping up.
+If constructed with a non-zero aDelayLineJiffies, changes that fit within a DelayLine are
+instead applied by moving its read position, crossfading over RampDuration.  No silence
+is generated and no audio discarded; audio held in the line is output before any halt,
+drain, mode change or new stream (including a seek).  The line is reset when audio is
+discarded upstream.
 FIXME - no handling of pause-resumes
 */
 
@@ -33,13 +39,16 @@ class VariableDelayBase : public PipelineElement, public IPipelineElementUpstrea
     friend class SuiteVariableDelay;
     friend class SuiteVariableDelayLeft;
     friend class SuiteVariableDelayRight;
+    friend class SuiteVariableDelayLine;
     static const TUint kSupportedMsgTypes;
 public:
     virtual ~VariableDelayBase();
 protected:
-    VariableDelayBase(MsgFactory& aMsgFactory, IPipelineElementUpstream& aUpstreamElement, TUint aRampDuration, const TChar* aId);
+    VariableDelayBase(MsgFactory& aMsgFactory, IPipelineElementUpstream& aUpstreamElement, TUint aRampDuration,
+                      TUint aDelayLineJiffies, const TChar* aId);
 public: // from IPipelineElementUpstream
     Msg* Pull() override;
+    UpstreamLink* SpliceableUpstream() override;
 protected:
     void HandleDelayChange(TUint aNewDelay);
     inline const TChar* Status() const;
@@ -50,10 +59,18 @@ private:
     void RampMsg(MsgAudio* aMsg);
     void ResetStatusAndRamp();
     void SetupRamp();
+    void CompleteDelayChange();
     MsgDecodedStream* UpdateDecodedStream(TUint64 aTrackOffset);
+    TBool TryApplyToDelayLine();
+    Msg* ApplyDelayLine(MsgAudioPcm* aMsg);
+    Msg* ApplyDelayLine(MsgSilence* aMsg);
+    Msg* DrainDelayLine(Msg* aMsg);
+    void ReapplyDelay(TUint aJiffies);
 protected: // from PipelineElement (IMsgProcessor)
     Msg* ProcessMsg(MsgMode* aMsg) override;
     Msg* ProcessMsg(MsgDrain* aMsg) override;
+    Msg* ProcessMsg(MsgStreamInterrupted* aMsg) override;
+    Msg* ProcessMsg(MsgHalt* aMsg) override;
     Msg* ProcessMsg(MsgFlush* aMsg) override;
     Msg* ProcessMsg(MsgDecodedStream* aMsg) override;
     Msg* ProcessMsg(MsgAudioPcm* aMsg) override;
@@ -77,7 +94,7 @@ protected:
     TInt iDelayAdjustment;
     MsgDecodedStream* iDecodedStream;
 private:
-    IPipelineElementUpstream& iUpstreamElement;
+    UpstreamLink iUpstreamElement;
     const TUint iRampDuration;
     const TChar* iId;
     MsgQueueLite iQueue;
@@ -89,13 +106,15 @@ private:
     BwsMode iMode;
     MsgDecodedStream* iPendingStream;
     TUint iTargetFlushId;
+    DelayLine* iDelayLine;        // nullptr => all delay changes generate silence or discard audio
+    MsgQueueLite iDelayLineQueue; // output from iDelayLine, already processed
 };
 
 class VariableDelayLeft : public VariableDelayBase
 {
 public:
     VariableDelayLeft(MsgFactory& aMsgFactory, IPipelineElementUpstream& aUpstreamElement,
-                      TUint aRampDuration, TUint aDownstreamDelay);
+                      TUint aRampDuration, TUint aDownstreamDelay, TUint aDelayLineJiffies);
     void SetObserver(IVariableDelayObserver& aObserver);
 private: // from PipelineElement (IMsgProcessor)
     using VariableDelayBase::ProcessMsg;
@@ -114,7 +133,7 @@ class VariableDelayRight : public VariableDelayBase
 public:
     VariableDelayRight(MsgFactory& aMsgFactory,
                        IPipelineElementUpstream& aUpstreamElement,
-                       TUint aRampDuration, TUint aMinDelay);
+                       TUint aRampDuration, TUint aMinDelay, TUint aDelayLineJiffies);
     void SetAnimator(IPipelineAnimator& aAnimator);
 public: // from IPipelineElementUpstream
     Msg* Pull() override;
@@ -97,6 +97,11 @@ Msg* Waiter::Pull()
     return msg;
 }
 
+UpstreamLink* Waiter::SpliceableUpstream()
+{
+    return &iUpstreamElement;
+}
+
 Msg* Waiter::ProcessMsg(MsgMode* aMsg)
 {
     if (iState != ERunning) {
@@ -168,15 +173,8 @@ Msg* Waiter::ProcessMsg(MsgAudioPcm* aMsg)
     HandleAudio();
     if (iState == ERampingDown || iState == ERampingUp) {
         if (iRemainingRampSize > 0) {
-            MsgAudio* split;
-            if (aMsg->Jiffies() > iRemainingRampSize) {
-                split = aMsg->Split(iRemainingRampSize);
-                if (split != nullptr) {
-                    iQueue.EnqueueAtHead(split);
-                }
-            }
-            split = nullptr;
             const Ramp::EDirection direction = (iState == ERampingDown? Ramp::EDown : Ramp::EUp);
+            MsgAudio* split;
             iCurrentRampValue = aMsg->SetRamp(iCurrentRampValue, iRemainingRampSize, direction, split);
             if (split != nullptr) {
                 iQueue.EnqueueAtHead(split);
@@ -42,6 +42,7 @@ public:
     void Wait(TUint aFlushId, TBool aRampDown);
 public: // from IPipelineElementUpstream
     Msg* Pull() override;
+    UpstreamLink* SpliceableUpstream() override;
 private: // from IMsgProcessor
     Msg* ProcessMsg(MsgMode* aMsg) override;
     Msg* ProcessMsg(MsgMetaText* aMsg) override;
@@ -69,7 +70,7 @@ private:
     };
 private:
     MsgFactory& iMsgFactory;
-    IPipelineElementUpstream& iUpstreamElement;
+    UpstreamLink iUpstreamElement;
     IWaiterObserver& iObserver;
     IPipelineElementObserverThread& iObserverThread;
     Mutex iLock;
@@ -321,11 +321,51 @@ void PipelineManager::GetThreadPriorities(TUint& aFiller, TUint& aFlywheelRamper
     iPipeline->GetThreadPriorities(aFlywheelRamper, aStarvationRamper, aCodec, aEvent);
 }
 
+void PipelineManager::GetLoggerIds(std::vector<const TChar*>& aIds) const
+{
+    iPipeline->GetLoggerIds(aIds);
+}
+
+TBool PipelineManager::SetLoggerEnabled(const Brx& aId, TBool aEnabled)
+{
+    return iPipeline->SetLoggerEnabled(aId, aEnabled);
+}
+
+TBool PipelineManager::SetProfilingEnabled(TBool aEnabled)
+{
+    return iPipeline->SetProfilingEnabled(aEnabled);
+}
+
+TBool PipelineManager::ProfilingEnabled() const
+{
+    return iPipeline->ProfilingEnabled();
+}
+
+void PipelineManager::ResetProfile()
+{
+    iPipeline->ResetProfile();
+}
+
+void PipelineManager::WriteProfile(IWriter& aWriter) const
+{
+    iPipeline->WriteProfile(aWriter);
+}
+
+void PipelineManager::RegisterProfile(IInfoAggregator& aInfoAggregator)
+{
+    iPipeline->RegisterProfile(aInfoAggregator);
+}
+
 Msg* PipelineManager::Pull()
 {
     return iPipeline->Pull();
 }
 
+void PipelineManager::PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs)
+{
+    iPipeline->PullBatch(aQueue, aMaxMsgs);
+}
+
 void PipelineManager::SetAnimator(IPipelineAnimator& aAnimator)
 {
     iPipeline->SetAnimator(aAnimator);
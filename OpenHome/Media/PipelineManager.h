@@ -259,10 +259,44 @@ public:
     TUint SenderMinLatencyMs() const;
     void GetThreadPriorityRange(TUint& aMin, TUint& aMax) const;
     void GetThreadPriorities(TUint& aFiller, TUint& aFlywheelRamper, TUint& aStarvationRamper, TUint& aCodec, TUint& aEvent);
+    /**
+     * Names of the Loggers between pipeline elements.  Only includes loggers that were
+     * constructed (see EPipelineSupportElementsLogger).
+     */
+    void GetLoggerIds(std::vector<const TChar*>& aIds) const;
+    /**
+     * Enable or disable logging of all msgs at a point in the pipeline.
+     *
+     * Loggers that were disabled at Start() may have been removed from the chain;
+     * they are spliced back in while enabled.
+     *
+     * @return  false if aId doesn't name a Logger.
+     */
+    TBool SetLoggerEnabled(const Brx& aId, TBool aEnabled);
+    /**
+     * Enable or disable collection of per-element timings, msg counts and reservoir levels.
+     *
+     * Profiles are collected by the Loggers so are only available if these were constructed.
+     * Times are inclusive of all work done upstream on the same thread.
+     *
+     * @return  false if there are no Loggers (or the pipeline is quitting).
+     */
+    TBool SetProfilingEnabled(TBool aEnabled);
+    TBool ProfilingEnabled() const;
+    void ResetProfile();
+    /**
+     * Write all profiles, as json, to aWriter.  Does not flush aWriter.
+     */
+    void WriteProfile(IWriter& aWriter) const;
+    /**
+     * Make profiles available via aInfoAggregator's Pipeline::kQueryProfile query.
+     */
+    void RegisterProfile(IInfoAggregator& aInfoAggregator);
 private:
     void RemoveAllLocked();
 private: // from IPipeline
     Msg* Pull() override;
+    void PullBatch(MsgQueueLite& aQueue, TUint aMaxMsgs) override;
     void SetAnimator(IPipelineAnimator& aAnimator) override;
 private: // from IPipelineIdManager
     void InvalidateAt(TUint aId) override;
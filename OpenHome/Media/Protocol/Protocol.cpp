@@ -441,6 +441,11 @@ ProtocolStreamResult ProtocolManager::Stream(const Brx& aUri)
                 res = protocol->TryStream(aUri);
             }
             catch (UriError&) {}
+            catch (AllocatorNoMemory&) {
+                // an elastic msg pool stayed full; give up on this stream rather than the Filler thread
+                LOG(kPipeline, "ProtocolManager::Stream - AllocatorNoMemory\n");
+                res = EProtocolStreamErrorUnrecoverable;
+            }
             ASSERT(res != EProtocolStreamErrorRecoverable);
         }
     }
@@ -58,6 +58,7 @@ void Supply::OutputData(const Brx& aData)
         return;
     }
     MsgAudioEncoded* msg = iMsgFactory.CreateMsgAudioEncoded(aData);
+    msg->TryStartLatencyTrace();
     iDownStreamElement.Push(msg);
 }
 
@@ -91,6 +91,7 @@ void SupplyAggregator::Output(Msg* aMsg)
 
 void SupplyAggregator::OutputEncodedAudio()
 {
+    iAudioEncoded->TryStartLatencyTrace();
     iDownStreamElement.Push(iAudioEncoded);
     iAudioEncoded = nullptr;
 }
@@ -0,0 +1,360 @@
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/OsWrapper.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/Private/Printer.h>
+#include <OpenHome/Media/Pipeline/Msg.h>
+#include <OpenHome/Media/Utils/AllocatorInfoLogger.h>
+
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
+using namespace OpenHome;
+using namespace OpenHome::Media;
+
+/*
+ Microbenchmarks for the Msg primitives exercised on every msg passing through the pipeline.
+ Parallel to TestMsg; run BenchmarkMsg to get a baseline before optimising any of these paths.
+
+ Each op is run for kWarmupUs, then timed over kRepetitions samples of at least kSampleUs.
+ The median, fastest sample and coefficient of variation across samples are reported.
+
+ Ops which need a msg to work on include the cost of creating and destroying it.  The
+ "create ..." rows measure that overhead alone so it can be subtracted.
+*/
+
+namespace OpenHome {
+namespace Media {
+
+class MsgBenchmarkReservoir : public MsgReservoir
+{
+public:
+    void Enqueue(Msg* aMsg) { DoEnqueue(aMsg); }
+    Msg* Dequeue() { return DoDequeue(); }
+};
+
+class MsgBenchmark : private IPcmProcessor, private INonCopyable
+{
+    static const TUint kWarmupUs = 20000;
+    static const TUint kSampleUs = 10000;
+    static const TUint kRepetitions = 9;
+    static const TUint kOpsPerBatch = 32;
+    static const TUint kSampleRate = 48000;
+    static const TUint kReservoirMsgs = 64;
+public:
+    MsgBenchmark(Environment& aEnv);
+    ~MsgBenchmark();
+    void Run();
+private:
+    typedef void (MsgBenchmark::*OpFunction)();
+    void RunAudio(TUint aBitDepth, TUint aNumChannels, TUint aBytes);
+    void RunEncoded(TUint aBytes);
+    void RunRamp(TUint aFragmentMs);
+    void RunReservoir();
+    void Measure(const TChar* aName, OpFunction aOp, TUint aBytesPerOp, TUint aItemsPerCall = 1);
+    MsgAudioPcm* CreateAudio(TUint aBytes);
+    void OpCreateAudioPcm();
+    void OpSplitAudioPcm();
+    void OpAggregateAudioPcm();
+    void OpReadPlayable();
+    void OpReadPlayableRamped();
+    void OpCreateAudioEncoded();
+    void OpSplitAudioEncoded();
+    void OpRampSet();
+    void OpReservoirEnqueueDequeue();
+private: // from IPcmProcessor
+    void BeginBlock() override;
+    void ProcessFragment8(const Brx& aData, TUint aNumChannels) override;
+    void ProcessFragment16(const Brx& aData, TUint aNumChannels) override;
+    void ProcessFragment24(const Brx& aData, TUint aNumChannels) override;
+    void ProcessFragment32(const Brx& aData, TUint aNumChannels) override;
+    void EndBlock() override;
+    void Flush() override;
+private:
+    Environment& iEnv;
+    AllocatorInfoLogger iInfoAggregator;
+    MsgFactory* iMsgFactory;
+    MsgBenchmarkReservoir* iReservoir;
+    std::vector<Msg*> iReservoirMsgs;
+    Bwh iData;
+    TUint iBitDepth;
+    TUint iNumChannels;
+    TUint iBytes;
+    TUint iFragmentJiffies;
+    TUint64 iSink; // consumed results, so the compiler can't discard any op
+};
+
+} // namespace Media
+} // namespace OpenHome
+
+
+// MsgBenchmark
+
+MsgBenchmark::MsgBenchmark(Environment& aEnv)
+    : iEnv(aEnv)
+    , iData(AudioData::kMaxBytes)
+    , iBitDepth(0)
+    , iNumChannels(0)
+    , iBytes(0)
+    , iFragmentJiffies(0)
+    , iSink(0)
+{
+    MsgFactoryInitParams init;
+    init.SetMsgAudioPcmCount(kReservoirMsgs + 8, kReservoirMsgs + 8);
+    init.SetMsgPlayableCount(8, 8);
+    init.SetMsgAudioEncodedCount(8, 8);
+    iMsgFactory = new MsgFactory(iInfoAggregator, init);
+    iReservoir = new MsgBenchmarkReservoir();
+    for (TUint i=0; i<iData.MaxBytes(); i++) {
+        iData.Append((TByte)(i * 7 + 3));
+    }
+}
+
+MsgBenchmark::~MsgBenchmark()
+{
+    delete iReservoir;
+    delete iMsgFactory;
+}
+
+void MsgBenchmark::Run()
+{
+    static const TUint kBitDepths[] = { 16, 24, 32 };
+    static const TUint kNumChannels[] = { 2, 8 };
+    static const TUint kSizes[] = { 512, 2048, AudioData::kMaxBytes };
+    Log::Print("Msg benchmark (median of %u samples of >= %ums after %ums warmup)\n", kRepetitions, kSampleUs/1000, kWarmupUs/1000);
+    for (auto bitDepth : kBitDepths) {
+        for (auto channels : kNumChannels) {
+            for (auto bytes : kSizes) {
+                RunAudio(bitDepth, channels, bytes);
+            }
+        }
+    }
+    for (auto bytes : kSizes) {
+        RunEncoded(bytes);
+    }
+    RunRamp(1);
+    RunRamp(5);
+    RunReservoir();
+}
+
+void MsgBenchmark::RunAudio(TUint aBitDepth, TUint aNumChannels, TUint aBytes)
+{
+    const TUint bytesPerSample = aNumChannels * (aBitDepth/8);
+    iBitDepth = aBitDepth;
+    iNumChannels = aNumChannels;
+    iBytes = aBytes - (aBytes % (2 * bytesPerSample)); // whole number of samples in each half, for Split/Aggregate
+    Log::Print("  %u-bit, %uch, %u bytes\n", iBitDepth, iNumChannels, iBytes);
+    Measure("create MsgAudioPcm", &MsgBenchmark::OpCreateAudioPcm, iBytes);
+    Measure("MsgAudioPcm::Split", &MsgBenchmark::OpSplitAudioPcm, iBytes);
+    Measure("MsgAudioPcm::Aggregate", &MsgBenchmark::OpAggregateAudioPcm, iBytes);
+    Measure("MsgPlayable::Read", &MsgBenchmark::OpReadPlayable, iBytes);
+    Measure("MsgPlayable::Read (ramped)", &MsgBenchmark::OpReadPlayableRamped, iBytes);
+}
+
+void MsgBenchmark::RunEncoded(TUint aBytes)
+{
+    iBytes = aBytes;
+    Log::Print("  encoded, %u bytes\n", iBytes);
+    Measure("create MsgAudioEncoded", &MsgBenchmark::OpCreateAudioEncoded, iBytes);
+    Measure("MsgAudioEncoded::Split", &MsgBenchmark::OpSplitAudioEncoded, iBytes);
+}
+
+void MsgBenchmark::RunRamp(TUint aFragmentMs)
+{
+    iFragmentJiffies = aFragmentMs * Jiffies::kPerMs;
+    Log::Print("  ramp, %ums fragments\n", aFragmentMs);
+    Measure("Ramp::Set", &MsgBenchmark::OpRampSet, 0);
+}
+
+void MsgBenchmark::RunReservoir()
+{
+    iBitDepth = 24;
+    iNumChannels = 2;
+    iBytes = 2048 - (2048 % 6);
+    for (TUint i=0; i<kReservoirMsgs; i++) {
+        iReservoirMsgs.push_back(CreateAudio(iBytes));
+    }
+    Log::Print("  MsgReservoir, %u msgs queued per op\n", kReservoirMsgs);
+    Measure("enqueue+dequeue (per msg)", &MsgBenchmark::OpReservoirEnqueueDequeue, 0, kReservoirMsgs);
+    for (auto msg : iReservoirMsgs) {
+        msg->RemoveRef();
+    }
+    iReservoirMsgs.clear();
+}
+
+void MsgBenchmark::Measure(const TChar* aName, OpFunction aOp, TUint aBytesPerOp, TUint aItemsPerCall)
+{
+    OsContext* osCtx = iEnv.OsCtx();
+    TUint64 start = OsTimeInUs(osCtx);
+    do {
+        for (TUint i=0; i<kOpsPerBatch; i++) {
+            (this->*aOp)();
+        }
+    } while (OsTimeInUs(osCtx) - start < kWarmupUs);
+
+    std::vector<double> nsPerOp;
+    for (TUint rep=0; rep<kRepetitions; rep++) {
+        TUint64 ops = 0;
+        TUint64 elapsed = 0;
+        start = OsTimeInUs(osCtx);
+        do {
+            for (TUint i=0; i<kOpsPerBatch; i++) {
+                (this->*aOp)();
+            }
+            ops += kOpsPerBatch * aItemsPerCall;
+            elapsed = OsTimeInUs(osCtx) - start;
+        } while (elapsed < kSampleUs);
+        nsPerOp.push_back(((double)elapsed * 1000.0) / (double)ops);
+    }
+
+    double mean = 0;
+    for (auto ns : nsPerOp) {
+        mean += ns;
+    }
+    mean /= nsPerOp.size();
+    double variance = 0;
+    for (auto ns : nsPerOp) {
+        variance += (ns - mean) * (ns - mean);
+    }
+    variance /= nsPerOp.size();
+    std::sort(nsPerOp.begin(), nsPerOp.end());
+    const double median = nsPerOp[nsPerOp.size() / 2];
+    const double cv = (mean > 0? (100.0 * sqrt(variance)) / mean : 0.0);
+    if (aBytesPerOp == 0) {
+        Log::Print("    %-28s %10.1f ns/op (min %10.1f, cv %5.1f%%)\n", aName, median, nsPerOp[0], cv);
+    }
+    else {
+        const double mbPerSec = (aBytesPerOp * 1000.0) / median; // bytes/ns * 1e9 / 1e6
+        Log::Print("    %-28s %10.1f ns/op (min %10.1f, cv %5.1f%%) %9.1f MB/s\n", aName, median, nsPerOp[0], cv, mbPerSec);
+    }
+}
+
+MsgAudioPcm* MsgBenchmark::CreateAudio(TUint aBytes)
+{
+    Brn data(iData.Ptr(), aBytes);
+    return iMsgFactory->CreateMsgAudioPcm(data, iNumChannels, kSampleRate, iBitDepth, AudioDataEndian::Little, 0);
+}
+
+void MsgBenchmark::OpCreateAudioPcm()
+{
+    MsgAudioPcm* msg = CreateAudio(iBytes);
+    iSink += msg->Jiffies();
+    msg->RemoveRef();
+}
+
+void MsgBenchmark::OpSplitAudioPcm()
+{
+    MsgAudioPcm* msg = CreateAudio(iBytes);
+    MsgAudio* remaining = msg->Split(msg->Jiffies() / 2);
+    iSink += remaining->Jiffies();
+    remaining->RemoveRef();
+    msg->RemoveRef();
+}
+
+void MsgBenchmark::OpAggregateAudioPcm()
+{ // MsgAudioPcm::Aggregate is a thin wrapper around DecodedAudio::Aggregate
+    MsgAudioPcm* msg = CreateAudio(iBytes / 2);
+    msg->Aggregate(CreateAudio(iBytes / 2));
+    iSink += msg->Jiffies();
+    msg->RemoveRef();
+}
+
+void MsgBenchmark::OpReadPlayable()
+{
+    MsgPlayable* playable = CreateAudio(iBytes)->CreatePlayable();
+    playable->Read(*this);
+    playable->RemoveRef();
+}
+
+void MsgBenchmark::OpReadPlayableRamped()
+{
+    MsgAudioPcm* msg = CreateAudio(iBytes);
+    TUint remainingDuration = msg->Jiffies() * 2;
+    MsgAudio* split = nullptr;
+    iSink += msg->SetRamp(Ramp::kMax, remainingDuration, Ramp::EDown, split);
+    if (split != nullptr) {
+        split->RemoveRef();
+    }
+    MsgPlayable* playable = msg->CreatePlayable();
+    playable->Read(*this);
+    playable->RemoveRef();
+}
+
+void MsgBenchmark::OpCreateAudioEncoded()
+{
+    MsgAudioEncoded* msg = iMsgFactory->CreateMsgAudioEncoded(Brn(iData.Ptr(), iBytes));
+    iSink += msg->Bytes();
+    msg->RemoveRef();
+}
+
+void MsgBenchmark::OpSplitAudioEncoded()
+{
+    MsgAudioEncoded* msg = iMsgFactory->CreateMsgAudioEncoded(Brn(iData.Ptr(), iBytes));
+    MsgAudioEncoded* remaining = msg->Split(iBytes / 2);
+    iSink += remaining->Bytes();
+    remaining->RemoveRef();
+    msg->RemoveRef();
+}
+
+void MsgBenchmark::OpRampSet()
+{
+    // starts are varied so successive calls don't hit identical ramp points
+    const TUint start = Ramp::kMax - (TUint)(iSink & 0xff);
+    Ramp ramp;
+    Ramp split;
+    TUint splitPos;
+    if (ramp.Set(start, iFragmentJiffies, iFragmentJiffies * 4, Ramp::EDown, split, splitPos)) {
+        iSink += splitPos;
+    }
+    iSink += ramp.End();
+}
+
+void MsgBenchmark::OpReservoirEnqueueDequeue()
+{
+    for (auto msg : iReservoirMsgs) {
+        iReservoir->Enqueue(msg);
+    }
+    for (TUint i=0; i<kReservoirMsgs; i++) {
+        iSink += (TUint64)(size_t)iReservoir->Dequeue();
+    }
+}
+
+void MsgBenchmark::BeginBlock()
+{
+}
+
+void MsgBenchmark::ProcessFragment8(const Brx& aData, TUint /*aNumChannels*/)
+{
+    iSink += aData[aData.Bytes() - 1];
+}
+
+void MsgBenchmark::ProcessFragment16(const Brx& aData, TUint /*aNumChannels*/)
+{
+    iSink += aData[aData.Bytes() - 1];
+}
+
+void MsgBenchmark::ProcessFragment24(const Brx& aData, TUint /*aNumChannels*/)
+{
+    iSink += aData[aData.Bytes() - 1];
+}
+
+void MsgBenchmark::ProcessFragment32(const Brx& aData, TUint /*aNumChannels*/)
+{
+    iSink += aData[aData.Bytes() - 1];
+}
+
+void MsgBenchmark::EndBlock()
+{
+}
+
+void MsgBenchmark::Flush()
+{
+}
+
+
+
+void BenchmarkMsg(Environment& aEnv)
+{
+    MsgBenchmark(aEnv).Run();
+}
@@ -0,0 +1,895 @@
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/OsWrapper.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Private/Printer.h>
+#include <OpenHome/Private/Parser.h>
+#include <OpenHome/Private/Ascii.h>
+#include <OpenHome/Private/File.h>
+#include <OpenHome/Private/InfoProvider.h>
+#include <OpenHome/Private/OptionParser.h>
+#include <OpenHome/Media/Pipeline/Msg.h>
+#include <OpenHome/Media/Pipeline/MuterVolume.h>
+#include <OpenHome/Media/Pipeline/AnalogBypassRamper.h>
+#include <OpenHome/Media/Pipeline/Pipeline.h>
+#include <OpenHome/Media/PipelineManager.h>
+#include <OpenHome/Media/PipelineObserver.h>
+#include <OpenHome/Media/Supply.h>
+#include <OpenHome/Media/UriProviderSingleTrack.h>
+#include <OpenHome/Media/MimeTypeList.h>
+#include <OpenHome/Media/Protocol/Protocol.h>
+#include <OpenHome/Media/Codec/CodecFactory.h>
+#include <OpenHome/Media/Codec/ContainerFactory.h>
+
+#include <algorithm>
+#include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <time.h>
+#include <vector>
+
+using namespace OpenHome;
+using namespace OpenHome::Media;
+
+/*
+ Headless throughput benchmark for a complete pipeline.
+
+ Each case streams an in-memory encoded file through Protocol -> Codec -> all pipeline elements
+ and into an animator which consumes audio as fast as the pipeline can supply it.  A new
+ PipelineManager is created per case so allocator peaks are per-case.
+
+ Built-in cases are WAV files generated at a range of sample rates, bit depths and channel
+ counts.  Other codecs are benchmarked by passing encoded files via --files.
+
+ Each case is run twice: once with the animator calling Pull() and once calling PullBatch()
+ (see --batch), so that msgs/s can be compared with and without batching.
+*/
+
+namespace OpenHome {
+namespace Media {
+
+class EncodedFile : private INonCopyable
+{
+public:
+    EncodedFile(const Brx& aName, Bwh* aData);
+    ~EncodedFile();
+    const Brx& Name() const;
+    const Brx& Data() const;
+private:
+    Bwh iName;
+    Bwh* iData;
+};
+
+// Streams the contents of an EncodedFile.  Uris are of the form mem://<index into aFiles>
+class ProtocolMemory : public Protocol
+{
+    static const Brn kScheme;
+public:
+    ProtocolMemory(Environment& aEnv, const std::vector<EncodedFile*>& aFiles);
+    ~ProtocolMemory();
+private: // from Protocol
+    void Initialise(MsgFactory& aMsgFactory, IPipelineElementDownstream& aDownstream) override;
+    void Interrupt(TBool aInterrupt) override;
+    ProtocolStreamResult Stream(const Brx& aUri) override;
+    ProtocolGetResult Get(IWriter& aWriter, const Brx& aUri, TUint64 aOffset, TUint aBytes) override;
+private: // from IStreamHandler
+    TUint TryStop(TUint aStreamId) override;
+private:
+    const std::vector<EncodedFile*>& iFiles;
+    Mutex iLock;
+    Supply* iSupply;
+    TUint iStreamId;
+    TBool iStop;
+    TUint iNextFlushId;
+};
+
+// Sums the peak number of bytes used by each allocator registered with it.
+class AllocatorPeakTracker : public IInfoAggregator, private IWriter
+{
+public:
+    TUint64 PeakBytes();
+private: // from IInfoAggregator
+    void Register(IInfoProvider& aProvider, std::vector<Brn>& aSupportedQueries) override;
+private: // from IWriter
+    void Write(TByte aValue) override;
+    void Write(const Brx& aBuffer) override;
+    void WriteFlush() override;
+private:
+    std::vector<IInfoProvider*> iInfoProviders;
+    std::string iInfo;
+};
+
+struct PipelineBenchmarkResult
+{
+    PipelineBenchmarkResult();
+    std::string iName;
+    std::string iCodec;
+    TUint iPullBatch; // 0 for Pull()
+    TBool iOk;
+    TUint iSampleRate;
+    TUint iBitDepth;
+    TUint iNumChannels;
+    double iAudioSecs;
+    double iWallMs;
+    double iCpuMs;
+    TUint64 iMsgs;
+    TUint64 iPeakAllocBytes;
+};
+
+/*
+ Consumes all audio as soon as it is available.  Playables are read into a lent AnimatorBuffer
+ in the stream's format, as a driver with an mmap'd output ring would.  Msgs are fetched via
+ Pull() if aPullBatch is 0, or via PullBatch(aPullBatch) otherwise.
+
+ The end of a case is signalled by the pipeline reporting the null track the Filler outputs
+ once UriProviderSingleTrack runs out of tracks.  Audio already pulled through Reporter may
+ still be in transit at this point so the end time is taken from the last MsgHalt (which
+ StarvationRamper outputs once the pipeline runs dry) rather than the time the null track
+ is reported.
+*/
+class AnimatorNull : public PipelineElement
+                   , public IPipelineAnimator
+                   , public IPipelineObserver
+{
+    static const TUint kSupportedMsgTypes;
+    static const TUint kBufferBytes = AudioData::kMaxBytes;
+public:
+    AnimatorNull(Environment& aEnv, IPipeline& aPipeline, TUint aPullBatch);
+    ~AnimatorNull();
+    void Start();
+    TBool IsComplete(TUint aQuiescentMs);
+    TUint64 LastMsgUs() const;
+    void GetResult(PipelineBenchmarkResult& aResult, TUint64 aStartUs, clock_t aStartCpu);
+private:
+    void DriverThread();
+private: // from IMsgProcessor
+    Msg* ProcessMsg(MsgMode* aMsg) override;
+    Msg* ProcessMsg(MsgDrain* aMsg) override;
+    Msg* ProcessMsg(MsgHalt* aMsg) override;
+    Msg* ProcessMsg(MsgDecodedStream* aMsg) override;
+    Msg* ProcessMsg(MsgPlayable* aMsg) override;
+    Msg* ProcessMsg(MsgQuit* aMsg) override;
+private: // from IPipelineAnimator
+    TUint PipelineAnimatorBufferJiffies() override;
+    TUint PipelineAnimatorDelayJiffies(TUint aSampleRate, TUint aBitDepth, TUint aNumChannels) override;
+private: // from IPipelineObserver
+    void NotifyPipelineState(EPipelineState aState) override;
+    void NotifyMode(const Brx& aMode, const ModeInfo& aInfo, const ModeTransportControls& aTransportControls) override;
+    void NotifyTrack(Track& aTrack, const Brx& aMode, TBool aStartOfStream) override;
+    void NotifyMetaText(const Brx& aText) override;
+    void NotifyTime(TUint aSeconds, TUint aTrackDurationSeconds) override;
+    void NotifyStreamInfo(const DecodedStreamInfo& aStreamInfo) override;
+private:
+    IPipeline& iPipeline;
+    const TUint iPullBatch;
+    OsContext* iOsCtx;
+    ThreadFunctor* iThread;
+    Semaphore iQuitSem;
+    Mutex iLock;
+    TBool iQuit;
+    std::atomic<TUint64> iMsgs;
+    std::atomic<TUint64> iLastMsgUs;
+    TUint64 iPcmBytes;
+    TByte iBuffer[kBufferBytes];
+    Bws<32> iCodecName;
+    TUint iSampleRate;
+    TUint iBitDepth;
+    TUint iNumChannels;
+    TUint64 iTrackLengthJiffies;
+    TUint64 iPlayableJiffies;
+    TBool iSeenTrackEnd;
+    TBool iHaltSinceAudio;
+    TUint64 iHaltUs;
+    clock_t iHaltCpu;
+};
+
+class PipelineBenchmark : private IAnalogBypassVolumeRamper, private INonCopyable
+{
+    static const TUint kPollIntervalMs = 20;
+    static const TUint kQuiescentMs = 250;
+    static const TUint kStallTimeoutMs = 10000;
+    static const TChar* kMode;
+public:
+    PipelineBenchmark(Environment& aEnv, TUint aDurationSecs, TUint aPullBatch);
+    ~PipelineBenchmark();
+    void AddGeneratedWav(TUint aSampleRate, TUint aBitDepth, TUint aNumChannels);
+    void AddFile(const Brx& aPath);
+    void Run();
+    void Report(const Brx& aCsvPath, const Brx& aJsonPath) const;
+private:
+    void RunCase(TUint aIndex, TUint aPullBatch, PipelineBenchmarkResult& aResult);
+    static void WriteFile(const Brx& aPath, const std::string& aText);
+private: // from IAnalogBypassVolumeRamper
+    void ApplyVolumeMultiplier(TUint aValue) override;
+private:
+    Environment& iEnv;
+    const TUint iDurationSecs;
+    const TUint iPullBatch;
+    std::vector<EncodedFile*> iFiles;
+    std::vector<PipelineBenchmarkResult> iResults;
+    VolumeRamperStub iVolumeRamper;
+};
+
+} // namespace Media
+} // namespace OpenHome
+
+
+// EncodedFile
+
+EncodedFile::EncodedFile(const Brx& aName, Bwh* aData)
+    : iName(aName)
+    , iData(aData)
+{
+}
+
+EncodedFile::~EncodedFile()
+{
+    delete iData;
+}
+
+const Brx& EncodedFile::Name() const
+{
+    return iName;
+}
+
+const Brx& EncodedFile::Data() const
+{
+    return *iData;
+}
+
+
+// ProtocolMemory
+
+const Brn ProtocolMemory::kScheme("mem://");
+
+ProtocolMemory::ProtocolMemory(Environment& aEnv, const std::vector<EncodedFile*>& aFiles)
+    : Protocol(aEnv)
+    , iFiles(aFiles)
+    , iLock("PMEM")
+    , iSupply(nullptr)
+    , iStreamId(IPipelineIdProvider::kStreamIdInvalid)
+    , iStop(false)
+    , iNextFlushId(MsgFlush::kIdInvalid)
+{
+}
+
+ProtocolMemory::~ProtocolMemory()
+{
+    delete iSupply;
+}
+
+void ProtocolMemory::Initialise(MsgFactory& aMsgFactory, IPipelineElementDownstream& aDownstream)
+{
+    iSupply = new Supply(aMsgFactory, aDownstream);
+}
+
+void ProtocolMemory::Interrupt(TBool aInterrupt)
+{
+    iLock.Wait();
+    if (aInterrupt) {
+        iStop = true;
+    }
+    iLock.Signal();
+}
+
+ProtocolStreamResult ProtocolMemory::Stream(const Brx& aUri)
+{
+    if (!aUri.BeginsWith(kScheme)) {
+        return EProtocolErrorNotSupported;
+    }
+    TUint index;
+    try {
+        index = Ascii::Uint(aUri.Split(kScheme.Bytes()));
+    }
+    catch (AsciiError&) {
+        return EProtocolErrorNotSupported;
+    }
+    if (index >= iFiles.size()) {
+        return EProtocolErrorNotSupported;
+    }
+    const Brx& data = iFiles[index]->Data();
+
+    iLock.Wait();
+    iStop = false;
+    iNextFlushId = MsgFlush::kIdInvalid;
+    iStreamId = iIdProvider->NextStreamId();
+    iLock.Signal();
+    iSupply->OutputStream(aUri, data.Bytes(), 0, false /* seekable */, false /* live */, Multiroom::Allowed, *this, iStreamId);
+
+    ProtocolStreamResult res = EProtocolStreamSuccess;
+    for (TUint offset=0; offset<data.Bytes(); offset+=EncodedAudio::kMaxBytes) {
+        iLock.Wait();
+        const TBool stop = iStop;
+        const TUint flushId = iNextFlushId;
+        iLock.Signal();
+        if (stop) {
+            if (flushId != MsgFlush::kIdInvalid) {
+                iSupply->OutputFlush(flushId);
+            }
+            res = EProtocolStreamStopped;
+            break;
+        }
+        const TUint bytes = std::min(EncodedAudio::kMaxBytes, data.Bytes() - offset);
+        iSupply->OutputData(Brn(data.Ptr() + offset, bytes));
+    }
+
+    iLock.Wait();
+    iStreamId = IPipelineIdProvider::kStreamIdInvalid;
+    iLock.Signal();
+    return res;
+}
+
+ProtocolGetResult ProtocolMemory::Get(IWriter& /*aWriter*/, const Brx& /*aUri*/, TUint64 /*aOffset*/, TUint /*aBytes*/)
+{
+    return EProtocolGetErrorNotSupported;
+}
+
+TUint ProtocolMemory::TryStop(TUint aStreamId)
+{
+    AutoMutex _(iLock);
+    if (iStreamId != aStreamId || aStreamId == IPipelineIdProvider::kStreamIdInvalid) {
+        return MsgFlush::kIdInvalid;
+    }
+    if (iNextFlushId == MsgFlush::kIdInvalid) {
+        iNextFlushId = iFlushIdProvider->NextFlushId();
+    }
+    iStop = true;
+    return iNextFlushId;
+}
+
+
+// AllocatorPeakTracker
+
+TUint64 AllocatorPeakTracker::PeakBytes()
+{
+    // AllocatorBase is only visible as an IInfoProvider here so parse its summary
+    // "Allocator: <name>, capacity:<n> cells x <bytes> bytes, in use:<n> cells, peak:<n> cells..."
+    TUint64 bytes = 0;
+    for (auto provider : iInfoProviders) {
+        iInfo.clear();
+        provider->QueryInfo(AllocatorBase::kQueryMemory, *this);
+        const char* cellBytes = strstr(iInfo.c_str(), " cells x ");
+        const char* peak = strstr(iInfo.c_str(), "peak:");
+        if (cellBytes != nullptr && peak != nullptr) {
+            bytes += (TUint64)strtoul(cellBytes + 9, nullptr, 10) * strtoul(peak + 5, nullptr, 10);
+        }
+    }
+    return bytes;
+}
+
+void AllocatorPeakTracker::Register(IInfoProvider& aProvider, std::vector<Brn>& /*aSupportedQueries*/)
+{
+    iInfoProviders.push_back(&aProvider);
+}
+
+void AllocatorPeakTracker::Write(TByte aValue)
+{
+    iInfo.push_back((char)aValue);
+}
+
+void AllocatorPeakTracker::Write(const Brx& aBuffer)
+{
+    iInfo.append((const char*)aBuffer.Ptr(), aBuffer.Bytes());
+}
+
+void AllocatorPeakTracker::WriteFlush()
+{
+}
+
+
+// PipelineBenchmarkResult
+
+PipelineBenchmarkResult::PipelineBenchmarkResult()
+    : iPullBatch(0)
+    , iOk(false)
+    , iSampleRate(0)
+    , iBitDepth(0)
+    , iNumChannels(0)
+    , iAudioSecs(0)
+    , iWallMs(0)
+    , iCpuMs(0)
+    , iMsgs(0)
+    , iPeakAllocBytes(0)
+{
+}
+
+
+// AnimatorNull
+
+const TUint AnimatorNull::kSupportedMsgTypes =   eMode
+                                               | eDrain
+                                               | eHalt
+                                               | eDecodedStream
+                                               | ePlayable
+                                               | eQuit;
+
+AnimatorNull::AnimatorNull(Environment& aEnv, IPipeline& aPipeline, TUint aPullBatch)
+    : PipelineElement(kSupportedMsgTypes)
+    , iPipeline(aPipeline)
+    , iPullBatch(aPullBatch)
+    , iOsCtx(aEnv.OsCtx())
+    , iQuitSem("ANUQ", 0)
+    , iLock("ANUL")
+    , iQuit(false)
+    , iMsgs(0)
+    , iLastMsgUs(0)
+    , iPcmBytes(0)
+    , iSampleRate(0)
+    , iBitDepth(0)
+    , iNumChannels(0)
+    , iTrackLengthJiffies(0)
+    , iPlayableJiffies(0)
+    , iSeenTrackEnd(false)
+    , iHaltSinceAudio(false)
+    , iHaltUs(0)
+    , iHaltCpu(0)
+{
+    iPipeline.SetAnimator(*this);
+    iThread = new ThreadFunctor("AnimatorNull", MakeFunctor(*this, &AnimatorNull::DriverThread), kPriorityHighest);
+}
+
+AnimatorNull::~AnimatorNull()
+{
+    iQuitSem.Wait();
+    delete iThread;
+}
+
+void AnimatorNull::Start()
+{
+    iLastMsgUs = OsTimeInUs(iOsCtx);
+    iThread->Start();
+}
+
+TBool AnimatorNull::IsComplete(TUint aQuiescentMs)
+{
+    AutoMutex _(iLock);
+    if (!iSeenTrackEnd) {
+        return false;
+    }
+    return (OsTimeInUs(iOsCtx) - iLastMsgUs) >= (TUint64)aQuiescentMs * 1000;
+}
+
+TUint64 AnimatorNull::LastMsgUs() const
+{
+    return iLastMsgUs;
+}
+
+void AnimatorNull::GetResult(PipelineBenchmarkResult& aResult, TUint64 aStartUs, clock_t aStartCpu)
+{
+    AutoMutex _(iLock);
+    aResult.iPullBatch = iPullBatch;
+    aResult.iOk = (iSampleRate != 0 && iPlayableJiffies > 0);
+    aResult.iCodec.assign((const char*)iCodecName.Ptr(), iCodecName.Bytes());
+    aResult.iSampleRate = iSampleRate;
+    aResult.iBitDepth = iBitDepth;
+    aResult.iNumChannels = iNumChannels;
+    // StarvationRamper pads the end of the stream with a flywheel ramp so prefer the length the codec reported
+    const TUint64 jiffies = (iTrackLengthJiffies != 0? iTrackLengthJiffies : iPlayableJiffies);
+    aResult.iAudioSecs = (double)jiffies / Jiffies::kPerSecond;
+    TUint64 endUs = iLastMsgUs;
+    clock_t endCpu = clock();
+    if (iHaltSinceAudio) {
+        endUs = iHaltUs;
+        endCpu = iHaltCpu;
+    }
+    aResult.iWallMs = (double)(endUs - aStartUs) / 1000.0;
+    aResult.iCpuMs = ((double)(endCpu - aStartCpu) * 1000.0) / CLOCKS_PER_SEC;
+    aResult.iMsgs = iMsgs;
+}
+
+void AnimatorNull::DriverThread()
+{
+    MsgQueueLite pulled;
+    while (!iQuit) {
+        if (iPullBatch == 0) {
+            pulled.Enqueue(iPipeline.Pull());
+        }
+        else {
+            iPipeline.PullBatch(pulled, iPullBatch);
+        }
+        while (!pulled.IsEmpty()) {
+            Msg* msg = pulled.Dequeue();
+            iMsgs++;
+            iLastMsgUs = OsTimeInUs(iOsCtx);
+            msg = msg->Process(*this);
+            ASSERT(msg == nullptr);
+        }
+    }
+    iQuitSem.Signal();
+}
+
+Msg* AnimatorNull::ProcessMsg(MsgMode* aMsg)
+{
+    aMsg->RemoveRef();
+    return nullptr;
+}
+
+Msg* AnimatorNull::ProcessMsg(MsgDrain* aMsg)
+{
+    aMsg->ReportDrained();
+    aMsg->RemoveRef();
+    return nullptr;
+}
+
+Msg* AnimatorNull::ProcessMsg(MsgHalt* aMsg)
+{
+    aMsg->ReportHalted();
+    aMsg->RemoveRef();
+    const TUint64 now = OsTimeInUs(iOsCtx);
+    const clock_t cpu = clock();
+    AutoMutex _(iLock);
+    if (!iHaltSinceAudio && iPlayableJiffies > 0) {
+        iHaltSinceAudio = true;
+        iHaltUs = now;
+        iHaltCpu = cpu;
+    }
+    return nullptr;
+}
+
+Msg* AnimatorNull::ProcessMsg(MsgDecodedStream* aMsg)
+{
+    const DecodedStreamInfo& info = aMsg->StreamInfo();
+    iLock.Wait();
+    iCodecName.Replace(info.CodecName().Split(0, std::min(info.CodecName().Bytes(), iCodecName.MaxBytes())));
+    iSampleRate = info.SampleRate();
+    iBitDepth = info.BitDepth();
+    iNumChannels = info.NumChannels();
+    iTrackLengthJiffies = info.TrackLength();
+    iLock.Signal();
+    aMsg->RemoveRef();
+    return nullptr;
+}
+
+Msg* AnimatorNull::ProcessMsg(MsgPlayable* aMsg)
+{
+    const TUint jiffies = aMsg->Jiffies();
+    const TUint bytesPerSample = (iBitDepth/8) * iNumChannels;
+    const TUint maxSamples = kBufferBytes / bytesPerSample;
+    MsgPlayable* playable = aMsg;
+    while (playable != nullptr) {
+        MsgPlayable* remaining = nullptr;
+        if (playable->Bytes() > maxSamples * bytesPerSample) {
+            remaining = playable->Split(maxSamples * bytesPerSample);
+        }
+        AnimatorBuffer buffer(iBuffer, maxSamples, iNumChannels, iBitDepth/8, AudioDataEndian::Little);
+        playable->Read(buffer);
+        iPcmBytes += buffer.SamplesWritten() * buffer.BytesPerSample();
+        playable->RemoveRef();
+        playable = remaining;
+    }
+    AutoMutex _(iLock);
+    iPlayableJiffies += jiffies;
+    iHaltSinceAudio = false;
+    return nullptr;
+}
+
+Msg* AnimatorNull::ProcessMsg(MsgQuit* aMsg)
+{
+    iQuit = true;
+    aMsg->RemoveRef();
+    return nullptr;
+}
+
+TUint AnimatorNull::PipelineAnimatorBufferJiffies()
+{
+    return 0;
+}
+
+TUint AnimatorNull::PipelineAnimatorDelayJiffies(TUint /*aSampleRate*/, TUint /*aBitDepth*/, TUint /*aNumChannels*/)
+{
+    return 0;
+}
+
+void AnimatorNull::NotifyPipelineState(EPipelineState /*aState*/)
+{
+}
+
+void AnimatorNull::NotifyMode(const Brx& /*aMode*/, const ModeInfo& /*aInfo*/, const ModeTransportControls& /*aTransportControls*/)
+{
+}
+
+void AnimatorNull::NotifyTrack(Track& aTrack, const Brx& /*aMode*/, TBool /*aStartOfStream*/)
+{
+    if (aTrack.Id() == Track::kIdNone) {
+        iLock.Wait();
+        iSeenTrackEnd = true;
+        iLock.Signal();
+    }
+}
+
+void AnimatorNull::NotifyMetaText(const Brx& /*aText*/)
+{
+}
+
+void AnimatorNull::NotifyTime(TUint /*aSeconds*/, TUint /*aTrackDurationSeconds*/)
+{
+}
+
+void AnimatorNull::NotifyStreamInfo(const DecodedStreamInfo& /*aStreamInfo*/)
+{
+}
+
+
+// PipelineBenchmark
+
+const TChar* PipelineBenchmark::kMode = "Benchmark";
+
+PipelineBenchmark::PipelineBenchmark(Environment& aEnv, TUint aDurationSecs, TUint aPullBatch)
+    : iEnv(aEnv)
+    , iDurationSecs(aDurationSecs)
+    , iPullBatch(aPullBatch)
+{
+}
+
+PipelineBenchmark::~PipelineBenchmark()
+{
+    for (auto file : iFiles) {
+        delete file;
+    }
+}
+
+void PipelineBenchmark::AddGeneratedWav(TUint aSampleRate, TUint aBitDepth, TUint aNumChannels)
+{
+    static const TUint kHeaderBytes = 44;
+    const TUint bytesPerSample = aNumChannels * (aBitDepth / 8);
+    const TUint audioBytes = aSampleRate * iDurationSecs * bytesPerSample;
+    Bwh* data = new Bwh(kHeaderBytes + audioBytes);
+    WriterBuffer writerBuf(*data);
+    WriterBinary writer(writerBuf);
+    writer.Write(Brn("RIFF"));
+    writer.WriteUint32Le(36 + audioBytes);
+    writer.Write(Brn("WAVE"));
+    writer.Write(Brn("fmt "));
+    writer.WriteUint32Le(16);
+    writer.WriteUint16Le(1); // PCM
+    writer.WriteUint16Le(aNumChannels);
+    writer.WriteUint32Le(aSampleRate);
+    writer.WriteUint32Le(aSampleRate * bytesPerSample);
+    writer.WriteUint16Le(bytesPerSample);
+    writer.WriteUint16Le(aBitDepth);
+    writer.Write(Brn("data"));
+    writer.WriteUint32Le(audioBytes);
+    // noise; content doesn't affect WAV decode cost but avoids ramps/gain working on silence
+    Bws<1024> block;
+    TUint32 lcg = 1;
+    for (TUint remaining=audioBytes; remaining>0;) {
+        const TUint bytes = std::min(remaining, block.MaxBytes());
+        block.SetBytes(0);
+        for (TUint i=0; i<bytes; i++) {
+            lcg = lcg * 1664525 + 1013904223;
+            block.Append((TByte)(lcg >> 24));
+        }
+        data->Append(block);
+        remaining -= bytes;
+    }
+
+    Bws<64> name("wav-");
+    Ascii::AppendDec(name, aSampleRate);
+    name.Append("-");
+    Ascii::AppendDec(name, aBitDepth);
+    name.Append("-");
+    Ascii::AppendDec(name, aNumChannels);
+    name.Append("ch");
+    iFiles.push_back(new EncodedFile(name, data));
+}
+
+void PipelineBenchmark::AddFile(const Brx& aPath)
+{
+    Bwh path(aPath.Bytes() + 1);
+    path.Replace(aPath);
+    IFile* file = nullptr;
+    try {
+        file = IFile::Open(path.PtrZ(), eFileReadOnly);
+    }
+    catch (FileOpenError&) {
+        Log::Print("Failed to open %.*s - skipping\n", PBUF(aPath));
+        return;
+    }
+    Bwh* data = new Bwh(file->Bytes());
+    file->Read(*data);
+    delete file;
+    Brn name(aPath);
+    for (TUint i=aPath.Bytes(); i>0; i--) {
+        if (aPath[i-1] == '/' || aPath[i-1] == '\\') {
+            name.Set(aPath.Split(i));
+            break;
+        }
+    }
+    iFiles.push_back(new EncodedFile(name, data));
+}
+
+void PipelineBenchmark::Run()
+{
+    Log::Print("Pipeline benchmark (%u cases)\n", (TUint)iFiles.size());
+    Log::Print("    %-24s %-8s %7s %5s %4s %5s %8s %10s %9s %11s %12s %10s\n",
+               "name", "codec", "rate", "bits", "ch", "batch", "audio(s)", "xRealtime", "cpuMs/s", "msgs/s", "peakAlloc(KB)", "result");
+    const TUint pullBatches[] = { 0, iPullBatch };
+    const TUint numPullBatches = (iPullBatch == 0? 1 : 2);
+    for (TUint i=0; i<iFiles.size(); i++) {
+        for (TUint j=0; j<numPullBatches; j++) {
+            PipelineBenchmarkResult res;
+            RunCase(i, pullBatches[j], res);
+            const double wallSecs = res.iWallMs / 1000.0;
+            Log::Print("    %-24s %-8s %7u %5u %4u %5u %8.2f %10.1f %9.2f %11.0f %12llu %10s\n",
+                       res.iName.c_str(), res.iCodec.c_str(), res.iSampleRate, res.iBitDepth, res.iNumChannels,
+                       res.iPullBatch, res.iAudioSecs,
+                       (wallSecs > 0? res.iAudioSecs / wallSecs : 0.0),
+                       (res.iAudioSecs > 0? res.iCpuMs / res.iAudioSecs : 0.0),
+                       (wallSecs > 0? res.iMsgs / wallSecs : 0.0),
+                       (unsigned long long)(res.iPeakAllocBytes / 1024),
+                       (res.iOk? "ok" : "FAILED"));
+            iResults.push_back(res);
+        }
+    }
+}
+
+void PipelineBenchmark::RunCase(TUint aIndex, TUint aPullBatch, PipelineBenchmarkResult& aResult)
+{
+    aResult.iName.assign((const char*)iFiles[aIndex]->Name().Ptr(), iFiles[aIndex]->Name().Bytes());
+
+    AllocatorPeakTracker allocators;
+    TrackFactory* trackFactory = new TrackFactory(allocators, 5);
+    MimeTypeList mimeTypes;
+    PipelineManager* pipeline = new PipelineManager(PipelineInitParams::New(), allocators, *trackFactory);
+    pipeline->Add(Codec::ContainerFactory::NewId3v2());
+    pipeline->Add(Codec::ContainerFactory::NewMpeg4(mimeTypes));
+    pipeline->Add(Codec::CodecFactory::NewWav(mimeTypes));
+    pipeline->Add(Codec::CodecFactory::NewFlac(mimeTypes));
+    pipeline->Add(Codec::CodecFactory::NewAiff(mimeTypes));
+    pipeline->Add(Codec::CodecFactory::NewAifc(mimeTypes));
+    pipeline->Add(Codec::CodecFactory::NewAac(mimeTypes));
+    pipeline->Add(Codec::CodecFactory::NewAdts(mimeTypes));
+    pipeline->Add(Codec::CodecFactory::NewAlacApple(mimeTypes));
+    pipeline->Add(Codec::CodecFactory::NewVorbis(mimeTypes));
+    pipeline->Add(Codec::CodecFactory::NewMp3(mimeTypes));
+    pipeline->Add(new ProtocolMemory(iEnv, iFiles));
+    UriProviderSingleTrack* uriProvider = new UriProviderSingleTrack(kMode, false, *trackFactory);
+    pipeline->Add(uriProvider);
+    pipeline->Start(*this, iVolumeRamper);
+    AnimatorNull* animator = new AnimatorNull(iEnv, *pipeline, aPullBatch);
+    pipeline->AddObserver(*animator);
+    animator->Start();
+
+    Bws<32> uri("mem://");
+    Ascii::AppendDec(uri, aIndex);
+    Track* track = uriProvider->SetTrack(uri, Brx::Empty());
+    const TUint64 startUs = OsTimeInUs(iEnv.OsCtx());
+    const clock_t startCpu = clock();
+    pipeline->Begin(Brn(kMode), track->Id());
+    pipeline->Play();
+    track->RemoveRef();
+
+    TUint64 lastMsgUs = 0;
+    TUint64 stallStartUs = startUs;
+    while (!animator->IsComplete(kQuiescentMs)) {
+        Thread::Sleep(kPollIntervalMs);
+        const TUint64 now = OsTimeInUs(iEnv.OsCtx());
+        if (animator->LastMsgUs() != lastMsgUs) {
+            lastMsgUs = animator->LastMsgUs();
+            stallStartUs = now;
+        }
+        else if (now - stallStartUs > (TUint64)kStallTimeoutMs * 1000) {
+            Log::Print("    %s: timed out\n", aResult.iName.c_str());
+            break;
+        }
+    }
+    animator->GetResult(aResult, startUs, startCpu);
+    aResult.iPeakAllocBytes = allocators.PeakBytes();
+
+    pipeline->RemoveObserver(*animator);
+    pipeline->Quit();
+    delete animator; // waits for MsgQuit to be pulled
+    delete pipeline;
+    delete trackFactory;
+}
+
+void PipelineBenchmark::Report(const Brx& aCsvPath, const Brx& aJsonPath) const
+{
+    char line[512];
+    if (aCsvPath.Bytes() > 0) {
+        std::string csv("name,codec,sample_rate,bit_depth,channels,pull_batch,audio_s,wall_ms,cpu_ms,x_realtime,cpu_ms_per_audio_s,msgs,msgs_per_s,peak_alloc_bytes,ok\n");
+        for (auto& res : iResults) {
+            const double wallSecs = res.iWallMs / 1000.0;
+            (void)snprintf(line, sizeof line, "%s,%s,%u,%u,%u,%u,%.3f,%.3f,%.3f,%.3f,%.3f,%llu,%.1f,%llu,%d\n",
+                           res.iName.c_str(), res.iCodec.c_str(), res.iSampleRate, res.iBitDepth, res.iNumChannels,
+                           res.iPullBatch, res.iAudioSecs, res.iWallMs, res.iCpuMs,
+                           (wallSecs > 0? res.iAudioSecs / wallSecs : 0.0),
+                           (res.iAudioSecs > 0? res.iCpuMs / res.iAudioSecs : 0.0),
+                           (unsigned long long)res.iMsgs,
+                           (wallSecs > 0? res.iMsgs / wallSecs : 0.0),
+                           (unsigned long long)res.iPeakAllocBytes, res.iOk? 1 : 0);
+            csv.append(line);
+        }
+        WriteFile(aCsvPath, csv);
+    }
+    if (aJsonPath.Bytes() > 0) {
+        std::string json("[\n");
+        for (TUint i=0; i<iResults.size(); i++) {
+            const PipelineBenchmarkResult& res = iResults[i];
+            const double wallSecs = res.iWallMs / 1000.0;
+            (void)snprintf(line, sizeof line,
+                           "  {\"name\": \"%s\", \"codec\": \"%s\", \"sample_rate\": %u, \"bit_depth\": %u, \"channels\": %u, "
+                           "\"pull_batch\": %u, \"audio_s\": %.3f, \"wall_ms\": %.3f, \"cpu_ms\": %.3f, \"x_realtime\": %.3f, \"cpu_ms_per_audio_s\": %.3f, "
+                           "\"msgs\": %llu, \"msgs_per_s\": %.1f, \"peak_alloc_bytes\": %llu, \"ok\": %s}%s\n",
+                           res.iName.c_str(), res.iCodec.c_str(), res.iSampleRate, res.iBitDepth, res.iNumChannels,
+                           res.iPullBatch, res.iAudioSecs, res.iWallMs, res.iCpuMs,
+                           (wallSecs > 0? res.iAudioSecs / wallSecs : 0.0),
+                           (res.iAudioSecs > 0? res.iCpuMs / res.iAudioSecs : 0.0),
+                           (unsigned long long)res.iMsgs,
+                           (wallSecs > 0? res.iMsgs / wallSecs : 0.0),
+                           (unsigned long long)res.iPeakAllocBytes, res.iOk? "true" : "false",
+                           (i+1 < iResults.size()? "," : ""));
+            json.append(line);
+        }
+        json.append("]\n");
+        WriteFile(aJsonPath, json);
+    }
+}
+
+void PipelineBenchmark::WriteFile(const Brx& aPath, const std::string& aText)
+{ // static
+    Bwh path(aPath.Bytes() + 1);
+    path.Replace(aPath);
+    try {
+        FileStream file;
+        file.OpenFile(path.PtrZ(), eFileWriteOnly);
+        file.Write(Brn((const TByte*)aText.c_str(), (TUint)aText.size()));
+        file.CloseFile();
+    }
+    catch (FileOpenError&) {
+        Log::Print("Failed to open %.*s for writing\n", PBUF(aPath));
+    }
+}
+
+void PipelineBenchmark::ApplyVolumeMultiplier(TUint /*aValue*/)
+{
+}
+
+
+
+void BenchmarkPipeline(Environment& aEnv, const std::vector<Brn>& aArgs)
+{
+    OptionParser parser;
+    OptionUint optionDuration("-d", "--duration", 20, "seconds of audio in each generated WAV file");
+    parser.AddOption(&optionDuration);
+    OptionString optionFiles("-f", "--files", Brx::Empty(), "comma separated list of encoded files to benchmark (any supported codec)");
+    parser.AddOption(&optionFiles);
+    OptionBool optionNoWav("", "--no-wav", "skip the generated WAV cases");
+    parser.AddOption(&optionNoWav);
+    OptionUint optionBatch("-b", "--batch", 4, "msgs per PullBatch() for the batched run of each case (0 to only use Pull())");
+    parser.AddOption(&optionBatch);
+    OptionString optionCsv("", "--csv", Brx::Empty(), "write results as CSV to this file");
+    parser.AddOption(&optionCsv);
+    OptionString optionJson("", "--json", Brx::Empty(), "write results as JSON to this file");
+    parser.AddOption(&optionJson);
+    if (!parser.Parse(aArgs) || parser.HelpDisplayed()) {
+        return;
+    }
+
+    PipelineBenchmark benchmark(aEnv, optionDuration.Value(), optionBatch.Value());
+    if (!optionNoWav.Value()) {
+        static const TUint kWavFormats[][3] = { // sample rate, bit depth, channels
+            {  44100, 16, 2 },
+            {  48000, 16, 1 },
+            {  48000, 24, 2 },
+            {  96000, 24, 2 },
+            { 192000, 24, 2 },
+            {  48000, 24, 6 },
+        };
+        for (auto& format : kWavFormats) {
+            benchmark.AddGeneratedWav(format[0], format[1], format[2]);
+        }
+    }
+    Parser files(optionFiles.Value());
+    while (!files.Finished()) {
+        Brn path = files.Next(',');
+        if (path.Bytes() > 0) {
+            benchmark.AddFile(path);
+        }
+    }
+    benchmark.Run();
+    benchmark.Report(optionCsv.Value(), optionJson.Value());
+}
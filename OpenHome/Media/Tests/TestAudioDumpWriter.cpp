@@ -0,0 +1,442 @@
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Private/SuiteUnitTest.h>
+#include <OpenHome/Media/Pipeline/AudioDumpWriter.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Private/File.h>
+
+#include <atomic>
+#include <vector>
+#include <string.h>
+
+using namespace OpenHome;
+using namespace OpenHome::TestFramework;
+using namespace OpenHome::Media;
+
+namespace OpenHome {
+namespace Media {
+
+class MemoryFileSystem;
+
+class MemoryFile : public IFile
+{
+public:
+    MemoryFile(MemoryFileSystem& aFileSystem, std::vector<TByte>& aData);
+private: // from IFile
+    void Read(Bwx& aBuffer) override;
+    void Read(Bwx& aBuffer, TUint32 aBytes) override;
+    void Write(const Brx& aBuffer) override;
+    void Write(const Brx& aBuffer, TUint32 aBytes) override;
+    void Seek(TInt32 aBytes, SeekWhence aWhence) override;
+    TUint32 Tell() const override;
+    TUint32 Bytes() const override;
+    void Flush() override;
+private:
+    MemoryFileSystem& iFileSystem;
+    std::vector<TByte>& iData;
+    TUint iPos;
+};
+
+class MemoryFileSystem : public IFileSystem
+{
+    static const TUint kMaxFiles = 8;
+    static const TUint kTimeoutMs = 5000;
+public:
+    MemoryFileSystem();
+    const std::vector<TByte>& File(TUint aIndex) const;
+    TUint NumFiles() const;
+    void BlockNextWrite();
+    void WaitUntilBlocked();
+    void Release();
+    void WriteStarting(); // called by MemoryFile; blocks if requested by BlockNextWrite()
+private: // from IFileSystem
+    IFile* Open(const TChar* aFilename, FileMode aFileMode) override;
+private:
+    std::vector<TByte> iFiles[kMaxFiles];
+    TUint iNumFiles;
+    std::atomic<bool> iBlockNextWrite;
+    Semaphore iBlocked;
+    Semaphore iRelease;
+};
+
+class SuiteAudioDumpWriter : public SuiteUnitTest
+{
+    static const TUint kRingBytes = 2048;
+    static const TUint kTimeoutMs = 5000;
+public:
+    SuiteAudioDumpWriter();
+private: // from SuiteUnitTest
+    void Setup() override;
+    void TearDown() override;
+private:
+    void WaitForWriter();
+    void Finish(); // deletes iWriter, so writes any queued data and closes the current file
+    static TUint64 ReadLe(const std::vector<TByte>& aFile, TUint aOffset, TUint aBytes);
+    static TBool HasTag(const std::vector<TByte>& aFile, TUint aOffset, const TChar* aTag);
+    void TestWavHeader();
+    void TestPcmByteOrder();
+    void TestNative32ByteOrder();
+    void TestRingWrapsWithPadRecord();
+    void TestDropsWhenFull();
+    void TestRf64Header();
+private:
+    MemoryFileSystem* iFileSystem;
+    AudioDumpWriter* iWriter;
+};
+
+} // namespace Media
+} // namespace OpenHome
+
+
+// MemoryFile
+
+MemoryFile::MemoryFile(MemoryFileSystem& aFileSystem, std::vector<TByte>& aData)
+    : iFileSystem(aFileSystem)
+    , iData(aData)
+    , iPos(0)
+{
+}
+
+void MemoryFile::Read(Bwx& /*aBuffer*/)
+{
+    ASSERTS();
+}
+
+void MemoryFile::Read(Bwx& /*aBuffer*/, TUint32 /*aBytes*/)
+{
+    ASSERTS();
+}
+
+void MemoryFile::Write(const Brx& aBuffer)
+{
+    Write(aBuffer, aBuffer.Bytes());
+}
+
+void MemoryFile::Write(const Brx& aBuffer, TUint32 aBytes)
+{
+    iFileSystem.WriteStarting();
+    if (iPos + aBytes > iData.size()) {
+        iData.resize(iPos + aBytes);
+    }
+    (void)memcpy(&iData[iPos], aBuffer.Ptr(), aBytes);
+    iPos += aBytes;
+}
+
+void MemoryFile::Seek(TInt32 aBytes, SeekWhence aWhence)
+{
+    ASSERT(aWhence == eSeekFromStart);
+    ASSERT(aBytes >= 0 && (TUint)aBytes <= iData.size());
+    iPos = (TUint)aBytes;
+}
+
+TUint32 MemoryFile::Tell() const
+{
+    return iPos;
+}
+
+TUint32 MemoryFile::Bytes() const
+{
+    return (TUint32)iData.size();
+}
+
+void MemoryFile::Flush()
+{
+}
+
+
+// MemoryFileSystem
+
+MemoryFileSystem::MemoryFileSystem()
+    : iNumFiles(0)
+    , iBlockNextWrite(false)
+    , iBlocked("MFS1", 0)
+    , iRelease("MFS2", 0)
+{
+}
+
+const std::vector<TByte>& MemoryFileSystem::File(TUint aIndex) const
+{
+    ASSERT(aIndex < iNumFiles);
+    return iFiles[aIndex];
+}
+
+TUint MemoryFileSystem::NumFiles() const
+{
+    return iNumFiles;
+}
+
+void MemoryFileSystem::BlockNextWrite()
+{
+    iBlockNextWrite.store(true);
+}
+
+void MemoryFileSystem::WaitUntilBlocked()
+{
+    iBlocked.Wait(kTimeoutMs);
+}
+
+void MemoryFileSystem::Release()
+{
+    iRelease.Signal();
+}
+
+void MemoryFileSystem::WriteStarting()
+{
+    if (iBlockNextWrite.exchange(false)) {
+        iBlocked.Signal();
+        iRelease.Wait();
+    }
+}
+
+IFile* MemoryFileSystem::Open(const TChar* /*aFilename*/, FileMode /*aFileMode*/)
+{
+    ASSERT(iNumFiles < kMaxFiles);
+    std::vector<TByte>& data = iFiles[iNumFiles++];
+    data.clear();
+    return new MemoryFile(*this, data);
+}
+
+
+// SuiteAudioDumpWriter
+
+SuiteAudioDumpWriter::SuiteAudioDumpWriter()
+    : SuiteUnitTest("AudioDumpWriter")
+    , iFileSystem(nullptr)
+    , iWriter(nullptr)
+{
+    AddTest(MakeFunctor(*this, &SuiteAudioDumpWriter::TestWavHeader), "TestWavHeader");
+    AddTest(MakeFunctor(*this, &SuiteAudioDumpWriter::TestPcmByteOrder), "TestPcmByteOrder");
+    AddTest(MakeFunctor(*this, &SuiteAudioDumpWriter::TestNative32ByteOrder), "TestNative32ByteOrder");
+    AddTest(MakeFunctor(*this, &SuiteAudioDumpWriter::TestRingWrapsWithPadRecord), "TestRingWrapsWithPadRecord");
+    AddTest(MakeFunctor(*this, &SuiteAudioDumpWriter::TestDropsWhenFull), "TestDropsWhenFull");
+    AddTest(MakeFunctor(*this, &SuiteAudioDumpWriter::TestRf64Header), "TestRf64Header");
+}
+
+void SuiteAudioDumpWriter::Setup()
+{
+    iFileSystem = new MemoryFileSystem();
+    iWriter = new AudioDumpWriter(kRingBytes, kPriorityNormal, *iFileSystem);
+}
+
+void SuiteAudioDumpWriter::TearDown()
+{
+    iFileSystem->Release(); // in case a failed test left the writer thread blocked
+    delete iWriter;
+    delete iFileSystem;
+}
+
+void SuiteAudioDumpWriter::WaitForWriter()
+{
+    iWriter->iThread->Signal();
+    for (TUint i=0; i<kTimeoutMs/10; i++) {
+        if (iWriter->iReadCount.load() == iWriter->iWriteCount.load()) {
+            return;
+        }
+        Thread::Sleep(10);
+    }
+    TEST(iWriter->iReadCount.load() == iWriter->iWriteCount.load());
+}
+
+void SuiteAudioDumpWriter::Finish()
+{
+    delete iWriter;
+    iWriter = nullptr;
+}
+
+TUint64 SuiteAudioDumpWriter::ReadLe(const std::vector<TByte>& aFile, TUint aOffset, TUint aBytes)
+{ // static
+    TUint64 val = 0;
+    for (TUint i=0; i<aBytes; i++) {
+        val |= ((TUint64)aFile[aOffset + i]) << (8 * i);
+    }
+    return val;
+}
+
+TBool SuiteAudioDumpWriter::HasTag(const std::vector<TByte>& aFile, TUint aOffset, const TChar* aTag)
+{ // static
+    return memcmp(&aFile[aOffset], aTag, 4) == 0;
+}
+
+void SuiteAudioDumpWriter::TestWavHeader()
+{
+    iWriter->OpenWav(Brn("header.wav"), 44100, 16, 2);
+    const TByte data[] = { 0x12, 0x34, 0x56, 0x78 };
+    iWriter->Write(Brn(data, sizeof(data)));
+    iWriter->Close();
+    Finish();
+
+    TEST(iFileSystem->NumFiles() == 1);
+    const std::vector<TByte>& file = iFileSystem->File(0);
+    TEST(file.size() == AudioDumpWriter::kWavHeaderBytes + sizeof(data));
+    TEST(HasTag(file, 0, "RIFF"));
+    TEST(ReadLe(file, 4, 4) == file.size() - 8);
+    TEST(HasTag(file, 8, "WAVE"));
+    TEST(HasTag(file, 12, "JUNK"));
+    TEST(ReadLe(file, 16, 4) == 28);
+    TEST(HasTag(file, 48, "fmt "));
+    TEST(ReadLe(file, 52, 4) == 16);
+    TEST(ReadLe(file, 56, 2) == 1);
+    TEST(ReadLe(file, 58, 2) == 2);
+    TEST(ReadLe(file, 60, 4) == 44100);
+    TEST(ReadLe(file, 64, 4) == 44100 * 4);
+    TEST(ReadLe(file, 68, 2) == 4);
+    TEST(ReadLe(file, 70, 2) == 16);
+    TEST(HasTag(file, 72, "data"));
+    TEST(ReadLe(file, 76, 4) == sizeof(data));
+    const TByte expected[] = { 0x34, 0x12, 0x78, 0x56 };
+    TEST(memcmp(&file[80], expected, sizeof(expected)) == 0);
+}
+
+void SuiteAudioDumpWriter::TestPcmByteOrder()
+{
+    // one big endian subsample per bit depth, followed by one subsample of silence
+    const TByte pcm8[]  = { 0x00, 0x7f, 0x80 };
+    const TByte wav8[]  = { 0x80, 0xff, 0x00, 0x80 };
+    const TByte pcm16[] = { 0x12, 0x34 };
+    const TByte wav16[] = { 0x34, 0x12, 0x00, 0x00 };
+    const TByte pcm24[] = { 0x12, 0x34, 0x56 };
+    const TByte wav24[] = { 0x56, 0x34, 0x12, 0x00, 0x00, 0x00 };
+    const TByte pcm32[] = { 0x12, 0x34, 0x56, 0x78 };
+    const TByte wav32[] = { 0x78, 0x56, 0x34, 0x12, 0x00, 0x00, 0x00, 0x00 };
+    const Brn pcm[] = { Brn(pcm8, sizeof(pcm8)), Brn(pcm16, sizeof(pcm16)), Brn(pcm24, sizeof(pcm24)), Brn(pcm32, sizeof(pcm32)) };
+    const Brn wav[] = { Brn(wav8, sizeof(wav8)), Brn(wav16, sizeof(wav16)), Brn(wav24, sizeof(wav24)), Brn(wav32, sizeof(wav32)) };
+    for (TUint i=0; i<4; i++) {
+        const TUint bitDepth = 8 * (i + 1);
+        iWriter->OpenWav(Brn("pcm.wav"), 44100, bitDepth, 1);
+        iWriter->Write(pcm[i]);
+        iWriter->WriteSilence(bitDepth / 8);
+        iWriter->Close();
+    }
+    Finish();
+
+    TEST(iFileSystem->NumFiles() == 4);
+    for (TUint i=0; i<4; i++) {
+        const std::vector<TByte>& file = iFileSystem->File(i);
+        TEST(file.size() == AudioDumpWriter::kWavHeaderBytes + wav[i].Bytes());
+        TEST(ReadLe(file, 70, 2) == 8 * (i + 1));
+        TEST(ReadLe(file, 76, 4) == wav[i].Bytes());
+        TEST(memcmp(&file[80], wav[i].Ptr(), wav[i].Bytes()) == 0);
+    }
+}
+
+void SuiteAudioDumpWriter::TestNative32ByteOrder()
+{
+    const TInt32 native[] = { 0x12345678, (TInt32)0x80000000 };
+    const TByte wav8[]  = { 0x92, 0x00 };
+    const TByte wav16[] = { 0x34, 0x12, 0x00, 0x80 };
+    const TByte wav24[] = { 0x56, 0x34, 0x12, 0x00, 0x00, 0x80 };
+    const TByte wav32[] = { 0x78, 0x56, 0x34, 0x12, 0x00, 0x00, 0x00, 0x80 };
+    const Brn wav[] = { Brn(wav8, sizeof(wav8)), Brn(wav16, sizeof(wav16)), Brn(wav24, sizeof(wav24)), Brn(wav32, sizeof(wav32)) };
+    const Brn data(reinterpret_cast<const TByte*>(native), sizeof(native));
+    for (TUint i=0; i<4; i++) {
+        iWriter->OpenWav(Brn("native.wav"), 48000, 8 * (i + 1), 2);
+        iWriter->WriteNative32(data);
+        iWriter->Close();
+    }
+    Finish();
+
+    TEST(iFileSystem->NumFiles() == 4);
+    for (TUint i=0; i<4; i++) {
+        const std::vector<TByte>& file = iFileSystem->File(i);
+        TEST(file.size() == AudioDumpWriter::kWavHeaderBytes + wav[i].Bytes());
+        TEST(ReadLe(file, 76, 4) == wav[i].Bytes());
+        TEST(memcmp(&file[80], wav[i].Ptr(), wav[i].Bytes()) == 0);
+    }
+}
+
+void SuiteAudioDumpWriter::TestRingWrapsWithPadRecord()
+{
+    /* Open record is 48 bytes (16 byte header + 12 bytes of format + 8 byte filename, aligned).
+       Each 480 byte write uses a 496 byte record so the fifth doesn't fit in the 16 bytes
+       at the end of the ring.  These are padded and the record starts at offset 0. */
+    static const TUint kChunkBytes = 480;
+    static const TUint kNumChunks = 5;
+    iWriter->OpenRaw(Brn("wrap.raw"));
+    TByte chunk[kChunkBytes];
+    for (TUint i=0; i<kNumChunks; i++) {
+        (void)memset(chunk, 'a' + i, kChunkBytes);
+        iWriter->Write(Brn(chunk, kChunkBytes));
+        WaitForWriter();
+    }
+    TEST(iWriter->iWriteCount.load() == 48 + (kNumChunks * 496) + 16);
+    iWriter->Close();
+    TEST(iWriter->DroppedBytes() == 0);
+    Finish();
+
+    const std::vector<TByte>& file = iFileSystem->File(0);
+    TEST(file.size() == kNumChunks * kChunkBytes);
+    for (TUint i=0; i<file.size(); i++) {
+        if (file[i] != 'a' + (i / kChunkBytes)) {
+            TEST(file[i] == 'a' + (i / kChunkBytes));
+            break;
+        }
+    }
+}
+
+void SuiteAudioDumpWriter::TestDropsWhenFull()
+{
+    // writer thread blocks on its first write to disk; the producer mustn't
+    static const TUint kChunkBytes = 256;
+    static const TUint kNumChunks = 64;
+    iFileSystem->BlockNextWrite();
+    iWriter->OpenRaw(Brn("drop.raw"));
+    TByte chunk[kChunkBytes];
+    for (TUint i=0; i<kNumChunks; i++) {
+        (void)memset(chunk, i, kChunkBytes);
+        iWriter->Write(Brn(chunk, kChunkBytes));
+    }
+    const TUint64 dropped = iWriter->DroppedBytes();
+    TEST(dropped > 0);
+    TEST(dropped % kChunkBytes == 0);
+    iWriter->Close();
+    iFileSystem->Release();
+    Finish();
+
+    const std::vector<TByte>& file = iFileSystem->File(0);
+    TEST(file.size() + dropped == kNumChunks * kChunkBytes);
+    // chunks that weren't dropped are written whole and in order
+    TInt prev = -1;
+    for (TUint i=0; i<file.size(); i+=kChunkBytes) {
+        TEST((TInt)file[i] > prev);
+        TEST(file[i] == file[i + kChunkBytes - 1]);
+        prev = file[i];
+    }
+}
+
+void SuiteAudioDumpWriter::TestRf64Header()
+{
+    iFileSystem->BlockNextWrite();
+    iWriter->OpenWav(Brn("big.wav"), 48000, 24, 2);
+    // writer is blocked writing the placeholder header.  Pretend that 4GB of audio follows it.
+    iFileSystem->WaitUntilBlocked();
+    static const TUint64 kDataBytes = 0x100000000ULL + (6 * 1000);
+    iWriter->iDataBytes = kDataBytes;
+    iWriter->Close();
+    iFileSystem->Release();
+    Finish();
+
+    const std::vector<TByte>& file = iFileSystem->File(0);
+    TEST(file.size() == AudioDumpWriter::kWavHeaderBytes);
+    TEST(HasTag(file, 0, "RF64"));
+    TEST(ReadLe(file, 4, 4) == 0xffffffff);
+    TEST(HasTag(file, 8, "WAVE"));
+    TEST(HasTag(file, 12, "ds64"));
+    TEST(ReadLe(file, 16, 4) == 28);
+    TEST(ReadLe(file, 20, 8) == kDataBytes + AudioDumpWriter::kWavHeaderBytes - 8);
+    TEST(ReadLe(file, 28, 8) == kDataBytes);
+    TEST(ReadLe(file, 36, 8) == kDataBytes / 6);
+    TEST(ReadLe(file, 44, 4) == 0);
+    TEST(HasTag(file, 48, "fmt "));
+    TEST(ReadLe(file, 70, 2) == 24);
+    TEST(HasTag(file, 72, "data"));
+    TEST(ReadLe(file, 76, 4) == 0xffffffff);
+}
+
+
+
+void TestAudioDumpWriter()
+{
+    Runner runner("AudioDumpWriter tests\n");
+    runner.Add(new SuiteAudioDumpWriter());
+    runner.Run();
+}
@@ -0,0 +1,10 @@
+#include <OpenHome/Private/TestFramework.h>
+extern void TestAudioDumpWriter();
+
+void OpenHome::TestFramework::Runner::Main(TInt /*aArgc*/, TChar* /*aArgv*/[], Net::InitialisationParams* aInitParams)
+{
+    Net::UpnpLibrary::InitialiseMinimal(aInitParams);
+    TestAudioDumpWriter();
+    delete aInitParams;
+    Net::UpnpLibrary::Close();
+}
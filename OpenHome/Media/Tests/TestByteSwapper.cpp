@@ -0,0 +1,204 @@
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Media/Utils/ByteSwapper.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/OsWrapper.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/Private/Printer.h>
+
+#include <string.h>
+#include <vector>
+
+using namespace OpenHome;
+using namespace OpenHome::TestFramework;
+using namespace OpenHome::Media;
+
+namespace OpenHome {
+namespace Media {
+
+class SuiteByteSwapper : public Suite
+{
+    static const TUint kMaxBytes = 1024 * 3; // multiple of 2, 3 and 4
+    static const TUint kMaxOffset = 31;
+public:
+    SuiteByteSwapper(ByteSwapper::Impl aImpl);
+    void Test() override;
+private:
+    typedef void (*CopyFunction)(const TByte* aSrc, TByte* aDest, TUint aBytes);
+    void TestWidth(CopyFunction aCopy, TUint aBytesPerSubsample);
+    static void Expected(const TByte* aSrc, TByte* aDest, TUint aBytes, TUint aBytesPerSubsample);
+private:
+    const ByteSwapper::Impl iImpl;
+    std::vector<TByte> iSrc;
+    std::vector<TByte> iDest;
+    std::vector<TByte> iExpected;
+};
+
+class ByteSwapperBenchmark : public INonCopyable
+{
+    static const TUint kBytes = 48 * 1024; // roughly the size of the largest DecodedAudio
+    static const TUint kWarmupIterations = 1000;
+    static const TUint kMinDurationUs = 200000;
+public:
+    ByteSwapperBenchmark(Environment& aEnv);
+    void Run();
+private:
+    typedef void (*CopyFunction)(const TByte* aSrc, TByte* aDest, TUint aBytes);
+    void Run(ByteSwapper::Impl aImpl, TUint aBitDepth, CopyFunction aCopy);
+private:
+    Environment& iEnv;
+    std::vector<TByte> iSrc;
+    std::vector<TByte> iDest;
+};
+
+} // namespace Media
+} // namespace OpenHome
+
+
+// SuiteByteSwapper
+
+SuiteByteSwapper::SuiteByteSwapper(ByteSwapper::Impl aImpl)
+    : Suite(ByteSwapper::Name(aImpl))
+    , iImpl(aImpl)
+    , iSrc(kMaxBytes + kMaxOffset)
+    , iDest(kMaxBytes + kMaxOffset + 16)
+    , iExpected(kMaxBytes)
+{
+    for (TUint i=0; i<iSrc.size(); i++) {
+        iSrc[i] = (TByte)(i * 7 + 3);
+    }
+}
+
+void SuiteByteSwapper::Test()
+{
+    const ByteSwapper::Impl prev = ByteSwapper::Selected();
+    ByteSwapper::SetImpl(iImpl);
+    TEST(ByteSwapper::Selected() == iImpl);
+    TestWidth(ByteSwapper::CopyToBigEndian16, 2);
+    TestWidth(ByteSwapper::CopyToBigEndian24, 3);
+    TestWidth(ByteSwapper::CopyToBigEndian32, 4);
+    ByteSwapper::SetImpl(prev);
+}
+
+void SuiteByteSwapper::TestWidth(CopyFunction aCopy, TUint aBytesPerSubsample)
+{
+    static const TByte kGuard = 0xa5;
+    // all short lengths (covering every vector tail), then a sample of longer ones
+    std::vector<TUint> lengths;
+    for (TUint bytes=0; bytes<=200; bytes+=aBytesPerSubsample) {
+        lengths.push_back(bytes);
+    }
+    for (TUint bytes=256*aBytesPerSubsample; bytes<=kMaxBytes; bytes+=37*aBytesPerSubsample) {
+        lengths.push_back(bytes);
+    }
+    lengths.push_back((TUint)kMaxBytes);
+
+    TBool ok = true;
+    for (TUint srcOffset=0; srcOffset<=kMaxOffset && ok; srcOffset+=(srcOffset<4? 1 : 9)) {
+        for (TUint destOffset=0; destOffset<=kMaxOffset && ok; destOffset+=(destOffset<4? 1 : 13)) {
+            for (auto bytes : lengths) {
+                const TByte* src = &iSrc[srcOffset];
+                TByte* dest = &iDest[destOffset];
+                memset(&iDest[0], kGuard, iDest.size());
+                aCopy(src, dest, bytes);
+                Expected(src, &iExpected[0], bytes, aBytesPerSubsample);
+                if (memcmp(dest, &iExpected[0], bytes) != 0) {
+                    Print("Mismatch: %u-bit, bytes=%u, srcOffset=%u, destOffset=%u\n", aBytesPerSubsample*8, bytes, srcOffset, destOffset);
+                    ok = false;
+                    break;
+                }
+                for (TUint i=0; i<destOffset; i++) {
+                    ok = ok && (iDest[i] == kGuard);
+                }
+                for (TUint i=destOffset+bytes; i<iDest.size(); i++) {
+                    ok = ok && (iDest[i] == kGuard);
+                }
+                if (!ok) {
+                    Print("Overrun: %u-bit, bytes=%u, srcOffset=%u, destOffset=%u\n", aBytesPerSubsample*8, bytes, srcOffset, destOffset);
+                    break;
+                }
+            }
+        }
+    }
+    TEST(ok);
+}
+
+void SuiteByteSwapper::Expected(const TByte* aSrc, TByte* aDest, TUint aBytes, TUint aBytesPerSubsample)
+{ // static
+    for (TUint i=0; i<aBytes; i+=aBytesPerSubsample) {
+        for (TUint j=0; j<aBytesPerSubsample; j++) {
+            aDest[i+j] = aSrc[i + aBytesPerSubsample - 1 - j];
+        }
+    }
+}
+
+
+// ByteSwapperBenchmark
+
+ByteSwapperBenchmark::ByteSwapperBenchmark(Environment& aEnv)
+    : iEnv(aEnv)
+    , iSrc(kBytes)
+    , iDest(kBytes)
+{
+    for (TUint i=0; i<kBytes; i++) {
+        iSrc[i] = (TByte)i;
+    }
+}
+
+void ByteSwapperBenchmark::Run()
+{
+    static const ByteSwapper::Impl kImpls[] = { ByteSwapper::Impl::eScalar, ByteSwapper::Impl::eSse2, ByteSwapper::Impl::eSsse3,
+                                                ByteSwapper::Impl::eAvx2, ByteSwapper::Impl::eNeon };
+    const ByteSwapper::Impl prev = ByteSwapper::Selected();
+    Log::Print("ByteSwapper benchmark (%u byte buffers, default impl is %s)\n", kBytes, ByteSwapper::Name(prev));
+    for (auto impl : kImpls) {
+        if (!ByteSwapper::IsSupported(impl)) {
+            Log::Print("    %-6s: not supported\n", ByteSwapper::Name(impl));
+            continue;
+        }
+        ByteSwapper::SetImpl(impl);
+        Run(impl, 16, ByteSwapper::CopyToBigEndian16);
+        Run(impl, 24, ByteSwapper::CopyToBigEndian24);
+        Run(impl, 32, ByteSwapper::CopyToBigEndian32);
+    }
+    ByteSwapper::SetImpl(prev);
+}
+
+void ByteSwapperBenchmark::Run(ByteSwapper::Impl aImpl, TUint aBitDepth, CopyFunction aCopy)
+{
+    const TUint bytes = kBytes - (kBytes % (aBitDepth/8));
+    for (TUint i=0; i<kWarmupIterations; i++) {
+        aCopy(&iSrc[0], &iDest[0], bytes);
+    }
+    TUint64 iterations = 0;
+    const TUint64 start = OsTimeInUs(iEnv.OsCtx());
+    TUint64 elapsed = 0;
+    do {
+        for (TUint i=0; i<kWarmupIterations; i++) {
+            aCopy(&iSrc[0], &iDest[0], bytes);
+        }
+        iterations += kWarmupIterations;
+        elapsed = OsTimeInUs(iEnv.OsCtx()) - start;
+    } while (elapsed < kMinDurationUs);
+    const double gbPerSec = ((double)bytes * iterations) / ((double)elapsed * 1000.0);
+    Log::Print("    %-6s: %u-bit %6.2f GB/s\n", ByteSwapper::Name(aImpl), aBitDepth, gbPerSec);
+}
+
+
+
+void TestByteSwapper()
+{
+    static const ByteSwapper::Impl kImpls[] = { ByteSwapper::Impl::eScalar, ByteSwapper::Impl::eSse2, ByteSwapper::Impl::eSsse3,
+                                                ByteSwapper::Impl::eAvx2, ByteSwapper::Impl::eNeon };
+    Runner runner("ByteSwapper tests\n");
+    for (auto impl : kImpls) {
+        if (ByteSwapper::IsSupported(impl)) {
+            runner.Add(new SuiteByteSwapper(impl));
+        }
+    }
+    runner.Run();
+}
+
+void BenchmarkByteSwapper(Environment& aEnv)
+{
+    ByteSwapperBenchmark(aEnv).Run();
+}
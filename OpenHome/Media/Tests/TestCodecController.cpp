@@ -45,6 +45,22 @@ protected:
     TUint64 iTrackOffset;
 };
 
+/**
+ * Codec that never recognises a stream.  Counts the number of times it is asked to.
+ */
+class TestCodecControllerRecogniseCounter : public Codec::CodecBase
+{
+public:
+    TestCodecControllerRecogniseCounter();
+    TUint RecogniseCount() const;
+public: // from CodecBase
+    TBool Recognise(const EncodedStreamInfo& aStreamInfo) override;
+    void Process() override;
+    TBool TrySeek(TUint aStreamId, TUint64 aSample) override;
+private:
+    TUint iRecogniseCount;
+};
+
 class SuiteCodecControllerBase : public SuiteUnitTest
                                , private IPipelineElementUpstream
                                , private IPipelineElementDownstream
@@ -177,7 +193,10 @@ private:
     void TestTrackEncodedStreamMetatext();
     void TestSeek();
     void TestSeekNewStream();
+    void TestRecognitionHint();
+    void TestRecognitionFailRecorded();
 private:
+    TestCodecControllerRecogniseCounter* iRecogniseCounter;
     Semaphore* iSemSeek;
     TUint iHandle;
     TUint iExpectedFlushId;
@@ -202,6 +221,29 @@ private:
     TestCodecControllerDummyCodec* iCodec;
 };
 
+/**
+ * Streams with no recognisable header, so codecs are tried in order of cost unless one
+ * decoded the previous stream.
+ */
+class SuiteCodecControllerPrevCodec : public SuiteCodecControllerBase
+{
+private:
+    static const TUint kBitsPerSample = 16;
+    static const TUint kSamplesPerMsg = 16;
+    static const TUint kAudioBytesPerMsg = 2*2*kSamplesPerMsg; // 16 bits (2 bytes) * 2 channels * kSamplesPerMsg
+public:
+    SuiteCodecControllerPrevCodec();
+private: // from SuiteCodecControllerBase
+    void Setup() override;
+    void TearDown() override;
+private:
+    Msg* CreateAudio();
+    void TestPrevCodecRecognisedFirst();
+private:
+    TestCodecControllerDummyCodec* iCodec;
+    TestCodecControllerRecogniseCounter* iRecogniseCounter;
+};
+
 class TestCodecControllerDummyCodecStreamInitialise : public TestCodecControllerDummyCodec
 {
 public:
@@ -285,6 +327,34 @@ private:
     TestCodecControllerDummyCodecBuffered* iCodec;
 };
 
+class TestCodecControllerDummyCodecProcess : public TestCodecControllerDummyCodec
+{
+public:
+    TestCodecControllerDummyCodecProcess(TUint aReadBufBytes, Semaphore& aSemProcessPending, Semaphore& aSemProcessContinue);
+public: // from TestCodecControllerDummyCodec
+    void Process() override;
+private:
+    Semaphore& iSemProcessPending;  // Notifies test code that Process() has been entered.
+    Semaphore& iSemProcessContinue; // Blocks reading of encoded audio until signalled.
+};
+
+class SuiteCodecControllerStopDuringProcess : public SuiteCodecControllerBase
+{
+private:
+    static const TUint kAudioBytesPerMsg = 1024;
+public:
+    SuiteCodecControllerStopDuringProcess();
+private: // from SuiteCodecControllerBase
+    void Setup() override;
+    void TearDown() override;
+private:
+    void TestStopAbandonsEncodedAudio();
+private:
+    Semaphore* iSemProcessPending;
+    Semaphore* iSemProcessContinue;
+    TestCodecControllerDummyCodecProcess* iCodec;
+};
+
 } // namespace Media
 } // namespace OpenHome
 
@@ -603,6 +673,8 @@ SuiteCodecControllerStream::SuiteCodecControllerStream()
     AddTest(MakeFunctor(*this, &SuiteCodecControllerStream::TestTruncatedStream), "TestTruncatedStream");
     AddTest(MakeFunctor(*this, &SuiteCodecControllerStream::TestSeek), "TestSeek");
     AddTest(MakeFunctor(*this, &SuiteCodecControllerStream::TestSeekNewStream), "TestSeekNewStream");
+    AddTest(MakeFunctor(*this, &SuiteCodecControllerStream::TestRecognitionHint), "TestRecognitionHint");
+    AddTest(MakeFunctor(*this, &SuiteCodecControllerStream::TestRecognitionFailRecorded), "TestRecognitionFailRecorded");
 }
 
 void SuiteCodecControllerStream::Setup()
@@ -612,6 +684,8 @@ void SuiteCodecControllerStream::Setup()
     iHandle = ISeeker::kHandleError;
     iExpectedFlushId = iFlushId = MsgFlush::kIdInvalid;
     iController->AddCodec(CodecFactory::NewWav(*this));
+    iRecogniseCounter = new TestCodecControllerRecogniseCounter(); // cheaper than WAV so tried first for a new stream
+    iController->AddCodec(iRecogniseCounter);  // Takes ownership.
     iController->Start();
 }
 
@@ -877,6 +951,46 @@ void SuiteCodecControllerStream::TestTrackEncodedStreamMetatext()
     PullNext(EMsgEncodedStream);
 }
 
+void SuiteCodecControllerStream::TestRecognitionHint()
+{
+    // "RIFF....WAVE" header should cause WAV to be tried before the (cheaper) counting codec
+    static const TUint kAudioBytes = 200;
+    iTotalBytes = kWavHeaderBytes + kAudioBytes;
+    Queue(CreateTrack());
+    PullNext(EMsgTrack);
+    Queue(CreateEncodedStream());
+    PullNext(EMsgEncodedStream);
+    Queue(CreateAudio(true, iTotalBytes));
+    PullNext(EMsgDecodedStream);
+    TEST(iRecogniseCounter->RecogniseCount() == 0);
+    TEST(iController->Recognition().Count() == 1);
+    TEST(iController->Recognition().HintsCorrect() == 1);
+
+    // Flush remaining audio from stream out by sending a new MsgEncodedStream.
+    Queue(CreateEncodedStream());
+    PullNext(EMsgAudioPcm);
+    PullNext(EMsgEncodedStream);
+}
+
+void SuiteCodecControllerStream::TestRecognitionFailRecorded()
+{
+    // no hint for a "NULL" header so every codec is tried (and fails) in order of cost
+    static const TUint kAudioBytes = 6144;
+    iTotalBytes = kWavHeaderBytes + kAudioBytes;
+    Queue(CreateTrack());
+    PullNext(EMsgTrack);
+    Queue(CreateEncodedStream());
+    PullNext(EMsgEncodedStream);
+    Queue(CreateAudio(false, kMaxMsgBytes));
+
+    iSemStop->Wait();
+    TEST(iStopCount == 1);
+    TEST(iRecogniseCounter->RecogniseCount() == 1);
+    TEST(iController->Recognition().Count() == 1);
+    TEST(iController->Recognition().Failures() == 1);
+    TEST(iController->Recognition().HintsCorrect() == 0);
+}
+
 void SuiteCodecControllerStream::TestSeek()
 {
     static const TUint kMaxEncodedBytes = kMaxMsgBytes;
@@ -1145,6 +1259,68 @@ void SuiteCodecControllerPcmSize::TestPcmIsExpectedSize()
 }
 
 
+// SuiteCodecControllerPrevCodec
+
+SuiteCodecControllerPrevCodec::SuiteCodecControllerPrevCodec()
+    : SuiteCodecControllerBase("SuiteCodecControllerPrevCodec")
+{
+    AddTest(MakeFunctor(*this, &SuiteCodecControllerPrevCodec::TestPrevCodecRecognisedFirst), "TestPrevCodecRecognisedFirst");
+}
+
+void SuiteCodecControllerPrevCodec::Setup()
+{
+    SuiteCodecControllerBase::Setup();
+    iCodec = new TestCodecControllerDummyCodec(kAudioBytesPerMsg);
+    iController->AddCodec(iCodec);  // Takes ownership.
+    iRecogniseCounter = new TestCodecControllerRecogniseCounter(); // cheaper than iCodec so tried first for a new stream
+    iController->AddCodec(iRecogniseCounter);  // Takes ownership.
+    iController->Start();
+}
+
+void SuiteCodecControllerPrevCodec::TearDown()
+{
+    SuiteCodecControllerBase::TearDown();
+}
+
+Msg* SuiteCodecControllerPrevCodec::CreateAudio()
+{
+    static const TUint kBytesPerSample = kBitsPerSample/8;
+
+    TByte encodedAudioData[kAudioBytesPerMsg];
+    (void)memset(encodedAudioData, 0x7f, kAudioBytesPerMsg); // matches no RecognitionHint signature
+    Brn encodedAudioBuf(encodedAudioData, kAudioBytesPerMsg);
+    MsgAudioEncoded* audio = iMsgFactory->CreateMsgAudioEncoded(encodedAudioBuf);
+
+    TUint samples = kAudioBytesPerMsg / (kNumChannels*kBytesPerSample);
+    TUint jiffiesPerSample = Jiffies::kPerSecond / kSampleRate;
+    iTrackOffset += samples * jiffiesPerSample;
+    iTrackOffsetBytes += kAudioBytesPerMsg;
+    return audio;
+}
+
+void SuiteCodecControllerPrevCodec::TestPrevCodecRecognisedFirst()
+{
+    iCodec->SetStreamInfo(kAudioBytesPerMsg, kNumChannels, kSampleRate, kBitsPerSample, AudioDataEndian::Big, kProfile);
+    Queue(CreateTrack());
+    PullNext(EMsgTrack);
+    Queue(CreateEncodedStream());
+    PullNext(EMsgEncodedStream);
+    Queue(CreateAudio());
+    Queue(CreateEncodedStream());
+    PullNext(EMsgDecodedStream);
+    PullNext(EMsgAudioPcm);
+    TEST(iRecogniseCounter->RecogniseCount() == 1);
+
+    // Start a second stream.  The dummy codec decoded the previous stream so should be tried first.
+    PullNext(EMsgEncodedStream);
+    Queue(CreateAudio());
+    PullNext(EMsgDecodedStream);
+    TEST(iRecogniseCounter->RecogniseCount() == 1);
+    TEST(iController->Recognition().Count() == 2);
+    TEST(iController->Recognition().Failures() == 0);
+}
+
+
 // TestCodecControllerDummyCodec
 
 const TChar* TestCodecControllerDummyCodec::kId("DUMC");
@@ -1218,6 +1394,37 @@ void TestCodecControllerDummyCodec::StreamCompleted()
 }
 
 
+// TestCodecControllerRecogniseCounter
+
+TestCodecControllerRecogniseCounter::TestCodecControllerRecogniseCounter()
+    : CodecBase("RCNT", CodecBase::RecognitionComplexity::kCostVeryLow)
+    , iRecogniseCount(0)
+{
+}
+
+TUint TestCodecControllerRecogniseCounter::RecogniseCount() const
+{
+    return iRecogniseCount;
+}
+
+TBool TestCodecControllerRecogniseCounter::Recognise(const EncodedStreamInfo& /*aStreamInfo*/)
+{
+    iRecogniseCount++;
+    return false;
+}
+
+void TestCodecControllerRecogniseCounter::Process()
+{
+    ASSERTS();
+}
+
+TBool TestCodecControllerRecogniseCounter::TrySeek(TUint /*aStreamId*/, TUint64 /*aSample*/)
+{
+    ASSERTS();
+    return false;
+}
+
+
 // TestCodecControllerDummyCodecStreamInitialise
 
 TestCodecControllerDummyCodecStreamInitialise::TestCodecControllerDummyCodecStreamInitialise(TUint aReadBufBytes, Semaphore& aSemStreamInitPending, Semaphore& aSemStreamInitContinue)
@@ -1510,14 +1717,92 @@ void SuiteCodecControllerUnexpectedFlush::TestUnexpectedFlush()
 
 
 
+// TestCodecControllerDummyCodecProcess
+
+TestCodecControllerDummyCodecProcess::TestCodecControllerDummyCodecProcess(TUint aReadBufBytes, Semaphore& aSemProcessPending, Semaphore& aSemProcessContinue)
+    : TestCodecControllerDummyCodec(aReadBufBytes)
+    , iSemProcessPending(aSemProcessPending)
+    , iSemProcessContinue(aSemProcessContinue)
+{
+}
+
+void TestCodecControllerDummyCodecProcess::Process()
+{
+    iSemProcessPending.Signal();
+    iSemProcessContinue.Wait();
+    TestCodecControllerDummyCodec::Process();
+}
+
+
+// SuiteCodecControllerStopDuringProcess
+
+SuiteCodecControllerStopDuringProcess::SuiteCodecControllerStopDuringProcess()
+    : SuiteCodecControllerBase("SuiteCodecControllerStopDuringProcess")
+{
+    AddTest(MakeFunctor(*this, &SuiteCodecControllerStopDuringProcess::TestStopAbandonsEncodedAudio), "TestStopAbandonsEncodedAudio");
+}
+
+void SuiteCodecControllerStopDuringProcess::Setup()
+{
+    SuiteCodecControllerBase::Setup();
+    iSemProcessPending = new Semaphore("SCPP", 0);
+    iSemProcessContinue = new Semaphore("SCPC", 0);
+    iCodec = new TestCodecControllerDummyCodecProcess(kAudioBytesPerMsg, *iSemProcessPending, *iSemProcessContinue);
+    iController->AddCodec(iCodec);  // Takes ownership.
+    iController->Start();
+}
+
+void SuiteCodecControllerStopDuringProcess::TearDown()
+{
+    iCodec = nullptr;
+    SuiteCodecControllerBase::TearDown();
+    delete iSemProcessContinue;
+    delete iSemProcessPending;
+}
+
+void SuiteCodecControllerStopDuringProcess::TestStopAbandonsEncodedAudio()
+{
+    iCodec->SetStreamInfo(kAudioBytesPerMsg, 2, 44100, 16, AudioDataEndian::Little, SpeakerProfile());
+
+    Queue(CreateTrack());
+    PullNext(EMsgTrack);
+    Queue(CreateEncodedStream());
+    PullNext(EMsgEncodedStream);
+    PullNext(EMsgDecodedStream);
+
+    // Queue a single msg containing enough audio for three calls to Process().
+    TByte encodedAudioData[kAudioBytesPerMsg*3];
+    (void)memset(encodedAudioData, 0x7f, sizeof(encodedAudioData));
+    Brn encodedAudioBuf(encodedAudioData, sizeof(encodedAudioData));
+    Queue(iMsgFactory->CreateMsgAudioEncoded(encodedAudioBuf));
+
+    iSemProcessPending->Wait();
+    iSemProcessContinue->Signal();
+    PullNext(EMsgAudioPcm);
+
+    // Stop the stream while CodecController still holds the remainder of the encoded audio.
+    iSemProcessPending->Wait();
+    TEST(iStreamHandler->TryStop(iStreamId) == kExpectedFlushId);
+    TEST(iStopCount == 1);
+    iSemProcessContinue->Signal();
+
+    // Held audio should be discarded rather than decoded.
+    Queue(CreateFlush());
+    PullNext(EMsgFlush);
+    TEST(iJiffies == Jiffies::kPerSecond / 44100 * (kAudioBytesPerMsg / 4));
+}
+
+
 void TestCodecController()
 {
     Runner runner("CodecController tests\n");
     runner.Add(new SuiteCodecControllerStream());
     runner.Add(new SuiteCodecControllerPcmSize());
+    runner.Add(new SuiteCodecControllerPrevCodec());
     runner.Add(new SuiteCodecControllerStopDuringStreamInit());
     runner.Add(new SuiteCodecControllerSeekInvalid());
     runner.Add(new SuiteCodecControllerUnexpectedFlush());
+    runner.Add(new SuiteCodecControllerStopDuringProcess());
     runner.Run();
 }
 
@@ -255,6 +255,38 @@ private:
     TestDummyContainer* iDummyContainer;
 };
 
+/**
+ * Container that recognises any stream and counts the MsgAudioEncoded it pulls from the cache.
+ */
+class TestCountingContainer : public ContainerBase
+{
+public:
+    TestCountingContainer();
+    TUint AudioCount() const;
+public: // from ContainerBase
+    Msg* Recognise() override;
+    TBool Recognised() const override;
+    void Reset() override;
+    void Init(TUint64 aStreamBytes) override;
+    TBool TrySeek(TUint aStreamId, TUint64 aOffset) override;
+    Msg* Pull() override;
+private:
+    MsgAudioEncodedRecogniser iRecogniser;
+    TUint iAudioCount;
+};
+
+class SuiteContainerStop : public SuiteContainerBase
+{
+public:
+    SuiteContainerStop();
+private: // from SuiteUnitTest
+    void Setup();
+private:
+    void TestStopDiscardsCachedAudio();
+private:
+    TestCountingContainer* iCountingContainer;
+};
+
 } // Codec
 } // Media
 } // OpenHome
@@ -1133,10 +1165,116 @@ void SuiteContainerNull::TestNullContainer()
 }
 
 
+// TestCountingContainer
+
+TestCountingContainer::TestCountingContainer()
+    : ContainerBase(Brn("CNTC"))
+    , iAudioCount(0)
+{
+}
+
+TUint TestCountingContainer::AudioCount() const
+{
+    return iAudioCount;
+}
+
+Msg* TestCountingContainer::Recognise()
+{
+    return nullptr;
+}
+
+TBool TestCountingContainer::Recognised() const
+{
+    return true;
+}
+
+void TestCountingContainer::Reset()
+{
+}
+
+void TestCountingContainer::Init(TUint64 /*aStreamBytes*/)
+{
+}
+
+TBool TestCountingContainer::TrySeek(TUint /*aStreamId*/, TUint64 /*aOffset*/)
+{
+    ASSERTS();
+    return false;
+}
+
+Msg* TestCountingContainer::Pull()
+{
+    Msg* msg = iCache->Pull();
+    if (msg->Process(iRecogniser) == nullptr) {
+        iAudioCount++;
+        return iRecogniser.AudioEncoded();
+    }
+    return msg;
+}
+
+
+// SuiteContainerStop
+
+SuiteContainerStop::SuiteContainerStop()
+    : SuiteContainerBase("SuiteContainerStop")
+{
+    AddTest(MakeFunctor(*this, &SuiteContainerStop::TestStopDiscardsCachedAudio), "TestStopDiscardsCachedAudio");
+}
+
+void SuiteContainerStop::Setup()
+{
+    SuiteContainerBase::Setup();
+    iCountingContainer = new TestCountingContainer();
+    iContainer->AddContainer(iCountingContainer);  // Takes ownership.
+}
+
+void SuiteContainerStop::TestStopDiscardsCachedAudio()
+{
+    // once TryStop has returned a flush id, audio preceding that flush should be
+    // discarded by the cache rather than passed to the active container to parse
+    static const TUint kDiscardedAudio = 2;
+
+    std::vector<TestContainerMsgGenerator::EMsgType> msgOrder;
+    msgOrder.push_back(TestContainerMsgGenerator::EMsgTrack);
+    msgOrder.push_back(TestContainerMsgGenerator::EMsgEncodedStream);
+    msgOrder.push_back(TestContainerMsgGenerator::EMsgAudioEncoded);
+    static const TUint kMsgCountStop = 3;
+
+    msgOrder.push_back(TestContainerMsgGenerator::EMsgAudioEncoded);
+    msgOrder.push_back(TestContainerMsgGenerator::EMsgAudioEncoded);
+    msgOrder.push_back(TestContainerMsgGenerator::EMsgFlush);
+    msgOrder.push_back(TestContainerMsgGenerator::EMsgAudioEncoded);
+    msgOrder.push_back(TestContainerMsgGenerator::EMsgQuit);
+    static const TUint kCountFinish = kMsgCountStop + 5;
+
+    iGenerator->SetMsgOrder(msgOrder);
+
+    while (iMsgRcvdCount < kMsgCountStop) {
+        PullAndProcess();
+    }
+    TEST(iCountingContainer->AudioCount() == 1);
+
+    TUint stopRes = iContainer->TryStop(iStreamId);
+    TEST(iProvider->StopCount() == 1);
+    TEST(stopRes != MsgFlush::kIdInvalid);
+
+    iAudioRcvdCount += kDiscardedAudio;
+    iMsgRcvdCount += kDiscardedAudio;
+    PullAndProcess(); // flush
+    TEST(iCountingContainer->AudioCount() == 1);
+
+    while (iMsgRcvdCount < kCountFinish) {
+        PullAndProcess();
+    }
+    TEST(iCountingContainer->AudioCount() == 2);
+}
+
+
 void TestContainer()
 {
     Runner runner("Container tests\n");
     runner.Add(new SuiteContainerUnbuffered());
     runner.Add(new SuiteContainerNull());
+    runner.Add(new SuiteContainerStop());
     runner.Run();
 }
@@ -0,0 +1,209 @@
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Private/SuiteUnitTest.h>
+#include <OpenHome/Media/Pipeline/ElementObserver.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/Ascii.h>
+
+#include <atomic>
+
+using namespace OpenHome;
+using namespace OpenHome::TestFramework;
+using namespace OpenHome::Media;
+
+namespace OpenHome {
+namespace Media {
+
+class SuiteElementObserver : public SuiteUnitTest
+{
+    static const TUint kTimeoutMs = 5000;
+    static const TUint kMinIntervalMs = 200;
+public:
+    SuiteElementObserver();
+private: // from SuiteUnitTest
+    void Setup() override;
+    void TearDown() override;
+private:
+    void Create(TUint aNumWorkers);
+    void CallbackA();
+    void CallbackB();
+    void TestCallbackRuns();
+    void TestSchedulesCoalesced();
+    void TestMinInterval();
+    void TestSlowCallbackDoesntBlockOthers();
+    void TestStats();
+private:
+    PipelineElementObserverThread* iObserverThread;
+    IPipelineElementObserverThread* iObserver;
+    Semaphore iSemA;
+    Semaphore iSemB;
+    Semaphore iSemRelease;
+    std::atomic<TUint> iCountA;
+    std::atomic<TUint> iCountB;
+    std::atomic<bool> iBlockA;
+    TUint iIdA;
+    TUint iIdB;
+};
+
+} // namespace Media
+} // namespace OpenHome
+
+
+// SuiteElementObserver
+
+SuiteElementObserver::SuiteElementObserver()
+    : SuiteUnitTest("PipelineElementObserverThread")
+    , iObserverThread(nullptr)
+    , iObserver(nullptr)
+    , iSemA("SEO1", 0)
+    , iSemB("SEO2", 0)
+    , iSemRelease("SEO3", 0)
+{
+    AddTest(MakeFunctor(*this, &SuiteElementObserver::TestCallbackRuns), "TestCallbackRuns");
+    AddTest(MakeFunctor(*this, &SuiteElementObserver::TestSchedulesCoalesced), "TestSchedulesCoalesced");
+    AddTest(MakeFunctor(*this, &SuiteElementObserver::TestMinInterval), "TestMinInterval");
+    AddTest(MakeFunctor(*this, &SuiteElementObserver::TestSlowCallbackDoesntBlockOthers), "TestSlowCallbackDoesntBlockOthers");
+    AddTest(MakeFunctor(*this, &SuiteElementObserver::TestStats), "TestStats");
+}
+
+void SuiteElementObserver::Setup()
+{
+    iObserverThread = nullptr;
+    iObserver = nullptr;
+    (void)iSemA.Clear();
+    (void)iSemB.Clear();
+    (void)iSemRelease.Clear();
+    iCountA.store(0);
+    iCountB.store(0);
+    iBlockA.store(false);
+}
+
+void SuiteElementObserver::TearDown()
+{
+    iBlockA.store(false);
+    iSemRelease.Signal();
+    delete iObserverThread;
+}
+
+void SuiteElementObserver::Create(TUint aNumWorkers)
+{
+    iObserverThread = new PipelineElementObserverThread(kPriorityNormal, aNumWorkers);
+    iObserver = iObserverThread;
+}
+
+void SuiteElementObserver::CallbackA()
+{
+    iCountA++;
+    iSemA.Signal();
+    if (iBlockA.load()) {
+        iSemRelease.Wait();
+    }
+}
+
+void SuiteElementObserver::CallbackB()
+{
+    iCountB++;
+    iSemB.Signal();
+}
+
+void SuiteElementObserver::TestCallbackRuns()
+{
+    Create(1);
+    iIdA = iObserver->Register(MakeFunctor(*this, &SuiteElementObserver::CallbackA));
+    iIdB = iObserver->Register(MakeFunctor(*this, &SuiteElementObserver::CallbackB));
+    TEST(iIdA != iIdB);
+    iObserver->Schedule(iIdB);
+    iSemB.Wait(kTimeoutMs);
+    TEST(iCountA.load() == 0);
+    TEST(iCountB.load() == 1);
+    iObserver->Schedule(iIdA);
+    iSemA.Wait(kTimeoutMs);
+    TEST(iCountA.load() == 1);
+}
+
+void SuiteElementObserver::TestSchedulesCoalesced()
+{
+    Create(1);
+    iIdA = iObserver->Register(MakeFunctor(*this, &SuiteElementObserver::CallbackA));
+    iBlockA.store(true);
+    iObserver->Schedule(iIdA);
+    iSemA.Wait(kTimeoutMs);
+    // callback is blocked; further Schedule calls should result in a single callback once it is released
+    for (TUint i=0; i<10; i++) {
+        iObserver->Schedule(iIdA);
+    }
+    iBlockA.store(false);
+    iSemRelease.Signal();
+    iSemA.Wait(kTimeoutMs);
+    Thread::Sleep(50);
+    TEST(iCountA.load() == 2);
+}
+
+void SuiteElementObserver::TestMinInterval()
+{
+    Create(1);
+    iIdA = iObserver->Register(MakeFunctor(*this, &SuiteElementObserver::CallbackA), kMinIntervalMs);
+    iObserver->Schedule(iIdA);
+    iSemA.Wait(kTimeoutMs); // first callback isn't delayed
+    iObserver->Schedule(iIdA);
+    iObserver->Schedule(iIdA);
+    TEST_THROWS(iSemA.Wait(kMinIntervalMs / 4), Timeout);
+    iSemA.Wait(kTimeoutMs);
+    TEST(iCountA.load() == 2);
+}
+
+void SuiteElementObserver::TestSlowCallbackDoesntBlockOthers()
+{
+    Create(2);
+    iIdA = iObserver->Register(MakeFunctor(*this, &SuiteElementObserver::CallbackA));
+    iIdB = iObserver->Register(MakeFunctor(*this, &SuiteElementObserver::CallbackB));
+    iBlockA.store(true);
+    iObserver->Schedule(iIdA);
+    iSemA.Wait(kTimeoutMs);
+    iObserver->Schedule(iIdB);
+    iSemB.Wait(kTimeoutMs); // throws Timeout if B is stuck behind A
+    TEST(iCountB.load() == 1);
+    // A must not run concurrently with itself
+    iObserver->Schedule(iIdA);
+    TEST_THROWS(iSemA.Wait(50), Timeout);
+    iBlockA.store(false);
+    iSemRelease.Signal();
+    iSemA.Wait(kTimeoutMs);
+    TEST(iCountA.load() == 2);
+}
+
+void SuiteElementObserver::TestStats()
+{
+    Create(1);
+    iIdA = iObserver->Register(MakeFunctor(*this, &SuiteElementObserver::CallbackA));
+    iBlockA.store(true);
+    iObserver->Schedule(iIdA);
+    iSemA.Wait(kTimeoutMs);
+    iObserver->Schedule(iIdA);
+    iObserver->Schedule(iIdA);
+    iBlockA.store(false);
+    iSemRelease.Signal();
+    iSemA.Wait(kTimeoutMs);
+    Thread::Sleep(50);
+
+    Bws<512> buf;
+    WriterBuffer writer(buf);
+    iObserverThread->WriteStats(writer);
+    TEST(Ascii::Contains(buf, Brn("\"dispatches\":2")));
+    TEST(Ascii::Contains(buf, Brn("\"coalesced\":1")));
+
+    iObserverThread->ResetStats();
+    buf.SetBytes(0);
+    iObserverThread->WriteStats(writer);
+    TEST(Ascii::Contains(buf, Brn("\"dispatches\":0")));
+}
+
+
+
+void TestElementObserver()
+{
+    Runner runner("PipelineElementObserverThread tests\n");
+    runner.Add(new SuiteElementObserver());
+    runner.Run();
+}
@@ -0,0 +1,10 @@
+#include <OpenHome/Private/TestFramework.h>
+extern void TestElementObserver();
+
+void OpenHome::TestFramework::Runner::Main(TInt /*aArgc*/, TChar* /*aArgv*/[], Net::InitialisationParams* aInitParams)
+{
+    Net::UpnpLibrary::InitialiseMinimal(aInitParams);
+    TestElementObserver();
+    delete aInitParams;
+    Net::UpnpLibrary::Close();
+}
@@ -38,6 +38,7 @@ private:
     void Test5(); // FeedbackModel oscillator (periodic alternating polarity impulse output)
     void Test6(); // Burg Method testing
     void Test7(); // Speed testing (profiling)
+    void Test8(); // Ramp start latency (profiling)
 
     void Setup();
     void TearDown();
@@ -107,6 +108,7 @@ SuiteFlywheelRamper::SuiteFlywheelRamper(OpenHome::Environment& aEnv)
 
     AddTest(MakeFunctor(*this, &SuiteFlywheelRamper::Test6)); // Burg Method testing
     //AddTest(MakeFunctor(*this, &SuiteFlywheelRamper::Test7)); // Burg Method profiling
+    AddTest(MakeFunctor(*this, &SuiteFlywheelRamper::Test8)); // Ramp start latency
 }
 
 
@@ -680,6 +682,49 @@ void SuiteFlywheelRamper::Test7() // Speed testing (profiling)
 }
 
 
+void SuiteFlywheelRamper::Test8() // Ramp start latency (profiling)
+{
+    // time from a ramp being requested to its first output block being available
+    const TUint kSampleRate = 192000;
+    const TUint kChanCount = 8;
+    const TUint kGenJiffies = Jiffies::kPerMs;
+    const TUint kRampJiffies = 20*Jiffies::kPerMs;
+    const TUint kIterations = 1000;
+
+    TUint genByteCount = FlywheelRamper::SampleCount(kSampleRate, kGenJiffies)*FlywheelRamper::kBytesPerSample*kChanCount;
+    Bwh genSamples(genByteCount);
+    genSamples.SetBytes(genByteCount);
+    genSamples.Fill(0x10);
+
+    TUint blockByteCount = FlywheelRamper::SampleCount(kSampleRate, FlywheelRamperManager::kMaxOutputJiffiesBlockSize)*FlywheelRamper::kBytesPerSample*kChanCount;
+    Bwh rampOutput(blockByteCount);
+    PcmProcessorFeedback opProc(rampOutput);
+    auto ramper = new FlywheelRamperManager(opProc, kGenJiffies, kRampJiffies);
+
+    const TUint decFactor = FlywheelRamper::DecimationFactor(kSampleRate);
+    const TUint blockSamples = FlywheelRamper::SampleCount(kSampleRate, FlywheelRamperManager::kMaxOutputJiffiesBlockSize);
+    TUint64 worstUs = 0;
+    const TUint64 startTime = Os::TimeInUs(iEnv.OsCtx());
+    for(TUint i=0; i<kIterations; i++)
+    {
+        const TUint64 rampStart = Os::TimeInUs(iEnv.OsCtx());
+        ramper->InitChannels(genSamples, kSampleRate, kChanCount);
+        ramper->RenderChannels(blockSamples, decFactor, kChanCount);
+        const TUint64 latency = Os::TimeInUs(iEnv.OsCtx()) - rampStart;
+        if (latency > worstUs)
+        {
+            worstUs = latency;
+        }
+    }
+    const TUint64 totalUs = Os::TimeInUs(iEnv.OsCtx()) - startTime;
+    TEST(rampOutput.Bytes() == blockByteCount);
+
+    Log::Print("ramp start latency (%u channels @ %uHz): mean = %lluus  worst = %lluus\n",
+               kChanCount, kSampleRate, totalUs/kIterations, worstUs);
+
+    delete ramper;
+}
+
 
 void SuiteFlywheelRamper::Setup()
 {
@@ -0,0 +1,153 @@
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Media/Utils/GainApplicator.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Private/Printer.h>
+
+#include <string.h>
+#include <vector>
+#include <cstdint>
+
+using namespace OpenHome;
+using namespace OpenHome::TestFramework;
+using namespace OpenHome::Media;
+
+namespace OpenHome {
+namespace Media {
+
+class SuiteGainApplicator : public Suite
+{
+    static const TUint kMaxSubsamples = 257; // not a multiple of any vector width
+public:
+    SuiteGainApplicator();
+    void Test() override;
+private:
+    void TestFromAttenuation();
+    void TestPacked(TUint aBitDepth, TUint aGain);
+    void TestNative32(TUint aGain);
+    static TInt32 ReadSubsample(const TByte* aPtr, TUint aBytes);
+private:
+    std::vector<TByte> iSrc;
+    std::vector<TByte> iDest;
+    std::vector<TInt32> iSrcNative;
+    std::vector<TInt32> iDestNative;
+};
+
+} // namespace Media
+} // namespace OpenHome
+
+
+// SuiteGainApplicator
+
+SuiteGainApplicator::SuiteGainApplicator()
+    : Suite("GainApplicator tests")
+    , iSrc(kMaxSubsamples * 4)
+    , iDest(kMaxSubsamples * 4)
+    , iSrcNative(kMaxSubsamples)
+    , iDestNative(kMaxSubsamples)
+{
+    for (TUint i=0; i<iSrc.size(); i++) {
+        iSrc[i] = (TByte)(i * 73 + 5);
+    }
+    // include full scale values at both ends of the range
+    iSrc[0] = iSrc[1] = iSrc[2] = iSrc[3] = 0x7f;
+    iSrc[4] = 0x80;
+    iSrc[5] = iSrc[6] = iSrc[7] = 0;
+    for (TUint i=0; i<iSrcNative.size(); i++) {
+        iSrcNative[i] = (TInt32)(i * 2654435761u);
+    }
+    iSrcNative[0] = INT32_MAX;
+    iSrcNative[1] = INT32_MIN;
+}
+
+void SuiteGainApplicator::Test()
+{
+    TestFromAttenuation();
+    const TUint kGains[] = { 0, 1, 0x4000, 0x7fff, 0x8000, 0x8001, 0xc123, 0xffff, GainApplicator::kUnity };
+    const TUint kBitDepths[] = { 8, 16, 24, 32 };
+    for (auto gain : kGains) {
+        for (auto bitDepth : kBitDepths) {
+            TestPacked(bitDepth, gain);
+        }
+        TestNative32(gain);
+    }
+}
+
+void SuiteGainApplicator::TestFromAttenuation()
+{
+    TEST(GainApplicator::FromAttenuation(256, 256) == GainApplicator::kUnity);
+    TEST(GainApplicator::FromAttenuation(0, 256) == 0);
+    TEST(GainApplicator::FromAttenuation(64, 256) == GainApplicator::kUnity / 4);
+    TEST(GainApplicator::FromAttenuation(300, 256) == GainApplicator::kUnity);
+}
+
+void SuiteGainApplicator::TestPacked(TUint aBitDepth, TUint aGain)
+{
+    const TUint bytesPerSubsample = aBitDepth / 8;
+    TBool ok = true;
+    for (TUint numSubsamples=0; numSubsamples<=kMaxSubsamples && ok; numSubsamples++) {
+        const TUint bytes = numSubsamples * bytesPerSubsample;
+        (void)memset(&iDest[0], 0xa5, iDest.size());
+        GainApplicator::Apply(&iSrc[0], &iDest[0], bytes, aBitDepth, aGain);
+        for (TUint i=0; i<bytes; i+=bytesPerSubsample) {
+            const TInt64 subsample = ReadSubsample(&iSrc[i], bytesPerSubsample);
+            const TInt32 expected = (TInt32)((subsample * aGain) >> GainApplicator::kGainShift);
+            ok = ok && (ReadSubsample(&iDest[i], bytesPerSubsample) == expected);
+        }
+        for (TUint i=bytes; i<iDest.size(); i++) {
+            ok = ok && (iDest[i] == 0xa5);
+        }
+        if (!ok) {
+            Print("Mismatch: %u-bit, gain=%05x, subsamples=%u\n", aBitDepth, aGain, numSubsamples);
+        }
+    }
+    TEST(ok);
+
+    // in place
+    const TUint bytes = kMaxSubsamples * bytesPerSubsample;
+    std::vector<TByte> expected(bytes);
+    GainApplicator::Apply(&iSrc[0], &expected[0], bytes, aBitDepth, aGain);
+    (void)memcpy(&iDest[0], &iSrc[0], bytes);
+    GainApplicator::Apply(&iDest[0], &iDest[0], bytes, aBitDepth, aGain);
+    TEST(memcmp(&iDest[0], &expected[0], bytes) == 0);
+}
+
+void SuiteGainApplicator::TestNative32(TUint aGain)
+{
+    TBool ok = true;
+    for (TUint numSubsamples=0; numSubsamples<=kMaxSubsamples && ok; numSubsamples++) {
+        for (TUint i=0; i<iDestNative.size(); i++) {
+            iDestNative[i] = 0x5a5a5a5a;
+        }
+        GainApplicator::ApplyNative32(&iSrcNative[0], &iDestNative[0], numSubsamples, aGain);
+        for (TUint i=0; i<numSubsamples; i++) {
+            const TInt32 expected = (TInt32)(((TInt64)iSrcNative[i] * aGain) >> GainApplicator::kGainShift);
+            ok = ok && (iDestNative[i] == expected);
+        }
+        for (TUint i=numSubsamples; i<iDestNative.size(); i++) {
+            ok = ok && (iDestNative[i] == 0x5a5a5a5a);
+        }
+        if (!ok) {
+            Print("Mismatch: native, gain=%05x, subsamples=%u\n", aGain, numSubsamples);
+        }
+    }
+    TEST(ok);
+}
+
+TInt32 SuiteGainApplicator::ReadSubsample(const TByte* aPtr, TUint aBytes)
+{ // static
+    TUint32 val = 0;
+    for (TUint i=0; i<aBytes; i++) {
+        val = (val << 8) | aPtr[i];
+    }
+    const TUint shift = 32 - (aBytes * 8);
+    return ((TInt32)(val << shift)) >> shift;
+}
+
+
+
+void TestGainApplicator()
+{
+    Runner runner("GainApplicator tests\n");
+    runner.Add(new SuiteGainApplicator());
+    runner.Run();
+}
@@ -3,9 +3,14 @@
 #include <OpenHome/Media/Pipeline/RampArray.h>
 #include <OpenHome/Media/Utils/AllocatorInfoLogger.h>
 #include <OpenHome/Media/Utils/ProcessorPcmUtils.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Private/Stream.h>
 
 #include <string.h>
 #include <vector>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
 
 using namespace OpenHome;
 using namespace OpenHome::TestFramework;
@@ -14,14 +19,42 @@ using namespace OpenHome::Media;
 namespace OpenHome {
 namespace Media {
 
+class TestCell;
+
 class SuiteAllocator : public Suite
 {
 public:
-    SuiteAllocator();
+    SuiteAllocator(const TChar* aName, AllocatorBase::Impl aImpl, AllocatorBase::Storage aStorage);
     void Test() override;
+private:
+    void StressThread();
 private:
     static const TUint kNumTestCells = 10;
+    static const TUint kNumStressThreads = 4;
+    static const TUint kNumStressIterations = 10000;
+    AllocatorInfoLogger iInfoAggregator;
+    const AllocatorBase::Impl iImpl;
+    const AllocatorBase::Storage iStorage;
+    Allocator<TestCell>* iAllocator;
+    std::atomic<TUint> iStressThreadId;
+    Semaphore iStressComplete;
+};
+
+class SuiteAllocatorElastic : public Suite
+{
+public:
+    SuiteAllocatorElastic();
+    void Test() override;
+private:
+    void FreeThread();
+private:
+    static const TUint kNumTestCells = 12;
+    static const TUint kNumChunks = 3;
+    static const TUint kShrinkAfterMs = 20;
+    static const TUint kFullTimeoutMs = 100;
+    static const TUint kFreeDelayMs = 10;
     AllocatorInfoLogger iInfoAggregator;
+    TestCell* iCellToFree;
 };
 
 class TestCell : public Allocated
@@ -73,6 +106,59 @@ private:
     AllocatorInfoLogger iInfoAggregator;
 };
 
+class SuiteAudioDataSizeClasses : public Suite
+{
+    static const TUint kMsgCount = 8;
+public:
+    SuiteAudioDataSizeClasses(const TChar* aName, AllocatorBase::Impl aImpl, AllocatorBase::Storage aStorage);
+    ~SuiteAudioDataSizeClasses();
+    void Test() override;
+private:
+    MsgFactory* iMsgFactory;
+    AllocatorInfoLogger iInfoAggregator;
+};
+
+class ProcessorNative32Test : public ProcessorPcmBufTest
+{
+public:
+    ProcessorNative32Test();
+    const TInt32* Samples() const;
+    TUint NumSubsamples() const;
+    TUint BitDepth() const;
+private: // from IPcmProcessor
+    void ProcessFragmentNative32(const Brx& aData, TUint aNumChannels, TUint aBitDepth) override;
+private:
+    TUint iBitDepth;
+};
+
+class SuiteDecodedAudioNative : public Suite
+{
+    static const TUint kMsgCount = 8;
+    static const TUint kSampleRate = 44100;
+    static const TUint kNumChannels = 2;
+    static const TUint kDataBytes = 960; // whole number of samples at all bit depths
+public:
+    SuiteDecodedAudioNative();
+    ~SuiteDecodedAudioNative();
+    void Test() override;
+private:
+    void TestBitDepth(TUint aBitDepth, AudioDataEndian aEndian);
+    void TestNativeProcessor();
+    void TestRampMatchesPacked();
+    void TestAttenuation();
+    void TestEncodedAudio();
+    void TestAnimatorBuffer();
+    void ReadPacked(MsgFactory& aFactory, TUint aBitDepth, AudioDataEndian aEndian, Bwx& aResult);
+    static Brn Read(MsgAudioPcm* aMsg, ProcessorPcmBufTest& aProcessor);
+private:
+    MsgFactory* iFactoryPacked;
+    MsgFactory* iFactoryNative;
+    AllocatorInfoLogger iInfoAggregator;
+    Bws<kDataBytes> iData;
+    Bws<kDataBytes> iExpected;
+    Bws<kDataBytes> iActual;
+};
+
 class SuiteMsgPlayable : public Suite
 {
     static const TUint kMsgCount = 2;
@@ -87,6 +173,18 @@ private:
     AllocatorInfoLogger iInfoAggregator;
 };
 
+class SuiteLatencyTracer : public Suite
+{
+    static const TUint kMsgCount = 4;
+public:
+    SuiteLatencyTracer();
+    ~SuiteLatencyTracer();
+    void Test() override;
+private:
+    MsgFactory* iMsgFactory;
+    AllocatorInfoLogger iInfoAggregator;
+};
+
 class SuiteRamp : public Suite
 {
     static const TUint kMsgCount = 8;
@@ -94,6 +192,9 @@ public:
     SuiteRamp();
     ~SuiteRamp();
     void Test() override;
+private:
+    void TestBlockApply(TUint aBitDepth, TUint aNumChannels);
+    static TInt32 ReadSubsample(const TByte* aPtr, TUint aBytes);
 private:
     MsgFactory* iMsgFactory;
     AllocatorInfoLogger iInfoAggregator;
@@ -287,6 +388,28 @@ private:
     AllocatorInfoLogger iInfoAggregator;
 };
 
+class SuiteMsgRing : public Suite
+{
+    static const TUint kRingCapacity = 4;
+    static const TUint kStressMsgs = 20000;
+public:
+    SuiteMsgRing();
+    ~SuiteMsgRing();
+    void Test() override;
+private:
+    void TestFifo();
+    void TestOverflow();
+    void TestEnqueueAtHead();
+    void TestTwoThreads();
+    void Producer();
+    void EnqueueHalts(MsgRing& aRing, TUint aFirstId, TUint aCount);
+    TBool DequeueHalts(MsgRing& aRing, TUint aFirstId, TUint aCount);
+private:
+    MsgFactory* iMsgFactory;
+    AllocatorInfoLogger iInfoAggregator;
+    MsgRing* iStressRing;
+};
+
 class SuiteMsgReservoir : public Suite
 {
     static const TUint kMsgCount = 8;
@@ -420,15 +543,20 @@ void TestCell::CheckIsFilled(TChar aVal) const
 
 // SuiteAllocator
 
-SuiteAllocator::SuiteAllocator()
-    : Suite("Allocator tests")
+SuiteAllocator::SuiteAllocator(const TChar* aName, AllocatorBase::Impl aImpl, AllocatorBase::Storage aStorage)
+    : Suite(aName)
+    , iImpl(aImpl)
+    , iStorage(aStorage)
+    , iAllocator(nullptr)
+    , iStressThreadId(0)
+    , iStressComplete("SASC", 0)
 {
 }
 
 void SuiteAllocator::Test()
 {
     //Print("\nCreate Allocator with 10 TestCells.  Check that 10 TestCells can be allocated\n");
-    Allocator<TestCell>* allocator = new Allocator<TestCell>("TestCell", kNumTestCells, iInfoAggregator);
+    Allocator<TestCell>* allocator = new Allocator<TestCell>("TestCell", kNumTestCells, iInfoAggregator, iImpl, iStorage);
     TestCell* cells[kNumTestCells];
     for (TUint i=0; i<kNumTestCells; i++) {
         cells[i] = allocator->Allocate();
@@ -449,6 +577,18 @@ void SuiteAllocator::Test()
     for (TUint i=0; i<kNumTestCells; i++) {
         cells[i]->CheckIsFilled((TByte)i);
     }
+
+    if (iStorage != AllocatorBase::Storage::eHeap) {
+        //Print("\nslab storage.  Check all TestCells start on a cache line and lie in a single block\n");
+        TByte* lowest = (TByte*)cells[0];
+        TByte* highest = (TByte*)cells[0];
+        for (TUint i=0; i<kNumTestCells; i++) {
+            TEST(((uintptr_t)cells[i] % 64) == 0);
+            lowest = std::min(lowest, (TByte*)cells[i]);
+            highest = std::max(highest, (TByte*)cells[i]);
+        }
+        TEST((TUint)(highest - lowest) == (kNumTestCells - 1) * 64);
+    }
     
     //Print("\nfree all TestCells.  Check values of iTestCellsUsed and iTestCellsUsedMax\n");
     TEST(allocator->CellsUsed() == kNumTestCells);
@@ -481,6 +621,116 @@ void SuiteAllocator::Test()
         allocator->Free(cells[i]);
     }
     delete allocator;
+
+    //Print("\nAllocate and free from several threads at once.  Check no cell is handed out twice\n");
+    iAllocator = new Allocator<TestCell>("TestCell", kNumStressThreads, iInfoAggregator, iImpl, iStorage);
+    std::vector<ThreadFunctor*> threads;
+    for (TUint i=0; i<kNumStressThreads; i++) {
+        threads.push_back(new ThreadFunctor("AllocStress", MakeFunctor(*this, &SuiteAllocator::StressThread)));
+    }
+    for (auto thread : threads) {
+        thread->Start();
+    }
+    for (TUint i=0; i<kNumStressThreads; i++) {
+        iStressComplete.Wait();
+    }
+    for (auto thread : threads) {
+        delete thread;
+    }
+    TEST(iAllocator->CellsUsed() == 0);
+    TEST(iAllocator->CellsUsedMax() <= kNumStressThreads);
+    delete iAllocator;
+    iAllocator = nullptr;
+}
+
+void SuiteAllocator::StressThread()
+{
+    const TChar val = (TChar)(++iStressThreadId);
+    for (TUint i=0; i<kNumStressIterations; i++) {
+        TestCell* cell = iAllocator->Allocate();
+        cell->Fill(val);
+        cell->CheckIsFilled(val);
+        cell->RemoveRef();
+    }
+    iStressComplete.Signal();
+}
+
+
+// SuiteAllocatorElastic
+
+SuiteAllocatorElastic::SuiteAllocatorElastic()
+    : Suite("Elastic allocator tests")
+    , iCellToFree(nullptr)
+{
+}
+
+void SuiteAllocatorElastic::Test()
+{
+    static const TUint kChunkCells = kNumTestCells / kNumChunks;
+    const AllocatorGrowth growth(kNumChunks, kShrinkAfterMs, kFullTimeoutMs);
+    Allocator<TestCell>* allocator = new Allocator<TestCell>("TestCell", kNumTestCells, iInfoAggregator,
+                                                             AllocatorBase::Impl::eLocking, AllocatorBase::Storage::eHeap, growth);
+
+    // only a single chunk is created up front
+    TEST(allocator->CellsTotal() == kNumTestCells);
+    TEST(allocator->CellsCreated() == kChunkCells);
+
+    // allocating beyond the first chunk grows the pool a chunk at a time
+    std::vector<TestCell*> cells;
+    for (TUint i=0; i<kChunkCells; i++) {
+        cells.push_back(allocator->Allocate());
+    }
+    TEST(allocator->CellsCreated() == kChunkCells);
+    cells.push_back(allocator->Allocate());
+    TEST(allocator->CellsCreated() == 2 * kChunkCells);
+    while (cells.size() < kNumTestCells) {
+        cells.push_back(allocator->Allocate());
+    }
+    TEST(allocator->CellsCreated() == kNumTestCells);
+    TEST(allocator->CellsUsed() == kNumTestCells);
+    iInfoAggregator.PrintStats();
+
+    // a full pool waits for a cell to be freed...
+    iCellToFree = cells.back();
+    cells.pop_back();
+    ThreadFunctor* freer = new ThreadFunctor("AllocFree", MakeFunctor(*this, &SuiteAllocatorElastic::FreeThread));
+    freer->Start();
+    cells.push_back(allocator->Allocate());
+    delete freer;
+    TEST(allocator->CellsUsed() == kNumTestCells);
+    // ...then throws if none is freed before its timeout
+    TEST_THROWS(allocator->Allocate(), AllocatorNoMemory);
+    TEST(allocator->CellsUsed() == kNumTestCells);
+
+    // free all cells then keep usage low.  Pool shrinks back to a single chunk, one chunk per quiet period
+    for (auto cell : cells) {
+        cell->RemoveRef();
+    }
+    cells.clear();
+    TEST(allocator->CellsUsed() == 0);
+    allocator->Allocate()->RemoveRef();
+    TEST(allocator->CellsCreated() == kNumTestCells); // chunks are only released after a quiet period
+    TUint periods = 0;
+    while (allocator->CellsCreated() > kChunkCells && periods < 4 * kNumChunks) {
+        Thread::Sleep(kShrinkAfterMs);
+        allocator->Allocate()->RemoveRef();
+        periods++;
+    }
+    TEST(allocator->CellsCreated() == kChunkCells);
+    TEST(periods == kNumChunks - 1);
+    Thread::Sleep(kShrinkAfterMs);
+    allocator->Allocate()->RemoveRef();
+    TEST(allocator->CellsCreated() == kChunkCells);
+    TEST(allocator->CellsUsedMax() == kNumTestCells);
+    iInfoAggregator.PrintStats();
+
+    delete allocator;
+}
+
+void SuiteAllocatorElastic::FreeThread()
+{
+    Thread::Sleep(kFreeDelayMs);
+    iCellToFree->RemoveRef();
 }
 
 
@@ -1002,6 +1252,344 @@ void SuiteMsgAudio::Test()
 }
 
 
+// SuiteAudioDataSizeClasses
+
+SuiteAudioDataSizeClasses::SuiteAudioDataSizeClasses(const TChar* aName, AllocatorBase::Impl aImpl, AllocatorBase::Storage aStorage)
+    : Suite(aName)
+{
+    MsgFactoryInitParams init;
+    init.SetMsgAudioPcmCount(kMsgCount, kMsgCount);
+    init.SetAllocatorImpl(aImpl);
+    init.SetAllocatorStorage(aStorage);
+    init.SetAudioDataSizeClasses(true);
+    iMsgFactory = new MsgFactory(iInfoAggregator, init);
+}
+
+SuiteAudioDataSizeClasses::~SuiteAudioDataSizeClasses()
+{
+    delete iMsgFactory;
+}
+
+void SuiteAudioDataSizeClasses::Test()
+{
+    // Aggregate msgs whose combined size crosses each size class boundary.
+    // Check all audio survives being moved to larger classes.
+    static const TUint kFragmentBytes = 800;
+    static const TUint kNumFragments = AudioData::kMaxBytes / kFragmentBytes;
+    static const TUint kJiffiesPerFragment = (kFragmentBytes / 2) * Jiffies::PerSample(44100);
+    Bwh data(kFragmentBytes, kFragmentBytes);
+    data.SetBytes(kFragmentBytes);
+    (void)memset((void*)data.Ptr(), 1, data.Bytes());
+    MsgAudioPcm* msg = iMsgFactory->CreateMsgAudioPcm(data, 2, 44100, 8, AudioDataEndian::Little, 0);
+    for (TUint i=1; i<kNumFragments; i++) {
+        (void)memset((void*)data.Ptr(), i+1, data.Bytes());
+        MsgAudioPcm* next = iMsgFactory->CreateMsgAudioPcm(data, 2, 44100, 8, AudioDataEndian::Little, i * kJiffiesPerFragment);
+        msg->Aggregate(next);
+        TEST(msg->Jiffies() == (i+1) * kJiffiesPerFragment);
+    }
+    iInfoAggregator.PrintStats();
+
+    MsgPlayable* playable = msg->CreatePlayable();
+    TEST(playable->Bytes() == kNumFragments * kFragmentBytes);
+    ProcessorPcmBufTest pcmProcessor;
+    playable->Read(pcmProcessor);
+    playable->RemoveRef();
+    const TByte* ptr = pcmProcessor.Ptr();
+    for (TUint i=0; i<kNumFragments; i++) {
+        for (TUint j=0; j<kFragmentBytes; j++) {
+            TEST(*ptr++ == (TByte)(i+1));
+        }
+    }
+
+    // encoded audio is appended to so always has the full capacity
+    MsgAudioEncoded* encoded = iMsgFactory->CreateMsgAudioEncoded(Brn(data.Ptr(), 10));
+    TEST(encoded->Append(Brn(data.Ptr(), kFragmentBytes)) == kFragmentBytes);
+    TEST(encoded->Bytes() == kFragmentBytes + 10);
+    encoded->RemoveRef();
+
+    // msgs are allocated from the smallest class that will hold them, up to DecodedAudio::kMaxBytes
+    Bwh big(DecodedAudio::kMaxBytes);
+    big.SetBytes(big.MaxBytes());
+    msg = iMsgFactory->CreateMsgAudioPcm(big, 2, 44100, 8, AudioDataEndian::Little, 0);
+    TEST(msg->Jiffies() == (DecodedAudio::kMaxBytes / 2) * Jiffies::PerSample(44100));
+    msg->RemoveRef();
+
+    // smaller classes only hold a share of the cells; once full, msgs fall through to larger classes
+    MsgAudioPcm* msgs[kMsgCount];
+    for (TUint i=0; i<kMsgCount; i++) {
+        msgs[i] = iMsgFactory->CreateMsgAudioPcm(Brn(data.Ptr(), 8), 2, 44100, 8, AudioDataEndian::Little, 0);
+        TEST(msgs[i]->Jiffies() == 4 * Jiffies::PerSample(44100));
+    }
+    iInfoAggregator.PrintStats();
+    for (TUint i=0; i<kMsgCount; i++) {
+        msgs[i]->RemoveRef();
+    }
+}
+
+
+// ProcessorNative32Test
+
+ProcessorNative32Test::ProcessorNative32Test()
+    : iBitDepth(0)
+{
+}
+
+const TInt32* ProcessorNative32Test::Samples() const
+{
+    return reinterpret_cast<const TInt32*>(Ptr());
+}
+
+TUint ProcessorNative32Test::NumSubsamples() const
+{
+    return Buf().Bytes() / DecodedAudio::kNativeBytesPerSubsample;
+}
+
+TUint ProcessorNative32Test::BitDepth() const
+{
+    return iBitDepth;
+}
+
+void ProcessorNative32Test::ProcessFragmentNative32(const Brx& aData, TUint /*aNumChannels*/, TUint aBitDepth)
+{
+    iBitDepth = aBitDepth;
+    ProcessFragment(aData);
+}
+
+
+// SuiteDecodedAudioNative
+
+SuiteDecodedAudioNative::SuiteDecodedAudioNative()
+    : Suite("DecodedAudio native format tests")
+{
+    MsgFactoryInitParams init;
+    init.SetMsgAudioPcmCount(kMsgCount, kMsgCount);
+    init.SetMsgAudioEncodedCount(kMsgCount, kMsgCount);
+    init.SetMsgPlayableCount(kMsgCount, kMsgCount);
+    iFactoryPacked = new MsgFactory(iInfoAggregator, init);
+    init.SetDecodedAudioFormat(DecodedAudioFormat::NativeInt32);
+    iFactoryNative = new MsgFactory(iInfoAggregator, init);
+
+    for (TUint i=0; i<kDataBytes; i++) {
+        iData.Append((TByte)(i * 13 + 7));
+    }
+}
+
+SuiteDecodedAudioNative::~SuiteDecodedAudioNative()
+{
+    delete iFactoryPacked;
+    delete iFactoryNative;
+}
+
+void SuiteDecodedAudioNative::Test()
+{
+    TEST(iFactoryPacked->DecodedFormat() == DecodedAudioFormat::Packed);
+    TEST(iFactoryNative->DecodedFormat() == DecodedAudioFormat::NativeInt32);
+    static const TUint kBitDepths[] = { 8, 16, 24, 32 };
+    for (auto bitDepth : kBitDepths) {
+        TestBitDepth(bitDepth, AudioDataEndian::Big);
+        TestBitDepth(bitDepth, AudioDataEndian::Little);
+    }
+    TestNativeProcessor();
+    TestRampMatchesPacked();
+    TestAttenuation();
+    TestEncodedAudio();
+    TestAnimatorBuffer();
+}
+
+void SuiteDecodedAudioNative::TestBitDepth(TUint aBitDepth, AudioDataEndian aEndian)
+{
+    // processors that don't override ProcessFragmentNative32 see the same packed data as before
+    ReadPacked(*iFactoryPacked, aBitDepth, aEndian, iExpected);
+    ReadPacked(*iFactoryNative, aBitDepth, aEndian, iActual);
+    TEST(iActual == iExpected);
+
+    // splitting msgs and their playables counts jiffies/bytes of packed audio in both formats
+    MsgAudioPcm* msg = iFactoryNative->CreateMsgAudioPcm(iData, kNumChannels, kSampleRate, aBitDepth, aEndian, 0);
+    const TUint numSamples = kDataBytes / (kNumChannels * (aBitDepth/8));
+    TEST(msg->Jiffies() == numSamples * Jiffies::PerSample(kSampleRate));
+    MsgAudio* remaining = msg->Split(3 * Jiffies::PerSample(kSampleRate));
+    MsgPlayable* playable = msg->CreatePlayable();
+    playable->Add(static_cast<MsgAudioPcm*>(remaining)->CreatePlayable());
+    TEST(playable->Bytes() == kDataBytes);
+    MsgPlayable* playableRemaining = playable->Split(5 * kNumChannels * (aBitDepth/8));
+    playable->Add(playableRemaining);
+    ProcessorPcmBufTest processor;
+    playable->Read(processor);
+    playable->RemoveRef();
+    TEST(processor.Buf() == iExpected);
+}
+
+void SuiteDecodedAudioNative::TestNativeProcessor()
+{
+    static const TByte kData[] = { 0x12, 0x34, 0x56, 0xfe, 0xdc, 0xba, 0x80, 0x00, 0x01, 0x7f, 0xff, 0xff };
+    Brn data(kData, sizeof(kData));
+
+    ProcessorNative32Test processor;
+    MsgAudioPcm* msg = iFactoryNative->CreateMsgAudioPcm(data, kNumChannels, kSampleRate, 24, AudioDataEndian::Big, 0);
+    (void)Read(msg, processor);
+    TEST(processor.BitDepth() == 24);
+    TEST(processor.NumSubsamples() == 4);
+    const TInt32* samples = processor.Samples();
+    TEST(samples[0] == 0x12345600);
+    TEST(samples[1] == (TInt32)0xfedcba00);
+    TEST(samples[2] == (TInt32)0x80000100);
+    TEST(samples[3] == 0x7fffff00);
+
+    ProcessorNative32Test processor16;
+    msg = iFactoryNative->CreateMsgAudioPcm(Brn(kData, 8), kNumChannels, kSampleRate, 16, AudioDataEndian::Little, 0);
+    (void)Read(msg, processor16);
+    TEST(processor16.BitDepth() == 16);
+    TEST(processor16.NumSubsamples() == 4);
+    samples = processor16.Samples();
+    TEST(samples[0] == 0x34120000);
+    TEST(samples[1] == (TInt32)0xfe560000);
+    TEST(samples[2] == (TInt32)0xbadc0000);
+    TEST(samples[3] == 0x00800000);
+
+    // packed msgs never use the native path
+    ProcessorNative32Test processorPacked;
+    msg = iFactoryPacked->CreateMsgAudioPcm(data, kNumChannels, kSampleRate, 24, AudioDataEndian::Big, 0);
+    (void)Read(msg, processorPacked);
+    TEST(processorPacked.BitDepth() == 0);
+    TEST(processorPacked.Buf() == data);
+}
+
+void SuiteDecodedAudioNative::TestRampMatchesPacked()
+{
+    // ramps are applied at full precision to both formats so results should match exactly at every bit depth
+    const TUint kBitDepths[] = { 8, 16, 24, 32 };
+    MsgFactory* factories[] = { iFactoryPacked, iFactoryNative };
+    for (auto bitDepth : kBitDepths) {
+        Bws<kDataBytes> results[2];
+        for (TUint i=0; i<2; i++) {
+            MsgAudioPcm* msg = factories[i]->CreateMsgAudioPcm(iData, kNumChannels, kSampleRate, bitDepth, AudioDataEndian::Big, 0);
+            TUint remainingDuration = msg->Jiffies();
+            MsgAudio* split = nullptr;
+            (void)msg->SetRamp(Ramp::kMax, remainingDuration, Ramp::EDown, split);
+            TEST(split == nullptr);
+            ProcessorPcmBufTest processor;
+            results[i].Replace(Read(msg, processor));
+        }
+        TEST(results[0].Bytes() == kDataBytes);
+        TEST(results[0] == results[1]);
+        TEST(results[1] != iData);
+    }
+}
+
+void SuiteDecodedAudioNative::TestAttenuation()
+{
+    static const TUint kAttenuation = MsgAudioPcm::kUnityAttenuation / 4;
+    const TUint kBitDepths[] = { 16, 24, 32 };
+    MsgFactory* factories[] = { iFactoryPacked, iFactoryNative };
+    for (auto factory : factories) {
+        for (auto bitDepth : kBitDepths) {
+            MsgAudioPcm* msg = factory->CreateMsgAudioPcm(iData, kNumChannels, kSampleRate, bitDepth, AudioDataEndian::Big, 0);
+            msg->SetAttenuation(kAttenuation);
+            ProcessorPcmBufTest processor;
+            const Brn attenuated = Read(msg, processor);
+            TEST(attenuated.Bytes() == kDataBytes);
+            const TUint bytesPerSubsample = bitDepth / 8;
+            const TUint shift = 32 - bitDepth;
+            TBool ok = true;
+            for (TUint i=0; i<kDataBytes; i+=bytesPerSubsample) {
+                TUint32 orig = 0;
+                TUint32 actual = 0;
+                for (TUint j=0; j<bytesPerSubsample; j++) {
+                    orig = (orig << 8) | iData[i+j];
+                    actual = (actual << 8) | attenuated[i+j];
+                }
+                const TInt64 origVal = ((TInt32)(orig << shift)) >> shift;
+                const TInt32 expected = (TInt32)((origVal * kAttenuation) >> 8); // rounds down
+                ok = ok && ((((TInt32)(actual << shift)) >> shift) == expected);
+            }
+            TEST(ok);
+        }
+    }
+}
+
+void SuiteDecodedAudioNative::TestEncodedAudio()
+{
+    // MsgAudioEncoded holding big endian pcm is converted rather than shared
+    MsgAudioEncoded* encoded = iFactoryNative->CreateMsgAudioEncoded(iData);
+    MsgAudioPcm* msg = iFactoryNative->CreateMsgAudioPcm(encoded, kNumChannels, kSampleRate, 24, 0);
+    encoded->RemoveRef();
+    TEST(msg->Format() == DecodedAudioFormat::NativeInt32);
+    ProcessorPcmBufTest processor;
+    TEST(Read(msg, processor) == iData);
+}
+
+void SuiteDecodedAudioNative::TestAnimatorBuffer()
+{
+    // audio written to a lent buffer matches the output of Read(IPcmProcessor&), converted to the buffer's format
+    static const TUint kMaxBytesPerSubsample = 4;
+    const TUint kBitDepths[] = { 8, 16, 24, 32 };
+    const AudioDataEndian kEndians[] = { AudioDataEndian::Big, AudioDataEndian::Little };
+    MsgFactory* factories[] = { iFactoryPacked, iFactoryNative };
+    TByte lent[2 * kDataBytes * kMaxBytesPerSubsample];
+    for (auto factory : factories) {
+        for (auto bitDepth : kBitDepths) {
+            const TUint srcBytes = bitDepth / 8;
+            const TUint numSamples = kDataBytes / (kNumChannels * srcBytes);
+            for (TUint destBytes=1; destBytes<=kMaxBytesPerSubsample; destBytes++) {
+                for (auto endian : kEndians) {
+                    // first msg is ramped and attenuated, second is passed through unchanged
+                    Bwh expected(2 * kDataBytes);
+                    AnimatorBuffer buffer(lent, 2 * numSamples, kNumChannels, destBytes, endian);
+                    for (TUint i=0; i<2; i++) {
+                        for (TUint j=0; j<2; j++) {
+                            MsgAudioPcm* msg = factory->CreateMsgAudioPcm(iData, kNumChannels, kSampleRate, bitDepth, AudioDataEndian::Big, 0);
+                            if (i == 0) {
+                                TUint remainingDuration = msg->Jiffies();
+                                MsgAudio* split = nullptr;
+                                (void)msg->SetRamp(Ramp::kMax, remainingDuration, Ramp::EDown, split);
+                                msg->SetAttenuation(MsgAudioPcm::kUnityAttenuation / 2);
+                            }
+                            if (j == 0) {
+                                ProcessorPcmBufTest processor;
+                                expected.Append(Read(msg, processor));
+                            }
+                            else {
+                                MsgPlayable* playable = msg->CreatePlayable();
+                                playable->Read(buffer);
+                                playable->RemoveRef();
+                            }
+                        }
+                    }
+                    TEST(buffer.SamplesWritten() == 2 * numSamples);
+                    TEST(buffer.SamplesFree() == 0);
+                    TEST(expected.Bytes() == 2 * kDataBytes);
+                    TBool ok = true;
+                    const TUint numSubsamples = expected.Bytes() / srcBytes;
+                    for (TUint i=0; i<numSubsamples; i++) {
+                        for (TUint j=0; j<destBytes; j++) {
+                            const TByte b = (j < srcBytes? expected[i*srcBytes + j] : 0);
+                            const TUint index = (endian == AudioDataEndian::Big? j : destBytes - 1 - j);
+                            ok = ok && (lent[i*destBytes + index] == b);
+                        }
+                    }
+                    TEST(ok);
+                }
+            }
+        }
+    }
+}
+
+void SuiteDecodedAudioNative::ReadPacked(MsgFactory& aFactory, TUint aBitDepth, AudioDataEndian aEndian, Bwx& aResult)
+{
+    ProcessorPcmBufTest processor;
+    MsgAudioPcm* msg = aFactory.CreateMsgAudioPcm(iData, kNumChannels, kSampleRate, aBitDepth, aEndian, 0);
+    aResult.Replace(Read(msg, processor));
+}
+
+Brn SuiteDecodedAudioNative::Read(MsgAudioPcm* aMsg, ProcessorPcmBufTest& aProcessor)
+{ // static
+    MsgPlayable* playable = aMsg->CreatePlayable();
+    playable->Read(aProcessor);
+    playable->RemoveRef();
+    return aProcessor.Buf();
+}
+
+
 // SuiteMsgPlayable
 
 SuiteMsgPlayable::SuiteMsgPlayable()
@@ -1288,6 +1876,113 @@ void SuiteMsgPlayable::ValidateSilence(MsgPlayable* aMsg)
 }
 
 
+// SuiteLatencyTracer
+
+SuiteLatencyTracer::SuiteLatencyTracer()
+    : Suite("LatencyTracer tests")
+{
+    MsgFactoryInitParams init;
+    init.SetMsgAudioEncodedCount(kMsgCount, kMsgCount);
+    init.SetMsgAudioPcmCount(kMsgCount, kMsgCount);
+    init.SetMsgPlayableCount(kMsgCount, kMsgCount);
+    iMsgFactory = new MsgFactory(iInfoAggregator, init);
+}
+
+SuiteLatencyTracer::~SuiteLatencyTracer()
+{
+    LatencyTracer::Disable();
+    LatencyTracer::Reset();
+    delete iMsgFactory;
+}
+
+void SuiteLatencyTracer::Test()
+{
+    static const TUint kDataSize = 256;
+    Bws<kDataSize> data(kDataSize);
+    for (TUint i=0; i<kDataSize; i++) {
+        data.At(i) = (TByte)i;
+    }
+    LatencyTracer::Disable();
+    LatencyTracer::Reset();
+
+    // nothing is traced while disabled
+    MsgAudioEncoded* encoded = iMsgFactory->CreateMsgAudioEncoded(data);
+    encoded->TryStartLatencyTrace();
+    TEST(!encoded->IsLatencyTraced());
+    encoded->RemoveRef();
+
+    // one msg in every SampleInterval() is traced
+    LatencyTracer::Enable(3);
+    TEST(LatencyTracer::SampleInterval() == 3);
+    TUint traced = 0;
+    for (TUint i=0; i<6; i++) {
+        encoded = iMsgFactory->CreateMsgAudioEncoded(data);
+        encoded->TryStartLatencyTrace();
+        if (encoded->IsLatencyTraced()) {
+            traced++;
+        }
+        encoded->RemoveRef();
+    }
+    TEST(traced == 2);
+
+    // trace passes from encoded to decoded audio and is recorded once it reaches the animator
+    LatencyTracer::Enable(1);
+    encoded = iMsgFactory->CreateMsgAudioEncoded(data);
+    encoded->TryStartLatencyTrace();
+    TEST(encoded->IsLatencyTraced());
+    encoded->AddLogPoint(LatencyPoint::eEncodedReservoir);
+    const LatencyTrace trace = encoded->GetLatencyTrace();
+    encoded->RemoveRef();
+    TEST(trace.Get(LatencyPoint::eProtocol) != 0);
+    TEST(trace.Get(LatencyPoint::eEncodedReservoir) >= trace.Get(LatencyPoint::eProtocol));
+    TEST(trace.Get(LatencyPoint::eCodec) == 0);
+
+    MsgAudioPcm* pcm = iMsgFactory->CreateMsgAudioPcm(data, 2, 44100, 16, AudioDataEndian::Little, 0);
+    pcm->SetLatencyTrace(trace);
+    pcm->AddLogPoint(LatencyPoint::eCodec);
+    pcm->AddLogPoint(LatencyPoint::eDecodedReservoir);
+    MsgAudioPcm* remaining = static_cast<MsgAudioPcm*>(pcm->Split(pcm->Jiffies() / 2));
+    pcm->AddLogPoint(LatencyPoint::eStarvationRamper);
+    pcm->AddLogPoint(LatencyPoint::ePreDriver);
+    MsgPlayable* playable = pcm->CreatePlayable();
+    for (TUint i=0; i<LatencyTracer::kNumHops; i++) {
+        TEST(LatencyTracer::HopCount(i) == 0);
+    }
+    playable->AddLogPoint(LatencyPoint::eAnimator);
+    playable->RemoveRef();
+    for (TUint i=0; i<LatencyTracer::kNumHops; i++) {
+        TEST(LatencyTracer::HopCount(i) == 1);
+    }
+
+    // the remainder of a split msg shares its trace; this is only recorded once
+    remaining->AddLogPoint(LatencyPoint::ePreDriver);
+    playable = remaining->CreatePlayable();
+    playable->AddLogPoint(LatencyPoint::eAnimator);
+    playable->RemoveRef();
+    TEST(LatencyTracer::HopCount(LatencyTracer::kNumHops-1) == 1);
+
+    // untraced msgs don't affect the histograms
+    pcm = iMsgFactory->CreateMsgAudioPcm(data, 2, 44100, 16, AudioDataEndian::Little, 0);
+    playable = pcm->CreatePlayable();
+    playable->AddLogPoint(LatencyPoint::eAnimator);
+    playable->RemoveRef();
+    TEST(LatencyTracer::HopCount(LatencyTracer::kNumHops-1) == 1);
+
+    Bws<4096> json;
+    WriterBuffer writer(json);
+    LatencyTracer::WriteJson(writer);
+    TEST(json.Bytes() > 0);
+    TEST(json[0] == '{');
+    TEST(json[json.Bytes()-1] == '}');
+
+    LatencyTracer::Reset();
+    for (TUint i=0; i<LatencyTracer::kNumHops; i++) {
+        TEST(LatencyTracer::HopCount(i) == 0);
+    }
+    LatencyTracer::Disable();
+}
+
+
 // SuiteRamp
 
 SuiteRamp::SuiteRamp()
@@ -1373,7 +2068,7 @@ void SuiteRamp::Test()
     TByte sample[DecodedAudio::kMaxNumChannels * 4];
     TUint numSamples = applicator.Start(audioBuf, 8, 2);
     for (TUint i=0; i<numSamples; i++) {
-        applicator.GetNextSample(sample);
+        TEST(applicator.Apply(sample, 1) == 1);
         sampleVal = sample[0];
         if (i==0) {
             TEST(sampleVal >= 0x7d); // test that start of ramp is close to initial value
@@ -1393,7 +2088,7 @@ void SuiteRamp::Test()
     prevSampleVal = 0xff;
     numSamples = applicator.Start(audioBufSigned, 8, 2);
     for (TUint i=0; i<numSamples; i++) {
-        applicator.GetNextSample(sample);
+        TEST(applicator.Apply(sample, 1) == 1);
         sampleVal = sample[0];
         if (i==0) {
             TEST(sampleVal >= 0xfd); // test that start of ramp is close to initial value
@@ -1411,7 +2106,7 @@ void SuiteRamp::Test()
     prevSampleVal = 0x7f7f;
     numSamples = applicator.Start(audioBuf, 16, 2);
     for (TUint i=0; i<numSamples; i++) {
-        applicator.GetNextSample(sample);
+        TEST(applicator.Apply(sample, 1) == 1);
         sampleVal = (sample[0]<<8) | sample[1];
         TEST(sampleVal == (TUint)(sample[2]<<8 | sample[3]));
         TEST(prevSampleVal >= sampleVal);
@@ -1424,7 +2119,7 @@ void SuiteRamp::Test()
     prevSampleVal = 0x7f7f7f;
     numSamples = applicator.Start(audioBuf, 24, 2);
     for (TUint i=0; i<numSamples; i++) {
-        applicator.GetNextSample(sample);
+        TEST(applicator.Apply(sample, 1) == 1);
         sampleVal = (sample[0]<<16) | (sample[1]<<8) | sample[2];
         TEST(sampleVal == (TUint)((sample[3]<<16) | (sample[4]<<8) | sample[5]));
         TEST(prevSampleVal >= sampleVal);
@@ -1437,7 +2132,7 @@ void SuiteRamp::Test()
     prevSampleVal = 0x7f7f7f7f;
     numSamples = applicator.Start(audioBuf, 32, 2);
     for (TUint i=0; i<numSamples; i++) {
-        applicator.GetNextSample(sample);
+        TEST(applicator.Apply(sample, 1) == 1);
         sampleVal = (sample[0]<<24) | (sample[1]<<16) | (sample[2]<<8) | (sample[3]);
         TEST(sampleVal == (TUint)((sample[4]<<24) | (sample[5]<<16) | (sample[6]<<8) | (sample[7])));
         TEST(prevSampleVal >= sampleVal);
@@ -1450,7 +2145,7 @@ void SuiteRamp::Test()
     prevSampleVal = 0;
     numSamples = applicator.Start(audioBuf, 8, 2);
     for (TUint i=0; i<numSamples; i++) {
-        applicator.GetNextSample(sample);
+        TEST(applicator.Apply(sample, 1) == 1);
         sampleVal = sample[0];
         if (i==0) {
             TEST(sampleVal <= 0x02); // test that start of ramp is close to zero
@@ -1467,7 +2162,7 @@ void SuiteRamp::Test()
     prevSampleVal = 0;
     numSamples = applicator.Start(audioBuf, 8, 2);
     for (TUint i=0; i<numSamples; i++) {
-        applicator.GetNextSample(sample);
+        TEST(applicator.Apply(sample, 1) == 1);
         sampleVal = sample[0];
         if (i==0) {
             TEST(sampleVal >= 0x7d); // test that start of ramp is close to max
@@ -1482,7 +2177,7 @@ void SuiteRamp::Test()
     prevSampleVal = 0;
     numSamples = applicator.Start(audioBuf, 8, 2);
     for (TUint i=0; i<numSamples; i++) {
-        applicator.GetNextSample(sample);
+        TEST(applicator.Apply(sample, 1) == 1);
         sampleVal = sample[0];
         if (i==0) {
             TEST(sampleVal <= 0x02); // test that start of ramp is close to zero
@@ -1497,7 +2192,7 @@ void SuiteRamp::Test()
     prevSampleVal = 0;
     numSamples = applicator.Start(audioBuf, 8, 2);
     for (TUint i=0; i<numSamples; i++) {
-        applicator.GetNextSample(sample);
+        TEST(applicator.Apply(sample, 1) == 1);
         sampleVal = sample[0];
         if (i==0) {
             TUint startValGuess = (((TUint64)0x7f * kRampArray[256])>>15);
@@ -1661,6 +2356,155 @@ void SuiteRamp::Test()
     for (TUint i=0; i<bytes; i++) {
         TEST(*ptr++ == 0);
     }
+
+    // Ramp up that ends part way through a msg.  Msg isn't split; audio after the ramp is unramped
+    audioPcm = iMsgFactory->CreateMsgAudioPcm(encodedAudio, kNumChannels, 44100, 16, AudioDataEndian::Little, 0);
+    jiffies = audioPcm->Jiffies();
+    const TUint rampJiffies = jiffies / 4;
+    remainingDuration = rampJiffies;
+    TEST(Ramp::kMax == audioPcm->SetRamp(Ramp::kMin, remainingDuration, Ramp::EUp, remaining));
+    TEST(remaining == nullptr);
+    TEST(remainingDuration == 0);
+    TEST(audioPcm->Jiffies() == jiffies);
+    TEST(audioPcm->RampJiffies() == rampJiffies);
+    playable = static_cast<MsgAudioPcm*>(audioPcm->Clone())->CreatePlayable();
+    playable->Read(pcmProcessor);
+    playable->RemoveRef();
+    ptr = pcmProcessor.Ptr();
+    bytes = pcmProcessor.Buf().Bytes();
+    TEST(bytes == kEncodedAudioSize);
+    TEST(((ptr[0]<<8) | ptr[1]) == 0);
+    prevSampleVal = 0;
+    for (TUint i=0; i<bytes; i+=4) {
+        sampleVal = (TUint)((ptr[i]<<8) | ptr[i+1]);
+        TEST(sampleVal == (TUint)((ptr[i+2]<<8) | ptr[i+3]));
+        if (i < kEncodedAudioSize / 4) {
+            TEST(prevSampleVal <= sampleVal);
+        }
+        else {
+            TEST(sampleVal == 0x7f7f);
+        }
+        prevSampleVal = sampleVal;
+    }
+    // ...splitting within the ramp leaves the rest of the ramp at the start of the remainder
+    remaining = audioPcm->Split(rampJiffies / 2);
+    TEST(audioPcm->RampJiffies() == rampJiffies / 2);
+    TEST(remaining->RampJiffies() == rampJiffies - rampJiffies / 2);
+    TEST(remaining->Ramp().Start() == audioPcm->Ramp().End());
+    TEST(remaining->Ramp().End() == Ramp::kMax);
+    // ...splitting at the end of the ramp leaves the remainder unramped
+    MsgAudio* unramped = remaining->Split(remaining->RampJiffies());
+    TEST(remaining->RampJiffies() == remaining->Jiffies());
+    TEST(!unramped->Ramp().IsEnabled());
+    audioPcm->RemoveRef();
+    remaining->RemoveRef();
+    unramped->RemoveRef();
+
+    // Ramp down that ends part way through a msg.  Audio after the ramp is split off
+    audioPcm = iMsgFactory->CreateMsgAudioPcm(encodedAudio, kNumChannels, 44100, 16, AudioDataEndian::Little, 0);
+    remainingDuration = rampJiffies;
+    TEST(Ramp::kMin == audioPcm->SetRamp(Ramp::kMax, remainingDuration, Ramp::EDown, remaining));
+    TEST(remaining != nullptr);
+    TEST(remainingDuration == 0);
+    TEST(audioPcm->Jiffies() == rampJiffies);
+    TEST(audioPcm->RampJiffies() == rampJiffies);
+    TEST(remaining->Jiffies() == jiffies - rampJiffies);
+    TEST(!remaining->Ramp().IsEnabled());
+    audioPcm->RemoveRef();
+    remaining->RemoveRef();
+
+    // ...as is audio after a ramp applied to a msg that is already ramped
+    audioPcm = iMsgFactory->CreateMsgAudioPcm(encodedAudio, kNumChannels, 44100, 16, AudioDataEndian::Little, 0);
+    remainingDuration = 2 * jiffies;
+    (void)audioPcm->SetRamp(Ramp::kMax, remainingDuration, Ramp::EDown, remaining);
+    TEST(remaining == nullptr);
+    const TUint existingEnd = audioPcm->Ramp().End();
+    remainingDuration = rampJiffies;
+    (void)audioPcm->SetRamp(Ramp::kMin, remainingDuration, Ramp::EUp, remaining);
+    TEST(remaining != nullptr);
+    TEST(audioPcm->Jiffies() == rampJiffies);
+    TEST(remaining->Jiffies() == jiffies - rampJiffies);
+    TEST(remaining->Ramp().Direction() == Ramp::EDown);
+    TEST(remaining->Ramp().End() == existingEnd);
+    // ...and the intersecting ramps over the first part are joined into one that's never louder than either
+    TEST(audioPcm->Ramp().Direction() == Ramp::EUp);
+    TEST(audioPcm->Ramp().Start() == Ramp::kMin);
+    TEST(audioPcm->Ramp().End() <= remaining->Ramp().Start());
+    audioPcm->RemoveRef();
+    remaining->RemoveRef();
+
+    // Interpolated gain is monotonic, exact at table entries and spans [0..kRampArray[0]]
+    TEST(RampApplicator::Gain(Ramp::kMax) == (TInt32)(kRampArray[0] << 5));
+    TEST(RampApplicator::Gain(Ramp::kMin) == 0);
+    TEST(RampApplicator::Gain(Ramp::kMax / 2) == (TInt32)(kRampArray[256] << 5));
+    TBool monotonic = true;
+    for (TUint r=Ramp::kMin; r<Ramp::kMax; r++) {
+        monotonic = monotonic && (RampApplicator::Gain(r) <= RampApplicator::Gain(r+1));
+    }
+    TEST(monotonic);
+
+    const TUint kBitDepths[] = { 8, 16, 24, 32 };
+    for (auto bitDepth : kBitDepths) {
+        for (TUint numChannels=1; numChannels<=3; numChannels++) {
+            TestBlockApply(bitDepth, numChannels);
+        }
+    }
+}
+
+void SuiteRamp::TestBlockApply(TUint aBitDepth, TUint aNumChannels)
+{
+    // Ramps are applied at full precision so expected values can be calculated independently.
+    // Results must not depend on how many samples are ramped per call.
+    const TUint kNumSamples = 300; // more than one block of gains
+    const TUint bytesPerSubsample = aBitDepth / 8;
+    const TUint bytesPerSample = bytesPerSubsample * aNumChannels;
+    std::vector<TByte> src(kNumSamples * bytesPerSample);
+    for (TUint i=0; i<src.size(); i++) {
+        src[i] = (TByte)(i * 37 + 11);
+    }
+    const Brn srcBuf(&src[0], (TUint)src.size());
+    Ramp ramp;
+    Ramp split;
+    TUint splitPos;
+    TEST(!ramp.Set(Ramp::kMax, kNumSamples, kNumSamples*3, Ramp::EDown, split, splitPos));
+
+    RampApplicator applicator(ramp);
+    std::vector<TByte> whole(src.size());
+    TEST(applicator.Start(srcBuf, aBitDepth, aNumChannels) == kNumSamples);
+    TEST(applicator.Apply(&whole[0], kNumSamples * 2) == kNumSamples);
+    TEST(applicator.Apply(&whole[0], 1) == 0);
+
+    std::vector<TByte> pieces(src.size());
+    TEST(applicator.Start(srcBuf, aBitDepth, aNumChannels) == kNumSamples);
+    TUint done = 0;
+    for (TUint len=1; done<kNumSamples; len+=7) {
+        done += applicator.Apply(&pieces[done * bytesPerSample], len);
+    }
+    TEST(done == kNumSamples);
+    TEST(whole == pieces);
+
+    TBool ok = true;
+    const TInt totalRamp = (TInt)(ramp.Start() - ramp.End());
+    for (TUint i=0; i<kNumSamples && ok; i++) {
+        const TUint rampVal = ramp.Start() - ((i * totalRamp) / (kNumSamples - 1));
+        const TInt64 gain = RampApplicator::Gain(rampVal);
+        for (TUint j=0; j<aNumChannels; j++) {
+            const TUint offset = (i * bytesPerSample) + (j * bytesPerSubsample);
+            const TInt32 expected = (TInt32)((ReadSubsample(&src[offset], bytesPerSubsample) * gain) >> RampApplicator::kGainShift);
+            ok = ok && (ReadSubsample(&whole[offset], bytesPerSubsample) == expected);
+        }
+    }
+    TEST(ok);
+}
+
+TInt32 SuiteRamp::ReadSubsample(const TByte* aPtr, TUint aBytes)
+{ // static
+    TUint32 val = 0;
+    for (TUint i=0; i<aBytes; i++) {
+        val = (val << 8) | aPtr[i];
+    }
+    const TUint shift = 32 - (aBytes * 8);
+    return ((TInt32)(val << shift)) >> shift;
 }
 
 
@@ -2747,6 +3591,119 @@ void SuiteMsgQueueLite::Test()
 }
 
 
+// SuiteMsgRing
+
+SuiteMsgRing::SuiteMsgRing()
+    : Suite("MsgRing tests")
+    , iStressRing(nullptr)
+{
+    MsgFactoryInitParams init;
+    init.SetMsgHaltCount(kStressMsgs);
+    iMsgFactory = new MsgFactory(iInfoAggregator, init);
+}
+
+SuiteMsgRing::~SuiteMsgRing()
+{
+    delete iMsgFactory;
+}
+
+void SuiteMsgRing::Test()
+{
+    TestFifo();
+    TestOverflow();
+    TestEnqueueAtHead();
+    TestTwoThreads();
+}
+
+void SuiteMsgRing::TestFifo()
+{
+    MsgRing ring(kRingCapacity);
+    TEST(ring.IsEmpty());
+    // wrap the ring indices several times without ever filling it
+    for (TUint i=0; i<10; i++) {
+        EnqueueHalts(ring, i*3, 3);
+        TEST(ring.NumMsgs() == 3);
+        TEST(DequeueHalts(ring, i*3, 3));
+        TEST(ring.IsEmpty());
+    }
+}
+
+void SuiteMsgRing::TestOverflow()
+{
+    MsgRing ring(kRingCapacity);
+    // fill ring and spill to overflow list
+    EnqueueHalts(ring, 0, kRingCapacity * 3);
+    TEST(ring.NumMsgs() == kRingCapacity * 3);
+    // free some ring slots.  Later msgs must still queue behind those that spilled
+    TEST(DequeueHalts(ring, 0, 2));
+    EnqueueHalts(ring, kRingCapacity * 3, 2);
+    TEST(DequeueHalts(ring, 2, kRingCapacity * 3));
+    TEST(ring.IsEmpty());
+    // ring is used again once overflow has drained
+    EnqueueHalts(ring, 100, kRingCapacity);
+    TEST(DequeueHalts(ring, 100, kRingCapacity));
+
+    // msgs still queued are released on destruction
+    MsgRing* ring2 = new MsgRing(kRingCapacity);
+    EnqueueHalts(*ring2, 0, kRingCapacity * 2);
+    delete ring2;
+}
+
+void SuiteMsgRing::TestEnqueueAtHead()
+{
+    MsgRing ring(kRingCapacity);
+    EnqueueHalts(ring, 1, kRingCapacity + 1);
+    ring.EnqueueAtHead(iMsgFactory->CreateMsgHalt(0));
+    TEST(ring.NumMsgs() == kRingCapacity + 2);
+    TEST(DequeueHalts(ring, 0, 1));
+    Msg* msg = ring.Dequeue();
+    ring.EnqueueAtHead(msg);
+    TEST(DequeueHalts(ring, 1, kRingCapacity + 1));
+    TEST(ring.IsEmpty());
+}
+
+void SuiteMsgRing::TestTwoThreads()
+{
+    // consumer regularly catches up with producer, so blocks when empty
+    iStressRing = new MsgRing(kRingCapacity * 4);
+    ThreadFunctor* producer = new ThreadFunctor("MsgRingProducer", MakeFunctor(*this, &SuiteMsgRing::Producer));
+    producer->Start();
+    TEST(DequeueHalts(*iStressRing, 0, kStressMsgs));
+    delete producer;
+    TEST(iStressRing->IsEmpty());
+    delete iStressRing;
+    iStressRing = nullptr;
+}
+
+void SuiteMsgRing::Producer()
+{
+    for (TUint i=0; i<kStressMsgs; i++) {
+        iStressRing->Enqueue(iMsgFactory->CreateMsgHalt(i));
+        if (i % 1000 == 0) {
+            Thread::Sleep(1);
+        }
+    }
+}
+
+void SuiteMsgRing::EnqueueHalts(MsgRing& aRing, TUint aFirstId, TUint aCount)
+{
+    for (TUint i=0; i<aCount; i++) {
+        aRing.Enqueue(iMsgFactory->CreateMsgHalt(aFirstId + i));
+    }
+}
+
+TBool SuiteMsgRing::DequeueHalts(MsgRing& aRing, TUint aFirstId, TUint aCount)
+{
+    TBool ok = true;
+    for (TUint i=0; i<aCount; i++) {
+        auto halt = static_cast<MsgHalt*>(aRing.Dequeue());
+        ok = ok && (halt->Id() == aFirstId + i);
+        halt->RemoveRef();
+    }
+    return ok;
+}
+
+
 // SuiteMsgReservoir
 
 SuiteMsgReservoir::SuiteMsgReservoir()
@@ -3285,11 +4242,19 @@ Msg* SuitePipelineElement::CreateMsg(ProcessorMsgType::EMsgType aType)
 void TestMsg()
 {
     Runner runner("Basic Msg tests\n");
-    runner.Add(new SuiteAllocator());
+    runner.Add(new SuiteAllocator("Allocator tests", AllocatorBase::Impl::eLocking, AllocatorBase::Storage::eHeap));
+    runner.Add(new SuiteAllocator("Allocator tests (lock-free)", AllocatorBase::Impl::eLockFree, AllocatorBase::Storage::eHeap));
+    runner.Add(new SuiteAllocator("Allocator tests (slab)", AllocatorBase::Impl::eLocking, AllocatorBase::Storage::eSlab));
+    runner.Add(new SuiteAllocator("Allocator tests (locked slab)", AllocatorBase::Impl::eLockFree, AllocatorBase::Storage::eSlabLocked));
+    runner.Add(new SuiteAllocatorElastic());
     runner.Add(new SuiteMsgAudioEncoded());
     runner.Add(new SuiteRamp());
     runner.Add(new SuiteMsgAudio());
+    runner.Add(new SuiteAudioDataSizeClasses("AudioData size class tests", AllocatorBase::Impl::eLocking, AllocatorBase::Storage::eHeap));
+    runner.Add(new SuiteAudioDataSizeClasses("AudioData size class tests (lock-free slab)", AllocatorBase::Impl::eLockFree, AllocatorBase::Storage::eSlab));
+    runner.Add(new SuiteDecodedAudioNative());
     runner.Add(new SuiteMsgPlayable());
+    runner.Add(new SuiteLatencyTracer());
     runner.Add(new SuiteAudioStream());
     runner.Add(new SuiteMetaText());
     runner.Add(new SuiteTrack());
@@ -3301,6 +4266,7 @@ void TestMsg()
     runner.Add(new SuiteMsgProcessor());
     runner.Add(new SuiteMsgQueue());
     runner.Add(new SuiteMsgQueueLite());
+    runner.Add(new SuiteMsgRing());
     runner.Add(new SuiteMsgReservoir());
     runner.Add(new SuitePipelineElement());
     runner.Run();
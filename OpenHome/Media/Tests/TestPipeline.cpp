@@ -10,6 +10,9 @@
 #include <OpenHome/Private/Shell.h>
 #include <OpenHome/Media/Pipeline/AnalogBypassRamper.h>
 #include <OpenHome/Media/Pipeline/MuterVolume.h>
+#include <OpenHome/Media/Pipeline/Logger.h>
+#include <OpenHome/Private/Ascii.h>
+#include <OpenHome/Private/Stream.h>
 
 #include <string.h>
 #include <vector>
@@ -507,6 +510,54 @@ void SuitePipeline::Test()
     TEST(iStateChangeCount == initialStateChangeCount);
 
 
+    // Disabled loggers were spliced out at Start().  Check one can be spliced in and out again without disturbing audio.
+    Print("\nEnable/disable logger\n");
+    TEST(!iPipeline->iSplicedLoggers.empty());
+    TEST(!iPipeline->SetLoggerEnabled(Brn("NotALogger"), true));
+    TEST(iPipeline->SetLoggerEnabled(Brn("Pruner"), true));
+    for (TUint i=0; i<5; i++) {
+        PullNextAudio();
+        Thread::Sleep(Jiffies::ToMs(iLastMsgJiffies));
+    }
+    TEST(iPipeline->SetLoggerEnabled(Brn("Pruner"), false));
+    for (TUint i=0; i<5; i++) {
+        PullNextAudio();
+        Thread::Sleep(Jiffies::ToMs(iLastMsgJiffies));
+    }
+    TEST(iFirstSubsample == iLastSubsample);
+    TEST(iPipelineState == EPipelinePlaying);
+
+
+    // Profiling splices all loggers back in.  Check counters update while enabled and are left alone once disabled.
+    Print("\nProfiling\n");
+    TEST(iPipeline->iLoggerPruner->Profile().Calls() == 0);
+    TEST(iPipeline->SetProfilingEnabled(true));
+    TEST(iPipeline->ProfilingEnabled());
+    for (TUint i=0; i<5; i++) {
+        PullNextAudio();
+        Thread::Sleep(Jiffies::ToMs(iLastMsgJiffies));
+    }
+    TEST(iPipeline->iLoggerPruner->Profile().Calls() > 0);
+    TEST(iPipeline->iLoggerPruner->Profile().MsgCount() > 0);
+    TEST(iPipeline->iLoggerEncodedAudioReservoir->Profile().MsgCount() > 0);
+    TEST(iPipeline->SetProfilingEnabled(false));
+    const TUint64 calls = iPipeline->iLoggerPruner->Profile().Calls();
+    for (TUint i=0; i<5; i++) {
+        PullNextAudio();
+        Thread::Sleep(Jiffies::ToMs(iLastMsgJiffies));
+    }
+    TEST(iPipeline->iLoggerPruner->Profile().Calls() == calls);
+    Bws<16 * 1024> profile;
+    WriterBuffer writer(profile);
+    iPipeline->WriteProfile(writer);
+    TEST(Ascii::Contains(profile, Brn("\"id\":\"Pruner\"")));
+    TEST(Ascii::Contains(profile, Brn("\"level\":{\"units\":\"jiffies\"")));
+    iPipeline->ResetProfile();
+    TEST(iPipeline->iLoggerPruner->Profile().Calls() == 0);
+    TEST(iFirstSubsample == iLastSubsample);
+    TEST(iPipelineState == EPipelinePlaying);
+
+
     // Stop.  Check for ramp down in Pipeline::kStopperRampDuration.
     Print("\nStop\n");
     iJiffies = 0;
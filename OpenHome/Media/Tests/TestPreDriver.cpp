@@ -200,6 +200,14 @@ void SuitePreDriver::Test()
     iNextGeneratedMsg = EMsgDecodedStream;
     iPreDriver->Pull()->Process(*this)->RemoveRef();
     TEST(iLastMsg == EMsgDecodedStream);
+
+    // PullBatch() skips consumed msgs, blocking until it has a msg to output
+    iNextGeneratedMsg = EMsgStreamInterrupted;
+    MsgQueueLite batch;
+    iPreDriver->PullBatch(batch, 4);
+    TEST(batch.NumMsgs() == 1); // upstream uses the default PullBatch() so supplies one msg per call
+    batch.Dequeue()->Process(*this)->RemoveRef();
+    TEST(iLastMsg == EMsgPlayable);
 }
 
 Msg* SuitePreDriver::Pull()
@@ -89,6 +89,7 @@ private:
     TUint iStreamId;
     TUint64 iTrackOffset;
     TUint iJiffies;
+    TUint iRampJiffies;
     std::list<Msg*> iPendingMsgs;
     TUint iLastSubsample;
     TUint iNextStreamId;
@@ -132,6 +133,7 @@ void SuiteRamper::Setup()
     iStreamId = UINT_MAX;
     iTrackOffset = 0;
     iJiffies = 0;
+    iRampJiffies = 0;
     iRamping = false;
     iLastSubsample = 0xffffff;
     iNextStreamId = 1;
@@ -241,6 +243,9 @@ Msg* SuiteRamper::ProcessMsg(MsgAudioPcm* aMsg)
 {
     iLastPulledMsg = EMsgAudioPcm;
     iJiffies += aMsg->Jiffies();
+    if (aMsg->Ramp().IsEnabled()) {
+        iRampJiffies += aMsg->RampJiffies(); // a ramp may end part way through a msg
+    }
     MsgPlayable* playable = aMsg->CreatePlayable();
     ProcessorPcmBufTest pcmProcessor;
     playable->Read(pcmProcessor);
@@ -379,12 +384,12 @@ void SuiteRamper::TestNonLiveStreamInMiddleRamps()
     TEST(iRamper->iRamping);
 
     iRamping = true;
-    iJiffies = 0;
+    iRampJiffies = 0;
     while (iRamper->iRamping) {
         iPendingMsgs.push_back(CreateAudio());
         PullNext(EMsgAudioPcm);
     }
-    TEST(iJiffies == kRampDuration);
+    TEST(iRampJiffies == kRampDuration);
 }
 
 void SuiteRamper::TestLiveStreamRamps()
@@ -398,12 +403,12 @@ void SuiteRamper::TestLiveStreamRamps()
     TEST(iRamper->iRamping);
 
     iRamping = true;
-    iJiffies = 0;
+    iRampJiffies = 0;
     while (iRamper->iRamping) {
         iPendingMsgs.push_back(CreateAudio());
         PullNext(EMsgAudioPcm);
     }
-    TEST(iJiffies == kRampDuration);
+    TEST(iRampJiffies == kRampDuration);
     iRamping = false; /* rounding errors in ramp code mean that
                          we can't rely on this being updated automatically */
 
@@ -119,7 +119,7 @@ SuiteReporter::SuiteReporter()
     init.SetMsgMetaTextCount(3);
     iMsgFactory = new MsgFactory(iInfoAggregator, init);
     iTrackFactory = new TrackFactory(iInfoAggregator, 3);
-    iEventThread = new PipelineElementObserverThread(kThreadPriorityReporter-1);
+    iEventThread = new PipelineElementObserverThread(kThreadPriorityReporter-1, 1);
     iReporter = new Reporter(*this, *this, *iEventThread); // aim for a priority just below thread that runs Reporter
 }
 
@@ -344,7 +344,7 @@ Msg* SuiteSeeker::ProcessMsg(MsgAudioPcm* aMsg)
 {
     iLastPulledMsg = EMsgAudioPcm;
     iLastMsgAudioSize = aMsg->Jiffies();
-    iJiffies += aMsg->Jiffies();
+    iJiffies += (iRampingUp? aMsg->RampJiffies() : aMsg->Jiffies()); // a ramp up may end part way through a msg
     TEST(iTrackOffsetPulled == aMsg->TrackOffset());
     iTrackOffsetPulled += aMsg->Jiffies();
     MsgPlayable* playable = aMsg->CreatePlayable();
@@ -27,6 +27,7 @@ SIMPLE_TEST_DECLARATION(TestPreDriver);
 SIMPLE_TEST_DECLARATION(TestProtocolHttp);
 SIMPLE_TEST_DECLARATION(TestRamper);
 SIMPLE_TEST_DECLARATION(TestReporter);
+SIMPLE_TEST_DECLARATION(TestElementObserver);
 SIMPLE_TEST_DECLARATION(TestRewinder);
 SIMPLE_TEST_DECLARATION(TestSampleRateValidator);
 SIMPLE_TEST_DECLARATION(TestSeeker);
@@ -96,6 +97,7 @@ void OpenHome::TestFramework::Runner::Main(TInt /*aArgc*/, TChar* /*aArgv*/[], N
     shellTests.push_back(ShellTest("TestProtocolHttp", ShellTestProtocolHttp));
     shellTests.push_back(ShellTest("TestRamper", ShellTestRamper));
     shellTests.push_back(ShellTest("TestReporter", ShellTestReporter));
+    shellTests.push_back(ShellTest("TestElementObserver", ShellTestElementObserver));
     shellTests.push_back(ShellTest("TestSampleRateValidator", ShellTestSampleRateValidator));
     shellTests.push_back(ShellTest("TestSeeker", ShellTestSeeker));
     shellTests.push_back(ShellTest("TestSkipper", ShellTestSkipper));
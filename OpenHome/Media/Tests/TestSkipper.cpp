@@ -15,7 +15,7 @@ using namespace OpenHome::Media;
 namespace OpenHome {
 namespace Media {
 
-class SuiteSkipper : public SuiteUnitTest, private IPipelineElementUpstream, private IStreamHandler, private IMsgProcessor
+class SuiteSkipper : public SuiteUnitTest, private IPipelineElementUpstream, private IStreamHandler, private IMsgProcessor, private IReservoirLevel
 {
     static const TUint kRampDuration = Jiffies::kPerMs * 50; // shorter than production code but this is assumed to not matter
     static const TUint kExpectedFlushId = 5;
@@ -36,6 +36,8 @@ private: // from IStreamHandler
     TUint TryDiscard(TUint aJiffies) override;
     TUint TryStop(TUint aStreamId) override;
     void NotifyStarving(const Brx& aMode, TUint aStreamId, TBool aStarving) override;
+private: // from IReservoirLevel
+    TUint ReservoirLevel() const override;
 private: // from IMsgProcessor
     Msg* ProcessMsg(MsgMode* aMsg) override;
     Msg* ProcessMsg(MsgTrack* aMsg) override;
@@ -94,6 +96,11 @@ private:
     void TestTryRemoveNoRampValidStream();
     void TestSilenceEndsRamp();
     void TestRemoveAllFlushesMostMsgs();
+    void TestRemoveStreamRampStopsUpstreamImmediately();
+    void TestFlushDuringRampEndsRamp();
+    void TestRemoveStreamRampDefersStopUntilBuffered();
+    void TestRemoveStreamRampStopsAfterRampIfNotBuffered();
+    void TestRemoveStreamRampShortenedToBufferedAudio();
 private:
     AllocatorInfoLogger iInfoAggregator;
     TrackFactory* iTrackFactory;
@@ -108,6 +115,8 @@ private:
     TUint iLastSubsample;
     TUint iNextStreamId;
     TUint iLastHaltId;
+    TUint iStopCount;
+    TUint iDecodedAudioJiffies;
 };
 
 } // namespace Media
@@ -149,6 +158,11 @@ SuiteSkipper::SuiteSkipper()
     AddTest(MakeFunctor(*this, &SuiteSkipper::TestTryRemoveNoRampValidStream), "TestTryRemoveNoRampValidStream");
     AddTest(MakeFunctor(*this, &SuiteSkipper::TestSilenceEndsRamp), "TestSilenceEndsRamp");
     AddTest(MakeFunctor(*this, &SuiteSkipper::TestRemoveAllFlushesMostMsgs), "TestRemoveAllFlushesMostMsgs");
+    AddTest(MakeFunctor(*this, &SuiteSkipper::TestRemoveStreamRampStopsUpstreamImmediately), "TestRemoveStreamRampStopsUpstreamImmediately");
+    AddTest(MakeFunctor(*this, &SuiteSkipper::TestFlushDuringRampEndsRamp), "TestFlushDuringRampEndsRamp");
+    AddTest(MakeFunctor(*this, &SuiteSkipper::TestRemoveStreamRampDefersStopUntilBuffered), "TestRemoveStreamRampDefersStopUntilBuffered");
+    AddTest(MakeFunctor(*this, &SuiteSkipper::TestRemoveStreamRampStopsAfterRampIfNotBuffered), "TestRemoveStreamRampStopsAfterRampIfNotBuffered");
+    AddTest(MakeFunctor(*this, &SuiteSkipper::TestRemoveStreamRampShortenedToBufferedAudio), "TestRemoveStreamRampShortenedToBufferedAudio");
 }
 
 SuiteSkipper::~SuiteSkipper()
@@ -171,7 +185,7 @@ void SuiteSkipper::Setup()
     init.SetMsgModeCount(2);
     init.SetMsgDelayCount(2);
     iMsgFactory = new MsgFactory(iInfoAggregator, init);
-    iSkipper = new Skipper(*iMsgFactory, *this, kRampDuration);
+    iSkipper = new Skipper(*iMsgFactory, *this, *this, kRampDuration);
     iStreamId = UINT_MAX;
     iTrackOffset = 0;
     iJiffies = 0;
@@ -179,6 +193,8 @@ void SuiteSkipper::Setup()
     iLastSubsample = 0xffffff;
     iNextStreamId = 1;
     iLastHaltId = MsgHalt::kIdInvalid;
+    iStopCount = 0;
+    iDecodedAudioJiffies = kRampDuration;
 }
 
 void SuiteSkipper::TearDown()
@@ -220,6 +236,7 @@ TUint SuiteSkipper::TryDiscard(TUint /*aJiffies*/)
 TUint SuiteSkipper::TryStop(TUint aStreamId)
 {
     if (aStreamId == iStreamId) {
+        iStopCount++;
         return kExpectedFlushId;
     }
     return MsgFlush::kIdInvalid;
@@ -229,6 +246,11 @@ void SuiteSkipper::NotifyStarving(const Brx& /*aMode*/, TUint /*aStreamId*/, TBo
 {
 }
 
+TUint SuiteSkipper::ReservoirLevel() const
+{
+    return iDecodedAudioJiffies;
+}
+
 Msg* SuiteSkipper::ProcessMsg(MsgMode* aMsg)
 {
     iLastPulledMsg = EMsgMode;
@@ -774,6 +796,155 @@ void SuiteSkipper::TestRemoveAllFlushesMostMsgs()
     TEST(iPendingMsgs.size() == 0);
 }
 
+void SuiteSkipper::TestRemoveStreamRampStopsUpstreamImmediately()
+{
+    iPendingMsgs.push_back(CreateTrack());
+    iPendingMsgs.push_back(CreateEncodedStream());
+    iPendingMsgs.push_back(CreateDecodedStream());
+    iPendingMsgs.push_back(CreateAudio());
+    for (TUint i=0; i<4; i++) {
+        PullNext();
+    }
+
+    TEST(iSkipper->TryRemoveStream(iStreamId, true));
+    TEST(iStopCount == 1);
+    iRamping = true;
+    while (iRamping) {
+        iPendingMsgs.push_back(CreateAudio());
+        PullNext(EMsgAudioPcm);
+    }
+    PullNext(EMsgHalt);
+    TEST(iStopCount == 1);
+    iPendingMsgs.push_back(CreateAudio());
+    iPendingMsgs.push_back(iMsgFactory->CreateMsgFlush(kExpectedFlushId)); // should be consumed by Skipper
+    iPendingMsgs.push_back(CreateEncodedStream());
+    PullNext(EMsgEncodedStream);
+}
+
+void SuiteSkipper::TestFlushDuringRampEndsRamp()
+{
+    iPendingMsgs.push_back(CreateTrack());
+    iPendingMsgs.push_back(CreateEncodedStream());
+    iPendingMsgs.push_back(CreateDecodedStream());
+    iPendingMsgs.push_back(CreateAudio());
+    for (TUint i=0; i<4; i++) {
+        PullNext();
+    }
+
+    TEST(iSkipper->TryRemoveStream(iStreamId, true));
+    iRamping = true;
+    iJiffies = 0;
+    iPendingMsgs.push_back(CreateAudio());
+    PullNext(EMsgAudioPcm);
+    // upstream has no more audio for the stream; its flush arrives before the ramp completes
+    iPendingMsgs.push_back(iMsgFactory->CreateMsgFlush(kExpectedFlushId));
+    PullNext(EMsgHalt);
+    TEST(iJiffies < kRampDuration);
+    iRamping = false;
+    iPendingMsgs.push_back(CreateEncodedStream());
+    PullNext(EMsgEncodedStream);
+    iPendingMsgs.push_back(CreateAudio());
+    PullNext(EMsgAudioPcm);
+    TEST(iStopCount == 1);
+}
+
+void SuiteSkipper::TestRemoveStreamRampDefersStopUntilBuffered()
+{
+    iPendingMsgs.push_back(CreateTrack());
+    iPendingMsgs.push_back(CreateEncodedStream());
+    iPendingMsgs.push_back(CreateDecodedStream());
+    iPendingMsgs.push_back(CreateAudio());
+    for (TUint i=0; i<4; i++) {
+        PullNext();
+    }
+
+    // too little audio buffered to complete the ramp so upstream isn't stopped yet
+    iDecodedAudioJiffies = 0;
+    TEST(iSkipper->TryRemoveStream(iStreamId, true));
+    TEST(iStopCount == 0);
+    iRamping = true;
+    iJiffies = 0;
+    iPendingMsgs.push_back(CreateAudio());
+    PullNext(EMsgAudioPcm);
+    TEST(iStopCount == 0);
+
+    // enough audio for the rest of the ramp has since been decoded
+    iDecodedAudioJiffies = kRampDuration;
+    iPendingMsgs.push_back(CreateAudio());
+    PullNext(EMsgAudioPcm);
+    TEST(iRamping);
+    TEST(iStopCount == 1);
+    while (iRamping) {
+        iPendingMsgs.push_back(CreateAudio());
+        PullNext(EMsgAudioPcm);
+    }
+    TEST(iJiffies == kRampDuration);
+    PullNext(EMsgHalt);
+    TEST(iStopCount == 1);
+    iPendingMsgs.push_back(iMsgFactory->CreateMsgFlush(kExpectedFlushId)); // should be consumed by Skipper
+    iPendingMsgs.push_back(CreateEncodedStream());
+    PullNext(EMsgEncodedStream);
+}
+
+void SuiteSkipper::TestRemoveStreamRampStopsAfterRampIfNotBuffered()
+{
+    iPendingMsgs.push_back(CreateTrack());
+    iPendingMsgs.push_back(CreateEncodedStream());
+    iPendingMsgs.push_back(CreateDecodedStream());
+    iPendingMsgs.push_back(CreateAudio());
+    for (TUint i=0; i<4; i++) {
+        PullNext();
+    }
+
+    iDecodedAudioJiffies = 0;
+    TEST(iSkipper->TryRemoveStream(iStreamId, true));
+    iRamping = true;
+    iJiffies = 0;
+    while (iRamping) {
+        iPendingMsgs.push_back(CreateAudio());
+        PullNext(EMsgAudioPcm);
+        if (iRamping) {
+            TEST(iStopCount == 0);
+        }
+    }
+    TEST(iJiffies == kRampDuration);
+    PullNext(EMsgHalt);
+    TEST(iStopCount == 1);
+    iPendingMsgs.push_back(CreateAudio());
+    iPendingMsgs.push_back(iMsgFactory->CreateMsgFlush(kExpectedFlushId)); // should be consumed by Skipper
+    iPendingMsgs.push_back(CreateEncodedStream());
+    PullNext(EMsgEncodedStream);
+}
+
+void SuiteSkipper::TestRemoveStreamRampShortenedToBufferedAudio()
+{
+    iPendingMsgs.push_back(CreateTrack());
+    iPendingMsgs.push_back(CreateEncodedStream());
+    iPendingMsgs.push_back(CreateDecodedStream());
+    iPendingMsgs.push_back(CreateAudio());
+    for (TUint i=0; i<4; i++) {
+        PullNext();
+    }
+
+    // less than a full ramp is buffered; upstream is stopped at once and the ramp shortened to fit
+    static const TUint kBufferedJiffies = Jiffies::kPerMs * 20;
+    iDecodedAudioJiffies = kBufferedJiffies;
+    TEST(iSkipper->TryRemoveStream(iStreamId, true));
+    TEST(iStopCount == 1);
+    iRamping = true;
+    iJiffies = 0;
+    while (iRamping) {
+        iPendingMsgs.push_back(CreateAudio());
+        PullNext(EMsgAudioPcm);
+    }
+    TEST(iJiffies == kBufferedJiffies);
+    PullNext(EMsgHalt);
+    TEST(iStopCount == 1);
+    iPendingMsgs.push_back(iMsgFactory->CreateMsgFlush(kExpectedFlushId)); // should be consumed by Skipper
+    iPendingMsgs.push_back(CreateEncodedStream());
+    PullNext(EMsgEncodedStream);
+}
+
 
 void TestSkipper()
 {
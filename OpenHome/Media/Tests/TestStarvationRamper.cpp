@@ -101,6 +101,7 @@ private:
     void TestNotifyStarvingAroundStarvation();
     void TestReportsBuffering();
     void TestAllSampleRates();
+    void TestPullBatchTakesBufferedMsgsOnly();
 private:
     AllocatorInfoLogger iInfoAggregator;
     TrackFactory* iTrackFactory;
@@ -146,6 +147,7 @@ SuiteStarvationRamper::SuiteStarvationRamper()
     AddTest(MakeFunctor(*this, &SuiteStarvationRamper::TestNotifyStarvingAroundStarvation), "TestNotifyStarvingAroundStarvation");
     AddTest(MakeFunctor(*this, &SuiteStarvationRamper::TestReportsBuffering), "TestReportsBuffering");
     AddTest(MakeFunctor(*this, &SuiteStarvationRamper::TestAllSampleRates), "TestAllSampleRates");
+    AddTest(MakeFunctor(*this, &SuiteStarvationRamper::TestPullBatchTakesBufferedMsgsOnly), "TestPullBatchTakesBufferedMsgsOnly");
 
     // audio data with left=0x7f, right=0x00
     iPcmData.SetBytes(kAudioPcmBytesDefault);
@@ -299,7 +301,7 @@ Msg* SuiteStarvationRamper::ProcessMsg(MsgBitRate* /*aMsg*/)
 Msg* SuiteStarvationRamper::ProcessMsg(MsgAudioPcm* aMsg)
 {
     iLastPulledMsg = EMsgAudioPcm;
-    iJiffies += aMsg->Jiffies();
+    iJiffies += (iRampingUp? aMsg->RampJiffies() : aMsg->Jiffies()); // a ramp up may end part way through a msg
     const Media::Ramp& ramp = aMsg->Ramp();
     if (iRampingDown) {
         TEST(ramp.Direction() == Ramp::EDown);
@@ -788,6 +790,45 @@ void SuiteStarvationRamper::TestAllSampleRates()
     Quit();
 }
 
+void SuiteStarvationRamper::TestPullBatchTakesBufferedMsgsOnly()
+{
+    static const TUint kNumAudioMsgs = 4;
+    AddPending(iMsgFactory->CreateMsgMode(kMode));
+    AddPending(CreateTrack());
+    AddPending(CreateDecodedStream());
+    PullNext(EMsgMode);
+    PullNext(EMsgTrack);
+    PullNext(EMsgDecodedStream);
+
+    for (TUint i=0; i<kNumAudioMsgs; i++) {
+        AddPending(CreateAudio());
+    }
+    TInt retries = 100;
+    while (iStarvationRamper->Jiffies() < iTrackOffset && retries-- > 0) {
+        Thread::Sleep(10);
+    }
+    TEST(iStarvationRamper->Jiffies() == iTrackOffset);
+
+    // aMaxMsgs is respected...
+    MsgQueueLite batch;
+    iStarvationRamper->PullBatch(batch, 1);
+    TEST(batch.NumMsgs() == 1);
+    // ...and the batch ends when StarvationRamper is empty rather than waiting for more msgs
+    iStarvationRamper->PullBatch(batch, kNumAudioMsgs * 2);
+    TEST(batch.NumMsgs() == kNumAudioMsgs);
+    TEST(iStarvationRamper->IsEmpty());
+    while (!batch.IsEmpty()) {
+        Msg* msg = batch.Dequeue()->Process(*this);
+        TEST(iLastPulledMsg == EMsgAudioPcm);
+        msg->RemoveRef();
+    }
+
+    AddPending(iMsgFactory->CreateMsgHalt());
+    AddPending(iMsgFactory->CreateMsgQuit());
+    PullNext(EMsgHalt);
+    PullNext(EMsgQuit);
+}
+
 
 
 void TestStarvationRamper()
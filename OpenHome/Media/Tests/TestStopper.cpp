@@ -365,7 +365,7 @@ Msg* SuiteStopper::ProcessMsg(MsgBitRate* aMsg)
 Msg* SuiteStopper::ProcessMsg(MsgAudioPcm* aMsg)
 {
     iLastPulledMsg = EMsgAudioPcm;
-    iJiffies += aMsg->Jiffies();
+    iJiffies += (iRampingUp? aMsg->RampJiffies() : aMsg->Jiffies()); // a ramp up may end part way through a msg
     MsgPlayable* playable = aMsg->CreatePlayable();
     ProcessorPcmBufTest pcmProcessor;
     playable->Read(pcmProcessor);
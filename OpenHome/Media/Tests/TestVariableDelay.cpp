@@ -120,6 +120,7 @@ protected:
     IClockPuller* iNextModeClockPuller;
     TUint iLastPulledDelay;
     TUint64 iLastPulledStreamPos;
+    TUint iTrackOffsetDiscontinuities;
     TUint iNextDiscardFlushId;
     TUint64 iNextStreamSampleStart;
     TUint iClockPullStartCount;
@@ -174,6 +175,30 @@ private:
     TUint iNumAnimatorDelayJiffiesCalls;
 };
 
+class SuiteVariableDelayLine : public SuiteVariableDelay, private IVariableDelayObserver
+{
+    static const TUint kDownstreamDelay = 30 * Jiffies::kPerMs;
+    static const TUint kDelayLineJiffies = 100 * Jiffies::kPerMs;
+    static const TUint kDelay = 60 * Jiffies::kPerMs;
+public:
+    SuiteVariableDelayLine();
+private: // from SuiteVariableDelay
+    void DoSetup() override;
+private: // from IVariableDelayObserver
+    void NotifyDelayApplied(TUint aJiffies) override;
+private:
+    void TestIncreaseDelayGeneratesNoSilence();
+    void TestReduceDelayDiscardsNoAudio();
+    void TestHeldAudioPrecedesHalt();
+    void TestHeldAudioPrecedesNewStream();
+    void TestHeldAudioPrecedesSeek();
+    void TestFlushResetsDelayLine();
+private:
+    void CheckHeldAudioPrecedesStream();
+private:
+    TUint iDelayAppliedJiffies;
+};
+
 } // namespace Media
 } // namespace OpenHome
 
@@ -217,6 +242,7 @@ void SuiteVariableDelay::Setup()
     iNextModeClockPuller = nullptr;
     iLastPulledDelay = 0;
     iLastPulledStreamPos = 0;
+    iTrackOffsetDiscontinuities = 0;
     iNextDiscardFlushId = MsgFlush::kIdInvalid;
     iNextStreamSampleStart = 0;
     iClockPullStartCount = iClockPullStopCount = 0;
@@ -389,6 +415,9 @@ Msg* SuiteVariableDelay::ProcessMsg(MsgAudioPcm* aMsg)
 {
     iLastMsg = EMsgAudioPcm;
     TUint jiffies = aMsg->Jiffies();
+    if (aMsg->TrackOffset() != iLastPulledStreamPos) {
+        iTrackOffsetDiscontinuities++;
+    }
     iLastPulledStreamPos += jiffies;
 
     MsgPlayable* playable = aMsg->CreatePlayable();
@@ -422,7 +451,7 @@ Msg* SuiteVariableDelay::ProcessMsg(MsgAudioPcm* aMsg)
         TEST(firstSubsample == lastSubsample);
         break;
     }
-    iJiffies += jiffies;
+    iJiffies += aMsg->RampJiffies(); // a ramp up may end part way through a msg
     iJiffiesAudioPcm += jiffies;
     return nullptr;
 }
@@ -551,7 +580,7 @@ SuiteVariableDelayLeft::SuiteVariableDelayLeft()
 
 void SuiteVariableDelayLeft::DoSetup()
 {
-    iVariableDelay = new VariableDelayLeft(*iMsgFactory, *this, kRampDuration, kDownstreamDelay);
+    iVariableDelay = new VariableDelayLeft(*iMsgFactory, *this, kRampDuration, kDownstreamDelay, 0);
     static_cast<VariableDelayLeft*>(iVariableDelay)->SetObserver(*this);
     iDelayAppliedJiffies = UINT_MAX;
 }
@@ -650,6 +679,7 @@ void SuiteVariableDelayLeft::TestReduceDelayFromRunning()
 
     iJiffies = 0;
     const TUint64 prevOffset = iTrackOffset;
+    const TUint prevAudioPcm = iJiffiesAudioPcm;
     const TUint queuedAudio = (TUint)iTrackOffset - iJiffiesAudioPcm;
     iNextGeneratedMsg = EMsgAudioPcm;
     PullNext();
@@ -666,7 +696,7 @@ void SuiteVariableDelayLeft::TestReduceDelayFromRunning()
         PullNext();
     }
     TUint audioGenerated = (TUint)(iTrackOffset - prevOffset);
-    TEST(audioGenerated - iJiffies + queuedAudio == 20 * Jiffies::kPerMs);
+    TEST(audioGenerated - (iJiffiesAudioPcm - prevAudioPcm) + queuedAudio == 20 * Jiffies::kPerMs);
 }
 
 void SuiteVariableDelayLeft::TestChangeDelayWhileRampingDown()
@@ -906,7 +936,7 @@ SuiteVariableDelayRight::SuiteVariableDelayRight()
 
 void SuiteVariableDelayRight::DoSetup()
 {
-    auto variableDelay = new VariableDelayRight(*iMsgFactory, *this, kRampDuration, kMinDelay);
+    auto variableDelay = new VariableDelayRight(*iMsgFactory, *this, kRampDuration, kMinDelay, 0);
     variableDelay->SetAnimator(*this);
     iVariableDelay = variableDelay;
     iAnimatorDelayJiffies = 0;
@@ -1013,10 +1043,160 @@ void SuiteVariableDelayRight::TestClockPuller()
 }
 
 
+// SuiteVariableDelayLine
+
+SuiteVariableDelayLine::SuiteVariableDelayLine()
+    : SuiteVariableDelay("VariableDelayLine")
+{
+    AddTest(MakeFunctor(*this, &SuiteVariableDelayLine::TestIncreaseDelayGeneratesNoSilence), "TestIncreaseDelayGeneratesNoSilence");
+    AddTest(MakeFunctor(*this, &SuiteVariableDelayLine::TestReduceDelayDiscardsNoAudio), "TestReduceDelayDiscardsNoAudio");
+    AddTest(MakeFunctor(*this, &SuiteVariableDelayLine::TestHeldAudioPrecedesHalt), "TestHeldAudioPrecedesHalt");
+    AddTest(MakeFunctor(*this, &SuiteVariableDelayLine::TestHeldAudioPrecedesNewStream), "TestHeldAudioPrecedesNewStream");
+    AddTest(MakeFunctor(*this, &SuiteVariableDelayLine::TestHeldAudioPrecedesSeek), "TestHeldAudioPrecedesSeek");
+    AddTest(MakeFunctor(*this, &SuiteVariableDelayLine::TestFlushResetsDelayLine), "TestFlushResetsDelayLine");
+}
+
+void SuiteVariableDelayLine::DoSetup()
+{
+    iVariableDelay = new VariableDelayLeft(*iMsgFactory, *this, kRampDuration, kDownstreamDelay, kDelayLineJiffies);
+    static_cast<VariableDelayLeft*>(iVariableDelay)->SetObserver(*this);
+    iDelayAppliedJiffies = UINT_MAX;
+}
+
+void SuiteVariableDelayLine::NotifyDelayApplied(TUint aJiffies)
+{
+    iDelayAppliedJiffies = aJiffies;
+}
+
+void SuiteVariableDelayLine::TestIncreaseDelayGeneratesNoSilence()
+{
+    PullNext(EMsgMode);
+    PullNext(EMsgTrack);
+    PullNext(EMsgDecodedStream);
+    // build up enough history that the crossfade is between identical samples
+    for (TUint i=0; i<4; i++) {
+        PullNext(EMsgAudioPcm);
+    }
+    TEST(iVariableDelay->iStatus == VariableDelayBase::ERunning);
+
+    iNextDelayAbsoluteJiffies = kDelay;
+    PullNext(EMsgDelay);
+    TEST(iVariableDelay->iStatus == VariableDelayBase::ERunning);
+    TEST(iDelayAppliedJiffies == kDelay - kDownstreamDelay);
+    TEST(iVariableDelay->iDelayLine->DelayJiffies() == kDelay - kDownstreamDelay);
+
+    iJiffies = 0;
+    for (TUint i=0; i<6; i++) {
+        PullNext(EMsgAudioPcm);
+        TEST(iVariableDelay->iStatus == VariableDelayBase::ERunning);
+    }
+    TEST(iJiffies == 6 * iAudioMsgSizeJiffies);
+    // replayed audio continues from the last offset output rather than moving backwards
+    TEST(iTrackOffsetDiscontinuities == 0);
+}
+
+void SuiteVariableDelayLine::TestReduceDelayDiscardsNoAudio()
+{
+    TestIncreaseDelayGeneratesNoSilence();
+    iDelayAppliedJiffies = UINT_MAX;
+    iNextDelayAbsoluteJiffies = kDownstreamDelay;
+    PullNext(EMsgDelay);
+    TEST(iVariableDelay->iStatus == VariableDelayBase::ERunning);
+    TEST(iDelayAppliedJiffies == 0);
+    TEST(iVariableDelay->iDelayLine->DelayJiffies() == 0);
+
+    iJiffies = 0;
+    for (TUint i=0; i<4; i++) {
+        PullNext(EMsgAudioPcm);
+    }
+    TEST(iJiffies == 4 * iAudioMsgSizeJiffies);
+    TEST(iVariableDelay->iDelayLine->IsTransparent());
+}
+
+void SuiteVariableDelayLine::TestHeldAudioPrecedesHalt()
+{
+    TestIncreaseDelayGeneratesNoSilence();
+    iJiffies = 0;
+    iNextGeneratedMsg = EMsgHalt;
+    PullNext();
+    TEST(iLastMsg == EMsgAudioPcm);
+    PullNext();
+    TEST(iLastMsg == EMsgHalt);
+    TEST(iJiffies == kDelay - kDownstreamDelay);
+    TEST(iTrackOffsetDiscontinuities == 0);
+    // delay is retained, to be re-applied to audio following the halt
+    TEST(iVariableDelay->iDelayLine->DelayJiffies() == kDelay - kDownstreamDelay);
+}
+
+void SuiteVariableDelayLine::TestHeldAudioPrecedesNewStream()
+{
+    TestIncreaseDelayGeneratesNoSilence();
+    // new stream has the same format as the last one
+    iNextStreamSampleStart = 0;
+    iTrackOffset = 0;
+    CheckHeldAudioPrecedesStream();
+}
+
+void SuiteVariableDelayLine::TestHeldAudioPrecedesSeek()
+{
+    TestIncreaseDelayGeneratesNoSilence();
+    static const TUint64 kSeekSample = 10 * 44100;
+    iNextStreamSampleStart = kSeekSample;
+    iTrackOffset = kSeekSample * Jiffies::PerSample(44100);
+    CheckHeldAudioPrecedesStream();
+}
+
+void SuiteVariableDelayLine::CheckHeldAudioPrecedesStream()
+{
+    iJiffies = 0;
+    iTrackOffsetDiscontinuities = 0;
+    iNextGeneratedMsg = EMsgDecodedStream;
+    do {
+        PullNext();
+    } while (iLastMsg == EMsgAudioPcm);
+    TEST(iLastMsg == EMsgDecodedStream);
+    TEST(iJiffies == kDelay - kDownstreamDelay);
+    // delay is retained, applied from the start of the new stream
+    TEST(iVariableDelay->iDelayLine->DelayJiffies() == kDelay - kDownstreamDelay);
+
+    iJiffies = 0;
+    for (TUint i=0; i<4; i++) {
+        PullNext(EMsgAudioPcm);
+    }
+    TEST(iJiffies == 4 * iAudioMsgSizeJiffies);
+    TEST(iTrackOffsetDiscontinuities == 0);
+}
+
+void SuiteVariableDelayLine::TestFlushResetsDelayLine()
+{
+    TestIncreaseDelayGeneratesNoSilence();
+    iNextDelayAbsoluteJiffies = kDownstreamDelay;
+    PullNext(EMsgDelay);
+    TEST(iVariableDelay->iDelayLine->DelayJiffies() == 0);
+    TEST(!iVariableDelay->iDelayLine->IsTransparent()); // crossfading away from the previous delay
+
+    // simulate a ramp down and upstream discard
+    static const TUint kFlushId = 42;
+    iVariableDelay->iStatus = VariableDelayBase::ERampedDown;
+    iVariableDelay->iTargetFlushId = kFlushId;
+    Msg* msg = iVariableDelay->ProcessMsg(iMsgFactory->CreateMsgFlush(kFlushId));
+    TEST(msg == nullptr);
+    TEST(iVariableDelay->iStatus == VariableDelayBase::ERampingUp);
+    TEST(iVariableDelay->iDelayLine->IsTransparent());
+
+    PullNext(EMsgDecodedStream);
+    do {
+        PullNext(EMsgAudioPcm);
+    } while (iVariableDelay->iStatus == VariableDelayBase::ERampingUp);
+    TEST(iVariableDelay->iStatus == VariableDelayBase::ERunning);
+}
+
+
 void TestVariableDelay()
 {
     Runner runner("Variable delay tests\n");
     runner.Add(new SuiteVariableDelayLeft());
     runner.Add(new SuiteVariableDelayRight());
+    runner.Add(new SuiteVariableDelayLine());
     runner.Run();
 }
@@ -311,7 +311,7 @@ Msg* SuiteWaiter::ProcessMsg(MsgBitRate* aMsg)
 Msg* SuiteWaiter::ProcessMsg(MsgAudioPcm* aMsg)
 {
     iLastPulledMsg = EMsgAudioPcm;
-    iJiffies += aMsg->Jiffies();
+    iJiffies += (iRampingUp? aMsg->RampJiffies() : aMsg->Jiffies()); // a ramp up may end part way through a msg
     MsgPlayable* playable = aMsg->CreatePlayable();
     ProcessorPcmBufTest pcmProcessor;
     playable->Read(pcmProcessor);
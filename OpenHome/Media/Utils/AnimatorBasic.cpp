@@ -67,7 +67,7 @@ AnimatorBasic::~AnimatorBasic()
 void AnimatorBasic::DriverThread()
 {
     // pull the first (assumed non-audio) msg here so that any delays populating the pipeline don't affect timing calculations below.
-    Msg* msg = iPipeline.Pull();
+    Msg* msg = PullMsg();
     ASSERT(msg != nullptr);
     (void)msg->Process(*this);
 
@@ -82,7 +82,7 @@ void AnimatorBasic::DriverThread()
                     ProcessAudio(iPlayable);
                 }
                 else {
-                    Msg* msg = iPipeline.Pull();
+                    Msg* msg = PullMsg();
                     msg = msg->Process(*this);
                     ASSERT(msg == nullptr);
                 }
@@ -120,7 +120,7 @@ void AnimatorBasic::DriverThread()
 
     // pull until the pipeline is emptied
     while (!iQuit) {
-        Msg* msg = iPipeline.Pull();
+        Msg* msg = PullMsg();
         msg = msg->Process(*this);
         ASSERT(msg == nullptr);
         if (iPlayable != nullptr) {
@@ -129,6 +129,14 @@ void AnimatorBasic::DriverThread()
     }
 }
 
+Msg* AnimatorBasic::PullMsg()
+{
+    if (iPulled.IsEmpty()) {
+        iPipeline.PullBatch(iPulled, kMaxPullMsgs);
+    }
+    return iPulled.Dequeue();
+}
+
 void AnimatorBasic::ProcessAudio(MsgPlayable* aMsg)
 {
     iPlayable = nullptr;
@@ -191,6 +199,7 @@ Msg* AnimatorBasic::ProcessMsg(MsgDecodedStream* aMsg)
 
 Msg* AnimatorBasic::ProcessMsg(MsgPlayable* aMsg)
 {
+    aMsg->AddLogPoint(LatencyPoint::eAnimator);
     ProcessAudio(aMsg);
     return nullptr;
 }
@@ -28,12 +28,14 @@ private:
 class AnimatorBasic : public PipelineElement, public IPullableClock, public IPipelineAnimator
 {
     static const TUint kTimerFrequencyMs = 5;
+    static const TUint kMaxPullMsgs = 4;
     static const TUint kSupportedMsgTypes;
 public:
     AnimatorBasic(Environment& aEnv, IPipeline& aPipeline, TBool aPullable);
     ~AnimatorBasic();
 private:
     void DriverThread();
+    Msg* PullMsg();
     void ProcessAudio(MsgPlayable* aMsg);
 private: // from IMsgProcessor
     Msg* ProcessMsg(MsgMode* aMsg) override;
@@ -50,6 +52,7 @@ private: // from IPipelineAnimator
     TUint PipelineAnimatorDelayJiffies(TUint aSampleRate, TUint aBitDepth, TUint aNumChannels) override;
 private:
     IPipeline& iPipeline;
+    MsgQueueLite iPulled; // msgs from the last PullBatch() that haven't been processed yet
     Semaphore iSem;
     OsContext* iOsCtx;
     ThreadFunctor *iThread;
@@ -0,0 +1,356 @@
+#include <OpenHome/Media/Utils/ByteSwapper.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Private/Standard.h>
+
+#include <atomic>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define BYTESWAPPER_X86
+# define BYTESWAPPER_TARGET(x) __attribute__((target(x)))
+# include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+# define BYTESWAPPER_X86
+# define BYTESWAPPER_TARGET(x)
+# include <intrin.h>
+# include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+// NEON is only used if the compiler targets it (always true for aarch64) so needs no runtime check
+# define BYTESWAPPER_NEON
+# include <arm_neon.h>
+#endif
+
+using namespace OpenHome;
+using namespace OpenHome::Media;
+
+namespace {
+
+typedef void (*CopyFunction)(const TByte* aSrc, TByte* aDest, TUint aBytes);
+
+struct Kernels
+{
+    ByteSwapper::Impl iImpl;
+    CopyFunction iCopy16;
+    CopyFunction iCopy24;
+    CopyFunction iCopy32;
+};
+
+// Scalar
+
+void Copy16Scalar(const TByte* aSrc, TByte* aDest, TUint aBytes)
+{
+    for (TUint i=0; i<aBytes; i+=2) {
+        *aDest++ = aSrc[i+1];
+        *aDest++ = aSrc[i];
+    }
+}
+
+void Copy24Scalar(const TByte* aSrc, TByte* aDest, TUint aBytes)
+{
+    for (TUint i=0; i<aBytes; i+=3) {
+        *aDest++ = aSrc[i+2];
+        *aDest++ = aSrc[i+1];
+        *aDest++ = aSrc[i];
+    }
+}
+
+void Copy32Scalar(const TByte* aSrc, TByte* aDest, TUint aBytes)
+{
+    for (TUint i=0; i<aBytes; i+=4) {
+        *aDest++ = aSrc[i+3];
+        *aDest++ = aSrc[i+2];
+        *aDest++ = aSrc[i+1];
+        *aDest++ = aSrc[i];
+    }
+}
+
+#ifdef BYTESWAPPER_X86
+
+// SSE2
+
+BYTESWAPPER_TARGET("sse2")
+void Copy16Sse2(const TByte* aSrc, TByte* aDest, TUint aBytes)
+{
+    TUint i = 0;
+    for (; i+16<=aBytes; i+=16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aSrc + i));
+        const __m128i swapped = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(aDest + i), swapped);
+    }
+    Copy16Scalar(aSrc + i, aDest + i, aBytes - i);
+}
+
+// SSSE3
+
+BYTESWAPPER_TARGET("ssse3")
+void Copy16Ssse3(const TByte* aSrc, TByte* aDest, TUint aBytes)
+{
+    const __m128i mask = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    TUint i = 0;
+    for (; i+16<=aBytes; i+=16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aSrc + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(aDest + i), _mm_shuffle_epi8(v, mask));
+    }
+    Copy16Scalar(aSrc + i, aDest + i, aBytes - i);
+}
+
+BYTESWAPPER_TARGET("ssse3")
+void Copy24Ssse3(const TByte* aSrc, TByte* aDest, TUint aBytes)
+{
+    /* Each iteration converts 4 samples (12 bytes) but loads and stores 16.
+       The 4 trailing bytes written are overwritten by the following iteration; the loop
+       condition stops before this could write beyond aDest + aBytes. */
+    const __m128i mask = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, -1, -1, -1, -1);
+    TUint i = 0;
+    for (; i+16<=aBytes; i+=12) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aSrc + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(aDest + i), _mm_shuffle_epi8(v, mask));
+    }
+    Copy24Scalar(aSrc + i, aDest + i, aBytes - i);
+}
+
+BYTESWAPPER_TARGET("ssse3")
+void Copy32Ssse3(const TByte* aSrc, TByte* aDest, TUint aBytes)
+{
+    const __m128i mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    TUint i = 0;
+    for (; i+16<=aBytes; i+=16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aSrc + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(aDest + i), _mm_shuffle_epi8(v, mask));
+    }
+    Copy32Scalar(aSrc + i, aDest + i, aBytes - i);
+}
+
+// AVX2
+
+BYTESWAPPER_TARGET("avx2")
+void Copy16Avx2(const TByte* aSrc, TByte* aDest, TUint aBytes)
+{
+    const __m256i mask = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                                          1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    TUint i = 0;
+    for (; i+32<=aBytes; i+=32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(aSrc + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(aDest + i), _mm256_shuffle_epi8(v, mask));
+    }
+    Copy16Ssse3(aSrc + i, aDest + i, aBytes - i);
+}
+
+BYTESWAPPER_TARGET("avx2")
+void Copy32Avx2(const TByte* aSrc, TByte* aDest, TUint aBytes)
+{
+    const __m256i mask = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                          3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    TUint i = 0;
+    for (; i+32<=aBytes; i+=32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(aSrc + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(aDest + i), _mm256_shuffle_epi8(v, mask));
+    }
+    Copy32Ssse3(aSrc + i, aDest + i, aBytes - i);
+}
+
+TBool CpuSupports(ByteSwapper::Impl aImpl)
+{
+# ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    const TBool sse2 = (info[3] & (1 << 26)) != 0;
+    const TBool ssse3 = (info[2] & (1 << 9)) != 0;
+    const TBool osxsave = (info[2] & (1 << 27)) != 0;
+    TBool avx2 = false;
+    if (maxLeaf >= 7 && osxsave && (_xgetbv(0) & 6) == 6) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+# else
+    __builtin_cpu_init();
+    const TBool sse2 = __builtin_cpu_supports("sse2");
+    const TBool ssse3 = __builtin_cpu_supports("ssse3");
+    const TBool avx2 = __builtin_cpu_supports("avx2");
+# endif
+    switch (aImpl)
+    {
+    case ByteSwapper::Impl::eSse2:
+        return sse2;
+    case ByteSwapper::Impl::eSsse3:
+        return ssse3;
+    case ByteSwapper::Impl::eAvx2:
+        return avx2 && ssse3;
+    default:
+        return false;
+    }
+}
+
+#endif // BYTESWAPPER_X86
+
+#ifdef BYTESWAPPER_NEON
+
+// NEON
+
+void Copy16Neon(const TByte* aSrc, TByte* aDest, TUint aBytes)
+{
+    TUint i = 0;
+    for (; i+16<=aBytes; i+=16) {
+        vst1q_u8(aDest + i, vrev16q_u8(vld1q_u8(aSrc + i)));
+    }
+    Copy16Scalar(aSrc + i, aDest + i, aBytes - i);
+}
+
+void Copy24Neon(const TByte* aSrc, TByte* aDest, TUint aBytes)
+{
+    // de-interleave 16 samples into planes of low, mid and high bytes then re-interleave with low/high swapped
+    TUint i = 0;
+    for (; i+48<=aBytes; i+=48) {
+        const uint8x16x3_t v = vld3q_u8(aSrc + i);
+        uint8x16x3_t swapped;
+        swapped.val[0] = v.val[2];
+        swapped.val[1] = v.val[1];
+        swapped.val[2] = v.val[0];
+        vst3q_u8(aDest + i, swapped);
+    }
+    Copy24Scalar(aSrc + i, aDest + i, aBytes - i);
+}
+
+void Copy32Neon(const TByte* aSrc, TByte* aDest, TUint aBytes)
+{
+    TUint i = 0;
+    for (; i+16<=aBytes; i+=16) {
+        vst1q_u8(aDest + i, vrev32q_u8(vld1q_u8(aSrc + i)));
+    }
+    Copy32Scalar(aSrc + i, aDest + i, aBytes - i);
+}
+
+#endif // BYTESWAPPER_NEON
+
+Kernels KernelsFor(ByteSwapper::Impl aImpl)
+{
+    Kernels k = { ByteSwapper::Impl::eScalar, Copy16Scalar, Copy24Scalar, Copy32Scalar };
+    switch (aImpl)
+    {
+#ifdef BYTESWAPPER_X86
+    case ByteSwapper::Impl::eSse2:
+        k.iCopy16 = Copy16Sse2;
+        break;
+    case ByteSwapper::Impl::eSsse3:
+        k.iCopy16 = Copy16Ssse3;
+        k.iCopy24 = Copy24Ssse3;
+        k.iCopy32 = Copy32Ssse3;
+        break;
+    case ByteSwapper::Impl::eAvx2:
+        k.iCopy16 = Copy16Avx2;
+        k.iCopy24 = Copy24Ssse3;
+        k.iCopy32 = Copy32Avx2;
+        break;
+#endif
+#ifdef BYTESWAPPER_NEON
+    case ByteSwapper::Impl::eNeon:
+        k.iCopy16 = Copy16Neon;
+        k.iCopy24 = Copy24Neon;
+        k.iCopy32 = Copy32Neon;
+        break;
+#endif
+    default:
+        return k;
+    }
+    k.iImpl = aImpl;
+    return k;
+}
+
+Kernels SelectKernels()
+{
+    static const ByteSwapper::Impl kPreferred[] = { ByteSwapper::Impl::eAvx2, ByteSwapper::Impl::eSsse3,
+                                                    ByteSwapper::Impl::eSse2, ByteSwapper::Impl::eNeon };
+    for (auto impl : kPreferred) {
+        if (ByteSwapper::IsSupported(impl)) {
+            return KernelsFor(impl);
+        }
+    }
+    return KernelsFor(ByteSwapper::Impl::eScalar);
+}
+
+std::atomic<const Kernels*> gKernels(nullptr);
+
+const Kernels& GetKernels()
+{
+    const Kernels* kernels = gKernels.load(std::memory_order_acquire);
+    if (kernels == nullptr) {
+        static const Kernels kSelected = SelectKernels();
+        kernels = &kSelected;
+        gKernels.store(kernels, std::memory_order_release);
+    }
+    return *kernels;
+}
+
+} // namespace
+
+
+// ByteSwapper
+
+void ByteSwapper::CopyToBigEndian16(const TByte* aSrc, TByte* aDest, TUint aBytes)
+{ // static
+    GetKernels().iCopy16(aSrc, aDest, aBytes);
+}
+
+void ByteSwapper::CopyToBigEndian24(const TByte* aSrc, TByte* aDest, TUint aBytes)
+{ // static
+    GetKernels().iCopy24(aSrc, aDest, aBytes);
+}
+
+void ByteSwapper::CopyToBigEndian32(const TByte* aSrc, TByte* aDest, TUint aBytes)
+{ // static
+    GetKernels().iCopy32(aSrc, aDest, aBytes);
+}
+
+ByteSwapper::Impl ByteSwapper::Selected()
+{ // static
+    return GetKernels().iImpl;
+}
+
+TBool ByteSwapper::IsSupported(Impl aImpl)
+{ // static
+    switch (aImpl)
+    {
+    case Impl::eScalar:
+        return true;
+#ifdef BYTESWAPPER_X86
+    case Impl::eSse2:
+    case Impl::eSsse3:
+    case Impl::eAvx2:
+        return CpuSupports(aImpl);
+#endif
+#ifdef BYTESWAPPER_NEON
+    case Impl::eNeon:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+const TChar* ByteSwapper::Name(Impl aImpl)
+{ // static
+    switch (aImpl)
+    {
+    case Impl::eScalar:
+        return "scalar";
+    case Impl::eSse2:
+        return "sse2";
+    case Impl::eSsse3:
+        return "ssse3";
+    case Impl::eAvx2:
+        return "avx2";
+    case Impl::eNeon:
+        return "neon";
+    }
+    return "unknown";
+}
+
+void ByteSwapper::SetImpl(Impl aImpl)
+{ // static
+    ASSERT(IsSupported(aImpl));
+    static Kernels kernels[5];
+    const TUint index = static_cast<TUint>(aImpl);
+    kernels[index] = KernelsFor(aImpl);
+    gKernels.store(&kernels[index], std::memory_order_release);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <OpenHome/Types.h>
+
+namespace OpenHome {
+namespace Media {
+
+/**
+ * Copies little endian PCM to a big endian destination.
+ *
+ * The fastest implementation supported by the current CPU is selected on first use.
+ * Source and destination may not overlap.  aBytes must be a multiple of the subsample size.
+ */
+class ByteSwapper
+{
+public:
+    enum class Impl
+    {
+        eScalar,
+        eSse2,  // 16-bit only; other widths use eScalar
+        eSsse3,
+        eAvx2,  // 16/32-bit; 24-bit uses eSsse3
+        eNeon
+    };
+public:
+    static void CopyToBigEndian16(const TByte* aSrc, TByte* aDest, TUint aBytes);
+    static void CopyToBigEndian24(const TByte* aSrc, TByte* aDest, TUint aBytes);
+    static void CopyToBigEndian32(const TByte* aSrc, TByte* aDest, TUint aBytes);
+    static Impl Selected();
+    static TBool IsSupported(Impl aImpl);
+    static const TChar* Name(Impl aImpl);
+    static void SetImpl(Impl aImpl); // for tests/benchmarks only.  aImpl must be supported
+};
+
+} // namespace Media
+} // namespace OpenHome
@@ -0,0 +1,181 @@
+#include <OpenHome/Media/Utils/GainApplicator.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Private/Standard.h>
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+// SSE2 is only used if the compiler targets it (always true for x86-64) so needs no runtime check
+# define GAIN_SSE2
+# include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+# define GAIN_NEON
+# include <arm_neon.h>
+#endif
+
+using namespace OpenHome;
+using namespace OpenHome::Media;
+
+namespace {
+
+// Scalar
+
+template <TUint kBytes> inline TInt32 ReadBigEndian(const TByte* aPtr)
+{
+    TUint32 val = 0;
+    for (TUint i=0; i<kBytes; i++) {
+        val = (val << 8) | aPtr[i];
+    }
+    return ((TInt32)(val << (32 - 8*kBytes))) >> (32 - 8*kBytes);
+}
+
+template <TUint kBytes> inline void WriteBigEndian(TByte* aPtr, TInt32 aSubsample)
+{
+    for (TUint i=0; i<kBytes; i++) {
+        aPtr[i] = (TByte)(aSubsample >> (8 * (kBytes - 1 - i)));
+    }
+}
+
+template <TUint kBytes>
+void ApplyScalar(const TByte* aSrc, TByte* aDest, TUint aBytes, TUint aGain)
+{
+    const TInt64 gain = aGain;
+    for (TUint i=0; i<aBytes; i+=kBytes) {
+        const TInt64 subsample = ReadBigEndian<kBytes>(aSrc + i);
+        WriteBigEndian<kBytes>(aDest + i, (TInt32)((subsample * gain) >> GainApplicator::kGainShift));
+    }
+}
+
+void ApplyNative32Scalar(const TInt32* aSrc, TInt32* aDest, TUint aNumSubsamples, TUint aGain)
+{
+    const TInt64 gain = aGain;
+    for (TUint i=0; i<aNumSubsamples; i++) {
+        aDest[i] = (TInt32)((aSrc[i] * gain) >> GainApplicator::kGainShift);
+    }
+}
+
+#ifdef GAIN_SSE2
+
+// SSE2
+
+void Apply16Sse2(const TByte* aSrc, TByte* aDest, TUint aBytes, TUint aGain)
+{
+    // _mm_mulhi_epi16 treats the gain as signed.  Gains of 0x8000 or more are seen as (aGain - 0x10000)
+    // so the subsample is added back to the result, giving (subsample * aGain) >> 16 exactly.
+    const __m128i gain = _mm_set1_epi16((short)aGain);
+    const __m128i addBack = (aGain >= 0x8000? _mm_set1_epi16(-1) : _mm_setzero_si128());
+    TUint i = 0;
+    for (; i+16<=aBytes; i+=16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aSrc + i));
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        __m128i r = _mm_add_epi16(_mm_mulhi_epi16(v, gain), _mm_and_si128(v, addBack));
+        r = _mm_or_si128(_mm_slli_epi16(r, 8), _mm_srli_epi16(r, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(aDest + i), r);
+    }
+    ApplyScalar<2>(aSrc + i, aDest + i, aBytes - i, aGain);
+}
+
+#endif // GAIN_SSE2
+
+#ifdef GAIN_NEON
+
+// NEON
+
+inline int32x4_t Gain32Neon(int32x4_t aSubsamples, int32x2_t aGain)
+{
+    const int32x2_t lo = vshrn_n_s64(vmull_s32(vget_low_s32(aSubsamples), aGain), GainApplicator::kGainShift);
+    const int32x2_t hi = vshrn_n_s64(vmull_s32(vget_high_s32(aSubsamples), aGain), GainApplicator::kGainShift);
+    return vcombine_s32(lo, hi);
+}
+
+void Apply16Neon(const TByte* aSrc, TByte* aDest, TUint aBytes, TUint aGain)
+{
+    // widen to 32 bits; a 16-bit subsample multiplied by a gain of up to kUnity fits
+    const int32x4_t gain = vdupq_n_s32((int32_t)aGain);
+    TUint i = 0;
+    for (; i+16<=aBytes; i+=16) {
+        const int16x8_t v = vreinterpretq_s16_u8(vrev16q_u8(vld1q_u8(aSrc + i)));
+        const int32x4_t lo = vshrq_n_s32(vmulq_s32(vmovl_s16(vget_low_s16(v)), gain), GainApplicator::kGainShift);
+        const int32x4_t hi = vshrq_n_s32(vmulq_s32(vmovl_s16(vget_high_s16(v)), gain), GainApplicator::kGainShift);
+        const int16x8_t r = vcombine_s16(vmovn_s32(lo), vmovn_s32(hi));
+        vst1q_u8(aDest + i, vrev16q_u8(vreinterpretq_u8_s16(r)));
+    }
+    ApplyScalar<2>(aSrc + i, aDest + i, aBytes - i, aGain);
+}
+
+void Apply32Neon(const TByte* aSrc, TByte* aDest, TUint aBytes, TUint aGain)
+{
+    const int32x2_t gain = vdup_n_s32((int32_t)aGain);
+    TUint i = 0;
+    for (; i+16<=aBytes; i+=16) {
+        const int32x4_t v = vreinterpretq_s32_u8(vrev32q_u8(vld1q_u8(aSrc + i)));
+        vst1q_u8(aDest + i, vrev32q_u8(vreinterpretq_u8_s32(Gain32Neon(v, gain))));
+    }
+    ApplyScalar<4>(aSrc + i, aDest + i, aBytes - i, aGain);
+}
+
+void ApplyNative32Neon(const TInt32* aSrc, TInt32* aDest, TUint aNumSubsamples, TUint aGain)
+{
+    const int32x2_t gain = vdup_n_s32((int32_t)aGain);
+    TUint i = 0;
+    for (; i+4<=aNumSubsamples; i+=4) {
+        vst1q_s32(aDest + i, Gain32Neon(vld1q_s32(aSrc + i), gain));
+    }
+    ApplyNative32Scalar(aSrc + i, aDest + i, aNumSubsamples - i, aGain);
+}
+
+#endif // GAIN_NEON
+
+} // namespace
+
+
+// GainApplicator
+
+TUint GainApplicator::FromAttenuation(TUint aAttenuation, TUint aUnityAttenuation)
+{ // static
+    ASSERT(aUnityAttenuation != 0);
+    const TUint attenuation = std::min(aAttenuation, aUnityAttenuation);
+    return (TUint)(((TUint64)attenuation << kGainShift) / aUnityAttenuation);
+}
+
+void GainApplicator::Apply(const TByte* aSrc, TByte* aDest, TUint aBytes, TUint aBitDepth, TUint aGain)
+{ // static
+    ASSERT(aGain <= kUnity);
+    switch (aBitDepth)
+    {
+    case 8:
+        ApplyScalar<1>(aSrc, aDest, aBytes, aGain);
+        break;
+    case 16:
+#if defined(GAIN_SSE2)
+        Apply16Sse2(aSrc, aDest, aBytes, aGain);
+#elif defined(GAIN_NEON)
+        Apply16Neon(aSrc, aDest, aBytes, aGain);
+#else
+        ApplyScalar<2>(aSrc, aDest, aBytes, aGain);
+#endif
+        break;
+    case 24:
+        ApplyScalar<3>(aSrc, aDest, aBytes, aGain);
+        break;
+    case 32:
+#ifdef GAIN_NEON
+        Apply32Neon(aSrc, aDest, aBytes, aGain);
+#else
+        ApplyScalar<4>(aSrc, aDest, aBytes, aGain);
+#endif
+        break;
+    default:
+        ASSERTS();
+    }
+}
+
+void GainApplicator::ApplyNative32(const TInt32* aSrc, TInt32* aDest, TUint aNumSubsamples, TUint aGain)
+{ // static
+    ASSERT(aGain <= kUnity);
+#ifdef GAIN_NEON
+    ApplyNative32Neon(aSrc, aDest, aNumSubsamples, aGain);
+#else
+    ApplyNative32Scalar(aSrc, aDest, aNumSubsamples, aGain);
+#endif
+}
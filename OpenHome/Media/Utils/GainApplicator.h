@@ -0,0 +1,28 @@
+#pragma once
+
+#include <OpenHome/Types.h>
+
+namespace OpenHome {
+namespace Media {
+
+/**
+ * Applies a constant gain to PCM audio.
+ *
+ * Gains are fixed point with kGainShift fractional bits and may not exceed kUnity.
+ * Packed audio is big endian, as held by DecodedAudio.  aSrc and aDest may be the same
+ * buffer but may not otherwise overlap.
+ * Holds no state so may be used by any number of threads at once.
+ */
+class GainApplicator
+{
+public:
+    static const TUint kGainShift = 16;
+    static const TUint kUnity = 1 << kGainShift;
+public:
+    static TUint FromAttenuation(TUint aAttenuation, TUint aUnityAttenuation);
+    static void Apply(const TByte* aSrc, TByte* aDest, TUint aBytes, TUint aBitDepth, TUint aGain);
+    static void ApplyNative32(const TInt32* aSrc, TInt32* aDest, TUint aNumSubsamples, TUint aGain);
+};
+
+} // namespace Media
+} // namespace OpenHome
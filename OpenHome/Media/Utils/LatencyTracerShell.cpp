@@ -0,0 +1,74 @@
+#include <OpenHome/Media/Utils/LatencyTracerShell.h>
+#include <OpenHome/Private/Shell.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Ascii.h>
+#include <OpenHome/Media/Pipeline/LatencyTracer.h>
+
+#include <vector>
+
+using namespace OpenHome;
+using namespace OpenHome::Media;
+
+const TChar LatencyTracerShell::kShellCommand[] = "latency";
+
+LatencyTracerShell::LatencyTracerShell(IShell& aShell)
+    : iShell(aShell)
+{
+    iShell.AddCommandHandler(kShellCommand, *this);
+}
+
+LatencyTracerShell::~LatencyTracerShell()
+{
+    iShell.RemoveCommandHandler(kShellCommand);
+}
+
+void LatencyTracerShell::HandleShellCommand(Brn /*aCommand*/, const std::vector<Brn>& aArgs, IWriter& aResponse)
+{
+    if (aArgs.size() == 0 || aArgs.size() > 2) {
+        aResponse.Write(Brn("Unexpected number of arguments for \'latency\' command\n"));
+        return;
+    }
+    const Brx& cmd = aArgs[0];
+    if (cmd == Brn("on")) {
+        TUint interval = kDefaultSampleInterval;
+        if (aArgs.size() == 2) {
+            try {
+                interval = Ascii::Uint(aArgs[1]);
+            }
+            catch (AsciiError&) {
+                interval = 0;
+            }
+            if (interval == 0) {
+                aResponse.Write(Brn("Error: sample interval must be a positive integer\n"));
+                return;
+            }
+        }
+        LatencyTracer::Enable(interval);
+    }
+    else if (aArgs.size() != 1) {
+        aResponse.Write(Brn("Unexpected arguments for \'latency\' command\n"));
+    }
+    else if (cmd == Brn("off")) {
+        LatencyTracer::Disable();
+    }
+    else if (cmd == Brn("reset")) {
+        LatencyTracer::Reset();
+    }
+    else if (cmd == Brn("show")) {
+        LatencyTracer::WriteJson(aResponse);
+        aResponse.Write(Brn("\n"));
+    }
+    else {
+        aResponse.Write(Brn("Unexpected arguments for \'latency\' command\n"));
+    }
+}
+
+void LatencyTracerShell::DisplayHelp(IWriter& aResponse)
+{
+    aResponse.Write(Brn("latency on [interval]|off|reset|show\n"));
+    aResponse.Write(Brn("  on [interval] - trace one audio msg in every [interval] (default 100) from protocol to animator\n"));
+    aResponse.Write(Brn("  off - stop tracing.  Histograms are retained\n"));
+    aResponse.Write(Brn("  reset - clear per-hop latency histograms\n"));
+    aResponse.Write(Brn("  show - write per-hop latency histograms as JSON\n"));
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <OpenHome/Private/Shell.h>
+#include <OpenHome/Types.h>
+
+namespace OpenHome {
+namespace Media {
+
+class LatencyTracerShell : private IShellCommandHandler
+{
+    static const TChar kShellCommand[];
+    static const TUint kDefaultSampleInterval = 100;
+public:
+    LatencyTracerShell(IShell& aShell);
+    ~LatencyTracerShell();
+private: // from IShellCommandHandler
+    void HandleShellCommand(Brn aCommand, const std::vector<Brn>& aArgs, IWriter& aResponse) override;
+    void DisplayHelp(IWriter& aResponse) override;
+private:
+    IShell& iShell;
+};
+
+} // namespace Media
+} // namespace OpenHome
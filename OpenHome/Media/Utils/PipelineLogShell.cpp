@@ -0,0 +1,67 @@
+#include <OpenHome/Media/Utils/PipelineLogShell.h>
+#include <OpenHome/Private/Shell.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Media/PipelineManager.h>
+
+#include <vector>
+
+using namespace OpenHome;
+using namespace OpenHome::Media;
+
+const TChar PipelineLogShell::kShellCommand[] = "pipeline_log";
+
+PipelineLogShell::PipelineLogShell(PipelineManager& aPipeline, IShell& aShell)
+    : iPipeline(aPipeline)
+    , iShell(aShell)
+{
+    iShell.AddCommandHandler(kShellCommand, *this);
+}
+
+PipelineLogShell::~PipelineLogShell()
+{
+    iShell.RemoveCommandHandler(kShellCommand);
+}
+
+void PipelineLogShell::HandleShellCommand(Brn /*aCommand*/, const std::vector<Brn>& aArgs, IWriter& aResponse)
+{
+    if (aArgs.size() == 1 && aArgs[0] == Brn("list")) {
+        std::vector<const TChar*> ids;
+        iPipeline.GetLoggerIds(ids);
+        for (auto id : ids) {
+            aResponse.Write(Brn(id));
+            aResponse.Write(Brn("\n"));
+        }
+        return;
+    }
+    if (aArgs.size() < 2 || (aArgs[0] != Brn("on") && aArgs[0] != Brn("off"))) {
+        aResponse.Write(Brn("Unexpected arguments for \'pipeline_log\' command\n"));
+        return;
+    }
+    // element names may contain spaces, which the shell will have split into separate args
+    Bws<64> id;
+    for (TUint i=1; i<aArgs.size(); i++) {
+        if (i > 1) {
+            id.Append(' ');
+        }
+        if (id.Bytes() + aArgs[i].Bytes() > id.MaxBytes()) {
+            aResponse.Write(Brn("Error: element name too long\n"));
+            return;
+        }
+        id.Append(aArgs[i]);
+    }
+    const TBool enable = (aArgs[0] == Brn("on"));
+    if (!iPipeline.SetLoggerEnabled(id, enable)) {
+        aResponse.Write(Brn("Error: no logger called \'"));
+        aResponse.Write(id);
+        aResponse.Write(Brn("\'.  Use \'pipeline_log list\' to see valid names\n"));
+    }
+}
+
+void PipelineLogShell::DisplayHelp(IWriter& aResponse)
+{
+    aResponse.Write(Brn("pipeline_log list|on [element]|off [element]\n"));
+    aResponse.Write(Brn("  list - names of elements whose output can be logged\n"));
+    aResponse.Write(Brn("  on [element] - log all msgs pulled from [element]\n"));
+    aResponse.Write(Brn("  off [element] - stop logging msgs pulled from [element]\n"));
+}
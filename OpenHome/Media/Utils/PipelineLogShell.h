@@ -0,0 +1,26 @@
+#pragma once
+
+#include <OpenHome/Private/Shell.h>
+#include <OpenHome/Types.h>
+
+namespace OpenHome {
+namespace Media {
+
+class PipelineManager;
+
+class PipelineLogShell : private IShellCommandHandler
+{
+    static const TChar kShellCommand[];
+public:
+    PipelineLogShell(PipelineManager& aPipeline, IShell& aShell);
+    ~PipelineLogShell();
+private: // from IShellCommandHandler
+    void HandleShellCommand(Brn aCommand, const std::vector<Brn>& aArgs, IWriter& aResponse) override;
+    void DisplayHelp(IWriter& aResponse) override;
+private:
+    PipelineManager& iPipeline;
+    IShell& iShell;
+};
+
+} // namespace Media
+} // namespace OpenHome
@@ -0,0 +1,57 @@
+#include <OpenHome/Media/Utils/PipelineProfileShell.h>
+#include <OpenHome/Private/Shell.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Media/PipelineManager.h>
+
+#include <vector>
+
+using namespace OpenHome;
+using namespace OpenHome::Media;
+
+const TChar PipelineProfileShell::kShellCommand[] = "pipeline_profile";
+
+PipelineProfileShell::PipelineProfileShell(PipelineManager& aPipeline, IShell& aShell)
+    : iPipeline(aPipeline)
+    , iShell(aShell)
+{
+    iShell.AddCommandHandler(kShellCommand, *this);
+}
+
+PipelineProfileShell::~PipelineProfileShell()
+{
+    iShell.RemoveCommandHandler(kShellCommand);
+}
+
+void PipelineProfileShell::HandleShellCommand(Brn /*aCommand*/, const std::vector<Brn>& aArgs, IWriter& aResponse)
+{
+    if (aArgs.size() != 1) {
+        aResponse.Write(Brn("Unexpected number of arguments for \'pipeline_profile\' command\n"));
+        return;
+    }
+    const Brx& cmd = aArgs[0];
+    if (cmd == Brn("on") || cmd == Brn("off")) {
+        if (!iPipeline.SetProfilingEnabled(cmd == Brn("on"))) {
+            aResponse.Write(Brn("Error: profiling requires pipeline Loggers (EPipelineSupportElementsLogger)\n"));
+        }
+    }
+    else if (cmd == Brn("reset")) {
+        iPipeline.ResetProfile();
+    }
+    else if (cmd == Brn("show")) {
+        iPipeline.WriteProfile(aResponse);
+        aResponse.Write(Brn("\n"));
+    }
+    else {
+        aResponse.Write(Brn("Unexpected arguments for \'pipeline_profile\' command\n"));
+    }
+}
+
+void PipelineProfileShell::DisplayHelp(IWriter& aResponse)
+{
+    aResponse.Write(Brn("pipeline_profile on|off|reset|show\n"));
+    aResponse.Write(Brn("  on - collect time spent, msg counts and reservoir levels at each pipeline element\n"));
+    aResponse.Write(Brn("  off - stop collecting.  Counters are retained\n"));
+    aResponse.Write(Brn("  reset - clear all counters\n"));
+    aResponse.Write(Brn("  show - write all counters as JSON\n"));
+}